@@ -4,12 +4,15 @@
 // #include <windows.h>
 #include <vector>
 #include <string>
+#include <filesystem>
 #include <fstream>
+#include <future>
 #include <iostream>
+#include <unordered_map>
 
 // 3rd-party
 #include <fbxsdk.h>
-#include <draco/compression/encode.h>
+#include <draco/compression/expert_encode.h>
 #include <draco/core/encoder_buffer.h>
 #include <draco/mesh/mesh.h>
 
@@ -19,6 +22,10 @@
 #include <nlohmann/json.hpp>
 
 #include "core/core.h"
+#include "core/gltf_export.h"
+#include "core/mesh_builder.h"
+#include "core/mesh_simplify.h"
+#include "core/meshlet_builder.h"
 
 namespace OIIO = OpenImageIO_v3_0;
 
@@ -61,154 +68,241 @@ bool SaveDracoFile(const std::string &filename, draco::EncoderBuffer &buffer)
     return true;
 }
 
-// Process a single mesh and export to Draco
-void ProcessMesh(FbxMesh *pMesh, const std::string &outputPrefix, int meshIndex)
+// Encode a mesh to Draco and save it to a .drc file
+bool ExportDracoFile(const IndexedMesh &mesh, const std::string &outputFile, const MeshExportOptions &exportOptions)
 {
-    // Get control points (vertices)
-    int controlPointCount = pMesh->GetControlPointsCount();
-    if (controlPointCount == 0)
+    std::unique_ptr<draco::Mesh> dracoMesh;
+    if (exportOptions.meshlets)
     {
-        std::cerr << "Mesh " << meshIndex << " has no control points." << std::endl;
-        return;
+        // Meshlets reorder the triangles and vertices, keep the mesh itself for comparisons
+        IndexedMesh orderedMesh = mesh;
+        const MeshletMesh meshlets = BuildMeshlets(orderedMesh);
+        dracoMesh = ToDracoMesh(orderedMesh);
+        AddMeshletMetadata(*dracoMesh, meshlets);
     }
-    FbxVector4 *controlPoints = pMesh->GetControlPoints();
+    else
+        dracoMesh = ToDracoMesh(mesh);
 
-    // Create Draco mesh
-    std::unique_ptr<draco::Mesh> dracoMesh = std::make_unique<draco::Mesh>();
-    dracoMesh->set_num_points(controlPointCount);
+    draco::ExpertEncoder encoder(*dracoMesh);
+    ConfigureDracoEncoder(encoder, *dracoMesh, exportOptions);
 
-    // Add positions
-    std::vector<float> positions(controlPointCount * 3);
-    for (int i = 0; i < controlPointCount; ++i)
+    draco::EncoderBuffer buffer;
+    if (!encoder.EncodeToBuffer(&buffer).ok())
     {
-        positions[i * 3] = static_cast<float>(controlPoints[i][0]);
-        positions[i * 3 + 1] = static_cast<float>(controlPoints[i][1]);
-        positions[i * 3 + 2] = static_cast<float>(controlPoints[i][2]);
+        std::cerr << "Failed to encode mesh " << outputFile << std::endl;
+        return false;
     }
-    draco::GeometryAttribute posAttr;
-    posAttr.Init(draco::GeometryAttribute::POSITION, nullptr, 3, draco::DT_FLOAT32, false, sizeof(float) * 3, 0);
-    int posAttrId = dracoMesh->AddAttribute(posAttr, true, controlPointCount);
-    draco::PointAttribute *posAttribute = dracoMesh->attribute(posAttrId);
-    for (int i = 0; i < controlPointCount; ++i)
+    return SaveDracoFile(outputFile, buffer);
+}
+
+// Unique meshes exported so far and the nodes that instance them
+struct SceneExport
+{
+    std::string outputPrefix;
+    MeshExportOptions exportOptions;
+    std::unordered_map<FbxMesh *, int> meshIds;           // Meshes shared by several nodes, -1 if not exported
+    std::unordered_multimap<uint64_t, int> meshIdsByHash; // Copies of the same geometry
+    std::vector<IndexedMesh> meshes;                      // Indexed by mesh id
+    nlohmann::json meshManifest = nlohmann::json::array();
+    nlohmann::json nodeManifest = nlohmann::json::array();
+};
+
+// Process a single mesh and export to Draco. Returns the id of the mesh, which is the id of an
+// identical mesh exported before if there is one, or -1 if the mesh cannot be exported.
+int ProcessMesh(FbxMesh *pMesh, SceneExport &scene)
+{
+    if (const auto it = scene.meshIds.find(pMesh); it != scene.meshIds.end())
+        return it->second;
+    scene.meshIds[pMesh] = -1;
+
+    const int meshIndex = static_cast<int>(scene.meshes.size());
+    if (pMesh->GetControlPointsCount() == 0)
     {
-        posAttribute->SetAttributeValue(draco::AttributeValueIndex(i), &positions[i * 3]);
+        std::cerr << "Mesh " << pMesh->GetName() << " has no control points." << std::endl;
+        return -1;
     }
 
-    // Add UVs (multiple channels)
-    std::vector<int> uvAttrIds;
-    int uvChannelCount = pMesh->GetElementUVCount();
-    for (int uvChannel = 0; uvChannel < uvChannelCount; ++uvChannel)
+    // Triangulate and weld polygon vertices with equal attributes
+    IndexedMesh mesh = BuildIndexedMesh(pMesh, scene.exportOptions);
+    if (mesh.TriangleCount() == 0)
     {
-        FbxGeometryElementUV *uvElement = pMesh->GetElementUV(uvChannel);
-        if (!uvElement)
-            continue;
-
-        std::vector<float> uvs;
-        int uvCount = controlPointCount; // Default to control point count
-        if (uvElement->GetMappingMode() == FbxGeometryElement::eByControlPoint)
-        {
-            uvs.resize(controlPointCount * 2);
-            for (int i = 0; i < controlPointCount; ++i)
-            {
-                FbxVector2 uv = uvElement->GetDirectArray().GetAt(i);
-                uvs[i * 2] = static_cast<float>(uv[0]);
-                uvs[i * 2 + 1] = static_cast<float>(uv[1]);
-            }
-        }
-        else if (uvElement->GetMappingMode() == FbxGeometryElement::eByPolygonVertex)
-        {
-            uvCount = uvElement->GetDirectArray().GetCount();
-            uvs.resize(uvCount * 2);
-            for (int i = 0; i < uvCount; ++i)
-            {
-                FbxVector2 uv = uvElement->GetDirectArray().GetAt(i);
-                uvs[i * 2] = static_cast<float>(uv[0]);
-                uvs[i * 2 + 1] = static_cast<float>(uv[1]);
-            }
-        }
-
-        draco::GeometryAttribute uvAttr;
-        uvAttr.Init(draco::GeometryAttribute::TEX_COORD, nullptr, 2, draco::DT_FLOAT32, false, sizeof(float) * 2, 0);
-        int uvAttrId = dracoMesh->AddAttribute(uvAttr, true, uvCount);
-        draco::PointAttribute *uvAttribute = dracoMesh->attribute(uvAttrId);
-        for (int i = 0; i < uvCount; ++i)
-        {
-            uvAttribute->SetAttributeValue(draco::AttributeValueIndex(i), &uvs[i * 2]);
-        }
-        uvAttrIds.push_back(uvAttrId);
-
-        // Add UV set name as metadata
-        std::string uvSetName = uvElement->GetName();
-        if (uvSetName.empty())
-            uvSetName = "uv" + std::to_string(uvChannel);
-        auto metadata = std::make_unique<draco::AttributeMetadata>();
-        metadata->AddEntryString("name", uvSetName);
-        dracoMesh->AddAttributeMetadata(uvAttrId, std::move(metadata));
+        std::cerr << "Mesh " << pMesh->GetName() << " has no triangles." << std::endl;
+        return -1;
     }
 
-    // Add faces (triangle indices)
-    int polygonCount = pMesh->GetPolygonCount();
-    std::vector<draco::Mesh::Face> faces;
-    for (int poly = 0; poly < polygonCount; ++poly)
+    // Reuse copies of the geometry in other FbxMesh objects
+    const uint64_t hash = HashIndexedMesh(mesh);
+    const auto [first, last] = scene.meshIdsByHash.equal_range(hash);
+    for (auto it = first; it != last; ++it)
     {
-        int polySize = pMesh->GetPolygonSize(poly);
-        if (polySize != 3)
-            continue; // Draco only supports triangles
-        draco::Mesh::Face face;
-        for (int vert = 0; vert < 3; ++vert)
+        if (SameMeshContent(scene.meshes[it->second], mesh))
         {
-            face[vert] = draco::PointIndex(pMesh->GetPolygonVertex(poly, vert));
+            scene.meshIds[pMesh] = it->second;
+            return it->second;
         }
-        faces.push_back(face);
-    }
-    dracoMesh->SetNumFaces(faces.size());
-    for (size_t i = 0; i < faces.size(); ++i)
-    {
-        dracoMesh->SetFace(draco::FaceIndex(static_cast<uint32_t>(i)), faces[i]);
     }
 
-    // Encode to Draco
-    draco::Encoder encoder;
-    encoder.SetSpeedOptions(5, 5); // Moderate compression
+    std::cout << "Mesh " << meshIndex << ": " << mesh.sourceCornerCount << " polygon vertices welded to "
+              << mesh.VertexCount() << " vertices, " << mesh.TriangleCount() << " triangles" << std::endl;
 
-    draco::EncoderBuffer buffer;
-    if (!encoder.EncodeMeshToBuffer(*dracoMesh, &buffer).ok())
+    // Simplify and encode the levels of detail in parallel with the full mesh
+    struct LevelOfDetail
+    {
+        IndexedMesh mesh;
+        std::string outputFile;
+        bool exported;
+    };
+    const std::string meshPrefix = scene.outputPrefix + "_mesh" + std::to_string(meshIndex);
+    std::vector<std::future<LevelOfDetail>> lodTasks;
+    for (size_t lod = 0; lod < scene.exportOptions.lodRatios.size(); ++lod)
     {
-        std::cerr << "Failed to encode mesh " << meshIndex << std::endl;
-        return;
+        lodTasks.push_back(std::async(std::launch::async,
+                                      [&mesh, &scene, &meshPrefix, lod]()
+                                      {
+                                          LevelOfDetail level;
+                                          level.mesh = SimplifyMesh(mesh, scene.exportOptions.lodRatios[lod]);
+                                          level.outputFile = meshPrefix + "_lod" + std::to_string(lod + 1) + ".drc";
+                                          level.exported =
+                                              level.mesh.TriangleCount() > 0 &&
+                                              ExportDracoFile(level.mesh, level.outputFile, scene.exportOptions);
+                                          return level;
+                                      }));
     }
 
-    // Save to .drc file
-    std::string outputFile = outputPrefix + "_mesh" + std::to_string(meshIndex) + ".drc";
-    if (SaveDracoFile(outputFile, buffer))
+    // Save to .drc file. A level of detail that fails is left out of the manifest, the mesh is still
+    // usable without it. Without the mesh the levels of detail are deleted, nothing refers to them.
+    std::string outputFile = meshPrefix + ".drc";
+    const bool exported = ExportDracoFile(mesh, outputFile, scene.exportOptions);
+    nlohmann::json lods = nlohmann::json::array();
+    for (size_t lod = 0; lod < lodTasks.size(); ++lod)
     {
-        std::cout << "Exported: " << outputFile << std::endl;
+        const LevelOfDetail level = lodTasks[lod].get();
+        if (!exported)
+        {
+            std::error_code ec;
+            if (level.exported)
+                std::filesystem::remove(level.outputFile, ec);
+            continue;
+        }
+        if (!level.exported)
+        {
+            std::cerr << "Skipped level of detail " << lod + 1 << " of mesh " << meshIndex << "." << std::endl;
+            continue;
+        }
+        lods.push_back({
+            {"ratio", scene.exportOptions.lodRatios[lod]},
+            {"file", std::filesystem::path(level.outputFile).filename().string()},
+            {"vertices", level.mesh.VertexCount()},
+            {"triangles", level.mesh.TriangleCount()},
+        });
     }
+    if (!exported)
+        return -1;
+    std::cout << "Exported: " << outputFile;
+    for (const auto &lod : lods)
+        std::cout << ", " << lod["file"].get<std::string>() << " (" << lod["triangles"] << " triangles)";
+    std::cout << std::endl;
+
+    scene.meshManifest.push_back({
+        {"id", meshIndex},
+        {"name", pMesh->GetName()},
+        {"file", std::filesystem::path(outputFile).filename().string()},
+        {"vertices", mesh.VertexCount()},
+        {"triangles", mesh.TriangleCount()},
+    });
+    if (!lods.empty())
+        scene.meshManifest.back()["lods"] = lods;
+    scene.meshIdsByHash.emplace(hash, meshIndex);
+    scene.meshIds[pMesh] = meshIndex;
+    scene.meshes.push_back(std::move(mesh));
+    return meshIndex;
+}
+
+// World transform of the geometry of a node, including its geometric (pivot) offsets, as 16
+// numbers in column-major order for column vectors, as in glTF.
+nlohmann::json NodeTransform(FbxNode *pNode)
+{
+    const FbxAMatrix geometric(pNode->GetGeometricTranslation(FbxNode::eSourcePivot),
+                               pNode->GetGeometricRotation(FbxNode::eSourcePivot),
+                               pNode->GetGeometricScaling(FbxNode::eSourcePivot));
+    const FbxAMatrix world = pNode->EvaluateGlobalTransform() * geometric;
+    nlohmann::json transform = nlohmann::json::array();
+    for (int row = 0; row < 4; ++row)
+        for (int column = 0; column < 4; ++column)
+            transform.push_back(world.Get(row, column));
+    return transform;
 }
 
 // Traverse scene to find meshes
-void ProcessNode(FbxNode *pNode, const std::string &outputPrefix, int &meshIndex)
+void ProcessNode(FbxNode *pNode, SceneExport &scene)
 {
     if (pNode->GetNodeAttribute() && pNode->GetNodeAttribute()->GetAttributeType() == FbxNodeAttribute::eMesh)
     {
         FbxMesh *mesh = pNode->GetMesh();
         if (mesh)
         {
-            ProcessMesh(mesh, outputPrefix, meshIndex++);
+            const int meshId = ProcessMesh(mesh, scene);
+            if (meshId >= 0)
+                scene.nodeManifest.push_back({
+                    {"name", pNode->GetName()},
+                    {"mesh", meshId},
+                    {"transform", NodeTransform(pNode)},
+                });
         }
     }
     for (int i = 0; i < pNode->GetChildCount(); ++i)
     {
-        ProcessNode(pNode->GetChild(i), outputPrefix, meshIndex);
+        ProcessNode(pNode->GetChild(i), scene);
     }
 }
 
+// Writes the manifest mapping the nodes of the scene to the exported meshes
+bool SaveSceneManifest(const std::string &filename, const SceneExport &scene)
+{
+    std::ofstream outFile(filename);
+    if (!outFile)
+    {
+        std::cerr << "Failed to open output file: " << filename << std::endl;
+        return false;
+    }
+    const nlohmann::json manifest = {{"meshes", scene.meshManifest}, {"nodes", scene.nodeManifest}};
+    outFile << manifest.dump(2) << std::endl;
+    return true;
+}
+
 extern "C"
 {
 
     VCPP_API int vcpp_ktx(int argc, char **argv, const char *options)
     {
-        return ktx_main(argc, argv);
+        if (!options)
+            return ktx_main(argc, argv);
+
+        const auto j = nlohmann::json::parse(options, nullptr, false);
+        if (j.is_discarded() || !j.is_object())
+            return ktx_main(argc, argv);
+
+        // {"trace": "<file>"} is passed on as --trace <file> to ktx create.
+        std::vector<std::string> args(argv, argv + argc);
+        const auto trace = j.value("trace", std::string{});
+        if (!trace.empty() && args.size() >= 2 && args[1] == "create")
+            args.insert(args.begin() + 2, {"--trace", trace});
+
+        std::vector<char *> argvs;
+        for (auto &arg : args)
+            argvs.push_back(arg.data());
+        argvs.push_back(nullptr);
+        const int argcs = static_cast<int>(args.size());
+
+        if (j.value("quiet", false))
+            return ktx_main_capture(argcs, argvs.data(), nullptr, nullptr, nullptr, 0, nullptr);
+        return ktx_main(argcs, argvs.data());
+    }
+
+    VCPP_API int vcpp_ktx_capture(int argc, char **argv, ktx_log_callback logCallback, void *userData,
+                                  char *outputBuffer, size_t outputBufferSize, size_t *outputSize)
+    {
+        return ktx_main_capture(argc, argv, logCallback, userData, outputBuffer, outputBufferSize, outputSize);
     }
 
     VCPP_API int vcpp_fbx(int argc, char *argv[], const char *options)
@@ -222,6 +316,11 @@ extern "C"
         const char *inputFile = argv[1];
         std::string outputPrefix = argv[2];
 
+        SceneExport scene;
+        scene.outputPrefix = outputPrefix;
+        if (!ParseMeshExportOptions(options, scene.exportOptions))
+            return 1;
+
         // Initialize FBX SDK
         FbxManager *lManager = nullptr;
         FbxScene *lScene = nullptr;
@@ -235,13 +334,25 @@ extern "C"
             return 1;
         }
 
-        // Process meshes
-        int meshIndex = 0;
-        ProcessNode(lScene->GetRootNode(), outputPrefix, meshIndex);
+        if (scene.exportOptions.glb)
+        {
+            const bool exported = ExportGlb(lScene, inputFile, outputPrefix + ".glb", scene.exportOptions);
+            lManager->Destroy();
+            return exported ? 0 : 1;
+        }
+
+        // Process meshes, exporting each unique mesh once
+        ProcessNode(lScene->GetRootNode(), scene);
 
         // Cleanup
         lManager->Destroy();
-        std::cout << "Processed " << meshIndex << " meshes." << std::endl;
+
+        const std::string manifestFile = outputPrefix + "_scene.json";
+        if (!SaveSceneManifest(manifestFile, scene))
+            return 1;
+        std::cout << "Exported: " << manifestFile << std::endl;
+        std::cout << "Processed " << scene.nodeManifest.size() << " mesh nodes, " << scene.meshes.size()
+                  << " unique meshes." << std::endl;
         return 0;
     }
 
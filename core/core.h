@@ -1,5 +1,7 @@
 #pragma once
 
+#include "ktx_main.h"
+
 #ifdef _WIN32
 #define VCPP_API __declspec(dllexport)
 #else
@@ -8,8 +10,18 @@
 
 extern "C"
 {
+    // options: stringified JSON. {"quiet": true} discards all console output of the command.
+    // {"trace": "<file>"} writes a Chrome trace of the processing stages of ktx create to file.
     VCPP_API int vcpp_ktx(int argc, char *argv[], const char *options = nullptr);
 
+    // Runs a ktx command without console I/O, see ktx_main_capture.
+    VCPP_API int vcpp_ktx_capture(int argc, char *argv[], ktx_log_callback logCallback, void *userData,
+                                  char *outputBuffer, size_t outputBufferSize, size_t *outputSize);
+
+    // Exports every unique mesh of the FBX file argv[1] once to <argv[2]>_mesh<N>.drc and writes
+    // <argv[2]>_scene.json mapping the mesh nodes to mesh ids and world transforms, or with
+    // {"output": "glb"} writes the whole scene with its materials and textures to <argv[2]>.glb.
+    // options: stringified JSON of the attributes and Draco settings, see MeshExportOptions.
     VCPP_API int vcpp_fbx(int argc, char *argv[], const char *options = nullptr);
 
     VCPP_API int vcpp_image_denoise(const char *options = nullptr);
@@ -0,0 +1,640 @@
+#include "core/gltf_export.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include <draco/compression/expert_encode.h>
+#include <draco/core/encoder_buffer.h>
+#include <OpenImageIO/imageio.h>
+#include <nlohmann/json.hpp>
+
+#include "ktx_main.h"
+#include "core/meshlet_builder.h"
+
+namespace OIIO = OpenImageIO_v3_0;
+
+namespace
+{
+    constexpr int kUnsignedShort = 5123;
+    constexpr int kUnsignedInt = 5125;
+    constexpr int kFloat = 5126;
+    constexpr int kTriangles = 4;
+
+    // A Draco-compressed primitive of a mesh, shared by all glTF meshes made from the mesh
+    struct EncodedPrimitive
+    {
+        int slot;
+        nlohmann::json primitive; // Without the material
+    };
+
+    // Directory for the intermediate files of one export, created on first use. Its name is unique
+    // across processes since creating it fails if the name is taken. Removed with its contents when
+    // the export ends, whichever way it ends.
+    class TemporaryDirectory
+    {
+    public:
+        TemporaryDirectory() = default;
+        TemporaryDirectory(const TemporaryDirectory &) = delete;
+        TemporaryDirectory &operator=(const TemporaryDirectory &) = delete;
+        ~TemporaryDirectory()
+        {
+            std::error_code ec;
+            if (!path.empty())
+                std::filesystem::remove_all(path, ec);
+        }
+
+        // Returns the path of a file in the directory, empty if the directory cannot be created
+        std::filesystem::path File(const std::string &name)
+        {
+            std::error_code ec;
+            if (path.empty())
+            {
+                const std::filesystem::path parent = std::filesystem::temp_directory_path(ec);
+                std::random_device random;
+                for (int attempt = 0; attempt < 16 && path.empty() && !ec; ++attempt)
+                {
+                    const auto candidate = parent / ("vcpp_fbx_" + std::to_string(random()) + std::to_string(random()));
+                    if (std::filesystem::create_directory(candidate, ec))
+                        path = candidate;
+                }
+                if (path.empty())
+                    return {};
+            }
+            return path / name;
+        }
+
+    private:
+        std::filesystem::path path;
+    };
+
+    // State of a GLB export. Buffer views are stored in the order they are written to the BIN chunk:
+    // all geometry in node order, followed by all images, so the file can be read front to back
+    // with the complete scene description known from the JSON chunk at its start.
+    struct GlbExport
+    {
+        MeshExportOptions exportOptions;
+        std::filesystem::path fbxDirectory;
+        nlohmann::json gltf;
+        std::vector<std::vector<uint8_t>> geometryViews;
+        std::vector<std::vector<uint8_t>> imageViews;
+        std::vector<int> geometryViewIds; // glTF buffer view index of each geometry view
+        std::vector<int> imageViewIds;
+
+        std::unordered_map<FbxMesh *, int> contentIds;           // Meshes shared by several nodes
+        std::unordered_multimap<uint64_t, int> contentIdsByHash; // Copies of the same geometry
+        std::vector<IndexedMesh> contents;
+        std::vector<std::vector<EncodedPrimitive>> contentPrimitives;
+        std::map<std::pair<int, std::vector<int>>, int> meshIds; // (content, materials) -> glTF mesh
+        std::unordered_map<FbxSurfaceMaterial *, int> materialIds;
+        std::map<std::pair<std::string, bool>, int> textureIds; // (path, sRGB) -> glTF texture, -1 if failed
+        TemporaryDirectory temporaryDirectory;
+    };
+
+    int Push(nlohmann::json &array, nlohmann::json value)
+    {
+        array.push_back(std::move(value));
+        return static_cast<int>(array.size()) - 1;
+    }
+
+    // Adds a buffer view whose offset is assigned when the BIN chunk is written
+    int AddBufferView(GlbExport &glb, std::vector<uint8_t> data, bool image)
+    {
+        const int viewId = Push(glb.gltf["bufferViews"], {{"buffer", 0}, {"byteLength", data.size()}});
+        (image ? glb.imageViews : glb.geometryViews).push_back(std::move(data));
+        (image ? glb.imageViewIds : glb.geometryViewIds).push_back(viewId);
+        return viewId;
+    }
+
+    bool IsIdentity(const FbxAMatrix &matrix)
+    {
+        for (int row = 0; row < 4; ++row)
+            for (int column = 0; column < 4; ++column)
+                if (std::fabs(matrix.Get(row, column) - (row == column ? 1.0 : 0.0)) > 1e-12)
+                    return false;
+        return true;
+    }
+
+    // Column-major for column vectors, the transpose of the row vector convention of FBX
+    nlohmann::json MatrixJson(const FbxAMatrix &matrix)
+    {
+        nlohmann::json values = nlohmann::json::array();
+        for (int row = 0; row < 4; ++row)
+            for (int column = 0; column < 4; ++column)
+                values.push_back(matrix.Get(row, column));
+        return values;
+    }
+
+    void LogKtxMessage(void *userData, ktx_log_level level, const char *command, const char *message)
+    {
+        if (level >= KTX_LOG_WARNING)
+            std::cerr << *static_cast<const std::string *>(userData) << ": " << command << ": " << message
+                      << std::endl;
+    }
+
+    std::filesystem::path ResolveTexturePath(FbxFileTexture *pTexture, const std::filesystem::path &fbxDirectory)
+    {
+        const std::filesystem::path fileName = pTexture->GetFileName();
+        const std::filesystem::path candidates[] = {
+            fileName,
+            fbxDirectory / pTexture->GetRelativeFileName(),
+            fbxDirectory / fileName.filename(),
+        };
+        for (const auto &candidate : candidates)
+        {
+            std::error_code ec;
+            if (!candidate.empty() && std::filesystem::is_regular_file(candidate, ec))
+                return candidate;
+        }
+        return {};
+    }
+
+    // Converts an image that ktx create cannot read to an 8-bit PNG
+    bool ConvertToPng(const std::string &input, const std::string &output)
+    {
+        auto inputFile = OIIO::ImageInput::open(input);
+        if (!inputFile)
+            return false;
+        const OIIO::ImageSpec &spec = inputFile->spec();
+        const int channels = std::min(spec.nchannels, 4);
+        std::vector<uint8_t> pixels(static_cast<size_t>(spec.width) * spec.height * channels);
+        const bool read = inputFile->read_image(0, 0, 0, channels, OIIO::TypeDesc::UINT8, pixels.data());
+        inputFile->close();
+        if (!read)
+            return false;
+
+        auto outputFile = OIIO::ImageOutput::create(output);
+        if (!outputFile || !outputFile->open(output, OIIO::ImageSpec(spec.width, spec.height, channels,
+                                                                     OIIO::TypeDesc::UINT8)))
+            return false;
+        const bool written = outputFile->write_image(OIIO::TypeDesc::UINT8, pixels.data());
+        outputFile->close();
+        return written;
+    }
+
+    bool ReadFile(const std::filesystem::path &filename, std::vector<uint8_t> &data)
+    {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file)
+            return false;
+        data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return !data.empty();
+    }
+
+    // Returns the glTF texture of a file texture, converted with ktx create, or -1 on failure
+    int AddTexture(FbxFileTexture *pTexture, bool srgb, GlbExport &glb)
+    {
+        const std::filesystem::path path = ResolveTexturePath(pTexture, glb.fbxDirectory);
+        if (path.empty())
+        {
+            std::cerr << "Texture not found: " << pTexture->GetFileName() << std::endl;
+            return -1;
+        }
+        const auto key = std::make_pair(path.string(), srgb);
+        if (const auto it = glb.textureIds.find(key); it != glb.textureIds.end())
+            return it->second;
+        glb.textureIds[key] = -1;
+
+        // Temporary files unique to this export and texture
+        const auto temporary = [&](const char *extension)
+        { return glb.temporaryDirectory.File(std::to_string(glb.textureIds.size()) + extension); };
+        if (temporary("").empty())
+        {
+            std::cerr << "Failed to create a temporary directory for " << path.string() << std::endl;
+            return -1;
+        }
+
+        std::string input = path.string();
+        std::string extension = path.extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        const std::filesystem::path pngFile = temporary(".png");
+        const bool convert = extension != ".png" && extension != ".jpg" && extension != ".jpeg" && extension != ".exr";
+        if (convert)
+        {
+            if (!ConvertToPng(input, pngFile.string()))
+            {
+                std::cerr << "Failed to read texture: " << input << std::endl;
+                return -1;
+            }
+            input = pngFile.string();
+        }
+
+        // EXR holds linear values, so colour textures are converted to sRGB rather than relabelled
+        const bool linearInput = extension == ".exr";
+        const std::filesystem::path ktxFile = temporary(".ktx2");
+        std::vector<std::string> args = {
+            "ktx", "create",
+            "--format", srgb ? "R8G8B8A8_SRGB" : "R8G8B8A8_UNORM",
+            linearInput ? "--convert-tf" : "--assign-tf", srgb ? "srgb" : "linear",
+            "--encode", glb.exportOptions.textureEncode,
+            "--generate-mipmap",
+        };
+        args.insert(args.end(), glb.exportOptions.textureArgs.begin(), glb.exportOptions.textureArgs.end());
+        args.push_back(input);
+        args.push_back(ktxFile.string());
+
+        std::vector<char *> argv;
+        for (auto &arg : args)
+            argv.push_back(arg.data());
+        argv.push_back(nullptr);
+        const std::string texturePath = path.string();
+        const int result = ktx_main_capture(static_cast<int>(args.size()), argv.data(), LogKtxMessage,
+                                            const_cast<std::string *>(&texturePath), nullptr, 0, nullptr);
+
+        std::vector<uint8_t> ktx2;
+        const bool read = result == 0 && ReadFile(ktxFile, ktx2);
+        std::error_code ec;
+        std::filesystem::remove(ktxFile, ec);
+        if (convert)
+            std::filesystem::remove(pngFile, ec);
+        if (!read)
+        {
+            std::cerr << "Failed to convert texture: " << texturePath << std::endl;
+            return -1;
+        }
+        std::cout << "Converted: " << texturePath << std::endl;
+
+        const int viewId = AddBufferView(glb, std::move(ktx2), true);
+        const int imageId = Push(glb.gltf["images"], {{"name", path.filename().string()},
+                                                       {"bufferView", viewId},
+                                                       {"mimeType", "image/ktx2"}});
+        const int textureId = Push(glb.gltf["textures"],
+                                   {{"sampler", 0}, {"extensions", {{"KHR_texture_basisu", {{"source", imageId}}}}}});
+        glb.textureIds[key] = textureId;
+        return textureId;
+    }
+
+    FbxFileTexture *FileTexture(const FbxProperty &property)
+    {
+        return property.IsValid() ? property.GetSrcObject<FbxFileTexture>(0) : nullptr;
+    }
+
+    // Returns the glTF material of an FBX material, -1 for none. Lambert and Phong parameters are
+    // mapped to a dielectric metallic-roughness material.
+    int AddMaterial(FbxSurfaceMaterial *pMaterial, GlbExport &glb)
+    {
+        if (!pMaterial)
+            return -1;
+        if (const auto it = glb.materialIds.find(pMaterial); it != glb.materialIds.end())
+            return it->second;
+
+        const auto color = [pMaterial](const char *name, const char *factorName, double fallback)
+        {
+            const FbxProperty property = pMaterial->FindProperty(name);
+            const FbxProperty factorProperty = pMaterial->FindProperty(factorName);
+            const FbxDouble3 value = property.IsValid() ? property.Get<FbxDouble3>()
+                                                        : FbxDouble3(fallback, fallback, fallback);
+            const double factor = factorProperty.IsValid() ? factorProperty.Get<FbxDouble>() : 1.0;
+            return nlohmann::json::array({value[0] * factor, value[1] * factor, value[2] * factor});
+        };
+
+        nlohmann::json pbr = {{"metallicFactor", 0.0}, {"roughnessFactor", 1.0}};
+        nlohmann::json baseColor = color(FbxSurfaceMaterial::sDiffuse, FbxSurfaceMaterial::sDiffuseFactor, 1.0);
+        const FbxProperty transparency = pMaterial->FindProperty(FbxSurfaceMaterial::sTransparencyFactor);
+        const double alpha = transparency.IsValid() ? 1.0 - transparency.Get<FbxDouble>() : 1.0;
+        baseColor.push_back(alpha);
+        pbr["baseColorFactor"] = baseColor;
+
+        const FbxProperty shininess = pMaterial->FindProperty(FbxSurfaceMaterial::sShininess);
+        if (shininess.IsValid())
+            pbr["roughnessFactor"] = std::sqrt(2.0 / (std::max(shininess.Get<FbxDouble>(), 0.0) + 2.0));
+
+        if (FbxFileTexture *pTexture = FileTexture(pMaterial->FindProperty(FbxSurfaceMaterial::sDiffuse)))
+            if (const int textureId = AddTexture(pTexture, true, glb); textureId >= 0)
+                pbr["baseColorTexture"] = {{"index", textureId}};
+
+        nlohmann::json material = {{"name", pMaterial->GetName()}, {"pbrMetallicRoughness", pbr}};
+        if (alpha < 1.0)
+            material["alphaMode"] = "BLEND";
+
+        // sBump holds a height map, which glTF has no slot for
+        if (FbxFileTexture *pNormalTexture = FileTexture(pMaterial->FindProperty(FbxSurfaceMaterial::sNormalMap)))
+            if (const int textureId = AddTexture(pNormalTexture, false, glb); textureId >= 0)
+                material["normalTexture"] = {{"index", textureId}};
+
+        material["emissiveFactor"] = color(FbxSurfaceMaterial::sEmissive, FbxSurfaceMaterial::sEmissiveFactor, 0.0);
+        for (auto &value : material["emissiveFactor"])
+            value = std::clamp(value.get<double>(), 0.0, 1.0);
+        if (FbxFileTexture *pTexture = FileTexture(pMaterial->FindProperty(FbxSurfaceMaterial::sEmissive)))
+            if (const int textureId = AddTexture(pTexture, true, glb); textureId >= 0)
+                material["emissiveTexture"] = {{"index", textureId}};
+
+        const int materialId = Push(glb.gltf["materials"], std::move(material));
+        glb.materialIds[pMaterial] = materialId;
+        return materialId;
+    }
+
+    // Accessor type and component type of a glTF attribute semantic
+    std::pair<const char *, int> AccessorFormat(const std::string &semantic)
+    {
+        if (semantic == "POSITION" || semantic == "NORMAL")
+            return {"VEC3", kFloat};
+        if (semantic.rfind("TEXCOORD_", 0) == 0)
+            return {"VEC2", kFloat};
+        if (semantic == "JOINTS_0")
+            return {"VEC4", kUnsignedShort};
+        return {"VEC4", kFloat};
+    }
+
+    // Encodes one material part of a mesh as a primitive with KHR_draco_mesh_compression
+    bool EncodePrimitive(const IndexedMesh &part, GlbExport &glb, nlohmann::json &primitive)
+    {
+        std::map<std::string, int> dracoAttributes;
+        std::unique_ptr<draco::Mesh> dracoMesh;
+        size_t meshletCount = 0;
+        if (glb.exportOptions.meshlets)
+        {
+            // Reordering keeps the vertex count and bounds the accessors are written from
+            IndexedMesh orderedPart = part;
+            const MeshletMesh meshlets = BuildMeshlets(orderedPart);
+            dracoMesh = ToDracoMesh(orderedPart, &dracoAttributes);
+            AddMeshletMetadata(*dracoMesh, meshlets);
+            meshletCount = meshlets.meshlets.size();
+        }
+        else
+            dracoMesh = ToDracoMesh(part, &dracoAttributes);
+
+        draco::ExpertEncoder encoder(*dracoMesh);
+        ConfigureDracoEncoder(encoder, *dracoMesh, glb.exportOptions);
+        draco::EncoderBuffer buffer;
+        if (!encoder.EncodeToBuffer(&buffer).ok())
+            return false;
+        const int viewId = AddBufferView(
+            glb, std::vector<uint8_t>(buffer.data(), buffer.data() + buffer.size()), false);
+
+        // TANGENT requires NORMAL in glTF
+        if (!dracoAttributes.count("NORMAL"))
+            dracoAttributes.erase("TANGENT");
+
+        nlohmann::json attributes = nlohmann::json::object();
+        nlohmann::json extensionAttributes = nlohmann::json::object();
+        for (const auto &[semantic, attributeId] : dracoAttributes)
+        {
+            const auto [type, componentType] = AccessorFormat(semantic);
+            nlohmann::json accessor = {{"count", part.VertexCount()}, {"componentType", componentType}, {"type", type}};
+            if (semantic == "POSITION")
+            {
+                float min[3] = {part.positions[0], part.positions[1], part.positions[2]};
+                float max[3] = {min[0], min[1], min[2]};
+                for (size_t i = 0; i < part.positions.size(); ++i)
+                {
+                    min[i % 3] = std::min(min[i % 3], part.positions[i]);
+                    max[i % 3] = std::max(max[i % 3], part.positions[i]);
+                }
+                accessor["min"] = min;
+                accessor["max"] = max;
+            }
+            attributes[semantic] = Push(glb.gltf["accessors"], std::move(accessor));
+            extensionAttributes[semantic] = attributeId;
+        }
+        const int indices = Push(glb.gltf["accessors"],
+                                 {{"count", part.indices.size()},
+                                  {"componentType", part.VertexCount() > 0xffff ? kUnsignedInt : kUnsignedShort},
+                                  {"type", "SCALAR"}});
+
+        primitive = {
+            {"attributes", attributes},
+            {"indices", indices},
+            {"mode", kTriangles},
+            {"extensions",
+             {{"KHR_draco_mesh_compression", {{"bufferView", viewId}, {"attributes", extensionAttributes}}}}},
+        };
+        // The meshlet tables are in the Draco metadata of the primitive
+        if (glb.exportOptions.meshlets)
+            primitive["extras"] = {{"meshlets", meshletCount}};
+        return true;
+    }
+
+    // Returns the id of the geometry of a mesh, encoding it unless identical geometry was encoded
+    // before, or -1 if it cannot be exported.
+    int AddMeshContent(FbxMesh *pMesh, GlbExport &glb)
+    {
+        if (const auto it = glb.contentIds.find(pMesh); it != glb.contentIds.end())
+            return it->second;
+        glb.contentIds[pMesh] = -1;
+
+        IndexedMesh mesh = BuildIndexedMesh(pMesh, glb.exportOptions);
+        if (mesh.TriangleCount() == 0)
+        {
+            std::cerr << "Mesh " << pMesh->GetName() << " has no triangles." << std::endl;
+            return -1;
+        }
+        // The texture coordinate origin of glTF is the top left corner
+        for (auto &uvSet : mesh.uvSets)
+            for (size_t i = 1; i < uvSet.size(); i += 2)
+                uvSet[i] = 1.0f - uvSet[i];
+
+        const uint64_t hash = HashIndexedMesh(mesh);
+        const auto [first, last] = glb.contentIdsByHash.equal_range(hash);
+        for (auto it = first; it != last; ++it)
+        {
+            if (SameMeshContent(glb.contents[it->second], mesh))
+            {
+                glb.contentIds[pMesh] = it->second;
+                return it->second;
+            }
+        }
+
+        std::vector<EncodedPrimitive> primitives;
+        for (const auto &[slot, part] : SplitByMaterial(mesh))
+        {
+            EncodedPrimitive encoded{slot, {}};
+            if (!EncodePrimitive(part, glb, encoded.primitive))
+            {
+                std::cerr << "Failed to encode mesh " << pMesh->GetName() << std::endl;
+                return -1;
+            }
+            primitives.push_back(std::move(encoded));
+        }
+        std::cout << "Mesh " << pMesh->GetName() << ": " << mesh.VertexCount() << " vertices, "
+                  << mesh.TriangleCount() << " triangles, " << primitives.size() << " primitives" << std::endl;
+
+        const int contentId = static_cast<int>(glb.contents.size());
+        glb.contentIdsByHash.emplace(hash, contentId);
+        glb.contentIds[pMesh] = contentId;
+        glb.contents.push_back(std::move(mesh));
+        glb.contentPrimitives.push_back(std::move(primitives));
+        return contentId;
+    }
+
+    // Returns the glTF mesh of the mesh of a node with the materials of the node, or -1
+    int AddMesh(FbxNode *pNode, GlbExport &glb)
+    {
+        FbxMesh *pMesh = pNode->GetMesh();
+        const int contentId = pMesh ? AddMeshContent(pMesh, glb) : -1;
+        if (contentId < 0)
+            return -1;
+
+        const auto &primitives = glb.contentPrimitives[contentId];
+        std::vector<int> materials;
+        for (const auto &encoded : primitives)
+            materials.push_back(encoded.slot < pNode->GetMaterialCount()
+                                    ? AddMaterial(pNode->GetMaterial(encoded.slot), glb)
+                                    : -1);
+
+        const auto key = std::make_pair(contentId, materials);
+        if (const auto it = glb.meshIds.find(key); it != glb.meshIds.end())
+            return it->second;
+
+        nlohmann::json gltfPrimitives = nlohmann::json::array();
+        for (size_t i = 0; i < primitives.size(); ++i)
+        {
+            nlohmann::json primitive = primitives[i].primitive;
+            if (materials[i] >= 0)
+                primitive["material"] = materials[i];
+            gltfPrimitives.push_back(std::move(primitive));
+        }
+        const int meshId = Push(glb.gltf["meshes"], {{"name", pMesh->GetName()}, {"primitives", gltfPrimitives}});
+        glb.meshIds[key] = meshId;
+        return meshId;
+    }
+
+    // Adds a node and its subtree, returns the index of the node
+    int AddNode(FbxNode *pNode, bool topLevel, GlbExport &glb)
+    {
+        // Top level nodes include the transform of the FBX root node, e.g. from the axis conversion
+        const FbxAMatrix transform = topLevel ? pNode->EvaluateGlobalTransform() : pNode->EvaluateLocalTransform();
+        nlohmann::json node = {{"name", pNode->GetName()}};
+        if (!IsIdentity(transform))
+            node["matrix"] = MatrixJson(transform);
+        const int nodeId = Push(glb.gltf["nodes"], std::move(node));
+
+        nlohmann::json children = nlohmann::json::array();
+        if (pNode->GetNodeAttribute() && pNode->GetNodeAttribute()->GetAttributeType() == FbxNodeAttribute::eMesh)
+        {
+            const int meshId = AddMesh(pNode, glb);
+            if (meshId >= 0)
+            {
+                // Geometric offsets apply to the mesh but not to the children of the node
+                const FbxAMatrix geometric(pNode->GetGeometricTranslation(FbxNode::eSourcePivot),
+                                           pNode->GetGeometricRotation(FbxNode::eSourcePivot),
+                                           pNode->GetGeometricScaling(FbxNode::eSourcePivot));
+                if (IsIdentity(geometric))
+                    glb.gltf["nodes"][nodeId]["mesh"] = meshId;
+                else
+                    children.push_back(Push(glb.gltf["nodes"], {{"name", std::string(pNode->GetName()) + "_geometry"},
+                                                                {"matrix", MatrixJson(geometric)},
+                                                                {"mesh", meshId}}));
+            }
+        }
+        for (int i = 0; i < pNode->GetChildCount(); ++i)
+            children.push_back(AddNode(pNode->GetChild(i), false, glb));
+        if (!children.empty())
+            glb.gltf["nodes"][nodeId]["children"] = children;
+        return nodeId;
+    }
+
+    void AppendPadded(std::vector<uint8_t> &data, const void *bytes, size_t size, uint8_t padding)
+    {
+        const auto *begin = static_cast<const uint8_t *>(bytes);
+        data.insert(data.end(), begin, begin + size);
+        data.resize((data.size() + 3) & ~size_t(3), padding);
+    }
+
+    void AppendUint32(std::vector<uint8_t> &data, uint32_t value)
+    {
+        const uint8_t bytes[4] = {uint8_t(value), uint8_t(value >> 8), uint8_t(value >> 16), uint8_t(value >> 24)};
+        data.insert(data.end(), bytes, bytes + 4);
+    }
+
+    bool SaveGlb(const std::string &filename, GlbExport &glb)
+    {
+        // BIN chunk: geometry views, then image views, each 4-byte aligned
+        std::vector<uint8_t> bin;
+        const auto appendViews = [&](const std::vector<std::vector<uint8_t>> &views, const std::vector<int> &viewIds)
+        {
+            for (size_t i = 0; i < views.size(); ++i)
+            {
+                glb.gltf["bufferViews"][viewIds[i]]["byteOffset"] = bin.size();
+                AppendPadded(bin, views[i].data(), views[i].size(), 0);
+            }
+        };
+        appendViews(glb.geometryViews, glb.geometryViewIds);
+        appendViews(glb.imageViews, glb.imageViewIds);
+        if (!bin.empty())
+            glb.gltf["buffers"] = {{{"byteLength", bin.size()}}};
+
+        std::vector<uint8_t> json;
+        const std::string jsonText = glb.gltf.dump();
+        AppendPadded(json, jsonText.data(), jsonText.size(), ' ');
+
+        std::vector<uint8_t> header;
+        const size_t length = 12 + 8 + json.size() + (bin.empty() ? 0 : 8 + bin.size());
+        AppendUint32(header, 0x46546C67); // "glTF"
+        AppendUint32(header, 2);
+        AppendUint32(header, static_cast<uint32_t>(length));
+        AppendUint32(header, static_cast<uint32_t>(json.size()));
+        AppendUint32(header, 0x4E4F534A); // "JSON"
+
+        std::ofstream outFile(filename, std::ios::binary);
+        if (!outFile)
+        {
+            std::cerr << "Failed to open output file: " << filename << std::endl;
+            return false;
+        }
+        outFile.write(reinterpret_cast<const char *>(header.data()), header.size());
+        outFile.write(reinterpret_cast<const char *>(json.data()), json.size());
+        if (!bin.empty())
+        {
+            std::vector<uint8_t> binHeader;
+            AppendUint32(binHeader, static_cast<uint32_t>(bin.size()));
+            AppendUint32(binHeader, 0x004E4942); // "BIN\0"
+            outFile.write(reinterpret_cast<const char *>(binHeader.data()), binHeader.size());
+            outFile.write(reinterpret_cast<const char *>(bin.data()), bin.size());
+        }
+        return static_cast<bool>(outFile);
+    }
+}
+
+bool ExportGlb(FbxScene *pScene, const std::string &fbxFile, const std::string &outputFile,
+               const MeshExportOptions &exportOptions)
+{
+    FbxAxisSystem::OpenGL.ConvertScene(pScene);
+    if (pScene->GetGlobalSettings().GetSystemUnit() != FbxSystemUnit::m)
+        FbxSystemUnit::m.ConvertScene(pScene);
+
+    GlbExport glb;
+    glb.exportOptions = exportOptions;
+    // Skins are not exported, so the joints and weights would be unused
+    glb.exportOptions.skin = false;
+    glb.fbxDirectory = std::filesystem::path(fbxFile).parent_path();
+    glb.gltf = {
+        {"asset", {{"version", "2.0"}, {"generator", "vcpp-core"}}},
+        {"samplers", {{{"magFilter", 9729}, {"minFilter", 9987}, {"wrapS", 10497}, {"wrapT", 10497}}}},
+    };
+
+    nlohmann::json sceneNodes = nlohmann::json::array();
+    FbxNode *pRoot = pScene->GetRootNode();
+    for (int i = 0; i < pRoot->GetChildCount(); ++i)
+        sceneNodes.push_back(AddNode(pRoot->GetChild(i), true, glb));
+    glb.gltf["scenes"] = {sceneNodes.empty() ? nlohmann::json::object() : nlohmann::json{{"nodes", sceneNodes}}};
+    glb.gltf["scene"] = 0;
+
+    // Every primitive is Draco compressed and every texture is KTX2, so the extensions are required
+    // exactly when the scene has meshes or textures
+    nlohmann::json extensions = nlohmann::json::array();
+    if (!glb.gltf.value("meshes", nlohmann::json::array()).empty())
+        extensions.push_back("KHR_draco_mesh_compression");
+    if (!glb.gltf.value("textures", nlohmann::json::array()).empty())
+        extensions.push_back("KHR_texture_basisu");
+    if (!extensions.empty())
+    {
+        glb.gltf["extensionsUsed"] = extensions;
+        glb.gltf["extensionsRequired"] = extensions;
+    }
+
+    if (!SaveGlb(outputFile, glb))
+        return false;
+    std::cout << "Exported: " << outputFile << " (" << glb.contents.size() << " unique meshes, "
+              << glb.gltf.value("nodes", nlohmann::json::array()).size() << " nodes)" << std::endl;
+    return true;
+}
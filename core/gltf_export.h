@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string>
+
+#include <fbxsdk.h>
+
+#include "core/mesh_builder.h"
+
+// Writes the node hierarchy, meshes and materials of the scene as one binary glTF 2.0 file (GLB).
+// Meshes are compressed with KHR_draco_mesh_compression, one primitive per material slot, and
+// shared between the nodes that instance them. Material textures are converted with ktx create to
+// KTX2 for KHR_texture_basisu; relative texture paths are resolved against the directory of
+// fbxFile. The scene is converted in place to the Y-up, right-handed, metre based axes of glTF.
+bool ExportGlb(FbxScene *pScene, const std::string &fbxFile, const std::string &outputFile,
+               const MeshExportOptions &exportOptions);
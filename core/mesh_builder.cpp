@@ -0,0 +1,799 @@
+#include "core/mesh_builder.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+
+#include <draco/attributes/point_attribute.h>
+#include <draco/metadata/geometry_metadata.h>
+#include <nlohmann/json.hpp>
+
+namespace
+{
+    // Reads the value of an FBX layer element for one polygon vertex, resolving its mapping and
+    // reference modes. Returns false if the element cannot provide a value for it.
+    template <typename T>
+    bool ReadLayerElement(const FbxLayerElementTemplate<T> *element, int controlPoint, int polygonVertex,
+                          int polygon, T &value)
+    {
+        if (!element)
+            return false;
+
+        int index = 0;
+        switch (element->GetMappingMode())
+        {
+        case FbxLayerElement::eByControlPoint:
+            index = controlPoint;
+            break;
+        case FbxLayerElement::eByPolygonVertex:
+            index = polygonVertex;
+            break;
+        case FbxLayerElement::eByPolygon:
+            index = polygon;
+            break;
+        case FbxLayerElement::eAllSame:
+            index = 0;
+            break;
+        default: // eNone, eByEdge
+            return false;
+        }
+
+        if (element->GetReferenceMode() != FbxLayerElement::eDirect)
+        {
+            if (index < 0 || index >= element->GetIndexArray().GetCount())
+                return false;
+            index = element->GetIndexArray().GetAt(index);
+        }
+        if (index < 0 || index >= element->GetDirectArray().GetCount())
+            return false;
+        value = element->GetDirectArray().GetAt(index);
+        return true;
+    }
+
+    // Returns the material slot of a polygon, 0 if there is no material element.
+    int MaterialSlot(const FbxGeometryElementMaterial *element, int polygon)
+    {
+        if (!element)
+            return 0;
+        int index = 0;
+        switch (element->GetMappingMode())
+        {
+        case FbxLayerElement::eByPolygon:
+            index = polygon;
+            break;
+        case FbxLayerElement::eAllSame:
+            index = 0;
+            break;
+        default:
+            return 0;
+        }
+        if (index < 0 || index >= element->GetIndexArray().GetCount())
+            return 0;
+        return std::max(element->GetIndexArray().GetAt(index), 0);
+    }
+
+    // Set of fixed size records, deduplicated by their exact bit patterns.
+    template <typename T>
+    class RecordTable
+    {
+    public:
+        explicit RecordTable(size_t stride) : stride(stride), records(0, Hash{this}, Equal{this}) {}
+        RecordTable(const RecordTable &) = delete;
+        RecordTable &operator=(const RecordTable &) = delete;
+
+        // Returns the index of the record equal to record, appending it if it is new.
+        uint32_t Insert(const T *record)
+        {
+            const auto candidate = static_cast<uint32_t>(data.size() / stride);
+            data.insert(data.end(), record, record + stride);
+            // -0.0 and 0.0 must weld
+            if constexpr (std::is_floating_point_v<T>)
+                for (size_t i = data.size() - stride; i < data.size(); ++i)
+                    if (data[i] == T(0))
+                        data[i] = T(0);
+            const auto [it, inserted] = records.insert(candidate);
+            if (!inserted)
+                data.resize(data.size() - stride);
+            return *it;
+        }
+
+        size_t Count() const { return data.size() / stride; }
+        const T *Record(size_t index) const { return data.data() + index * stride; }
+
+    private:
+        struct Hash
+        {
+            const RecordTable *table;
+            size_t operator()(uint32_t index) const
+            {
+                const auto *bytes = reinterpret_cast<const unsigned char *>(table->Record(index));
+                uint64_t hash = 0xcbf29ce484222325ull;
+                for (size_t i = 0; i < table->stride * sizeof(T); ++i)
+                    hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+                return static_cast<size_t>(hash ^ (hash >> 32));
+            }
+        };
+        struct Equal
+        {
+            const RecordTable *table;
+            bool operator()(uint32_t a, uint32_t b) const
+            {
+                return std::memcmp(table->Record(a), table->Record(b), table->stride * sizeof(T)) == 0;
+            }
+        };
+
+        size_t stride;
+        std::vector<T> data;
+        std::unordered_set<uint32_t, Hash, Equal> records;
+    };
+
+    // Skin influences per control point, up to four with weights summing to one.
+    struct SkinInfluences
+    {
+        std::vector<std::array<uint16_t, 4>> joints;
+        std::vector<std::array<float, 4>> weights;
+        std::vector<std::string> jointNames;
+    };
+
+    // Reads the first skin deformer of pMesh. Returns false if the mesh is not skinned.
+    bool ReadSkin(FbxMesh *pMesh, int controlPointCount, SkinInfluences &skinInfluences)
+    {
+        if (pMesh->GetDeformerCount(FbxDeformer::eSkin) == 0)
+            return false;
+        auto *skin = static_cast<FbxSkin *>(pMesh->GetDeformer(0, FbxDeformer::eSkin));
+        if (!skin || skin->GetClusterCount() == 0)
+            return false;
+
+        std::vector<std::vector<std::pair<float, uint16_t>>> influences(controlPointCount);
+        const int clusterCount = std::min(skin->GetClusterCount(), 0xffff);
+        for (int clusterIndex = 0; clusterIndex < clusterCount; ++clusterIndex)
+        {
+            FbxCluster *cluster = skin->GetCluster(clusterIndex);
+            FbxNode *link = cluster ? cluster->GetLink() : nullptr;
+            skinInfluences.jointNames.push_back(link ? link->GetName() : "");
+            if (!cluster)
+                continue;
+            const int *indices = cluster->GetControlPointIndices();
+            const double *weights = cluster->GetControlPointWeights();
+            for (int i = 0; i < cluster->GetControlPointIndicesCount(); ++i)
+                if (indices[i] >= 0 && indices[i] < controlPointCount && weights[i] > 0.0)
+                    influences[indices[i]].emplace_back(static_cast<float>(weights[i]),
+                                                        static_cast<uint16_t>(clusterIndex));
+        }
+
+        skinInfluences.joints.assign(controlPointCount, {0, 0, 0, 0});
+        skinInfluences.weights.assign(controlPointCount, {0.0f, 0.0f, 0.0f, 0.0f});
+        for (int controlPoint = 0; controlPoint < controlPointCount; ++controlPoint)
+        {
+            auto &pointInfluences = influences[controlPoint];
+            const size_t count = std::min<size_t>(pointInfluences.size(), 4);
+            std::partial_sort(pointInfluences.begin(), pointInfluences.begin() + count, pointInfluences.end(),
+                              [](const auto &a, const auto &b) { return a.first > b.first; });
+            float sum = 0.0f;
+            for (size_t i = 0; i < count; ++i)
+                sum += pointInfluences[i].first;
+            for (size_t i = 0; i < count; ++i)
+            {
+                skinInfluences.joints[controlPoint][i] = pointInfluences[i].second;
+                skinInfluences.weights[controlPoint][i] = pointInfluences[i].first / sum;
+            }
+        }
+        return true;
+    }
+
+    void Normalize(float *vector)
+    {
+        const float length = std::sqrt(vector[0] * vector[0] + vector[1] * vector[1] + vector[2] * vector[2]);
+        if (length > 0.0f)
+            for (int i = 0; i < 3; ++i)
+                vector[i] /= length;
+    }
+
+    // Appends the triangles of a polygon to triangles as indices of its corners. Ears are clipped in
+    // the plane of the polygon, so concave polygons are handled. Degenerate polygons fall back to a
+    // fan. The winding of the polygon is preserved.
+    void TriangulatePolygon(const std::vector<FbxVector4> &corners, std::vector<int> &triangles)
+    {
+        const int n = static_cast<int>(corners.size());
+        if (n < 3)
+            return;
+        if (n == 3)
+        {
+            triangles.insert(triangles.end(), {0, 1, 2});
+            return;
+        }
+
+        // Newell normal of the polygon selects the projection plane
+        double normal[3] = {0.0, 0.0, 0.0};
+        for (int i = 0; i < n; ++i)
+        {
+            const FbxVector4 &a = corners[i];
+            const FbxVector4 &b = corners[(i + 1) % n];
+            normal[0] += (a[1] - b[1]) * (a[2] + b[2]);
+            normal[1] += (a[2] - b[2]) * (a[0] + b[0]);
+            normal[2] += (a[0] - b[0]) * (a[1] + b[1]);
+        }
+        const int axis = std::fabs(normal[0]) > std::fabs(normal[1])
+                             ? (std::fabs(normal[0]) > std::fabs(normal[2]) ? 0 : 2)
+                             : (std::fabs(normal[1]) > std::fabs(normal[2]) ? 1 : 2);
+
+        std::vector<int> remaining(n);
+        for (int i = 0; i < n; ++i)
+            remaining[i] = i;
+
+        if (normal[axis] != 0.0)
+        {
+            const int u = (axis + 1) % 3;
+            const int v = (axis + 2) % 3;
+            // Makes the projected polygon counter-clockwise
+            const double orientation = normal[axis] > 0.0 ? 1.0 : -1.0;
+            const auto cross = [&](int a, int b, int c)
+            {
+                const FbxVector4 &pa = corners[a];
+                const FbxVector4 &pb = corners[b];
+                const FbxVector4 &pc = corners[c];
+                return orientation * ((pb[u] - pa[u]) * (pc[v] - pa[v]) - (pb[v] - pa[v]) * (pc[u] - pa[u]));
+            };
+            const auto same = [&](int a, int b)
+            { return corners[a][u] == corners[b][u] && corners[a][v] == corners[b][v]; };
+
+            while (remaining.size() > 3)
+            {
+                const int m = static_cast<int>(remaining.size());
+                bool clipped = false;
+                for (int k = 0; k < m && !clipped; ++k)
+                {
+                    const int prev = remaining[(k + m - 1) % m];
+                    const int cur = remaining[k];
+                    const int next = remaining[(k + 1) % m];
+                    if (cross(prev, cur, next) <= 0.0)
+                        continue; // Reflex or degenerate corner
+
+                    bool isEar = true;
+                    for (const int other : remaining)
+                    {
+                        if (other == prev || other == cur || other == next || same(other, prev) ||
+                            same(other, cur) || same(other, next))
+                            continue;
+                        if (cross(prev, cur, other) >= 0.0 && cross(cur, next, other) >= 0.0 &&
+                            cross(next, prev, other) >= 0.0)
+                        {
+                            isEar = false;
+                            break;
+                        }
+                    }
+                    if (isEar)
+                    {
+                        triangles.insert(triangles.end(), {prev, cur, next});
+                        remaining.erase(remaining.begin() + k);
+                        clipped = true;
+                    }
+                }
+                if (!clipped)
+                    break; // Self-intersecting or degenerate, fan the rest
+            }
+        }
+
+        for (size_t i = 1; i + 1 < remaining.size(); ++i)
+            triangles.insert(triangles.end(), {remaining[0], remaining[i], remaining[i + 1]});
+    }
+
+    // Adds an attribute that stores only the unique values of data, with components values per point.
+    // Points are mapped to their values explicitly unless every value is unique.
+    template <typename T>
+    int AddDracoAttribute(draco::Mesh &dracoMesh, draco::GeometryAttribute::Type type, draco::DataType dataType,
+                          const std::vector<T> &data, int components)
+    {
+        const size_t pointCount = data.size() / components;
+        RecordTable<T> values(components);
+        std::vector<uint32_t> valueOfPoint(pointCount);
+        for (size_t point = 0; point < pointCount; ++point)
+            valueOfPoint[point] = values.Insert(&data[point * components]);
+
+        const bool identity = values.Count() == pointCount;
+        draco::GeometryAttribute geometryAttribute;
+        geometryAttribute.Init(type, nullptr, static_cast<uint8_t>(components), dataType, false,
+                               sizeof(T) * components, 0);
+        const int attributeId = dracoMesh.AddAttribute(geometryAttribute, identity,
+                                                       static_cast<uint32_t>(values.Count()));
+        draco::PointAttribute *attribute = dracoMesh.attribute(attributeId);
+        for (size_t value = 0; value < values.Count(); ++value)
+            attribute->SetAttributeValue(draco::AttributeValueIndex(static_cast<uint32_t>(value)), values.Record(value));
+        if (!identity)
+            for (size_t point = 0; point < pointCount; ++point)
+                attribute->SetPointMapEntry(draco::PointIndex(static_cast<uint32_t>(point)),
+                                            draco::AttributeValueIndex(valueOfPoint[point]));
+        return attributeId;
+    }
+
+    // Adds a GENERIC attribute with the glTF semantic as the "name" entry of its metadata. Draco has
+    // TANGENT, JOINTS and WEIGHTS attribute types only when built with DRACO_TRANSCODER_SUPPORTED.
+    template <typename T>
+    int AddNamedDracoAttribute(draco::Mesh &dracoMesh, const char *semantic, draco::DataType dataType,
+                               const std::vector<T> &data, int components,
+                               std::unique_ptr<draco::AttributeMetadata> metadata = nullptr)
+    {
+        const int attributeId =
+            AddDracoAttribute(dracoMesh, draco::GeometryAttribute::GENERIC, dataType, data, components);
+        if (!metadata)
+            metadata = std::make_unique<draco::AttributeMetadata>();
+        metadata->AddEntryString("name", semantic);
+        dracoMesh.AddAttributeMetadata(attributeId, std::move(metadata));
+        return attributeId;
+    }
+}
+
+bool ParseMeshExportOptions(const char *options, MeshExportOptions &exportOptions)
+{
+    if (!options)
+        return true;
+
+    const auto j = nlohmann::json::parse(options, nullptr, false);
+    if (j.is_discarded() || !j.is_object())
+    {
+        std::cerr << "Invalid options JSON: " << options << std::endl;
+        return false;
+    }
+
+    try
+    {
+        const auto output = j.value("output", std::string(exportOptions.glb ? "glb" : "drc"));
+        if (output != "drc" && output != "glb")
+        {
+            std::cerr << "Unknown output \"" << output << "\", expected drc or glb." << std::endl;
+            return false;
+        }
+        exportOptions.glb = output == "glb";
+
+        if (j.contains("texture"))
+        {
+            const auto &texture = j.at("texture");
+            exportOptions.textureEncode = texture.value("encode", exportOptions.textureEncode);
+            if (exportOptions.textureEncode != "basis-lz" && exportOptions.textureEncode != "uastc")
+            {
+                std::cerr << "Unknown texture encode \"" << exportOptions.textureEncode
+                          << "\", expected basis-lz or uastc." << std::endl;
+                return false;
+            }
+            exportOptions.textureArgs = texture.value("args", exportOptions.textureArgs);
+        }
+
+        if (j.contains("attributes"))
+        {
+            const auto &attributes = j.at("attributes");
+            exportOptions.normals = attributes.value("normal", exportOptions.normals);
+            exportOptions.tangents = attributes.value("tangent", exportOptions.tangents);
+            exportOptions.colors = attributes.value("color", exportOptions.colors);
+            exportOptions.skin = attributes.value("skin", exportOptions.skin);
+        }
+
+        if (j.contains("quantization"))
+        {
+            const auto &quantization = j.at("quantization");
+            const std::pair<const char *, int *> bits[] = {
+                {"position", &exportOptions.positionBits}, {"normal", &exportOptions.normalBits},
+                {"texcoord", &exportOptions.texcoordBits}, {"color", &exportOptions.colorBits},
+                {"tangent", &exportOptions.tangentBits},   {"weight", &exportOptions.weightBits},
+            };
+            for (const auto &[name, value] : bits)
+            {
+                *value = quantization.value(name, *value);
+                if (*value < 0 || *value > 30)
+                {
+                    std::cerr << "Quantization bits of " << name << " must be between 0 and 30." << std::endl;
+                    return false;
+                }
+            }
+        }
+
+        const auto method = j.value("method", std::string(exportOptions.edgebreaker ? "edgebreaker" : "sequential"));
+        if (method != "edgebreaker" && method != "sequential")
+        {
+            std::cerr << "Unknown method \"" << method << "\", expected edgebreaker or sequential." << std::endl;
+            return false;
+        }
+        exportOptions.edgebreaker = method == "edgebreaker";
+
+        exportOptions.lodRatios = j.value("lods", exportOptions.lodRatios);
+        for (const float ratio : exportOptions.lodRatios)
+        {
+            if (!(ratio > 0.0f && ratio < 1.0f))
+            {
+                std::cerr << "Level of detail ratios must be between 0 and 1, got " << ratio << "." << std::endl;
+                return false;
+            }
+        }
+
+        exportOptions.meshlets = j.value("meshlets", exportOptions.meshlets);
+
+        exportOptions.encodeSpeed = j.value("encode_speed", exportOptions.encodeSpeed);
+        exportOptions.decodeSpeed = j.value("decode_speed", exportOptions.decodeSpeed);
+        if (exportOptions.encodeSpeed < 0 || exportOptions.encodeSpeed > 10 || exportOptions.decodeSpeed < 0 ||
+            exportOptions.decodeSpeed > 10)
+        {
+            std::cerr << "encode_speed and decode_speed must be between 0 and 10." << std::endl;
+            return false;
+        }
+    }
+    catch (const nlohmann::json::exception &e)
+    {
+        std::cerr << "Invalid options: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void ConfigureDracoEncoder(draco::ExpertEncoder &encoder, const draco::Mesh &dracoMesh,
+                           const MeshExportOptions &exportOptions)
+{
+    encoder.SetSpeedOptions(exportOptions.encodeSpeed, exportOptions.decodeSpeed);
+    encoder.SetEncodingMethod(exportOptions.edgebreaker && !exportOptions.meshlets
+                                  ? draco::MESH_EDGEBREAKER_ENCODING
+                                  : draco::MESH_SEQUENTIAL_ENCODING);
+
+    const std::pair<draco::GeometryAttribute::Type, int> bits[] = {
+        {draco::GeometryAttribute::POSITION, exportOptions.positionBits},
+        {draco::GeometryAttribute::NORMAL, exportOptions.normalBits},
+        {draco::GeometryAttribute::TEX_COORD, exportOptions.texcoordBits},
+        {draco::GeometryAttribute::COLOR, exportOptions.colorBits},
+    };
+    for (int attributeId = 0; attributeId < dracoMesh.num_attributes(); ++attributeId)
+        for (const auto &[type, value] : bits)
+            if (dracoMesh.attribute(attributeId)->attribute_type() == type && value > 0)
+                encoder.SetAttributeQuantization(attributeId, value);
+
+    // Joints are integers and never quantized
+    const std::pair<const char *, int> namedBits[] = {
+        {"TANGENT", exportOptions.tangentBits},
+        {"WEIGHTS_0", exportOptions.weightBits},
+    };
+    for (const auto &[semantic, value] : namedBits)
+    {
+        const int attributeId = dracoMesh.GetAttributeIdByMetadataEntry("name", semantic);
+        if (attributeId >= 0 && value > 0 &&
+            dracoMesh.attribute(attributeId)->attribute_type() == draco::GeometryAttribute::GENERIC)
+            encoder.SetAttributeQuantization(attributeId, value);
+    }
+}
+
+IndexedMesh BuildIndexedMesh(FbxMesh *pMesh, const MeshExportOptions &exportOptions)
+{
+    IndexedMesh mesh;
+    const int controlPointCount = pMesh->GetControlPointsCount();
+    const FbxVector4 *controlPoints = pMesh->GetControlPoints();
+    if (controlPointCount == 0 || !controlPoints)
+        return mesh;
+
+    const FbxGeometryElementNormal *normalElement = exportOptions.normals ? pMesh->GetElementNormal(0) : nullptr;
+    const FbxGeometryElementTangent *tangentElement =
+        exportOptions.tangents ? pMesh->GetElementTangent(0) : nullptr;
+    const FbxGeometryElementBinormal *binormalElement = tangentElement ? pMesh->GetElementBinormal(0) : nullptr;
+    const FbxGeometryElementVertexColor *colorElement =
+        exportOptions.colors ? pMesh->GetElementVertexColor(0) : nullptr;
+    std::vector<const FbxGeometryElementUV *> uvElements;
+    for (int uvChannel = 0; uvChannel < pMesh->GetElementUVCount(); ++uvChannel)
+    {
+        const FbxGeometryElementUV *uvElement = pMesh->GetElementUV(uvChannel);
+        if (!uvElement)
+            continue;
+        std::string uvSetName = uvElement->GetName();
+        if (uvSetName.empty())
+            uvSetName = "uv" + std::to_string(uvChannel);
+        uvElements.push_back(uvElement);
+        mesh.uvSetNames.push_back(uvSetName);
+    }
+    const FbxGeometryElementMaterial *materialElement = pMesh->GetElementMaterial(0);
+    SkinInfluences skinInfluences;
+    const bool skinned = exportOptions.skin && ReadSkin(pMesh, controlPointCount, skinInfluences);
+
+    // Vertex record layout: position, [normal], [tangent], [colour], [joints, weights], uv set 0, ...
+    // Joint indices are small integers and exact as floats.
+    const size_t normalOffset = 3;
+    const size_t tangentOffset = normalOffset + (normalElement ? 3 : 0);
+    const size_t colorOffset = tangentOffset + (tangentElement ? 4 : 0);
+    const size_t jointOffset = colorOffset + (colorElement ? 4 : 0);
+    const size_t weightOffset = jointOffset + (skinned ? 4 : 0);
+    const size_t uvOffset = weightOffset + (skinned ? 4 : 0);
+    const size_t stride = uvOffset + 2 * uvElements.size();
+
+    RecordTable<float> vertices(stride);
+    std::vector<float> record(stride);
+    std::vector<uint32_t> cornerVertices;
+    std::vector<FbxVector4> cornerPositions;
+    std::vector<int> triangles;
+
+    const int polygonCount = pMesh->GetPolygonCount();
+    for (int polygon = 0; polygon < polygonCount; ++polygon)
+    {
+        const int polygonSize = pMesh->GetPolygonSize(polygon);
+        if (polygonSize < 3)
+            continue;
+        const int firstPolygonVertex = pMesh->GetPolygonVertexIndex(polygon);
+
+        cornerVertices.clear();
+        cornerPositions.clear();
+        for (int corner = 0; corner < polygonSize; ++corner)
+        {
+            const int controlPoint = pMesh->GetPolygonVertex(polygon, corner);
+            if (controlPoint < 0 || controlPoint >= controlPointCount)
+                break;
+            const int polygonVertex = firstPolygonVertex + corner;
+            std::fill(record.begin(), record.end(), 0.0f);
+
+            const FbxVector4 &position = controlPoints[controlPoint];
+            for (int i = 0; i < 3; ++i)
+                record[i] = static_cast<float>(position[i]);
+
+            FbxVector4 normal;
+            if (ReadLayerElement<FbxVector4>(normalElement, controlPoint, polygonVertex, polygon, normal))
+            {
+                for (int i = 0; i < 3; ++i)
+                    record[normalOffset + i] = static_cast<float>(normal[i]);
+                Normalize(&record[normalOffset]);
+            }
+
+            FbxVector4 tangent;
+            if (ReadLayerElement<FbxVector4>(tangentElement, controlPoint, polygonVertex, polygon, tangent))
+            {
+                for (int i = 0; i < 3; ++i)
+                    record[tangentOffset + i] = static_cast<float>(tangent[i]);
+                Normalize(&record[tangentOffset]);
+                // Handedness of the tangent frame from the binormal, right-handed if there is none
+                float sign = 1.0f;
+                FbxVector4 binormal;
+                if (normalElement &&
+                    ReadLayerElement<FbxVector4>(binormalElement, controlPoint, polygonVertex, polygon, binormal))
+                {
+                    const float *n = &record[normalOffset];
+                    const float *t = &record[tangentOffset];
+                    const double handedness = (n[1] * t[2] - n[2] * t[1]) * binormal[0] +
+                                              (n[2] * t[0] - n[0] * t[2]) * binormal[1] +
+                                              (n[0] * t[1] - n[1] * t[0]) * binormal[2];
+                    sign = handedness < 0.0 ? -1.0f : 1.0f;
+                }
+                record[tangentOffset + 3] = sign;
+            }
+
+            FbxColor color;
+            if (ReadLayerElement<FbxColor>(colorElement, controlPoint, polygonVertex, polygon, color))
+            {
+                record[colorOffset] = static_cast<float>(color.mRed);
+                record[colorOffset + 1] = static_cast<float>(color.mGreen);
+                record[colorOffset + 2] = static_cast<float>(color.mBlue);
+                record[colorOffset + 3] = static_cast<float>(color.mAlpha);
+            }
+
+            if (skinned)
+            {
+                for (int i = 0; i < 4; ++i)
+                {
+                    record[jointOffset + i] = skinInfluences.joints[controlPoint][i];
+                    record[weightOffset + i] = skinInfluences.weights[controlPoint][i];
+                }
+            }
+
+            for (size_t uvSet = 0; uvSet < uvElements.size(); ++uvSet)
+            {
+                FbxVector2 uv;
+                if (ReadLayerElement<FbxVector2>(uvElements[uvSet], controlPoint, polygonVertex, polygon, uv))
+                {
+                    record[uvOffset + uvSet * 2] = static_cast<float>(uv[0]);
+                    record[uvOffset + uvSet * 2 + 1] = static_cast<float>(uv[1]);
+                }
+            }
+
+            cornerVertices.push_back(vertices.Insert(record.data()));
+            cornerPositions.push_back(position);
+        }
+        if (static_cast<int>(cornerVertices.size()) != polygonSize)
+            continue; // Invalid control point index
+        mesh.sourceCornerCount += polygonSize;
+
+        const int materialSlot = MaterialSlot(materialElement, polygon);
+        triangles.clear();
+        TriangulatePolygon(cornerPositions, triangles);
+        for (size_t i = 0; i + 2 < triangles.size(); i += 3)
+        {
+            const uint32_t a = cornerVertices[triangles[i]];
+            const uint32_t b = cornerVertices[triangles[i + 1]];
+            const uint32_t c = cornerVertices[triangles[i + 2]];
+            if (a == b || b == c || c == a)
+                continue; // Collapsed by welding
+            mesh.indices.insert(mesh.indices.end(), {a, b, c});
+            if (materialElement)
+                mesh.materials.push_back(materialSlot);
+        }
+    }
+
+    const size_t vertexCount = vertices.Count();
+    mesh.positions.resize(vertexCount * 3);
+    if (normalElement)
+        mesh.normals.resize(vertexCount * 3);
+    if (tangentElement)
+        mesh.tangents.resize(vertexCount * 4);
+    if (colorElement)
+        mesh.colors.resize(vertexCount * 4);
+    if (skinned)
+    {
+        mesh.joints.resize(vertexCount * 4);
+        mesh.weights.resize(vertexCount * 4);
+        mesh.jointNames = std::move(skinInfluences.jointNames);
+    }
+    mesh.uvSets.assign(uvElements.size(), std::vector<float>(vertexCount * 2));
+    for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+    {
+        const float *source = vertices.Record(vertex);
+        std::copy(source, source + 3, &mesh.positions[vertex * 3]);
+        if (normalElement)
+            std::copy(source + normalOffset, source + normalOffset + 3, &mesh.normals[vertex * 3]);
+        if (tangentElement)
+            std::copy(source + tangentOffset, source + tangentOffset + 4, &mesh.tangents[vertex * 4]);
+        if (colorElement)
+            std::copy(source + colorOffset, source + colorOffset + 4, &mesh.colors[vertex * 4]);
+        if (skinned)
+        {
+            for (int i = 0; i < 4; ++i)
+                mesh.joints[vertex * 4 + i] = static_cast<uint16_t>(source[jointOffset + i]);
+            std::copy(source + weightOffset, source + weightOffset + 4, &mesh.weights[vertex * 4]);
+        }
+        for (size_t uvSet = 0; uvSet < uvElements.size(); ++uvSet)
+            std::copy(source + uvOffset + uvSet * 2, source + uvOffset + uvSet * 2 + 2, &mesh.uvSets[uvSet][vertex * 2]);
+    }
+    return mesh;
+}
+
+uint64_t HashIndexedMesh(const IndexedMesh &mesh)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    const auto hashBytes = [&hash](const void *data, size_t size)
+    {
+        // Sizes are hashed too, so that the boundaries between the arrays are part of the hash
+        const auto *sizeBytes = reinterpret_cast<const unsigned char *>(&size);
+        for (size_t i = 0; i < sizeof(size); ++i)
+            hash = (hash ^ sizeBytes[i]) * 0x100000001b3ull;
+        const auto *bytes = static_cast<const unsigned char *>(data);
+        for (size_t i = 0; i < size; ++i)
+            hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    };
+    const auto hashVector = [&hashBytes](const auto &vector)
+    { hashBytes(vector.data(), vector.size() * sizeof(vector[0])); };
+
+    hashVector(mesh.positions);
+    hashVector(mesh.indices);
+    hashVector(mesh.materials);
+    hashVector(mesh.normals);
+    hashVector(mesh.tangents);
+    hashVector(mesh.colors);
+    hashVector(mesh.joints);
+    hashVector(mesh.weights);
+    for (const auto &uvSet : mesh.uvSets)
+        hashVector(uvSet);
+    for (const auto &name : mesh.uvSetNames)
+        hashVector(name);
+    for (const auto &name : mesh.jointNames)
+        hashVector(name);
+    return hash;
+}
+
+bool SameMeshContent(const IndexedMesh &a, const IndexedMesh &b)
+{
+    return a.positions == b.positions && a.indices == b.indices && a.materials == b.materials &&
+           a.normals == b.normals &&
+           a.tangents == b.tangents && a.colors == b.colors && a.joints == b.joints && a.weights == b.weights &&
+           a.uvSets == b.uvSets && a.uvSetNames == b.uvSetNames && a.jointNames == b.jointNames;
+}
+
+IndexedMesh Reindex(const IndexedMesh &mesh, const std::vector<uint32_t> &indices, std::vector<int> materials)
+{
+    IndexedMesh result;
+    result.uvSets.resize(mesh.uvSets.size());
+    result.uvSetNames = mesh.uvSetNames;
+    result.jointNames = mesh.jointNames;
+    result.sourceCornerCount = mesh.sourceCornerCount;
+    result.materials = std::move(materials);
+
+    const auto copyVertex = [](std::vector<float> &target, const std::vector<float> &source, size_t components,
+                               uint32_t vertex)
+    {
+        if (!source.empty())
+            target.insert(target.end(), &source[vertex * components], &source[vertex * components] + components);
+    };
+    std::vector<uint32_t> remap(mesh.VertexCount(), UINT32_MAX);
+    result.indices.reserve(indices.size());
+    for (const uint32_t vertex : indices)
+    {
+        if (remap[vertex] == UINT32_MAX)
+        {
+            remap[vertex] = static_cast<uint32_t>(result.VertexCount());
+            copyVertex(result.positions, mesh.positions, 3, vertex);
+            copyVertex(result.normals, mesh.normals, 3, vertex);
+            copyVertex(result.tangents, mesh.tangents, 4, vertex);
+            copyVertex(result.colors, mesh.colors, 4, vertex);
+            copyVertex(result.weights, mesh.weights, 4, vertex);
+            if (!mesh.joints.empty())
+                result.joints.insert(result.joints.end(), &mesh.joints[vertex * 4], &mesh.joints[vertex * 4] + 4);
+            for (size_t uvSet = 0; uvSet < mesh.uvSets.size(); ++uvSet)
+                copyVertex(result.uvSets[uvSet], mesh.uvSets[uvSet], 2, vertex);
+        }
+        result.indices.push_back(remap[vertex]);
+    }
+    return result;
+}
+
+std::vector<std::pair<int, IndexedMesh>> SplitByMaterial(const IndexedMesh &mesh)
+{
+    std::map<int, std::vector<uint32_t>> indicesOfSlot;
+    for (size_t triangle = 0; triangle < mesh.TriangleCount(); ++triangle)
+    {
+        auto &slotIndices = indicesOfSlot[mesh.materials.empty() ? 0 : mesh.materials[triangle]];
+        slotIndices.insert(slotIndices.end(), &mesh.indices[triangle * 3], &mesh.indices[triangle * 3] + 3);
+    }
+
+    std::vector<std::pair<int, IndexedMesh>> parts;
+    for (const auto &[slot, slotIndices] : indicesOfSlot)
+    {
+        std::vector<int> materials;
+        if (!mesh.materials.empty())
+            materials.assign(slotIndices.size() / 3, slot);
+        parts.emplace_back(slot, Reindex(mesh, slotIndices, std::move(materials)));
+    }
+    return parts;
+}
+
+std::unique_ptr<draco::Mesh> ToDracoMesh(const IndexedMesh &mesh, std::map<std::string, int> *gltfAttributes)
+{
+    std::map<std::string, int> attributeIds;
+    auto dracoMesh = std::make_unique<draco::Mesh>();
+    dracoMesh->set_num_points(static_cast<uint32_t>(mesh.VertexCount()));
+
+    attributeIds["POSITION"] =
+        AddDracoAttribute(*dracoMesh, draco::GeometryAttribute::POSITION, draco::DT_FLOAT32, mesh.positions, 3);
+    if (!mesh.normals.empty())
+        attributeIds["NORMAL"] =
+            AddDracoAttribute(*dracoMesh, draco::GeometryAttribute::NORMAL, draco::DT_FLOAT32, mesh.normals, 3);
+    if (!mesh.tangents.empty())
+        attributeIds["TANGENT"] = AddNamedDracoAttribute(*dracoMesh, "TANGENT", draco::DT_FLOAT32, mesh.tangents, 4);
+    if (!mesh.colors.empty())
+        attributeIds["COLOR_0"] =
+            AddDracoAttribute(*dracoMesh, draco::GeometryAttribute::COLOR, draco::DT_FLOAT32, mesh.colors, 4);
+
+    for (size_t uvSet = 0; uvSet < mesh.uvSets.size(); ++uvSet)
+    {
+        const int uvAttrId = AddDracoAttribute(*dracoMesh, draco::GeometryAttribute::TEX_COORD, draco::DT_FLOAT32,
+                                               mesh.uvSets[uvSet], 2);
+        attributeIds["TEXCOORD_" + std::to_string(uvSet)] = uvAttrId;
+
+        // Add UV set name as metadata
+        auto metadata = std::make_unique<draco::AttributeMetadata>();
+        metadata->AddEntryString("name", mesh.uvSetNames[uvSet]);
+        dracoMesh->AddAttributeMetadata(uvAttrId, std::move(metadata));
+    }
+
+    if (!mesh.joints.empty())
+    {
+        // Add bone node names as metadata, "joint<i>" for joint index i
+        auto metadata = std::make_unique<draco::AttributeMetadata>();
+        for (size_t joint = 0; joint < mesh.jointNames.size(); ++joint)
+            metadata->AddEntryString("joint" + std::to_string(joint), mesh.jointNames[joint]);
+        attributeIds["JOINTS_0"] =
+            AddNamedDracoAttribute(*dracoMesh, "JOINTS_0", draco::DT_UINT16, mesh.joints, 4, std::move(metadata));
+        attributeIds["WEIGHTS_0"] = AddNamedDracoAttribute(*dracoMesh, "WEIGHTS_0", draco::DT_FLOAT32, mesh.weights, 4);
+    }
+
+    dracoMesh->SetNumFaces(mesh.TriangleCount());
+    for (size_t triangle = 0; triangle < mesh.TriangleCount(); ++triangle)
+    {
+        draco::Mesh::Face face;
+        for (int corner = 0; corner < 3; ++corner)
+            face[corner] = draco::PointIndex(mesh.indices[triangle * 3 + corner]);
+        dracoMesh->SetFace(draco::FaceIndex(static_cast<uint32_t>(triangle)), face);
+    }
+    if (gltfAttributes)
+        *gltfAttributes = std::move(attributeIds);
+    return dracoMesh;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fbxsdk.h>
+#include <draco/compression/expert_encode.h>
+#include <draco/mesh/mesh.h>
+
+// Options of the FBX exporter, parsed from the options JSON of vcpp_fbx:
+//   {"output": "drc" | "glb",
+//    "texture": {"encode": "basis-lz" | "uastc", "args": ["--zstd", "18", ...]},
+//    "attributes": {"normal": true, "tangent": true, "color": true, "skin": true},
+//    "quantization": {"position": 11, "normal": 8, "texcoord": 10, "color": 8, "tangent": 8, "weight": 8},
+//    "method": "edgebreaker" | "sequential", "encode_speed": 5, "decode_speed": 5,
+//    "lods": [0.5, 0.25, 0.1], "meshlets": true}
+// Every key is optional. Quantization bits of 0 store the attribute as lossless floats.
+struct MeshExportOptions
+{
+    // One .drc per unique mesh and a scene manifest, or a single GLB of the whole scene
+    bool glb = false;
+    // ktx create --encode codec and additional arguments for the textures of the GLB
+    std::string textureEncode = "basis-lz";
+    std::vector<std::string> textureArgs;
+
+    // Attributes exported in addition to positions and UVs
+    bool normals = true;
+    bool tangents = true;
+    bool colors = true;
+    bool skin = true;
+
+    int positionBits = 11;
+    int normalBits = 8;
+    int texcoordBits = 10;
+    int colorBits = 8;
+    int tangentBits = 8;
+    int weightBits = 8;
+
+    // Fraction of the triangles of the mesh kept by each level of detail after the full mesh,
+    // written as <prefix>_mesh<id>_lod<n>.drc. Not used by the GLB output.
+    std::vector<float> lodRatios;
+
+    // Partition every mesh into meshlets stored as Draco metadata, see AddMeshletMetadata.
+    // Forces the sequential method, which keeps the vertex order the meshlets refer to.
+    bool meshlets = false;
+
+    bool edgebreaker = true;
+    int encodeSpeed = 5; // 0 (slowest, smallest) to 10 (fastest)
+    int decodeSpeed = 5;
+};
+
+// Parses options over the defaults. Returns false and reports the problem on std::cerr if
+// options is not valid.
+bool ParseMeshExportOptions(const char *options, MeshExportOptions &exportOptions);
+
+// Applies the speed, method and quantization options to encoder, which encodes dracoMesh. Attributes
+// are quantized by their own id, so tangents and weights written as GENERIC get their own bits.
+void ConfigureDracoEncoder(draco::ExpertEncoder &encoder, const draco::Mesh &dracoMesh,
+                           const MeshExportOptions &exportOptions);
+
+// Triangulated mesh with one entry per unique vertex, i.e. per unique combination of the
+// position and all per-corner attributes of the polygon vertices that reference it.
+struct IndexedMesh
+{
+    std::vector<float> positions;             // 3 per vertex
+    std::vector<float> normals;               // 3 per vertex, empty if the mesh has no normals
+    std::vector<float> tangents;              // 4 per vertex, w is the bitangent sign, empty if none
+    std::vector<float> colors;                // 4 per vertex, empty if the mesh has no vertex colours
+    std::vector<std::vector<float>> uvSets;   // 2 per vertex for each UV set
+    std::vector<std::string> uvSetNames;      // One per UV set
+    std::vector<uint16_t> joints;             // 4 per vertex, indices into jointNames, empty if not skinned
+    std::vector<float> weights;               // 4 per vertex summing to one, empty if not skinned
+    std::vector<std::string> jointNames;      // Bone node of each cluster of the skin
+    std::vector<uint32_t> indices;            // 3 per triangle
+    std::vector<int> materials;               // Material slot per triangle, empty if the mesh has none
+    uint32_t sourceCornerCount = 0;           // Polygon vertices read from the FBX mesh
+
+    size_t VertexCount() const { return positions.size() / 3; }
+    size_t TriangleCount() const { return indices.size() / 3; }
+};
+
+// Triangulates every polygon of pMesh, including concave n-gons, and welds the polygon vertices
+// that agree in all exported attributes into shared vertices. Skinned vertices keep their four
+// strongest influences.
+IndexedMesh BuildIndexedMesh(FbxMesh *pMesh, const MeshExportOptions &exportOptions);
+
+// Hash of the geometry and all attributes of the mesh, for finding copies of it.
+uint64_t HashIndexedMesh(const IndexedMesh &mesh);
+
+// Returns true if the meshes have identical geometry and attributes.
+bool SameMeshContent(const IndexedMesh &a, const IndexedMesh &b);
+
+// Returns the mesh of the triangles given by indices into the vertices of mesh, with the material
+// slot of each triangle, keeping only the referenced vertices in order of first reference.
+IndexedMesh Reindex(const IndexedMesh &mesh, const std::vector<uint32_t> &indices, std::vector<int> materials);
+
+// Splits the mesh into one mesh per material slot used by its triangles, in ascending slot order,
+// each with only the vertices its triangles reference.
+std::vector<std::pair<int, IndexedMesh>> SplitByMaterial(const IndexedMesh &mesh);
+
+// Converts the mesh to a Draco mesh. Every attribute stores only its unique values and maps the
+// points to them explicitly, e.g. positions are stored once even where UV seams split a vertex.
+// gltfAttributes, if not null, receives the Draco attribute id of each glTF attribute semantic.
+std::unique_ptr<draco::Mesh> ToDracoMesh(const IndexedMesh &mesh,
+                                         std::map<std::string, int> *gltfAttributes = nullptr);
@@ -0,0 +1,350 @@
+#include "core/mesh_simplify.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace
+{
+    // Sum of squared distances to a set of weighted planes
+    struct Quadric
+    {
+        double a2 = 0, ab = 0, ac = 0, ad = 0, b2 = 0, bc = 0, bd = 0, c2 = 0, cd = 0, d2 = 0;
+
+        void AddPlane(double a, double b, double c, double d, double weight)
+        {
+            a2 += weight * a * a;
+            ab += weight * a * b;
+            ac += weight * a * c;
+            ad += weight * a * d;
+            b2 += weight * b * b;
+            bc += weight * b * c;
+            bd += weight * b * d;
+            c2 += weight * c * c;
+            cd += weight * c * d;
+            d2 += weight * d * d;
+        }
+
+        Quadric &operator+=(const Quadric &other)
+        {
+            a2 += other.a2;
+            ab += other.ab;
+            ac += other.ac;
+            ad += other.ad;
+            b2 += other.b2;
+            bc += other.bc;
+            bd += other.bd;
+            c2 += other.c2;
+            cd += other.cd;
+            d2 += other.d2;
+            return *this;
+        }
+
+        double Error(const float *p) const
+        {
+            const double x = p[0], y = p[1], z = p[2];
+            return a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x + b2 * y * y + 2 * bc * y * z +
+                   2 * bd * y + c2 * z * z + 2 * cd * z + d2;
+        }
+    };
+
+    // Collapses may turn a triangle by at most about 75 degrees, which also keeps slivers out
+    constexpr double kMinNormalCosine = 0.25;
+
+    // Border planes are weighted above the surface so that borders keep their shape
+    constexpr double kBorderWeight = 10.0;
+
+    void Cross(const double *a, const double *b, double *result)
+    {
+        result[0] = a[1] * b[2] - a[2] * b[1];
+        result[1] = a[2] * b[0] - a[0] * b[2];
+        result[2] = a[0] * b[1] - a[1] * b[0];
+    }
+
+    double Dot(const double *a, const double *b)
+    {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    void TriangleNormal(const float *p0, const float *p1, const float *p2, double *normal)
+    {
+        const double e1[3] = {double(p1[0]) - p0[0], double(p1[1]) - p0[1], double(p1[2]) - p0[2]};
+        const double e2[3] = {double(p2[0]) - p0[0], double(p2[1]) - p0[1], double(p2[2]) - p0[2]};
+        Cross(e1, e2, normal);
+    }
+
+    uint64_t EdgeKey(uint32_t a, uint32_t b)
+    {
+        return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+    }
+
+    struct Collapse
+    {
+        double cost;
+        uint32_t from; // Position groups
+        uint32_t to;
+    };
+}
+
+IndexedMesh SimplifyMesh(const IndexedMesh &mesh, float targetRatio)
+{
+    const size_t vertexCount = mesh.VertexCount();
+    const size_t triangleCount = mesh.TriangleCount();
+    const size_t targetTriangles = std::max<size_t>(1, static_cast<size_t>(triangleCount * targetRatio));
+    if (targetTriangles >= triangleCount)
+        return mesh;
+    const float *positions = mesh.positions.data();
+
+    // Group the vertices split by attribute seams by their position
+    std::vector<uint32_t> order(vertexCount);
+    std::iota(order.begin(), order.end(), 0);
+    const auto lessPosition = [positions](uint32_t a, uint32_t b)
+    { return std::lexicographical_compare(positions + a * 3, positions + a * 3 + 3, positions + b * 3, positions + b * 3 + 3); };
+    std::sort(order.begin(), order.end(), lessPosition);
+    std::vector<uint32_t> groupOf(vertexCount);
+    std::vector<std::vector<uint32_t>> vertices; // Of each group
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        if (i == 0 || lessPosition(order[i - 1], order[i]))
+            vertices.emplace_back();
+        groupOf[order[i]] = static_cast<uint32_t>(vertices.size() - 1);
+        vertices.back().push_back(order[i]);
+    }
+    const size_t groupCount = vertices.size();
+    const auto groupPosition = [&](uint32_t group) { return positions + vertices[group][0] * 3; };
+
+    std::vector<uint32_t> indices = mesh.indices;
+    std::vector<bool> live(triangleCount, true);
+    size_t liveCount = triangleCount;
+
+    // Edges between position groups with the number of triangles sharing them
+    std::vector<std::pair<uint64_t, uint32_t>> edgeCounts;
+    const auto countEdges = [&]()
+    {
+        std::vector<uint64_t> keys;
+        keys.reserve(liveCount * 3);
+        for (size_t t = 0; t < triangleCount; ++t)
+            if (live[t])
+                for (int corner = 0; corner < 3; ++corner)
+                    keys.push_back(EdgeKey(groupOf[indices[t * 3 + corner]], groupOf[indices[t * 3 + (corner + 1) % 3]]));
+        std::sort(keys.begin(), keys.end());
+        edgeCounts.clear();
+        for (const uint64_t key : keys)
+        {
+            if (edgeCounts.empty() || edgeCounts.back().first != key)
+                edgeCounts.emplace_back(key, 0);
+            ++edgeCounts.back().second;
+        }
+    };
+    const auto edgeCount = [&](uint32_t a, uint32_t b)
+    {
+        const auto it = std::lower_bound(edgeCounts.begin(), edgeCounts.end(), std::make_pair(EdgeKey(a, b), 0u));
+        return it != edgeCounts.end() && it->first == EdgeKey(a, b) ? it->second : 0u;
+    };
+
+    // Quadrics of the planes of the triangles and of the planes through the border edges
+    // perpendicular to their triangles
+    std::vector<Quadric> quadrics(groupCount);
+    countEdges();
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        const uint32_t *triangle = &indices[t * 3];
+        double normal[3];
+        TriangleNormal(positions + triangle[0] * 3, positions + triangle[1] * 3, positions + triangle[2] * 3, normal);
+        const double length = std::sqrt(Dot(normal, normal));
+        if (length == 0.0)
+            continue;
+        for (double &component : normal)
+            component /= length;
+        const float *p0 = positions + triangle[0] * 3;
+        const double d = -(normal[0] * p0[0] + normal[1] * p0[1] + normal[2] * p0[2]);
+        for (int corner = 0; corner < 3; ++corner)
+            quadrics[groupOf[triangle[corner]]].AddPlane(normal[0], normal[1], normal[2], d, length * 0.5);
+
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            const uint32_t a = groupOf[triangle[corner]];
+            const uint32_t b = groupOf[triangle[(corner + 1) % 3]];
+            if (edgeCount(a, b) != 1)
+                continue;
+            const float *pa = groupPosition(a);
+            const float *pb = groupPosition(b);
+            const double edge[3] = {double(pb[0]) - pa[0], double(pb[1]) - pa[1], double(pb[2]) - pa[2]};
+            double border[3];
+            Cross(edge, normal, border);
+            const double borderLength = std::sqrt(Dot(border, border));
+            if (borderLength == 0.0)
+                continue;
+            for (double &component : border)
+                component /= borderLength;
+            const double borderD = -(border[0] * pa[0] + border[1] * pa[1] + border[2] * pa[2]);
+            const double weight = kBorderWeight * Dot(edge, edge);
+            quadrics[a].AddPlane(border[0], border[1], border[2], borderD, weight);
+            quadrics[b].AddPlane(border[0], border[1], border[2], borderD, weight);
+        }
+    }
+
+    // Greedy passes over the cheapest collapses, each touching a vertex at most once
+    std::vector<std::vector<uint32_t>> trianglesOf(groupCount);
+    std::vector<bool> onBorder(groupCount);
+    std::vector<bool> onMaterialBoundary(groupCount);
+    std::vector<bool> touched(groupCount);
+    std::vector<Collapse> collapses;
+    std::vector<std::pair<uint32_t, uint32_t>> mapping; // Vertex of the collapsed group -> target vertex
+    while (liveCount > targetTriangles)
+    {
+        for (auto &groupTriangles : trianglesOf)
+            groupTriangles.clear();
+        for (size_t t = 0; t < triangleCount; ++t)
+            if (live[t])
+                for (int corner = 0; corner < 3; ++corner)
+                {
+                    auto &groupTriangles = trianglesOf[groupOf[indices[t * 3 + corner]]];
+                    if (groupTriangles.empty() || groupTriangles.back() != t)
+                        groupTriangles.push_back(static_cast<uint32_t>(t));
+                }
+        // Vertices shared by triangles of different materials stay in place, so that no material
+        // spreads over the triangles of another
+        if (!mesh.materials.empty())
+            for (size_t group = 0; group < groupCount; ++group)
+                onMaterialBoundary[group] =
+                    std::any_of(trianglesOf[group].begin(), trianglesOf[group].end(),
+                                [&](uint32_t t) { return mesh.materials[t] != mesh.materials[trianglesOf[group][0]]; });
+        countEdges();
+        std::fill(onBorder.begin(), onBorder.end(), false);
+        for (const auto &[key, count] : edgeCounts)
+            if (count != 2)
+                onBorder[key >> 32] = onBorder[key & 0xffffffff] = true;
+
+        collapses.clear();
+        for (const auto &[key, count] : edgeCounts)
+        {
+            const auto a = static_cast<uint32_t>(key >> 32);
+            const auto b = static_cast<uint32_t>(key & 0xffffffff);
+            if (a == b)
+                continue;
+            Quadric sum = quadrics[a];
+            sum += quadrics[b];
+            collapses.push_back({sum.Error(groupPosition(b)), a, b});
+            collapses.push_back({sum.Error(groupPosition(a)), b, a});
+        }
+        std::sort(collapses.begin(), collapses.end(),
+                  [](const Collapse &x, const Collapse &y) { return x.cost < y.cost; });
+
+        std::fill(touched.begin(), touched.end(), false);
+        size_t collapsed = 0;
+        for (const Collapse &collapse : collapses)
+        {
+            if (liveCount <= targetTriangles)
+                break;
+            const uint32_t from = collapse.from;
+            const uint32_t to = collapse.to;
+            if (touched[from] || touched[to] || onMaterialBoundary[from])
+                continue;
+            // Borders only collapse along themselves
+            if (onBorder[from] && edgeCount(from, to) != 1)
+                continue;
+
+            // Each vertex of the group must reach exactly one vertex of the target group through
+            // its triangles, i.e. the edge runs along every seam through the group
+            mapping.clear();
+            bool valid = true;
+            for (const uint32_t t : trianglesOf[from])
+            {
+                uint32_t fromVertex = UINT32_MAX;
+                uint32_t toVertex = UINT32_MAX;
+                for (int corner = 0; corner < 3; ++corner)
+                {
+                    const uint32_t vertex = indices[t * 3 + corner];
+                    if (groupOf[vertex] == from)
+                        fromVertex = vertex;
+                    else if (groupOf[vertex] == to)
+                        toVertex = vertex;
+                }
+                const auto it = std::find_if(mapping.begin(), mapping.end(),
+                                             [fromVertex](const auto &entry) { return entry.first == fromVertex; });
+                if (it == mapping.end())
+                    mapping.emplace_back(fromVertex, toVertex);
+                else if (it->second == UINT32_MAX)
+                    it->second = toVertex;
+                else if (toVertex != UINT32_MAX && it->second != toVertex)
+                    valid = false;
+            }
+            for (const auto &entry : mapping)
+                valid = valid && entry.second != UINT32_MAX;
+            if (!valid)
+                continue;
+
+            // Reject collapses that flip or fold a remaining triangle
+            const float *target = groupPosition(to);
+            size_t removedCount = 0;
+            for (const uint32_t t : trianglesOf[from])
+            {
+                const float *corners[3];
+                const float *moved[3];
+                bool removed = false;
+                for (int corner = 0; corner < 3; ++corner)
+                {
+                    const uint32_t vertex = indices[t * 3 + corner];
+                    removed = removed || groupOf[vertex] == to;
+                    corners[corner] = positions + vertex * 3;
+                    moved[corner] = groupOf[vertex] == from ? target : corners[corner];
+                }
+                if (removed)
+                {
+                    ++removedCount;
+                    continue;
+                }
+                double before[3];
+                double after[3];
+                TriangleNormal(corners[0], corners[1], corners[2], before);
+                TriangleNormal(moved[0], moved[1], moved[2], after);
+                if (Dot(before, after) <= kMinNormalCosine * std::sqrt(Dot(before, before) * Dot(after, after)))
+                {
+                    valid = false;
+                    break;
+                }
+            }
+            // Never go below the target, which is at least one triangle, so no level ends up empty
+            if (!valid || liveCount - removedCount < targetTriangles)
+                continue;
+
+            for (const uint32_t t : trianglesOf[from])
+            {
+                bool removed = false;
+                for (int corner = 0; corner < 3; ++corner)
+                {
+                    uint32_t &vertex = indices[t * 3 + corner];
+                    touched[groupOf[vertex]] = true;
+                    removed = removed || groupOf[vertex] == to;
+                    if (groupOf[vertex] == from)
+                        vertex = std::find_if(mapping.begin(), mapping.end(),
+                                              [vertex](const auto &entry) { return entry.first == vertex; })
+                                     ->second;
+                }
+                if (removed)
+                {
+                    live[t] = false;
+                    --liveCount;
+                }
+            }
+            quadrics[to] += quadrics[from];
+            ++collapsed;
+        }
+        if (collapsed == 0)
+            break;
+    }
+
+    std::vector<uint32_t> liveIndices;
+    std::vector<int> liveMaterials;
+    liveIndices.reserve(liveCount * 3);
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        if (!live[t])
+            continue;
+        liveIndices.insert(liveIndices.end(), &indices[t * 3], &indices[t * 3] + 3);
+        if (!mesh.materials.empty())
+            liveMaterials.push_back(mesh.materials[t]);
+    }
+    return Reindex(mesh, liveIndices, std::move(liveMaterials));
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "core/mesh_builder.h"
+
+// Reduces the mesh to about targetRatio of its triangles by quadric error edge collapses.
+// Vertices only move onto neighbouring vertices, so attributes are never interpolated. Attribute
+// seams are preserved: a vertex split by a seam collapses only along the seam, moving all of its
+// split vertices together. Mesh borders are kept in place the same way. The result may have more
+// triangles than requested if no further collapse keeps the seams and orientation intact, but never
+// fewer, and always at least one.
+IndexedMesh SimplifyMesh(const IndexedMesh &mesh, float targetRatio);
@@ -0,0 +1,320 @@
+#include "core/meshlet_builder.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <numeric>
+
+#include <draco/metadata/geometry_metadata.h>
+
+namespace
+{
+    // Interleaves the bits of three 10-bit coordinates
+    uint32_t Morton(uint32_t x, uint32_t y, uint32_t z)
+    {
+        const auto spread = [](uint32_t v)
+        {
+            v &= 0x3ff;
+            v = (v | (v << 16)) & 0x030000ff;
+            v = (v | (v << 8)) & 0x0300f00f;
+            v = (v | (v << 4)) & 0x030c30c3;
+            v = (v | (v << 2)) & 0x09249249;
+            return v;
+        };
+        return spread(x) | (spread(y) << 1) | (spread(z) << 2);
+    }
+
+    void TriangleCentroid(const IndexedMesh &mesh, size_t triangle, float *centroid)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            centroid[axis] = 0.0f;
+            for (int corner = 0; corner < 3; ++corner)
+                centroid[axis] += mesh.positions[mesh.indices[triangle * 3 + corner] * 3 + axis] / 3.0f;
+        }
+    }
+
+    float DistanceSquared(const float *a, const float *b)
+    {
+        const float dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    // Ritter's bounding sphere and the normal cone of a meshlet
+    void ComputeBounds(const IndexedMesh &mesh, const MeshletMesh &result, Meshlet &meshlet)
+    {
+        const auto position = [&](uint32_t local)
+        { return &mesh.positions[result.vertices[meshlet.vertexOffset + local] * 3]; };
+
+        uint32_t a = 0;
+        for (uint32_t v = 1; v < meshlet.vertexCount; ++v)
+            if (DistanceSquared(position(v), position(0)) > DistanceSquared(position(a), position(0)))
+                a = v;
+        uint32_t b = a;
+        for (uint32_t v = 0; v < meshlet.vertexCount; ++v)
+            if (DistanceSquared(position(v), position(a)) > DistanceSquared(position(b), position(a)))
+                b = v;
+        float center[3];
+        for (int axis = 0; axis < 3; ++axis)
+            center[axis] = (position(a)[axis] + position(b)[axis]) * 0.5f;
+        float radius = std::sqrt(DistanceSquared(position(a), position(b))) * 0.5f;
+        for (uint32_t v = 0; v < meshlet.vertexCount; ++v)
+        {
+            const float distance = std::sqrt(DistanceSquared(position(v), center));
+            if (distance > radius)
+            {
+                const float grown = (radius + distance) * 0.5f;
+                for (int axis = 0; axis < 3; ++axis)
+                    center[axis] += (position(v)[axis] - center[axis]) * (grown - radius) / distance;
+                radius = grown;
+            }
+        }
+        std::copy(center, center + 3, meshlet.center);
+        meshlet.radius = radius;
+
+        std::vector<std::array<float, 3>> normals;
+        float axis[3] = {0.0f, 0.0f, 0.0f};
+        for (uint32_t t = 0; t < meshlet.triangleCount; ++t)
+        {
+            const uint8_t *triangle = &result.triangles[meshlet.triangleOffset + t * 3];
+            const float *p0 = position(triangle[0]);
+            const float *p1 = position(triangle[1]);
+            const float *p2 = position(triangle[2]);
+            const float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+            const float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+            std::array<float, 3> normal = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2],
+                                           e1[0] * e2[1] - e1[1] * e2[0]};
+            const float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            if (length == 0.0f)
+                continue;
+            for (int i = 0; i < 3; ++i)
+            {
+                normal[i] /= length;
+                axis[i] += normal[i];
+            }
+            normals.push_back(normal);
+        }
+
+        const float axisLength = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+        float minDot = 1.0f;
+        if (axisLength > 0.0f)
+        {
+            for (float &component : axis)
+                component /= axisLength;
+            for (const auto &normal : normals)
+                minDot = std::min(minDot, normal[0] * axis[0] + normal[1] * axis[1] + normal[2] * axis[2]);
+        }
+        // Cones wider than about 84 degrees would hardly ever cull
+        if (axisLength == 0.0f || minDot <= 0.1f)
+        {
+            std::fill(meshlet.coneAxis, meshlet.coneAxis + 3, 0.0f);
+            meshlet.coneCutoff = 1.0f;
+            return;
+        }
+        std::copy(axis, axis + 3, meshlet.coneAxis);
+        meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+    }
+
+    void AppendUint32(std::vector<uint8_t> &data, uint32_t value)
+    {
+        const uint8_t bytes[4] = {uint8_t(value), uint8_t(value >> 8), uint8_t(value >> 16), uint8_t(value >> 24)};
+        data.insert(data.end(), bytes, bytes + 4);
+    }
+
+    void AppendFloat(std::vector<uint8_t> &data, float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        AppendUint32(data, bits);
+    }
+}
+
+MeshletMesh BuildMeshlets(IndexedMesh &mesh)
+{
+    const size_t vertexCount = mesh.VertexCount();
+    const size_t triangleCount = mesh.TriangleCount();
+    MeshletMesh result;
+    if (triangleCount == 0)
+        return result;
+
+    // Triangles around each vertex
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    for (const uint32_t vertex : mesh.indices)
+        ++adjacencyOffsets[vertex + 1];
+    std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+    std::vector<uint32_t> adjacency(mesh.indices.size());
+    {
+        std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t i = 0; i < mesh.indices.size(); ++i)
+            adjacency[fill[mesh.indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    // Seeds in Morton order of the triangle centroids keep consecutive meshlets close together
+    std::vector<float> centroids(triangleCount * 3);
+    float minimum[3] = {INFINITY, INFINITY, INFINITY};
+    float maximum[3] = {-INFINITY, -INFINITY, -INFINITY};
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        TriangleCentroid(mesh, t, &centroids[t * 3]);
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            minimum[axis] = std::min(minimum[axis], centroids[t * 3 + axis]);
+            maximum[axis] = std::max(maximum[axis], centroids[t * 3 + axis]);
+        }
+    }
+    const float extent = std::max({maximum[0] - minimum[0], maximum[1] - minimum[1], maximum[2] - minimum[2], 1e-20f});
+    std::vector<uint32_t> mortonCodes(triangleCount);
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        uint32_t cell[3];
+        for (int axis = 0; axis < 3; ++axis)
+            cell[axis] = static_cast<uint32_t>((centroids[t * 3 + axis] - minimum[axis]) / extent * 1023.0f);
+        mortonCodes[t] = Morton(cell[0], cell[1], cell[2]);
+    }
+    std::vector<uint32_t> seeds(triangleCount);
+    std::iota(seeds.begin(), seeds.end(), 0);
+    std::sort(seeds.begin(), seeds.end(), [&](uint32_t a, uint32_t b) { return mortonCodes[a] < mortonCodes[b]; });
+
+    std::vector<bool> used(triangleCount, false);
+    std::vector<int> localIndex(vertexCount, -1);
+    std::vector<uint32_t> meshletVertices;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> orderedTriangles;
+    orderedTriangles.reserve(triangleCount);
+    float centroidSum[3];
+
+    const auto addTriangle = [&](uint32_t t, Meshlet &meshlet)
+    {
+        used[t] = true;
+        orderedTriangles.push_back(t);
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            const uint32_t vertex = mesh.indices[t * 3 + corner];
+            if (localIndex[vertex] < 0)
+            {
+                localIndex[vertex] = static_cast<int>(meshletVertices.size());
+                meshletVertices.push_back(vertex);
+                for (int axis = 0; axis < 3; ++axis)
+                    centroidSum[axis] += mesh.positions[vertex * 3 + axis];
+                for (uint32_t i = adjacencyOffsets[vertex]; i < adjacencyOffsets[vertex + 1]; ++i)
+                    if (!used[adjacency[i]])
+                        candidates.push_back(adjacency[i]);
+            }
+            result.triangles.push_back(static_cast<uint8_t>(localIndex[vertex]));
+        }
+        ++meshlet.triangleCount;
+    };
+
+    for (const uint32_t seed : seeds)
+    {
+        if (used[seed])
+            continue;
+
+        Meshlet meshlet = {};
+        meshlet.vertexOffset = static_cast<uint32_t>(result.vertices.size());
+        meshlet.triangleOffset = static_cast<uint32_t>(result.triangles.size());
+        const int material = mesh.materials.empty() ? 0 : mesh.materials[seed];
+        meshletVertices.clear();
+        candidates.clear();
+        std::fill(centroidSum, centroidSum + 3, 0.0f);
+        addTriangle(seed, meshlet);
+
+        // Grow over the triangles adding the fewest vertices, preferring those nearest the middle
+        while (meshlet.triangleCount < kMaxMeshletTriangles)
+        {
+            const float scale = 1.0f / meshletVertices.size();
+            const float middle[3] = {centroidSum[0] * scale, centroidSum[1] * scale, centroidSum[2] * scale};
+            uint32_t best = UINT32_MAX;
+            int bestNewVertices = 4;
+            float bestDistance = INFINITY;
+            size_t kept = 0;
+            for (const uint32_t t : candidates)
+            {
+                if (used[t] || (!mesh.materials.empty() && mesh.materials[t] != material))
+                    continue;
+                candidates[kept++] = t;
+                int newVertices = 0;
+                for (int corner = 0; corner < 3; ++corner)
+                    newVertices += localIndex[mesh.indices[t * 3 + corner]] < 0;
+                if (meshletVertices.size() + newVertices > kMaxMeshletVertices)
+                    continue;
+                const float distance = DistanceSquared(&centroids[t * 3], middle);
+                if (newVertices < bestNewVertices || (newVertices == bestNewVertices && distance < bestDistance))
+                {
+                    best = t;
+                    bestNewVertices = newVertices;
+                    bestDistance = distance;
+                }
+            }
+            candidates.resize(kept);
+            if (best == UINT32_MAX)
+                break;
+            addTriangle(best, meshlet);
+        }
+
+        meshlet.vertexCount = static_cast<uint32_t>(meshletVertices.size());
+        result.vertices.insert(result.vertices.end(), meshletVertices.begin(), meshletVertices.end());
+        result.triangles.resize((result.triangles.size() + 3) & ~size_t(3), 0);
+        for (const uint32_t vertex : meshletVertices)
+            localIndex[vertex] = -1;
+        result.meshlets.push_back(meshlet);
+    }
+
+    // Reorder the mesh to meshlet order, numbering the vertices by first use
+    std::vector<uint32_t> orderedIndices;
+    std::vector<int> orderedMaterials;
+    orderedIndices.reserve(mesh.indices.size());
+    for (const uint32_t t : orderedTriangles)
+    {
+        orderedIndices.insert(orderedIndices.end(), &mesh.indices[t * 3], &mesh.indices[t * 3] + 3);
+        if (!mesh.materials.empty())
+            orderedMaterials.push_back(mesh.materials[t]);
+    }
+    std::vector<uint32_t> remap(vertexCount, UINT32_MAX);
+    uint32_t nextVertex = 0;
+    for (const uint32_t vertex : orderedIndices)
+        if (remap[vertex] == UINT32_MAX)
+            remap[vertex] = nextVertex++;
+    for (uint32_t &vertex : result.vertices)
+        vertex = remap[vertex];
+    mesh = Reindex(mesh, orderedIndices, std::move(orderedMaterials));
+
+    for (Meshlet &meshlet : result.meshlets)
+        ComputeBounds(mesh, result, meshlet);
+    return result;
+}
+
+void AddMeshletMetadata(draco::Mesh &dracoMesh, const MeshletMesh &meshlets)
+{
+    std::vector<uint8_t> table;
+    table.reserve(meshlets.meshlets.size() * 48);
+    for (const Meshlet &meshlet : meshlets.meshlets)
+    {
+        AppendUint32(table, meshlet.vertexOffset);
+        AppendUint32(table, meshlet.triangleOffset);
+        AppendUint32(table, meshlet.vertexCount);
+        AppendUint32(table, meshlet.triangleCount);
+        for (const float value : meshlet.center)
+            AppendFloat(table, value);
+        AppendFloat(table, meshlet.radius);
+        for (const float value : meshlet.coneAxis)
+            AppendFloat(table, value);
+        AppendFloat(table, meshlet.coneCutoff);
+    }
+    std::vector<uint8_t> vertices;
+    vertices.reserve(meshlets.vertices.size() * 4);
+    for (const uint32_t vertex : meshlets.vertices)
+        AppendUint32(vertices, vertex);
+
+    // Keep the attribute metadata already added to the mesh
+    if (!dracoMesh.metadata())
+        dracoMesh.AddMetadata(std::make_unique<draco::GeometryMetadata>());
+    draco::GeometryMetadata *metadata = dracoMesh.metadata();
+    metadata->AddEntryInt("meshlet_max_vertices", kMaxMeshletVertices);
+    metadata->AddEntryInt("meshlet_max_triangles", kMaxMeshletTriangles);
+    metadata->AddEntryBinary("meshlets", table);
+    metadata->AddEntryBinary("meshlet_vertices", vertices);
+    metadata->AddEntryBinary("meshlet_triangles", meshlets.triangles);
+}
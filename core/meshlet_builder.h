@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <draco/mesh/mesh.h>
+
+#include "core/mesh_builder.h"
+
+constexpr uint32_t kMaxMeshletVertices = 64;
+constexpr uint32_t kMaxMeshletTriangles = 124;
+
+// A cluster of up to kMaxMeshletVertices vertices and kMaxMeshletTriangles triangles of one material.
+// The meshlet is entirely backfacing for a camera at position camera, and can be culled, if
+//   dot(center - camera, coneAxis) >= coneCutoff * length(center - camera) + radius
+// A coneCutoff of 1 with a zero axis marks meshlets whose normals spread too far to be culled.
+struct Meshlet
+{
+    uint32_t vertexOffset;   // First entry in MeshletMesh::vertices
+    uint32_t triangleOffset; // First byte in MeshletMesh::triangles, a multiple of 4
+    uint32_t vertexCount;
+    uint32_t triangleCount;
+    float center[3]; // Bounding sphere
+    float radius;
+    float coneAxis[3]; // Normal cone
+    float coneCutoff;
+};
+
+struct MeshletMesh
+{
+    std::vector<Meshlet> meshlets;
+    std::vector<uint32_t> vertices; // Mesh vertex of each meshlet vertex
+    std::vector<uint8_t> triangles; // 3 meshlet vertex indices per triangle, padded to 4 bytes per meshlet
+};
+
+// Partitions the triangles of mesh into spatially coherent meshlets, grown greedily over shared
+// vertices from seeds in Morton order. The mesh is reordered in place so that its triangles follow
+// the meshlets and its vertices are in order of first use, so every meshlet reads a compact range of
+// vertices; within a meshlet the vertices are also in order of first use by its triangles.
+MeshletMesh BuildMeshlets(IndexedMesh &mesh);
+
+// Stores the meshlets as geometry metadata of the Draco mesh: "meshlets" (48 bytes per meshlet,
+// the fields of Meshlet in little-endian order), "meshlet_vertices" (uint32 each) and
+// "meshlet_triangles" as binary entries, and the limits as "meshlet_max_vertices" and
+// "meshlet_max_triangles". Vertex indices refer to the point ids of the mesh, which the
+// sequential Draco encoding preserves.
+void AddMeshletMetadata(draco::Mesh &dracoMesh, const MeshletMesh &meshlets);
@@ -20,6 +20,7 @@
 
 #include <KHR/khr_df.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -185,6 +186,16 @@ const char* dfdToStringSampleDatatypeQualifiersBit(uint32_t bit_index, bool bit_
  * If there is no direct match or the value is invalid returns NULL */
 const char* dfdToStringChannelId(khr_df_model_e model, khr_df_model_channels_e value);
 
+/* Receives the text printed by printDFD, printDFDJSON and dfdPrintf. */
+typedef void (*dfdPrintFunction)(void* userData, const char* text, size_t length);
+
+/* Route the text printed on the calling thread to function instead of stdout.
+ * Pass NULL to print to stdout again. */
+void dfdSetThreadPrintFunction(dfdPrintFunction function, void* userData);
+
+/* printf to stdout or to the print function of the calling thread. */
+int dfdPrintf(const char* format, ...);
+
 /* Print a human-readable interpretation of a data format descriptor. */
 void printDFD(uint32_t *DFD, uint32_t dataSize);
 
@@ -16,12 +16,62 @@
  */
 
 #include <assert.h>
+#include <stdarg.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <KHR/khr_df.h>
 #include "dfd.h"
 
+#if defined(_MSC_VER)
+#define DFD_THREAD_LOCAL __declspec(thread)
+#else
+#define DFD_THREAD_LOCAL _Thread_local
+#endif
+
+static DFD_THREAD_LOCAL dfdPrintFunction threadPrintFunction;
+static DFD_THREAD_LOCAL void* threadPrintUserData;
+
+void dfdSetThreadPrintFunction(dfdPrintFunction function, void* userData)
+{
+    threadPrintFunction = function;
+    threadPrintUserData = userData;
+}
+
+int dfdPrintf(const char* format, ...)
+{
+    va_list args;
+    int length;
+
+    va_start(args, format);
+    if (!threadPrintFunction) {
+        length = vprintf(format, args);
+        va_end(args);
+        return length;
+    }
+
+    char stackBuffer[256];
+    va_list argsCopy;
+    va_copy(argsCopy, args);
+    length = vsnprintf(stackBuffer, sizeof(stackBuffer), format, argsCopy);
+    va_end(argsCopy);
+    if (length >= 0 && (size_t)length < sizeof(stackBuffer)) {
+        threadPrintFunction(threadPrintUserData, stackBuffer, (size_t)length);
+    } else if (length >= 0) {
+        char* heapBuffer = (char*)malloc((size_t)length + 1);
+        if (heapBuffer) {
+            vsnprintf(heapBuffer, (size_t)length + 1, format, args);
+            threadPrintFunction(threadPrintUserData, heapBuffer, (size_t)length);
+            free(heapBuffer);
+        } else {
+            length = -1;
+        }
+    }
+    va_end(args);
+    return length;
+}
+
 enum {
     // These constraints are not mandated by the spec and only used as a
     // reasonable upper limit to stop parsing garbage data during print
@@ -681,10 +731,10 @@ static void printFlagBits(uint32_t flags, const char*(*toStringFn)(uint32_t, boo
         const char* comma = first ? "" : ", ";
         const char* str = toStringFn(bit_index, bit_value);
         if (str) {
-            printf("%s%s", comma, str);
+            dfdPrintf("%s%s", comma, str);
             first = false;
         } else if (bit_value) {
-            printf("%s%u", comma, bit_mask);
+            dfdPrintf("%s%u", comma, bit_mask);
             first = false;
         }
     }
@@ -701,15 +751,15 @@ static void printFlagBitsJSON(uint32_t indent, const char* nl, uint32_t flags, c
 
         const char* str = toStringFn(bit_index, bit_value);
         if (str) {
-            printf("%s%s%*s\"%s\"", first ? "" : ",", first ? "" : nl, indent, "", str);
+            dfdPrintf("%s%s%*s\"%s\"", first ? "" : ",", first ? "" : nl, indent, "", str);
             first = false;
         } else if (bit_value) {
-            printf("%s%s%*s%u", first ? "" : ",", first ? "" : nl, indent, "", bit_mask);
+            dfdPrintf("%s%s%*s%u", first ? "" : ",", first ? "" : nl, indent, "", bit_mask);
             first = false;
         }
     }
     if (!first)
-        printf("%s", nl);
+        dfdPrintf("%s", nl);
 }
 
 /**
@@ -725,9 +775,9 @@ void printDFD(uint32_t *DFD, uint32_t dataSize)
         int value = VALUE;                                       \
         const char* str = TO_STRING_FN(value);                   \
         if (str)                                                 \
-            printf("%s", str);                                   \
+            dfdPrintf("%s", str);                                   \
         else                                                     \
-            printf("%u", value);                                 \
+            dfdPrintf("%u", value);                                 \
     }
 
     const uint32_t sizeof_dfdTotalSize = sizeof(uint32_t);
@@ -743,7 +793,7 @@ void printDFD(uint32_t *DFD, uint32_t dataSize)
     uint32_t* block = DFD + 1;
     remainingSize -= sizeof_dfdTotalSize;
 
-    printf("DFD total bytes: %u\n", dfdTotalSize);
+    dfdPrintf("DFD total bytes: %u\n", dfdTotalSize);
 
     for (int i = 0; i < MAX_NUM_DFD_BLOCKS; ++i) { // At most only iterate MAX_NUM_DFD_BLOCKS block
         if (remainingSize < sizeof_DFDBHeader)
@@ -754,14 +804,14 @@ void printDFD(uint32_t *DFD, uint32_t dataSize)
         const khr_df_versionnumber_e versionNumber = KHR_DFDVAL(block, VERSIONNUMBER);
         const uint32_t blockSize = KHR_DFDVAL(block, DESCRIPTORBLOCKSIZE);
 
-        printf("Vendor ID: ");
+        dfdPrintf("Vendor ID: ");
         PRINT_ENUM(vendorID, dfdToStringVendorID);
-        printf("\nDescriptor type: ");
+        dfdPrintf("\nDescriptor type: ");
         PRINT_ENUM(descriptorType, dfdToStringDescriptorType);
-        printf("\nVersion: ");
+        dfdPrintf("\nVersion: ");
         PRINT_ENUM(versionNumber, dfdToStringVersionNumber);
-        printf("\nDescriptor block size: %u", blockSize);
-        printf("\n");
+        dfdPrintf("\nDescriptor block size: %u", blockSize);
+        dfdPrintf("\n");
 
         if (vendorID == KHR_DF_VENDORID_KHRONOS && descriptorType == KHR_DF_KHR_DESCRIPTORTYPE_BASICFORMAT) {
             if (remainingSize < sizeof_BDFD)
@@ -770,22 +820,22 @@ void printDFD(uint32_t *DFD, uint32_t dataSize)
             const int model = KHR_DFDVAL(block, MODEL);
 
             khr_df_flags_e flags = KHR_DFDVAL(block, FLAGS);
-            printf("Flags: 0x%X (", flags);
+            dfdPrintf("Flags: 0x%X (", flags);
             printFlagBits(flags, dfdToStringFlagsBit);
-            printf(")\nTransfer: ");
+            dfdPrintf(")\nTransfer: ");
             PRINT_ENUM(KHR_DFDVAL(block, TRANSFER), dfdToStringTransferFunction);
-            printf("\nPrimaries: ");
+            dfdPrintf("\nPrimaries: ");
             PRINT_ENUM(KHR_DFDVAL(block, PRIMARIES), dfdToStringColorPrimaries);
-            printf("\nModel: ");
+            dfdPrintf("\nModel: ");
             PRINT_ENUM(model, dfdToStringColorModel);
-            printf("\n");
+            dfdPrintf("\n");
 
-            printf("Dimensions: %u, %u, %u, %u\n",
+            dfdPrintf("Dimensions: %u, %u, %u, %u\n",
                    KHR_DFDVAL(block, TEXELBLOCKDIMENSION0) + 1,
                    KHR_DFDVAL(block, TEXELBLOCKDIMENSION1) + 1,
                    KHR_DFDVAL(block, TEXELBLOCKDIMENSION2) + 1,
                    KHR_DFDVAL(block, TEXELBLOCKDIMENSION3) + 1);
-            printf("Plane bytes: %u, %u, %u, %u, %u, %u, %u, %u\n",
+            dfdPrintf("Plane bytes: %u, %u, %u, %u, %u, %u, %u, %u\n",
                    KHR_DFDVAL(block, BYTESPLANE0),
                    KHR_DFDVAL(block, BYTESPLANE1),
                    KHR_DFDVAL(block, BYTESPLANE2),
@@ -803,29 +853,29 @@ void printDFD(uint32_t *DFD, uint32_t dataSize)
                     break; // Invalid DFD: Missing or partial basic DFD sample
 
                 khr_df_model_channels_e channelType = KHR_DFDSVAL(block, sample, CHANNELID);
-                printf("Sample %u:\n", sample);
+                dfdPrintf("Sample %u:\n", sample);
 
                 khr_df_sample_datatype_qualifiers_e qualifiers = KHR_DFDSVAL(block, sample, QUALIFIERS);
-                printf("    Qualifiers: 0x%X (", qualifiers);
+                dfdPrintf("    Qualifiers: 0x%X (", qualifiers);
                 printFlagBits(qualifiers, dfdToStringSampleDatatypeQualifiersBit);
-                printf(")\n");
-                printf("    Channel Type: 0x%X", channelType);
+                dfdPrintf(")\n");
+                dfdPrintf("    Channel Type: 0x%X", channelType);
                 {
                     const char* str = dfdToStringChannelId(model, channelType);
                     if (str)
-                        printf(" (%s)\n", str);
+                        dfdPrintf(" (%s)\n", str);
                     else
-                        printf(" (%u)\n", channelType);
+                        dfdPrintf(" (%u)\n", channelType);
                 }
-                printf("    Length: %u bits Offset: %u\n",
+                dfdPrintf("    Length: %u bits Offset: %u\n",
                        KHR_DFDSVAL(block, sample, BITLENGTH) + 1,
                        KHR_DFDSVAL(block, sample, BITOFFSET));
-                printf("    Position: %u, %u, %u, %u\n",
+                dfdPrintf("    Position: %u, %u, %u, %u\n",
                        KHR_DFDSVAL(block, sample, SAMPLEPOSITION0),
                        KHR_DFDSVAL(block, sample, SAMPLEPOSITION1),
                        KHR_DFDSVAL(block, sample, SAMPLEPOSITION2),
                        KHR_DFDSVAL(block, sample, SAMPLEPOSITION3));
-                printf("    Lower: 0x%08x\n    Upper: 0x%08x\n",
+                dfdPrintf("    Lower: 0x%08x\n    Upper: 0x%08x\n",
                        KHR_DFDSVAL(block, sample, SAMPLELOWER),
                        KHR_DFDSVAL(block, sample, SAMPLEUPPER));
             }
@@ -834,7 +884,7 @@ void printDFD(uint32_t *DFD, uint32_t dataSize)
         } else if (vendorID == KHR_DF_VENDORID_KHRONOS && descriptorType == KHR_DF_KHR_DESCRIPTORTYPE_ADDITIONAL_PLANES) {
             // TODO: Implement DFD print for ADDITIONAL_PLANES
         } else {
-            printf("Unknown block\n");
+            dfdPrintf("Unknown block\n");
         }
 
         const uint32_t advance = sizeof_DFDBHeader > blockSize ? sizeof_DFDBHeader : blockSize;
@@ -870,13 +920,13 @@ void printDFDJSON(uint32_t* DFD, uint32_t dataSize, uint32_t base_indent, uint32
 /** Prints an enum as string or number */
 #define PRINT_ENUM(INDENT, NAME, VALUE, TO_STRING_FN, COMMA) {          \
         int value = VALUE;                                                 \
-        printf("%*s\"" NAME "\":%s", LENGTH_OF_INDENT(INDENT), "", space); \
+        dfdPrintf("%*s\"" NAME "\":%s", LENGTH_OF_INDENT(INDENT), "", space); \
         const char* str = TO_STRING_FN(value);                             \
         if (str)                                                           \
-            printf("\"%s\"", str);                                         \
+            dfdPrintf("\"%s\"", str);                                         \
         else                                                               \
-            printf("%u", value);                                           \
-        printf(COMMA "%s", nl);                                            \
+            dfdPrintf("%u", value);                                           \
+        dfdPrintf(COMMA "%s", nl);                                            \
     }
 
 /** Prints an enum as string or number if the to string function fails with a trailing comma*/
@@ -888,11 +938,11 @@ void printDFDJSON(uint32_t* DFD, uint32_t dataSize, uint32_t base_indent, uint32
         PRINT_ENUM(INDENT, NAME, VALUE, TO_STRING_FN, "")
 
 #define PRINT_INDENT(INDENT, FMT, ...) {                              \
-        printf("%*s" FMT, LENGTH_OF_INDENT(INDENT), "", __VA_ARGS__); \
+        dfdPrintf("%*s" FMT, LENGTH_OF_INDENT(INDENT), "", __VA_ARGS__); \
     }
 
 #define PRINT_INDENT_NOARG(INDENT, FMT) {                \
-        printf("%*s" FMT, LENGTH_OF_INDENT(INDENT), ""); \
+        dfdPrintf("%*s" FMT, LENGTH_OF_INDENT(INDENT), ""); \
     }
 
     const uint32_t sizeof_dfdTotalSize = sizeof(uint32_t);
@@ -925,9 +975,9 @@ void printDFDJSON(uint32_t* DFD, uint32_t dataSize, uint32_t base_indent, uint32
         const int model = KHR_DFDVAL(block, MODEL);
 
         if (i == 0) {
-            printf("%s", nl);
+            dfdPrintf("%s", nl);
         } else {
-            printf(",%s", nl);
+            dfdPrintf(",%s", nl);
         }
         PRINT_INDENT(1, "{%s", nl)
         PRINT_ENUM_C(2, "vendorId", vendorID, dfdToStringVendorID);
@@ -938,12 +988,12 @@ void printDFDJSON(uint32_t* DFD, uint32_t dataSize, uint32_t base_indent, uint32
         if (vendorID == KHR_DF_VENDORID_KHRONOS && descriptorType == KHR_DF_KHR_DESCRIPTORTYPE_BASICFORMAT) {
             if (remainingSize < sizeof_BDFD) {
                 // Invalid DFD: Missing or partial basic DFD block
-                printf("%s", nl);
+                dfdPrintf("%s", nl);
                 PRINT_INDENT(1, "}%s", nl) // End of block
                 break;
             }
 
-            printf(",%s", nl);
+            dfdPrintf(",%s", nl);
             PRINT_INDENT(2, "\"flags\":%s[%s", space, nl)
             khr_df_flags_e flags = KHR_DFDVAL(block, FLAGS);
             printFlagBitsJSON(LENGTH_OF_INDENT(3), nl, flags, dfdToStringFlagsBit);
@@ -976,7 +1026,7 @@ void printDFDJSON(uint32_t* DFD, uint32_t dataSize, uint32_t base_indent, uint32
                     break; // Invalid DFD: Missing or partial basic DFD sample
 
                 if (sample != 0)
-                    printf(",%s", nl);
+                    dfdPrintf(",%s", nl);
                 PRINT_INDENT(3, "{%s", nl)
 
                 khr_df_sample_datatype_qualifiers_e qualifiers = KHR_DFDSVAL(block, sample, QUALIFIERS);
@@ -1014,19 +1064,19 @@ void printDFDJSON(uint32_t* DFD, uint32_t dataSize, uint32_t base_indent, uint32
 
                 PRINT_INDENT_NOARG(3, "}")
             }
-            printf("%s", nl);
+            dfdPrintf("%s", nl);
             PRINT_INDENT(2, "]%s", nl) // End of samples
         } else if (vendorID == KHR_DF_VENDORID_KHRONOS && descriptorType == KHR_DF_KHR_DESCRIPTORTYPE_ADDITIONAL_DIMENSIONS) {
-            printf("%s", nl);
-            // printf(",%s", nl); // If there is extra member printed
+            dfdPrintf("%s", nl);
+            // dfdPrintf(",%s", nl); // If there is extra member printed
             // TODO: Implement DFD print for ADDITIONAL_DIMENSIONS
         } else if (vendorID == KHR_DF_VENDORID_KHRONOS && descriptorType == KHR_DF_KHR_DESCRIPTORTYPE_ADDITIONAL_PLANES) {
-            printf("%s", nl);
-            // printf(",%s", nl); // If there is extra member printed
+            dfdPrintf("%s", nl);
+            // dfdPrintf(",%s", nl); // If there is extra member printed
             // TODO: Implement DFD print for ADDITIONAL_PLANES
         } else {
-            printf("%s", nl);
-            // printf(",%s", nl); // If there is extra member printed
+            dfdPrintf("%s", nl);
+            // dfdPrintf(",%s", nl); // If there is extra member printed
             // TODO: What to do with unknown blocks for json?
             //      Unknown block data in binary?
         }
@@ -1039,7 +1089,7 @@ void printDFDJSON(uint32_t* DFD, uint32_t dataSize, uint32_t base_indent, uint32
         remainingSize -= advance;
         block += advance / 4;
     }
-    printf("%s", nl);
+    dfdPrintf("%s", nl);
     PRINT_INDENT(0, "]%s", nl) // End of blocks
 
 #undef PRINT_ENUM
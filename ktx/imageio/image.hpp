@@ -18,9 +18,12 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstring>
 #include <sstream>
 #include <stdexcept>
 #include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include <KHR/khr_df.h>
 #include <fmt/format.h>
@@ -32,6 +35,7 @@
 #ifdef _MSC_VER
   #pragma warning(pop)
 #endif
+#include "imageio_kernels.h"
 #include "imageio_utility.h"
 #include "unused.h"
 #include "encoder/basisu_resampler.h"
@@ -699,25 +703,82 @@ class Image {
     virtual uint32_t getComponentCount() const = 0;
     virtual uint32_t getComponentSize() const = 0;
     virtual Image* createImage(uint32_t width, uint32_t height) = 0;
+
+    // The conversion functions taking a destination write
+    // getPixelCount() * <bytes per converted pixel> bytes to @p dst, e.g.
+    // directly into the image storage of a KTX texture. They throw
+    // std::runtime_error if @p dstSize is too small. The functions returning a
+    // std::vector are convenience wrappers around them.
+
     /// Should only be used if the stored image data is UNORM convertable (with optional significant bit count)
-    virtual std::vector<uint8_t> getUNORM(uint32_t numChannels, uint32_t targetBits, uint32_t sBits = 0) const = 0;
+    virtual void getUNORM(uint8_t* dst, size_t dstSize,
+            uint32_t numChannels, uint32_t targetBits, uint32_t sBits = 0) const = 0;
     /// Should only be used if the stored image data is UNORM convertable (packed into a single word)
-    virtual std::vector<uint8_t> getUNORMPacked(
+    virtual void getUNORMPacked(uint8_t* dst, size_t dstSize,
             uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3) const = 0;
     /// Should only be used if the stored image data is SFloat convertable
-    virtual std::vector<uint8_t> getSFloat(uint32_t numChannels, uint32_t targetBits) const = 0;
+    virtual void getSFloat(uint8_t* dst, size_t dstSize, uint32_t numChannels, uint32_t targetBits) const = 0;
     /// Should only be used if the stored image data is UFloat convertable
-    virtual std::vector<uint8_t> getB10G11R11() const = 0;
+    virtual void getB10G11R11(uint8_t* dst, size_t dstSize) const = 0;
     /// Should only be used if the stored image data is UFloat convertable
-    virtual std::vector<uint8_t> getE5B9G9R9() const = 0;
+    virtual void getE5B9G9R9(uint8_t* dst, size_t dstSize) const = 0;
     /// Should only be used if the stored image data is UINT convertable
-    virtual std::vector<uint8_t> getUINT(uint32_t numChannels, uint32_t targetBits) const = 0;
+    virtual void getUINT(uint8_t* dst, size_t dstSize, uint32_t numChannels, uint32_t targetBits) const = 0;
     /// Should only be used if the stored image data is SINT convertable
-    virtual std::vector<uint8_t> getSINT(uint32_t numChannels, uint32_t targetBits) const = 0;
+    virtual void getSINT(uint8_t* dst, size_t dstSize, uint32_t numChannels, uint32_t targetBits) const = 0;
     /// Should only be used if the stored image data is UINT convertable
-    virtual std::vector<uint8_t> getUINTPacked(uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3) const = 0;
+    virtual void getUINTPacked(uint8_t* dst, size_t dstSize,
+            uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3) const = 0;
     /// Should only be used if the stored image data is SINT convertable
-    virtual std::vector<uint8_t> getSINTPacked(uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3) const = 0;
+    virtual void getSINTPacked(uint8_t* dst, size_t dstSize,
+            uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3) const = 0;
+
+    std::vector<uint8_t> getUNORM(uint32_t numChannels, uint32_t targetBits, uint32_t sBits = 0) const {
+        std::vector<uint8_t> data(getImageByteCount(numChannels * (targetBits / 8)));
+        getUNORM(data.data(), data.size(), numChannels, targetBits, sBits);
+        return data;
+    }
+    std::vector<uint8_t> getUNORMPacked(uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3) const {
+        std::vector<uint8_t> data(getImageByteCount((c0 + c1 + c2 + c3) / 8));
+        getUNORMPacked(data.data(), data.size(), c0, c1, c2, c3);
+        return data;
+    }
+    std::vector<uint8_t> getSFloat(uint32_t numChannels, uint32_t targetBits) const {
+        std::vector<uint8_t> data(getImageByteCount(numChannels * (targetBits / 8)));
+        getSFloat(data.data(), data.size(), numChannels, targetBits);
+        return data;
+    }
+    std::vector<uint8_t> getB10G11R11() const {
+        std::vector<uint8_t> data(getImageByteCount(4));
+        getB10G11R11(data.data(), data.size());
+        return data;
+    }
+    std::vector<uint8_t> getE5B9G9R9() const {
+        std::vector<uint8_t> data(getImageByteCount(4));
+        getE5B9G9R9(data.data(), data.size());
+        return data;
+    }
+    std::vector<uint8_t> getUINT(uint32_t numChannels, uint32_t targetBits) const {
+        std::vector<uint8_t> data(getImageByteCount(numChannels * (targetBits / 8)));
+        getUINT(data.data(), data.size(), numChannels, targetBits);
+        return data;
+    }
+    std::vector<uint8_t> getSINT(uint32_t numChannels, uint32_t targetBits) const {
+        std::vector<uint8_t> data(getImageByteCount(numChannels * (targetBits / 8)));
+        getSINT(data.data(), data.size(), numChannels, targetBits);
+        return data;
+    }
+    std::vector<uint8_t> getUINTPacked(uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3) const {
+        std::vector<uint8_t> data(getImageByteCount(sizeof(uint32_t)));
+        getUINTPacked(data.data(), data.size(), c0, c1, c2, c3);
+        return data;
+    }
+    std::vector<uint8_t> getSINTPacked(uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3) const {
+        std::vector<uint8_t> data(getImageByteCount(sizeof(uint32_t)));
+        getSINTPacked(data.data(), data.size(), c0, c1, c2, c3);
+        return data;
+    }
+
     virtual std::unique_ptr<Image> resample(uint32_t targetWidth, uint32_t targetHeight,
             const char* filter, float filterScale, basisu::Resampler::Boundary_Op wrapMode) = 0;
     virtual Image& yflip() = 0;
@@ -736,6 +797,16 @@ class Image {
             : width(w), height(h), transferFunction(KHR_DF_TRANSFER_UNSPECIFIED),
               primaries(KHR_DF_PRIMARIES_BT709) { }
 
+    size_t getImageByteCount(size_t pixelByteCount) const {
+        return size_t{width} * height * pixelByteCount;
+    }
+    void checkDstSize(size_t dstSize, size_t pixelByteCount) const {
+        if (dstSize < getImageByteCount(pixelByteCount))
+            throw std::runtime_error(fmt::format(
+                "Destination of {} bytes is too small for a {}x{} image with {} bytes per pixel.",
+                dstSize, width, height, pixelByteCount));
+    }
+
     uint32_t width, height;  // In pixels
     khr_df_transfer_e transferFunction;
     khr_df_primaries_e primaries;
@@ -801,296 +872,166 @@ class ImageT : public Image {
         return image;
     }
 
-    virtual std::vector<uint8_t> getUNORM(uint32_t numChannels, uint32_t targetBits, uint32_t sBits) const override {
+    using Image::getUNORM;
+    using Image::getUNORMPacked;
+    using Image::getSFloat;
+    using Image::getB10G11R11;
+    using Image::getE5B9G9R9;
+    using Image::getUINT;
+    using Image::getSINT;
+    using Image::getUINTPacked;
+    using Image::getSINTPacked;
+
+    virtual void getUNORM(uint8_t* dst, size_t dstSize,
+            uint32_t numChannels, uint32_t targetBits, uint32_t sBits) const override {
         assert(numChannels <= componentCount);
         assert(targetBits == 8 || targetBits == 16 || targetBits == 32);
+        checkDstSize(dstSize, numChannels * (targetBits / 8));
 
-        const uint32_t sourceBits = sizeof(componentType) * 8;
-        const uint32_t targetBytes = targetBits / 8;
-        const uint32_t mask = (sBits == 0) ? 0xFFFFFFFF : ((1u << sBits) - 1u) << (targetBits - sBits);
-        std::vector<uint8_t> data(height * width * numChannels * targetBytes);
-
-        for (uint32_t y = 0; y < height; ++y) {
-            for (uint32_t x = 0; x < width; ++x) {
-                for (uint32_t c = 0; c < numChannels; ++c) {
-                    const auto sourceValue = c < componentCount ? pixels[y * width + x][c] : (c != 3 ? componentType{0} : Color::one());
-                    const auto value = imageio::convertUNORM(static_cast<uint32_t>(sourceValue), sourceBits, targetBits);
-                    auto* target = data.data() + (y * width * numChannels + x * numChannels + c) * targetBytes;
-
-                    if (targetBytes == 1) {
-                        const auto outValue = static_cast<uint8_t>(value & mask);
-                        std::memcpy(target, &outValue, sizeof(outValue));
-                    } else if (targetBytes == 2) {
-                        const auto outValue = static_cast<uint16_t>(value & mask);
-                        std::memcpy(target, &outValue, sizeof(outValue));
-                    } else if (targetBytes == 4) {
-                        const auto outValue = static_cast<uint32_t>(value & mask);
-                        std::memcpy(target, &outValue, sizeof(outValue));
-                    }
-                }
-            }
-        }
-
-        return data;
+        dispatchChannelCount(numChannels, [&](auto channels) {
+            constexpr uint32_t NumChannels = decltype(channels)::value;
+            if (targetBits == 8)
+                storeUNORM<uint8_t, NumChannels>(dst, sBits);
+            else if (targetBits == 16)
+                storeUNORM<uint16_t, NumChannels>(dst, sBits);
+            else if (targetBits == 32)
+                storeUNORM<uint32_t, NumChannels>(dst, sBits);
+        });
     }
 
-    virtual std::vector<uint8_t> getUNORMPacked(
+    virtual void getUNORMPacked(uint8_t* dst, size_t dstSize,
             uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3) const override {
         assert((c0 + c1 + c2 + c3) % 8 == 0);
         const auto targetPackBytes = (c0 + c1 + c2 + c3) / 8;
         assert(targetPackBytes == 1 || targetPackBytes == 2 || targetPackBytes == 4 || targetPackBytes == 8);
-        const auto packC0 = c0 > 0;
-        const auto packC1 = c1 > 0;
-        const auto packC2 = c2 > 0;
-        const auto packC3 = c3 > 0;
-        const auto numChannels = (packC0 ? 1u : 0) + (packC1 ? 1u : 0) + (packC2 ? 1u : 0) + (packC3 ? 1u : 0);
-        assert(numChannels <= componentCount); (void) numChannels;
-        const uint32_t sourceBits = sizeof(componentType) * 8;
-        static constexpr auto hasC0 = componentCount > 0;
-        static constexpr auto hasC1 = componentCount > 1;
-        static constexpr auto hasC2 = componentCount > 2;
-        static constexpr auto hasC3 = componentCount > 3;
-
-        std::vector<uint8_t> data(height * width * targetPackBytes);
-
-        for (uint32_t y = 0; y < height; ++y) {
-            for (uint32_t x = 0; x < width; ++x) {
-                const auto& pixel = pixels[y * width + x];
-                auto* target = data.data() + (y * width + x) * targetPackBytes;
-
-                const auto copy = [&](auto& pack) {
-                    using PackType = std::remove_reference_t<decltype(pack)>;
-
-                    if (packC0) {
-                        const auto sourceValue = hasC0 ? pixel[0] : componentType{0};
-                        const auto value = imageio::convertUNORM(static_cast<uint32_t>(sourceValue), sourceBits, c0);
-                        pack |= static_cast<PackType>(value) << (c1 + c2 + c3);
-                    }
-                    if (packC1) {
-                        const auto sourceValue = hasC1 ? pixel[1] : componentType{0};
-                        const auto value = imageio::convertUNORM(static_cast<uint32_t>(sourceValue), sourceBits, c1);
-                        pack |= static_cast<PackType>(value) << (c2 + c3);
-                    }
-                    if (packC2) {
-                        const auto sourceValue = hasC2 ? pixel[2] : componentType{0};
-                        const auto value = imageio::convertUNORM(static_cast<uint32_t>(sourceValue), sourceBits, c2);
-                        pack |= static_cast<PackType>(value) << c3;
-                    }
-                    if (packC3) {
-                        const auto sourceValue = hasC3 ? pixel[3] : Color::one();
-                        const auto value = imageio::convertUNORM(static_cast<uint32_t>(sourceValue), sourceBits, c3);
-                        pack |= static_cast<PackType>(value);
-                    }
-                };
-
-                if (targetPackBytes == 1) {
-                    uint8_t pack = 0;
-                    copy(pack);
-                    std::memcpy(target, &pack, sizeof(pack));
-                } else if (targetPackBytes == 2) {
-                    uint16_t pack = 0;
-                    copy(pack);
-                    std::memcpy(target, &pack, sizeof(pack));
-                } else if (targetPackBytes == 4) {
-                    uint32_t pack = 0;
-                    copy(pack);
-                    std::memcpy(target, &pack, sizeof(pack));
-                } else if (targetPackBytes == 8) {
-                    uint64_t pack = 0;
-                    copy(pack);
-                    std::memcpy(target, &pack, sizeof(pack));
-                }
-            }
-        }
+        [[maybe_unused]] const auto numChannels = (c0 > 0 ? 1u : 0) + (c1 > 0 ? 1u : 0) + (c2 > 0 ? 1u : 0) + (c3 > 0 ? 1u : 0);
+        assert(numChannels <= componentCount);
+        checkDstSize(dstSize, targetPackBytes);
 
-        return data;
+        if (targetPackBytes == 1)
+            storeUNORMPacked<uint8_t>(dst, c0, c1, c2, c3);
+        else if (targetPackBytes == 2)
+            storeUNORMPacked<uint16_t>(dst, c0, c1, c2, c3);
+        else if (targetPackBytes == 4)
+            storeUNORMPacked<uint32_t>(dst, c0, c1, c2, c3);
+        else if (targetPackBytes == 8)
+            storeUNORMPacked<uint64_t>(dst, c0, c1, c2, c3);
     }
 
-    virtual std::vector<uint8_t> getSFloat(uint32_t numChannels, uint32_t targetBits) const override {
+    virtual void getSFloat(uint8_t* dst, size_t dstSize, uint32_t numChannels, uint32_t targetBits) const override {
         assert(numChannels <= componentCount);
         assert(targetBits == 16 || targetBits == 32);
+        checkDstSize(dstSize, numChannels * (targetBits / 8));
 
-        const uint32_t targetBytes = targetBits / 8;
-        std::vector<uint8_t> data(height * width * numChannels * targetBytes);
-
-        for (uint32_t y = 0; y < height; ++y) {
-            for (uint32_t x = 0; x < width; ++x) {
-                for (uint32_t c = 0; c < numChannels; ++c) {
-                    const auto value = c < componentCount ? pixels[y * width + x][c] : (c != 3 ? componentType{0} : componentType{1});
-                    auto* target = data.data() + (y * width * numChannels + x * numChannels + c) * targetBytes;
-
-                    if (sizeof(componentType) == targetBytes) {
-                        *reinterpret_cast<componentType*>(target) = value;
-                    } else if (targetBytes == 2) {
-                        const auto outValue = imageio::float_to_half(static_cast<float>(value));
-                        std::memcpy(target, &outValue, targetBytes);
-                    } else if (targetBytes == 4) {
-                        const auto outValue = static_cast<float>(value);
-                        std::memcpy(target, &outValue, targetBytes);
-                    }
-                }
-            }
-        }
-
-        return data;
+        dispatchChannelCount(numChannels, [&](auto channels) {
+            constexpr uint32_t NumChannels = decltype(channels)::value;
+            if (targetBits == 16)
+                storeSFloat<uint16_t, NumChannels>(dst);
+            else if (targetBits == 32)
+                storeSFloat<float, NumChannels>(dst);
+        });
     }
 
-    virtual std::vector<uint8_t> getB10G11R11() const override {
+    virtual void getB10G11R11(uint8_t* dst, size_t dstSize) const override {
         assert(3 <= componentCount);
         assert(std::is_floating_point_v<componentType>);
+        checkDstSize(dstSize, sizeof(uint32_t));
 
-        std::vector<uint8_t> data(height * width * 4);
-
-        for (uint32_t y = 0; y < height; ++y) {
+        forEachTargetRow<uint32_t, 1>(dst, [&](uint32_t* target, const Color* source) {
             for (uint32_t x = 0; x < width; ++x) {
-                auto* target = data.data() + (y * width + x) * 4;
-
-                const auto pixel = (*this)(x, y);
-                const auto r = pixel[0];
-                const auto g = pixel[1];
-                const auto b = pixel[2];
-                const auto outValue = glm::packF2x11_1x10(glm::vec3(r, g, b));
-                std::memcpy(target, &outValue, sizeof(outValue));
+                const auto& pixel = source[x];
+                target[x] = glm::packF2x11_1x10(glm::vec3(pixel[0], pixel[1], pixel[2]));
             }
-        }
-
-        return data;
+        });
     }
 
-    virtual std::vector<uint8_t> getE5B9G9R9() const override {
+    virtual void getE5B9G9R9(uint8_t* dst, size_t dstSize) const override {
         assert(3 <= componentCount);
         assert(std::is_floating_point_v<componentType>);
+        checkDstSize(dstSize, sizeof(uint32_t));
 
-        std::vector<uint8_t> data(height * width * 4);
-
-        for (uint32_t y = 0; y < height; ++y) {
+        forEachTargetRow<uint32_t, 1>(dst, [&](uint32_t* target, const Color* source) {
             for (uint32_t x = 0; x < width; ++x) {
-                auto* target = data.data() + (y * width + x) * 4;
-
-                const auto pixel = (*this)(x, y);
-                const auto r = pixel[0];
-                const auto g = pixel[1];
-                const auto b = pixel[2];
-                const auto outValue = glm::packF3x9_E1x5(glm::vec3(r, g, b));
-                std::memcpy(target, &outValue, sizeof(outValue));
+                const auto& pixel = source[x];
+                target[x] = glm::packF3x9_E1x5(glm::vec3(pixel[0], pixel[1], pixel[2]));
             }
-        }
-
-        return data;
+        });
     }
 
-    virtual std::vector<uint8_t> getUINT(uint32_t numChannels, uint32_t targetBits) const override {
+    virtual void getUINT(uint8_t* dst, size_t dstSize, uint32_t numChannels, uint32_t targetBits) const override {
         assert(numChannels <= componentCount);
         assert(targetBits == 8 || targetBits == 16 || targetBits == 32 || targetBits == 64);
-
-        const uint32_t targetBytes = targetBits / 8;
-        std::vector<uint8_t> data(height * width * numChannels * targetBytes);
-
-        for (uint32_t y = 0; y < height; ++y) {
-            for (uint32_t x = 0; x < width; ++x) {
-                for (uint32_t c = 0; c < numChannels; ++c) {
-                    const auto value = c < componentCount ? pixels[y * width + x][c] : c != 3 ? 0 : componentType{1};
-                    auto* target = data.data() + (y * width * numChannels + x * numChannels + c) * targetBytes;
-
-                    if (targetBytes == 1) {
-                        const auto outValue = static_cast<uint8_t>(value);
-                        std::memcpy(target, &outValue, targetBytes);
-                    } else if (targetBytes == 2) {
-                        const auto outValue = static_cast<uint16_t>(value);
-                        std::memcpy(target, &outValue, targetBytes);
-                    } else if (targetBytes == 4) {
-                        const auto outValue = static_cast<uint32_t>(value);
-                        std::memcpy(target, &outValue, targetBytes);
-                    } else if (targetBytes == 8) {
-                        const auto outValue = static_cast<uint64_t>(value);
-                        std::memcpy(target, &outValue, targetBytes);
-                    }
-                }
-            }
-        }
-
-        return data;
-    }
-
-    virtual std::vector<uint8_t> getSINT(uint32_t numChannels, uint32_t targetBits) const override {
+        checkDstSize(dstSize, numChannels * (targetBits / 8));
+
+        dispatchChannelCount(numChannels, [&](auto channels) {
+            constexpr uint32_t NumChannels = decltype(channels)::value;
+            if (targetBits == 8)
+                storeINT<uint8_t, NumChannels>(dst);
+            else if (targetBits == 16)
+                storeINT<uint16_t, NumChannels>(dst);
+            else if (targetBits == 32)
+                storeINT<uint32_t, NumChannels>(dst);
+            else if (targetBits == 64)
+                storeINT<uint64_t, NumChannels>(dst);
+        });
+    }
+
+    virtual void getSINT(uint8_t* dst, size_t dstSize, uint32_t numChannels, uint32_t targetBits) const override {
         assert(numChannels <= componentCount);
         assert(targetBits == 8 || targetBits == 16 || targetBits == 32 || targetBits == 64);
-
-        const uint32_t targetBytes = targetBits / 8;
-        std::vector<uint8_t> data(height * width * numChannels * targetBytes);
-
-        for (uint32_t y = 0; y < height; ++y) {
-            for (uint32_t x = 0; x < width; ++x) {
-                for (uint32_t c = 0; c < numChannels; ++c) {
-                    const auto value = c < componentCount ? pixels[y * width + x][c] : c != 3 ? 0 : componentType{1};
-                    auto* target = data.data() + (y * width * numChannels + x * numChannels + c) * targetBytes;
-
-                    if (targetBytes == 1) {
-                        const auto outValue = static_cast<int8_t>(value);
-                        std::memcpy(target, &outValue, targetBytes);
-                    } else if (targetBytes == 2) {
-                        const auto outValue = static_cast<int16_t>(value);
-                        std::memcpy(target, &outValue, targetBytes);
-                    } else if (targetBytes == 4) {
-                        const auto outValue = static_cast<int32_t>(value);
-                        std::memcpy(target, &outValue, targetBytes);
-                    } else if (targetBytes == 8) {
-                        const auto outValue = static_cast<int64_t>(value);
-                        std::memcpy(target, &outValue, targetBytes);
-                    }
-                }
-            }
-        }
-
-        return data;
-    }
-
-    virtual std::vector<uint8_t> getUINTPacked(uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3) const override {
+        checkDstSize(dstSize, numChannels * (targetBits / 8));
+
+        dispatchChannelCount(numChannels, [&](auto channels) {
+            constexpr uint32_t NumChannels = decltype(channels)::value;
+            if (targetBits == 8)
+                storeINT<int8_t, NumChannels>(dst);
+            else if (targetBits == 16)
+                storeINT<int16_t, NumChannels>(dst);
+            else if (targetBits == 32)
+                storeINT<int32_t, NumChannels>(dst);
+            else if (targetBits == 64)
+                storeINT<int64_t, NumChannels>(dst);
+        });
+    }
+
+    virtual void getUINTPacked(uint8_t* dst, size_t dstSize,
+            uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3) const override {
         assert(c0 + c1 + c2 + c3 == 32);
         assert(c0 != 0 && c1 != 0 && c2 != 0 && c3 != 0);
         assert(componentCount == 4);
+        checkDstSize(dstSize, sizeof(uint32_t));
 
-        std::vector<uint8_t> data(height * width * sizeof(uint32_t));
-        for (uint32_t y = 0; y < height; ++y) {
+        forEachTargetRow<uint32_t, 1>(dst, [&](uint32_t* target, const Color* source) {
             for (uint32_t x = 0; x < width; ++x) {
-                const auto& pixel = pixels[y * width + x];
-                auto* target = data.data() + (y * width + x) * sizeof(uint32_t);
-
+                const auto& pixel = source[x];
                 uint32_t pack = 0;
                 pack |= imageio::convertUINT(static_cast<uint32_t>(pixel[0]), sizeof(uint32_t) * 8, c0) << (c1 + c2 + c3);
                 pack |= imageio::convertUINT(static_cast<uint32_t>(pixel[1]), sizeof(uint32_t) * 8, c1) << (c2 + c3);
                 pack |= imageio::convertUINT(static_cast<uint32_t>(pixel[2]), sizeof(uint32_t) * 8, c2) << c3;
                 pack |= imageio::convertUINT(static_cast<uint32_t>(pixel[3]), sizeof(uint32_t) * 8, c3);
-
-                std::memcpy(target, &pack, sizeof(pack));
+                target[x] = pack;
             }
-        }
-
-        return data;
+        });
     }
 
-    virtual std::vector<uint8_t> getSINTPacked(uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3) const override {
+    virtual void getSINTPacked(uint8_t* dst, size_t dstSize,
+            uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3) const override {
         assert(c0 + c1 + c2 + c3 == 32);
         assert(c0 != 0 && c1 != 0 && c2 != 0 && c3 != 0);
         assert(componentCount == 4);
+        checkDstSize(dstSize, sizeof(uint32_t));
 
-        std::vector<uint8_t> data(height * width * sizeof(uint32_t));
-        for (uint32_t y = 0; y < height; ++y) {
+        forEachTargetRow<uint32_t, 1>(dst, [&](uint32_t* target, const Color* source) {
             for (uint32_t x = 0; x < width; ++x) {
-                const auto& pixel = pixels[y * width + x];
-                auto* target = data.data() + (y * width + x) * sizeof(uint32_t);
-
+                const auto& pixel = source[x];
                 uint32_t pack = 0;
                 pack |= imageio::convertSINT(imageio::bit_cast<uint32_t>(static_cast<int32_t>(pixel[0])), sizeof(uint32_t) * 8, c0) << (c1 + c2 + c3);
                 pack |= imageio::convertSINT(imageio::bit_cast<uint32_t>(static_cast<int32_t>(pixel[1])), sizeof(uint32_t) * 8, c1) << (c2 + c3);
                 pack |= imageio::convertSINT(imageio::bit_cast<uint32_t>(static_cast<int32_t>(pixel[2])), sizeof(uint32_t) * 8, c2) << c3;
                 pack |= imageio::convertSINT(imageio::bit_cast<uint32_t>(static_cast<int32_t>(pixel[3])), sizeof(uint32_t) * 8, c3);
-
-                std::memcpy(target, &pack, sizeof(pack));
+                target[x] = pack;
             }
-        }
-
-        return data;
+        });
     }
 
     static void checkResamplerStatus(basisu::Resampler& resampler, const char* pFilter) {
@@ -1276,12 +1217,7 @@ class ImageT : public Image {
 
     virtual ImageT& swizzle(std::string_view swizzle) override {
         assert(swizzle.size() == 4);
-        for (size_t i = 0; i < getPixelCount(); i++) {
-            Color srcPixel = pixels[i];
-            for (uint32_t c = 0; c < getComponentCount(); c++) {
-                pixels[i].set(c, swizzlePixel(srcPixel, swizzle[c]));
-            }
-        }
+        applySwizzle(*this, compileSwizzle<componentCount>(swizzle));
         return *this;
     }
 
@@ -1292,20 +1228,7 @@ class ImageT : public Image {
 
         dst.setTransferFunction(transferFunction);
         dst.setPrimaries(primaries);
-        for (size_t i = 0; i < getPixelCount(); i++) {
-            uint32_t c;
-            for (c = 0; c < dst.getComponentCount(); c++) {
-                if (c < getComponentCount())
-                    dst.pixels[i].set(c, swizzlePixel(pixels[i], swizzle[c]));
-                else
-                    break;
-            }
-            for (; c < dst.getComponentCount(); c++)
-                if (c < 3)
-                    dst.pixels[i].set(c, componentType{0});
-                else
-                    dst.pixels[i].set(c, Color::one());
-        }
+        applySwizzle(dst, compileSwizzle<DstImage::Color::getComponentCount()>(swizzle));
         return *this;
     }
 
@@ -1315,24 +1238,200 @@ class ImageT : public Image {
     virtual ImageT& copyToRGBA(Image& dst, std::string_view swizzle) override { return copyTo((ImageT<componentType, 4>&)dst, swizzle); }
 
   protected:
-    componentType swizzlePixel(const Color& srcPixel, char swizzle) {
+    template <typename F>
+    static void dispatchChannelCount(uint32_t numChannels, F&& func) {
+        switch (numChannels) {
+          case 1: func(std::integral_constant<uint32_t, 1>{}); break;
+          case 2: func(std::integral_constant<uint32_t, 2>{}); break;
+          case 3: func(std::integral_constant<uint32_t, 3>{}); break;
+          case 4: func(std::integral_constant<uint32_t, 4>{}); break;
+          default: assert(false);
+        }
+    }
+
+    template <uint32_t NumChannels, typename F>
+    static void forEachChannel(F&& func) {
+        forEachChannel(func, std::make_integer_sequence<uint32_t, NumChannels>{});
+    }
+    template <typename F, uint32_t... C>
+    static void forEachChannel(F& func, std::integer_sequence<uint32_t, C...>) {
+        (func(std::integral_constant<uint32_t, C>{}), ...);
+    }
+
+    /// Channel @p C of @p pixel, or 0 for missing color and @p alpha for a
+    /// missing alpha channel.
+    template <uint32_t C>
+    static componentType channelOr(const Color& pixel, componentType alpha) {
+        if constexpr (C < componentCount)
+            return pixel.comps[C];
+        else if constexpr (C == 3)
+            return alpha;
+        else
+            return componentType{0};
+    }
+
+    /// Call @p func(targetRow, sourceRow) for every row of the image, on
+    /// parallel row bands for large images. @p dst must be suitably aligned
+    /// for @p TargetT.
+    template <typename TargetT, uint32_t NumChannels, typename F>
+    void forEachTargetRow(uint8_t* dst, F&& func) const {
+        const size_t rowValues = size_t{width} * NumChannels;
+        imageio::forEachRowBand(height, rowValues * sizeof(TargetT), [&](uint32_t firstRow, uint32_t endRow) {
+            for (uint32_t y = firstRow; y < endRow; ++y)
+                func(reinterpret_cast<TargetT*>(dst) + y * rowValues, pixels + size_t{y} * width);
+        });
+    }
+
+    template <typename TargetT, uint32_t NumChannels>
+    void storeUNORM(uint8_t* dst, uint32_t sBits) const {
+        static constexpr uint32_t targetBits = sizeof(TargetT) * 8;
+        static constexpr bool sameLayout = NumChannels == componentCount;
+        const auto mask = static_cast<TargetT>(
+                sBits == 0 ? 0xFFFFFFFFu : ((1u << sBits) - 1u) << (targetBits - sBits));
+
+        forEachTargetRow<TargetT, NumChannels>(dst, [&](TargetT* target, const Color* source) {
+            const auto* sourceValues = reinterpret_cast<const componentType*>(source);
+            if (sBits == 0) {
+                if constexpr (std::is_same_v<componentType, TargetT> && NumChannels <= componentCount) {
+                    imageio::truncateChannels<componentCount, NumChannels>(target, sourceValues, width);
+                    return;
+                } else if constexpr (sameLayout && std::is_same_v<componentType, uint8_t> && std::is_same_v<TargetT, uint16_t>) {
+                    imageio::widenUNORM8To16(target, sourceValues, size_t{width} * NumChannels);
+                    return;
+                } else if constexpr (sameLayout && std::is_same_v<componentType, uint16_t> && std::is_same_v<TargetT, uint8_t>) {
+                    imageio::narrowUNORM16To8(target, sourceValues, size_t{width} * NumChannels);
+                    return;
+                }
+            }
+            for (uint32_t x = 0; x < width; ++x) {
+                forEachChannel<NumChannels>([&](auto c) {
+                    const auto sourceValue = channelOr<c>(source[x], Color::one());
+                    const auto value = imageio::convertUNORM(static_cast<uint32_t>(sourceValue),
+                                                             sizeof(componentType) * 8, targetBits);
+                    target[x * NumChannels + c] = static_cast<TargetT>(value & mask);
+                });
+            }
+        });
+    }
+
+    template <typename PackType>
+    void storeUNORMPacked(uint8_t* dst, uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3) const {
+        const std::array<uint32_t, 4> bits{c0, c1, c2, c3};
+        const std::array<uint32_t, 4> shifts{c1 + c2 + c3, c2 + c3, c3, 0};
+
+        forEachTargetRow<PackType, 1>(dst, [&](PackType* target, const Color* source) {
+            for (uint32_t x = 0; x < width; ++x) {
+                PackType pack = 0;
+                forEachChannel<4>([&](auto c) {
+                    if (bits[c] == 0)
+                        return;
+                    const auto sourceValue = channelOr<c>(source[x], Color::one());
+                    const auto value = imageio::convertUNORM(static_cast<uint32_t>(sourceValue),
+                                                             sizeof(componentType) * 8, bits[c]);
+                    pack |= static_cast<PackType>(value) << shifts[c];
+                });
+                target[x] = pack;
+            }
+        });
+    }
+
+    template <typename TargetT, uint32_t NumChannels>
+    void storeSFloat(uint8_t* dst) const {
+        forEachTargetRow<TargetT, NumChannels>(dst, [&](TargetT* target, const Color* source) {
+            if constexpr (std::is_same_v<componentType, TargetT> && NumChannels <= componentCount) {
+                imageio::truncateChannels<componentCount, NumChannels>(
+                        target, reinterpret_cast<const componentType*>(source), width);
+            } else {
+                for (uint32_t x = 0; x < width; ++x) {
+                    forEachChannel<NumChannels>([&](auto c) {
+                        const auto value = channelOr<c>(source[x], componentType{1});
+                        auto& out = target[x * NumChannels + c];
+                        if constexpr (sizeof(componentType) == sizeof(TargetT))
+                            std::memcpy(&out, &value, sizeof(out));
+                        else if constexpr (sizeof(TargetT) == 2)
+                            out = imageio::float_to_half(static_cast<float>(value));
+                        else
+                            out = static_cast<float>(value);
+                    });
+                }
+            }
+        });
+    }
+
+    template <typename TargetT, uint32_t NumChannels>
+    void storeINT(uint8_t* dst) const {
+        forEachTargetRow<TargetT, NumChannels>(dst, [&](TargetT* target, const Color* source) {
+            if constexpr (std::is_same_v<componentType, TargetT> && NumChannels <= componentCount) {
+                imageio::truncateChannels<componentCount, NumChannels>(
+                        target, reinterpret_cast<const componentType*>(source), width);
+            } else {
+                for (uint32_t x = 0; x < width; ++x)
+                    forEachChannel<NumChannels>([&](auto c) {
+                        target[x * NumChannels + c] = static_cast<TargetT>(channelOr<c>(source[x], componentType{1}));
+                    });
+            }
+        });
+    }
+
+    static uint8_t swizzleSelector(char swizzle) {
+        // Out of range channels read the last one, as Color::operator[] does.
         switch (swizzle) {
           case 'r':
-            return srcPixel[0];
+            return 0;
           case 'g':
-            return srcPixel[1];
+            return static_cast<uint8_t>(std::min(1u, componentCount - 1));
           case 'b':
-            return srcPixel[2];
+            return static_cast<uint8_t>(std::min(2u, componentCount - 1));
           case 'a':
-            return srcPixel[3];
+            return static_cast<uint8_t>(std::min(3u, componentCount - 1));
           case '0':
-            return componentType{0};
+            return imageio::kSwizzleZero;
           case '1':
-            return Color::one();
+            return imageio::kSwizzleOne;
           default:
             assert(false);
-            return componentType{0};
+            return imageio::kSwizzleZero;
+        }
+    }
+
+    /// Compile @p swizzle once for a destination with @p DstChannels
+    /// channels. Destination channels the source lacks are set to 0 for
+    /// color and one for alpha.
+    template <uint32_t DstChannels>
+    static imageio::SwizzleSelect compileSwizzle(std::string_view swizzle) {
+        imageio::SwizzleSelect select{imageio::kSwizzleZero, imageio::kSwizzleZero,
+                                      imageio::kSwizzleZero, imageio::kSwizzleOne};
+        for (uint32_t c = 0; c < std::min(DstChannels, componentCount); ++c)
+            select[c] = swizzleSelector(swizzle[c]);
+        return select;
+    }
+
+    /// Write the pixels selected by @p select to @p dst, which may be *this.
+    /// Identity swizzles are a copy, or nothing at all when in place.
+    template <class DstImage>
+    void applySwizzle(DstImage& dst, const imageio::SwizzleSelect& select) const {
+        static constexpr uint32_t DstChannels = DstImage::Color::getComponentCount();
+        const auto* src = reinterpret_cast<const componentType*>(pixels);
+        auto* out = reinterpret_cast<componentType*>(dst.pixels);
+
+        bool identity = DstChannels == componentCount;
+        for (uint32_t c = 0; c < DstChannels; ++c)
+            identity = identity && select[c] == c;
+        if (identity) {
+            if (out != src)
+                std::memcpy(out, src, getByteCount());
+            return;
         }
+
+        imageio::forEachRowBand(height, size_t{width} * sizeof(Color), [&](uint32_t firstRow, uint32_t endRow) {
+            const size_t first = size_t{firstRow} * width;
+            const size_t count = size_t{endRow - firstRow} * width;
+            if constexpr (std::is_same_v<componentType, uint8_t> && componentCount == 4 && DstChannels == 4)
+                imageio::swizzleRGBA8(out + first * 4, src + first * 4, count, select);
+            else
+                imageio::swizzlePixels<componentCount, DstChannels>(
+                        out + first * DstChannels, src + first * componentCount, count, select, Color::one());
+        });
     }
 
     Color* pixels;
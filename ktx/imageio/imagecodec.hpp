@@ -115,43 +115,43 @@ public:
             case VK_FORMAT_E5B9G9R9_UFLOAT_PACK32:
                 flags.isFloat = true;
                 channels = 3;
-                codec.decodeFLOAT = decodeFLOAT_E9B5G5R5;
+                setDecodeFLOAT<decodeFLOAT_E9B5G5R5>();
                 break;
 
             case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
                 channels = 3;
-                codec.decodeFLOAT = decodeFLOAT_B10G11R11;
+                setDecodeFLOAT<decodeFLOAT_B10G11R11>();
                 break;
 
             case VK_FORMAT_R16G16_SFIXED5_NV:
                 channels = 2;
-                codec.decodeFLOAT = decodeFLOAT_SFIXED5_NV<2>;
+                setDecodeFLOAT<decodeFLOAT_SFIXED5_NV<2>>();
                 break;
 
             case VK_FORMAT_D16_UNORM_S8_UINT:
                 flags.isNormalized = true;
                 channels = 2;
                 codec.decodeUINT = decodeUINT_D16_S8;
-                codec.decodeFLOAT = decodeFLOAT_D16_S8;
+                setDecodeFLOAT<decodeFLOAT_D16_S8>();
                 break;
 
             case VK_FORMAT_X8_D24_UNORM_PACK32:
                 flags.isNormalized = true;
                 channels = 1;
                 codec.decodeUINT = decodeUINT_D24;
-                codec.decodeFLOAT = decodeFLOAT_D24;
+                setDecodeFLOAT<decodeFLOAT_D24>();
                 break;
 
             case VK_FORMAT_D24_UNORM_S8_UINT:
                 flags.isNormalized = true;
                 channels = 2;
                 codec.decodeUINT = decodeUINT_D24_S8;
-                codec.decodeFLOAT = decodeFLOAT_D24_S8;
+                setDecodeFLOAT<decodeFLOAT_D24_S8>();
                 break;
 
             case VK_FORMAT_D32_SFLOAT_S8_UINT:
                 channels = 2;
-                codec.decodeFLOAT = decodeFLOAT_D32_S8;
+                setDecodeFLOAT<decodeFLOAT_D32_S8>();
                 break;
 
             default: {
@@ -196,19 +196,19 @@ public:
                 if (flags.isFloatHalf) {
                     // Data is a vector of FP16 values
                     switch (sampleCount) {
-                    case 1: codec.decodeFLOAT = decodeFLOAT_FP16Vec<1>; break;
-                    case 2: codec.decodeFLOAT = decodeFLOAT_FP16Vec<2>; break;
-                    case 3: codec.decodeFLOAT = decodeFLOAT_FP16Vec<3>; break;
-                    case 4: codec.decodeFLOAT = decodeFLOAT_FP16Vec<4>; break;
+                    case 1: setDecodeFLOAT<decodeFLOAT_FP16Vec<1>>(); break;
+                    case 2: setDecodeFLOAT<decodeFLOAT_FP16Vec<2>>(); break;
+                    case 3: setDecodeFLOAT<decodeFLOAT_FP16Vec<3>>(); break;
+                    case 4: setDecodeFLOAT<decodeFLOAT_FP16Vec<4>>(); break;
                     default: flags.valid = false; return;
                     }
                 } else if (flags.isFloat) {
                     // Data is a vector of FP32 values
                     switch (sampleCount) {
-                    case 1: codec.decodeFLOAT = decodeFLOAT_FP32Vec<1>; break;
-                    case 2: codec.decodeFLOAT = decodeFLOAT_FP32Vec<2>; break;
-                    case 3: codec.decodeFLOAT = decodeFLOAT_FP32Vec<3>; break;
-                    case 4: codec.decodeFLOAT = decodeFLOAT_FP32Vec<4>; break;
+                    case 1: setDecodeFLOAT<decodeFLOAT_FP32Vec<1>>(); break;
+                    case 2: setDecodeFLOAT<decodeFLOAT_FP32Vec<2>>(); break;
+                    case 3: setDecodeFLOAT<decodeFLOAT_FP32Vec<3>>(); break;
+                    case 4: setDecodeFLOAT<decodeFLOAT_FP32Vec<4>>(); break;
                     default: flags.valid = false; return;
                     }
                 } else if (flags.isPacked) {
@@ -237,11 +237,11 @@ public:
                         if (flags.isSigned) {
                             codec.decodeSINT = decodeSINT_SINTPacked<int8_t>;
                             if (flags.isNormalized)
-                                codec.decodeFLOAT = decodeFLOAT_SINTPacked<int8_t>;
+                                setDecodeFLOAT<decodeFLOAT_SINTPacked<int8_t>>();
                         } else {
                             codec.decodeUINT = decodeUINT_UINTPacked<uint8_t>;
                             if (flags.isNormalized)
-                                codec.decodeFLOAT = decodeFLOAT_UINTPacked<uint8_t>;
+                                setDecodeFLOAT<decodeFLOAT_UINTPacked<uint8_t>>();
                         }
                         break;
                     case 2:
@@ -249,11 +249,11 @@ public:
                         if (flags.isSigned) {
                             codec.decodeSINT = decodeSINT_SINTPacked<int16_t>;
                             if (flags.isNormalized)
-                                codec.decodeFLOAT = decodeFLOAT_SINTPacked<int16_t>;
+                                setDecodeFLOAT<decodeFLOAT_SINTPacked<int16_t>>();
                         } else {
                             codec.decodeUINT = decodeUINT_UINTPacked<uint16_t>;
                             if (flags.isNormalized)
-                                codec.decodeFLOAT = decodeFLOAT_UINTPacked<uint16_t>;
+                                setDecodeFLOAT<decodeFLOAT_UINTPacked<uint16_t>>();
                         }
                         break;
                     case 4:
@@ -261,11 +261,11 @@ public:
                         if (flags.isSigned) {
                             codec.decodeSINT = decodeSINT_SINTPacked<int32_t>;
                             if (flags.isNormalized)
-                                codec.decodeFLOAT = decodeFLOAT_SINTPacked<int32_t>;
+                                setDecodeFLOAT<decodeFLOAT_SINTPacked<int32_t>>();
                         } else {
                             codec.decodeUINT = decodeUINT_UINTPacked<uint32_t>;
                             if (flags.isNormalized)
-                                codec.decodeFLOAT = decodeFLOAT_UINTPacked<uint32_t>;
+                                setDecodeFLOAT<decodeFLOAT_UINTPacked<uint32_t>>();
                         }
                         break;
                     default:
@@ -287,10 +287,10 @@ public:
                             }
                             if (flags.isNormalized) {
                                 switch (sampleCount) {
-                                case 1: codec.decodeFLOAT = decodeFLOAT_SINTVec<int8_t, 1>; break;
-                                case 2: codec.decodeFLOAT = decodeFLOAT_SINTVec<int8_t, 2>; break;
-                                case 3: codec.decodeFLOAT = decodeFLOAT_SINTVec<int8_t, 3>; break;
-                                case 4: codec.decodeFLOAT = decodeFLOAT_SINTVec<int8_t, 4>; break;
+                                case 1: setDecodeFLOAT<decodeFLOAT_SINTVec<int8_t, 1>>(); break;
+                                case 2: setDecodeFLOAT<decodeFLOAT_SINTVec<int8_t, 2>>(); break;
+                                case 3: setDecodeFLOAT<decodeFLOAT_SINTVec<int8_t, 3>>(); break;
+                                case 4: setDecodeFLOAT<decodeFLOAT_SINTVec<int8_t, 4>>(); break;
                                 default: break;
                                 }
                             }
@@ -306,10 +306,10 @@ public:
                             }
                             if (flags.isNormalized) {
                                 switch (sampleCount) {
-                                case 1: codec.decodeFLOAT = decodeFLOAT_SINTVec<int16_t, 1>; break;
-                                case 2: codec.decodeFLOAT = decodeFLOAT_SINTVec<int16_t, 2>; break;
-                                case 3: codec.decodeFLOAT = decodeFLOAT_SINTVec<int16_t, 3>; break;
-                                case 4: codec.decodeFLOAT = decodeFLOAT_SINTVec<int16_t, 4>; break;
+                                case 1: setDecodeFLOAT<decodeFLOAT_SINTVec<int16_t, 1>>(); break;
+                                case 2: setDecodeFLOAT<decodeFLOAT_SINTVec<int16_t, 2>>(); break;
+                                case 3: setDecodeFLOAT<decodeFLOAT_SINTVec<int16_t, 3>>(); break;
+                                case 4: setDecodeFLOAT<decodeFLOAT_SINTVec<int16_t, 4>>(); break;
                                 default: break;
                                 }
                             }
@@ -325,10 +325,10 @@ public:
                             }
                             if (flags.isNormalized) {
                                 switch (sampleCount) {
-                                case 1: codec.decodeFLOAT = decodeFLOAT_SINTVec<int32_t, 1>; break;
-                                case 2: codec.decodeFLOAT = decodeFLOAT_SINTVec<int32_t, 2>; break;
-                                case 3: codec.decodeFLOAT = decodeFLOAT_SINTVec<int32_t, 3>; break;
-                                case 4: codec.decodeFLOAT = decodeFLOAT_SINTVec<int32_t, 4>; break;
+                                case 1: setDecodeFLOAT<decodeFLOAT_SINTVec<int32_t, 1>>(); break;
+                                case 2: setDecodeFLOAT<decodeFLOAT_SINTVec<int32_t, 2>>(); break;
+                                case 3: setDecodeFLOAT<decodeFLOAT_SINTVec<int32_t, 3>>(); break;
+                                case 4: setDecodeFLOAT<decodeFLOAT_SINTVec<int32_t, 4>>(); break;
                                 default: break;
                                 }
                             }
@@ -350,10 +350,10 @@ public:
                             }
                             if (flags.isNormalized) {
                                 switch (sampleCount) {
-                                case 1: codec.decodeFLOAT = decodeFLOAT_UINTVec<uint8_t, 1>; break;
-                                case 2: codec.decodeFLOAT = decodeFLOAT_UINTVec<uint8_t, 2>; break;
-                                case 3: codec.decodeFLOAT = decodeFLOAT_UINTVec<uint8_t, 3>; break;
-                                case 4: codec.decodeFLOAT = decodeFLOAT_UINTVec<uint8_t, 4>; break;
+                                case 1: setDecodeFLOAT<decodeFLOAT_UINTVec<uint8_t, 1>>(); break;
+                                case 2: setDecodeFLOAT<decodeFLOAT_UINTVec<uint8_t, 2>>(); break;
+                                case 3: setDecodeFLOAT<decodeFLOAT_UINTVec<uint8_t, 3>>(); break;
+                                case 4: setDecodeFLOAT<decodeFLOAT_UINTVec<uint8_t, 4>>(); break;
                                 default: break;
                                 }
                             }
@@ -369,10 +369,10 @@ public:
                             }
                             if (flags.isNormalized) {
                                 switch (sampleCount) {
-                                case 1: codec.decodeFLOAT = decodeFLOAT_UINTVec<uint16_t, 1>; break;
-                                case 2: codec.decodeFLOAT = decodeFLOAT_UINTVec<uint16_t, 2>; break;
-                                case 3: codec.decodeFLOAT = decodeFLOAT_UINTVec<uint16_t, 3>; break;
-                                case 4: codec.decodeFLOAT = decodeFLOAT_UINTVec<uint16_t, 4>; break;
+                                case 1: setDecodeFLOAT<decodeFLOAT_UINTVec<uint16_t, 1>>(); break;
+                                case 2: setDecodeFLOAT<decodeFLOAT_UINTVec<uint16_t, 2>>(); break;
+                                case 3: setDecodeFLOAT<decodeFLOAT_UINTVec<uint16_t, 3>>(); break;
+                                case 4: setDecodeFLOAT<decodeFLOAT_UINTVec<uint16_t, 4>>(); break;
                                 default: break;
                                 }
                             }
@@ -388,10 +388,10 @@ public:
                             }
                             if (flags.isNormalized) {
                                 switch (sampleCount) {
-                                case 1: codec.decodeFLOAT = decodeFLOAT_UINTVec<uint32_t, 1>; break;
-                                case 2: codec.decodeFLOAT = decodeFLOAT_UINTVec<uint32_t, 2>; break;
-                                case 3: codec.decodeFLOAT = decodeFLOAT_UINTVec<uint32_t, 3>; break;
-                                case 4: codec.decodeFLOAT = decodeFLOAT_UINTVec<uint32_t, 4>; break;
+                                case 1: setDecodeFLOAT<decodeFLOAT_UINTVec<uint32_t, 1>>(); break;
+                                case 2: setDecodeFLOAT<decodeFLOAT_UINTVec<uint32_t, 2>>(); break;
+                                case 3: setDecodeFLOAT<decodeFLOAT_UINTVec<uint32_t, 3>>(); break;
+                                case 4: setDecodeFLOAT<decodeFLOAT_UINTVec<uint32_t, 4>>(); break;
                                 default: break;
                                 }
                             }
@@ -475,6 +475,8 @@ public:
     glm::uvec4 decodeUINT(const void* ptr) const { return codec.decodeUINT(this, ptr); }
     glm::ivec4 decodeSINT(const void* ptr) const { return codec.decodeSINT(this, ptr); }
     glm::vec4 decodeFLOAT(const void* ptr) const { return codec.decodeFLOAT(this, ptr); }
+    /// Decodes @p count consecutive texel blocks into four floats each, with the per texel dispatch resolved once
+    void decodeFLOATRow(const void* ptr, uint32_t count, float* out) const { codec.decodeFLOATRow(this, ptr, count, out); }
 
 private:
     struct {
@@ -504,14 +506,35 @@ private:
     typedef glm::uvec4 (*DecodeUINT)(const ImageCodec*, const void*);
     typedef glm::ivec4 (*DecodeSINT)(const ImageCodec*, const void*);
     typedef glm::vec4 (*DecodeFLOAT)(const ImageCodec*, const void*);
+    typedef void (*DecodeFLOATRow)(const ImageCodec*, const void*, uint32_t, float*);
 
     struct {
         GetPackedElement getPackedElement = nullptr;
         DecodeUINT  decodeUINT = nullptr;
         DecodeSINT  decodeSINT = nullptr;
         DecodeFLOAT decodeFLOAT = nullptr;
+        DecodeFLOATRow decodeFLOATRow = nullptr;
     } codec = {};
 
+    template <DecodeFLOAT DECODE>
+    void setDecodeFLOAT() {
+        codec.decodeFLOAT = DECODE;
+        codec.decodeFLOATRow = decodeFLOATRow<DECODE>;
+    }
+
+    template <DecodeFLOAT DECODE>
+    static void decodeFLOATRow(const ImageCodec* codec, const void* ptr, uint32_t count, float* out) {
+        // DECODE is a template argument so it can be inlined into the loop
+        auto data = reinterpret_cast<const uint8_t*>(ptr);
+        for (uint32_t i = 0; i < count; ++i, data += codec->texelBlockByteSize, out += 4) {
+            const glm::vec4 value = DECODE(codec, data);
+            out[0] = value.x;
+            out[1] = value.y;
+            out[2] = value.z;
+            out[3] = value.w;
+        }
+    }
+
     template <typename TYPE>
     static uint32_t getPackedElement(const ImageCodec* codec, const void* ptr, uint32_t index) {
         static_assert(std::is_unsigned_v<TYPE>);
@@ -630,7 +653,7 @@ private:
         static_assert(std::is_unsigned_v<TYPE>);
         static_assert((COMPONENTS > 0) && (COMPONENTS <= 4));
         auto data = reinterpret_cast<const TYPE*>(ptr);
-        const auto upper = static_cast<float>((256u << sizeof(TYPE)) - 1u);
+        const auto upper = static_cast<float>(std::numeric_limits<TYPE>::max());
         glm::vec4 result(0.f, 0.f, 0.f, 1.f);
         for (int i = 0; i < COMPONENTS; ++i)
             result[i] = static_cast<float>(data[i]) / upper;
@@ -653,7 +676,7 @@ private:
         static_assert(std::is_signed_v<TYPE>);
         static_assert((COMPONENTS > 0) && (COMPONENTS <= 4));
         auto data = reinterpret_cast<const TYPE*>(ptr);
-        const auto upper = static_cast<float>((128u << sizeof(TYPE)) - 1u);
+        const auto upper = static_cast<float>(std::numeric_limits<TYPE>::max());
         glm::vec4 result(0.f, 0.f, 0.f, 1.f);
         for (int i = 0; i < COMPONENTS; ++i)
             result[i] = std::max(static_cast<float>(data[i]) / upper, -1.f);
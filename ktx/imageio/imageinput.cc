@@ -14,6 +14,7 @@
 
 #include "imageio.h"
 #include "imageio_utility.h"
+#include "imageio_kernels.h"
 #include "platform_utils.h"
 
 #include <iomanip>
@@ -301,11 +302,67 @@ ImageInput::readScanline(void* pBufferOut, size_t bufferByteCount,
 }
 
 
+/// @brief Check if @a format is full range UNORM with the same bit length in
+/// every channel, returning that bit length or 0 if it isn't.
+static uint32_t
+fullRangeUNORMBitLength(const FormatDescriptor& format)
+{
+    if (format.isUnknown() || !format.sameUnitAllChannels()
+        || format.sampleCount() != format.channelCount())
+        return 0;
+
+    const auto& sample = format.samples[0];
+    if (sample.qualifierLinear || sample.qualifierExponent
+        || sample.qualifierSigned || sample.qualifierFloat)
+        return 0;
+
+    const uint32_t bitLength = format.channelBitLength();
+    if (bitLength != 8 && bitLength != 16)
+        return 0;
+    if (format.channelUpper() != (1u << bitLength) - 1u)
+        return 0;
+    return bitLength;
+}
+
+/// @brief Read native scanlines and convert them with @a converter.
+///
+/// Scanlines come from a single stream so they are read sequentially into a
+/// scratch image. The conversion is then done in parallel row bands.
+void
+ImageInput::readImageConverted(uint8_t* pDst, size_t outScanlineByteCount,
+                               uint32_t subimage, uint32_t miplevel,
+                               imageio::RowConverter converter)
+{
+    const auto width = spec().width();
+    const auto height = spec().height();
+    const size_t nativeScanlineByteCount = spec().scanlineByteCount();
+
+    std::vector<uint8_t> nativeImage(nativeScanlineByteCount * height);
+    for (uint32_t y = 0; y < height; y++) {
+        readNativeScanline(nativeImage.data() + nativeScanlineByteCount * y,
+                           nativeScanlineByteCount, y, 0, subimage, miplevel);
+    }
+
+    imageio::forEachRowBand(height, outScanlineByteCount,
+        [&](uint32_t firstRow, uint32_t endRow) {
+            for (uint32_t y = firstRow; y < endRow; y++) {
+                converter(pDst + outScanlineByteCount * y,
+                          nativeImage.data() + nativeScanlineByteCount * y,
+                          width);
+            }
+        });
+}
+
 /// @brief Read an entire image into contiguous memory performing conversions
 /// to @a format.
 ///
 /// Default implementation for derived classes.
 ///
+/// When the requested format has the same layout as the native format the
+/// native scanlines are read directly into @a pBuffer. Widening of full range
+/// UNORM data to 4 channels and/or from 8 to 16 bits is done with row
+/// kernels. Everything else falls back to per scanline conversion.
+///
 /// @sa readScanline() for support conversions.
 void
 ImageInput::readImage(void* pBuffer, size_t bufferByteCount,
@@ -319,6 +376,33 @@ ImageInput::readImage(void* pBuffer, size_t bufferByteCount,
         throw buffer_too_small();
 
     uint8_t* pDst = static_cast<uint8_t*>(pBuffer);
+
+    const auto& nativeFormat = spec().format();
+    const uint32_t nativeBits = fullRangeUNORMBitLength(nativeFormat);
+    const uint32_t targetBits = fullRangeUNORMBitLength(targetFormat);
+    if (nativeBits != 0 && targetBits != 0 && spec().depth() <= 1) {
+        seekSubimage(subimage, miplevel);
+        if (nativeBits == targetBits
+            && nativeFormat.channelCount() == targetFormat.channelCount()) {
+            // Same layout. Nothing to convert.
+            assert(outScanlineByteCount == spec().scanlineByteCount());
+            for (uint32_t y = 0; y < spec().height(); y++) {
+                readNativeScanline(pDst, outScanlineByteCount,
+                                   y, 0, subimage, miplevel);
+                pDst += outScanlineByteCount;
+            }
+            return;
+        }
+        const auto converter = imageio::selectUNORMRowConverter(
+                nativeFormat.channelCount(), nativeBits,
+                targetFormat.channelCount(), targetBits);
+        if (converter != nullptr) {
+            readImageConverted(pDst, outScanlineByteCount,
+                               subimage, miplevel, converter);
+            return;
+        }
+    }
+
     for (uint32_t y = 0; y < spec().height(); y++) {
         readScanline(pDst, bufferByteCount,
                      y, 0, subimage, miplevel, targetFormat);
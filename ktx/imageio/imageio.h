@@ -43,6 +43,7 @@
 #include <math.h>
 
 #include "formatdesc.h"
+#include "imageio_kernels.h"
 
 using stride_t = int64_t;
 const stride_t AutoStride = std::numeric_limits<stride_t>::min();
@@ -398,6 +399,10 @@ class ImageInput {
 
     void throwOnReadFailure();
 
+    void readImageConverted(uint8_t* pDst, size_t outScanlineByteCount,
+                            uint32_t subimage, uint32_t miplevel,
+                            imageio::RowConverter converter);
+
     void warning(const std::string& wmsg);
     void fwarning(const std::string& wmsg);
 
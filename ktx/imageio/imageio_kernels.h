@@ -0,0 +1,431 @@
+// -*- tab-width: 4; -*-
+// vi: set sw=2 ts=4 expandtab:
+
+// Copyright 2025 The Khronos Group Inc.
+// SPDX-License-Identifier: Apache-2.0
+
+//!
+//! @internal
+//! @~English
+//! @file
+//!
+//! @brief Row conversion kernels and row band parallelism helpers shared by
+//! the image input plug-ins.
+//!
+//! All kernels convert UNORM data between layouts whose channel upper value
+//! is the full range of the component type, so widening 8-bit to 16-bit is a
+//! bit replication (v * 257) and needs no float arithmetic. Kernels operate on
+//! whole rows and are selected once per image, not per pixel.
+//!
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #include <emmintrin.h>
+  #define IMAGEIO_KERNELS_SSE2 1
+#endif
+#if defined(__SSSE3__) || defined(__AVX__)
+  #include <tmmintrin.h>
+  #define IMAGEIO_KERNELS_SSSE3 1
+#endif
+
+// -----------------------------------------------------------------------------
+
+namespace imageio {
+
+/// Number of pixels converted per chunk when a conversion is done in two
+/// passes (channel expansion followed by widening) through a stack buffer.
+inline constexpr size_t kKernelChunkPixels = 256;
+
+// --- Channel expansion to RGBA ------------------------------------------------
+
+/// @brief Expand @a pixelCount pixels of @a SrcChannels channel data to RGBA.
+///
+/// 1 channel is treated as luminance (R=G=B=L), 2 channels as luminance+alpha,
+/// 3 channels as RGB. A missing alpha is set to the max value of @a T.
+template <uint32_t SrcChannels, typename T>
+inline void expandToRGBAScalar(T* dst, const T* src, size_t pixelCount) noexcept {
+    static_assert(SrcChannels >= 1 && SrcChannels <= 4);
+    constexpr T one = std::numeric_limits<T>::max();
+    for (size_t i = 0; i < pixelCount; ++i, src += SrcChannels, dst += 4) {
+        if constexpr (SrcChannels == 1) {
+            dst[0] = dst[1] = dst[2] = src[0];
+            dst[3] = one;
+        } else if constexpr (SrcChannels == 2) {
+            dst[0] = dst[1] = dst[2] = src[0];
+            dst[3] = src[1];
+        } else if constexpr (SrcChannels == 3) {
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+            dst[3] = one;
+        } else {
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+            dst[3] = src[3];
+        }
+    }
+}
+
+inline void expandL8ToRGBA8(uint8_t* dst, const uint8_t* src, size_t pixelCount) noexcept {
+    size_t i = 0;
+#if IMAGEIO_KERNELS_SSE2
+    const __m128i ones = _mm_set1_epi8(static_cast<char>(0xff));
+    for (; i + 16 <= pixelCount; i += 16) {
+        const __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        // (l, l) and (l, 1) byte pairs interleaved as 16-bit lanes give l,l,l,1.
+        const __m128i llLo = _mm_unpacklo_epi8(l, l);
+        const __m128i llHi = _mm_unpackhi_epi8(l, l);
+        const __m128i laLo = _mm_unpacklo_epi8(l, ones);
+        const __m128i laHi = _mm_unpackhi_epi8(l, ones);
+        __m128i* out = reinterpret_cast<__m128i*>(dst + i * 4);
+        _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(llLo, laLo));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(llLo, laLo));
+        _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(llHi, laHi));
+        _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(llHi, laHi));
+    }
+#endif
+    expandToRGBAScalar<1>(dst + i * 4, src + i, pixelCount - i);
+}
+
+inline void expandLA8ToRGBA8(uint8_t* dst, const uint8_t* src, size_t pixelCount) noexcept {
+    size_t i = 0;
+#if IMAGEIO_KERNELS_SSE2
+    const __m128i lowMask = _mm_set1_epi16(0x00ff);
+    for (; i + 8 <= pixelCount; i += 8) {
+        const __m128i la = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+        const __m128i l = _mm_and_si128(la, lowMask);
+        const __m128i ll = _mm_or_si128(l, _mm_slli_epi16(l, 8));
+        __m128i* out = reinterpret_cast<__m128i*>(dst + i * 4);
+        _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(ll, la));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(ll, la));
+    }
+#endif
+    expandToRGBAScalar<2>(dst + i * 4, src + i * 2, pixelCount - i);
+}
+
+inline void expandRGB8ToRGBA8(uint8_t* dst, const uint8_t* src, size_t pixelCount) noexcept {
+    size_t i = 0;
+#if IMAGEIO_KERNELS_SSSE3
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xff000000));
+    // Each load reads 16 bytes but consumes 12 so stop while 16 remain.
+    for (; i + 6 <= pixelCount; i += 4) {
+        const __m128i rgb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+        const __m128i rgba = _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle), alpha);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), rgba);
+    }
+#endif
+    expandToRGBAScalar<3>(dst + i * 4, src + i * 3, pixelCount - i);
+}
+
+// --- Bit widening --------------------------------------------------------------
+
+/// @brief Widen @a valueCount full range UNORM8 values to UNORM16.
+///
+/// Equivalent to imageio::convertUNORM(v, 8, 16), i.e. v * 257.
+inline void widenUNORM8To16(uint16_t* dst, const uint8_t* src, size_t valueCount) noexcept {
+    size_t i = 0;
+#if IMAGEIO_KERNELS_SSE2
+    for (; i + 16 <= valueCount; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi8(v, v));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 8), _mm_unpackhi_epi8(v, v));
+    }
+#endif
+    for (; i < valueCount; ++i)
+        dst[i] = static_cast<uint16_t>(src[i] * 257u);
+}
+
+/// @brief Narrow @a valueCount full range UNORM16 values to UNORM8.
+///
+/// Equivalent to imageio::convertUNORM(v, 16, 8): round on the most
+/// significant dropped bit and saturate at 255.
+inline void narrowUNORM16To8(uint8_t* dst, const uint16_t* src, size_t valueCount) noexcept {
+    size_t i = 0;
+#if IMAGEIO_KERNELS_SSE2
+    const __m128i bit = _mm_set1_epi16(1);
+    for (; i + 16 <= valueCount; i += 16) {
+        const __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8));
+        // (v >> 8) + ((v >> 7) & 1) is at most 256; packus saturates it to 255.
+        const __m128i r0 = _mm_add_epi16(_mm_srli_epi16(v0, 8), _mm_and_si128(_mm_srli_epi16(v0, 7), bit));
+        const __m128i r1 = _mm_add_epi16(_mm_srli_epi16(v1, 8), _mm_and_si128(_mm_srli_epi16(v1, 7), bit));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(r0, r1));
+    }
+#endif
+    for (; i < valueCount; ++i) {
+        const uint32_t v = (src[i] >> 8) + ((src[i] >> 7) & 1u);
+        dst[i] = static_cast<uint8_t>(std::min(v, 255u));
+    }
+}
+
+// --- Channel truncation ---------------------------------------------------------
+
+/// @brief Copy the first @a DstChannels channels of @a pixelCount pixels with
+/// @a SrcChannels channels each.
+///
+/// Channel counts are compile time constants so the inner loop is fully
+/// unrolled and left to the auto-vectoriser.
+template <uint32_t SrcChannels, uint32_t DstChannels, typename T>
+inline void truncateChannels(T* dst, const T* src, size_t pixelCount) noexcept {
+    static_assert(DstChannels <= SrcChannels);
+    if constexpr (DstChannels == SrcChannels) {
+        std::memcpy(dst, src, pixelCount * SrcChannels * sizeof(T));
+    } else {
+        for (size_t i = 0; i < pixelCount; ++i, src += SrcChannels, dst += DstChannels)
+            for (uint32_t c = 0; c < DstChannels; ++c)
+                dst[c] = src[c];
+    }
+}
+
+// --- Row converters --------------------------------------------------------------
+
+using RowConverter = void (*)(void* dst, const void* src, size_t pixelCount);
+
+template <uint32_t SrcChannels>
+inline void expandRow8(void* dst, const void* src, size_t pixelCount) noexcept {
+    auto* d = static_cast<uint8_t*>(dst);
+    const auto* s = static_cast<const uint8_t*>(src);
+    if constexpr (SrcChannels == 1)
+        expandL8ToRGBA8(d, s, pixelCount);
+    else if constexpr (SrcChannels == 2)
+        expandLA8ToRGBA8(d, s, pixelCount);
+    else if constexpr (SrcChannels == 3)
+        expandRGB8ToRGBA8(d, s, pixelCount);
+    else
+        std::memcpy(d, s, pixelCount * 4);
+}
+
+template <uint32_t SrcChannels>
+inline void expandRow16(void* dst, const void* src, size_t pixelCount) noexcept {
+    expandToRGBAScalar<SrcChannels>(static_cast<uint16_t*>(dst),
+                                    static_cast<const uint16_t*>(src), pixelCount);
+}
+
+template <uint32_t Channels>
+inline void widenRow8To16(void* dst, const void* src, size_t pixelCount) noexcept {
+    widenUNORM8To16(static_cast<uint16_t*>(dst), static_cast<const uint8_t*>(src),
+                    pixelCount * Channels);
+}
+
+/// Expand to RGBA8 in chunks through a stack buffer, then widen to RGBA16.
+template <uint32_t SrcChannels>
+inline void expandWidenRow8To16(void* dst, const void* src, size_t pixelCount) noexcept {
+    uint8_t rgba8[kKernelChunkPixels * 4];
+    auto* d = static_cast<uint16_t*>(dst);
+    const auto* s = static_cast<const uint8_t*>(src);
+    for (size_t i = 0; i < pixelCount; i += kKernelChunkPixels) {
+        const size_t n = std::min(kKernelChunkPixels, pixelCount - i);
+        expandRow8<SrcChannels>(rgba8, s + i * SrcChannels, n);
+        widenUNORM8To16(d + i * 4, rgba8, n * 4);
+    }
+}
+
+/// @brief Select a row converter for full range UNORM data.
+///
+/// Supported conversions are
+/// - 8->8, 16->16 and 8->16 bit with identical channel counts
+/// - [1,2,3,4]->4 channels (L, LA, RGB, RGBA to RGBA) combined with the above
+///
+/// Returns nullptr when the conversion is not handled by a kernel; callers
+/// must then use the generic conversion path.
+[[nodiscard]] inline RowConverter selectUNORMRowConverter(uint32_t srcChannels, uint32_t srcBits,
+                                                          uint32_t dstChannels, uint32_t dstBits) noexcept {
+    if (srcChannels < 1 || srcChannels > 4)
+        return nullptr;
+    if (srcChannels != dstChannels && dstChannels != 4)
+        return nullptr;
+
+    const bool expand = srcChannels != dstChannels;
+    if (srcBits == 8 && dstBits == 8) {
+        if (!expand)
+            return nullptr; // Identical layouts need no kernel, just a copy.
+        switch (srcChannels) {
+        case 1: return expandRow8<1>;
+        case 2: return expandRow8<2>;
+        case 3: return expandRow8<3>;
+        }
+    } else if (srcBits == 16 && dstBits == 16) {
+        if (!expand)
+            return nullptr;
+        switch (srcChannels) {
+        case 1: return expandRow16<1>;
+        case 2: return expandRow16<2>;
+        case 3: return expandRow16<3>;
+        }
+    } else if (srcBits == 8 && dstBits == 16) {
+        if (!expand) {
+            switch (srcChannels) {
+            case 1: return widenRow8To16<1>;
+            case 2: return widenRow8To16<2>;
+            case 3: return widenRow8To16<3>;
+            case 4: return widenRow8To16<4>;
+            }
+        }
+        switch (srcChannels) {
+        case 1: return expandWidenRow8To16<1>;
+        case 2: return expandWidenRow8To16<2>;
+        case 3: return expandWidenRow8To16<3>;
+        }
+    }
+    return nullptr;
+}
+
+// --- Swizzle --------------------------------------------------------------------
+
+/// Selector values of a compiled swizzle beyond the source channel indices.
+inline constexpr uint8_t kSwizzleZero = 4;
+inline constexpr uint8_t kSwizzleOne = 5;
+
+/// A swizzle compiled to one selector per destination channel: a source
+/// channel index (0-3), kSwizzleZero or kSwizzleOne.
+using SwizzleSelect = std::array<uint8_t, 4>;
+
+/// @brief Apply @a select to @a pixelCount RGBA8 pixels. @a dst may equal @a src.
+///
+/// The selector is turned into a byte shuffle mask and a constant OR mask once
+/// per call; each iteration then swizzles 4 pixels with a single pshufb.
+inline void swizzleRGBA8(uint8_t* dst, const uint8_t* src, size_t pixelCount,
+                         const SwizzleSelect& select) noexcept {
+    size_t i = 0;
+#if IMAGEIO_KERNELS_SSSE3
+    alignas(16) uint8_t shuffle[16];
+    alignas(16) uint8_t ones[16];
+    for (uint32_t p = 0; p < 4; ++p)
+        for (uint32_t c = 0; c < 4; ++c) {
+            shuffle[p * 4 + c] = select[c] < 4 ? static_cast<uint8_t>(p * 4 + select[c]) : 0x80;
+            ones[p * 4 + c] = select[c] == kSwizzleOne ? 0xFF : 0x00;
+        }
+    const __m128i shuffleMask = _mm_load_si128(reinterpret_cast<const __m128i*>(shuffle));
+    const __m128i onesMask = _mm_load_si128(reinterpret_cast<const __m128i*>(ones));
+    for (; i + 4 <= pixelCount; i += 4) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4),
+                         _mm_or_si128(_mm_shuffle_epi8(v, shuffleMask), onesMask));
+    }
+#endif
+    for (; i < pixelCount; ++i) {
+        const uint8_t ext[6] = {src[i * 4], src[i * 4 + 1], src[i * 4 + 2], src[i * 4 + 3], 0, 0xFF};
+        for (uint32_t c = 0; c < 4; ++c)
+            dst[i * 4 + c] = ext[select[c]];
+    }
+}
+
+/// @brief Apply @a select to @a pixelCount pixels of any component type.
+///
+/// Channel counts are compile time constants; the per pixel work is a table
+/// lookup into the source pixel extended with 0 and @a one. @a dst may equal
+/// @a src.
+template <uint32_t SrcChannels, uint32_t DstChannels, typename T>
+inline void swizzlePixels(T* dst, const T* src, size_t pixelCount,
+                          const SwizzleSelect& select, T one) noexcept {
+    static_assert(SrcChannels <= 4 && DstChannels <= 4);
+    for (size_t i = 0; i < pixelCount; ++i, src += SrcChannels, dst += DstChannels) {
+        T ext[6] = {};
+        for (uint32_t c = 0; c < SrcChannels; ++c)
+            ext[c] = src[c];
+        ext[kSwizzleZero] = T{0};
+        ext[kSwizzleOne] = one;
+        for (uint32_t c = 0; c < DstChannels; ++c)
+            dst[c] = ext[select[c]];
+    }
+}
+
+// --- Tolerance compare ---------------------------------------------------------
+
+/// @brief Flag the texels of two RGBA32F rows that differ beyond a tolerance.
+///
+/// A channel matches when both values are equal, both are NaN, or their
+/// finite difference is within @a absTolerance or within @a relTolerance
+/// times the larger magnitude. @a mismatches[i] is set to 1 when any channel
+/// of texel i mismatches, 0 otherwise.
+///
+/// @return the number of mismatching texels.
+inline size_t compareRGBA32F(uint8_t* mismatches, const float* a, const float* b, size_t texelCount,
+        const float absTolerance[4], const float relTolerance[4]) noexcept {
+    size_t count = 0;
+    size_t i = 0;
+#if IMAGEIO_KERNELS_SSE2
+    const __m128 absTol = _mm_loadu_ps(absTolerance);
+    const __m128 relTol = _mm_loadu_ps(relTolerance);
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    const __m128 infinity = _mm_set1_ps(std::numeric_limits<float>::infinity());
+    for (; i < texelCount; ++i) {
+        const __m128 va = _mm_loadu_ps(a + i * 4);
+        const __m128 vb = _mm_loadu_ps(b + i * 4);
+        const __m128 diff = _mm_and_ps(_mm_sub_ps(va, vb), absMask);
+        const __m128 magnitude = _mm_max_ps(_mm_and_ps(va, absMask), _mm_and_ps(vb, absMask));
+        const __m128 tolerance = _mm_max_ps(absTol, _mm_mul_ps(relTol, magnitude));
+        const __m128 close = _mm_and_ps(_mm_cmple_ps(diff, tolerance), _mm_cmplt_ps(diff, infinity));
+        const __m128 bothNaN = _mm_and_ps(_mm_cmpunord_ps(va, va), _mm_cmpunord_ps(vb, vb));
+        const __m128 match = _mm_or_ps(_mm_or_ps(_mm_cmpeq_ps(va, vb), close), bothNaN);
+        const uint8_t mismatch = _mm_movemask_ps(match) != 0xF;
+        mismatches[i] = mismatch;
+        count += mismatch;
+    }
+#endif
+    for (; i < texelCount; ++i) {
+        uint8_t mismatch = 0;
+        for (uint32_t c = 0; c < 4; ++c) {
+            const float va = a[i * 4 + c];
+            const float vb = b[i * 4 + c];
+            const float diff = va > vb ? va - vb : vb - va;
+            const float magnitude = std::max(va < 0 ? -va : va, vb < 0 ? -vb : vb);
+            const bool close = diff <= std::max(absTolerance[c], relTolerance[c] * magnitude) &&
+                    diff < std::numeric_limits<float>::infinity();
+            if (!(va == vb || close || (va != va && vb != vb)))
+                mismatch = 1;
+        }
+        mismatches[i] = mismatch;
+        count += mismatch;
+    }
+    return count;
+}
+
+// --- Row band parallelism ------------------------------------------------------
+
+/// Below this many bytes of work a single thread is used as thread start up
+/// costs more than the conversion.
+inline constexpr size_t kMinParallelBytes = size_t{1} << 20;
+
+/// @brief Call @a func(firstRow, endRow) over disjoint bands covering
+/// [0, @a rowCount), concurrently when the work is large enough.
+///
+/// @a func must be safe to call concurrently on disjoint row ranges.
+/// Exceptions must not escape @a func.
+template <typename F>
+void forEachRowBand(uint32_t rowCount, size_t bytesPerRow, F&& func) {
+    const size_t totalBytes = bytesPerRow * rowCount;
+    uint32_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+    threadCount = static_cast<uint32_t>(std::min<size_t>(
+            {threadCount, rowCount, totalBytes / kMinParallelBytes + 1}));
+    if (threadCount <= 1) {
+        func(0u, rowCount);
+        return;
+    }
+
+    const uint32_t rowsPerBand = (rowCount + threadCount - 1) / threadCount;
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount - 1);
+    for (uint32_t first = rowsPerBand; first < rowCount; first += rowsPerBand)
+        workers.emplace_back([&func, first, rowsPerBand, rowCount] {
+            func(first, std::min(first + rowsPerBand, rowCount));
+        });
+    func(0u, std::min(rowsPerBand, rowCount));
+    for (auto& worker : workers)
+        worker.join();
+}
+
+} // namespace imageio
@@ -318,15 +318,7 @@ JpegInput::readScanline(void* bufferOut, size_t bufferByteCount, uint y, uint,
         } else { // targetChannelCount = 4
             if (bufferByteCount < scanlineByteCount * 4)
             throw buffer_too_small();
-            for (uint x = 0; x < spec().width(); x++)
-            {
-                uint8 luma = pScanline[x];
-                pDst[0] = luma;
-                pDst[1] = luma;
-                pDst[2] = luma;
-                pDst[3] = 255;
-                pDst += 4;
-            }
+            imageio::expandL8ToRGBA8(pDst, pScanline, spec().width());
         }
     } else if (inputChannelCount == 3) {
         if (targetChannelCount == 1) {
@@ -358,15 +350,28 @@ JpegInput::readScanline(void* bufferOut, size_t bufferByteCount, uint y, uint,
 /// @brief Read an entire image into contiguous memory performing conversions
 /// to @a format.
 ///
+/// The JPEG decoder only produces scanlines in order so this calls
+/// readScanline() directly rather than the default implementation, which
+/// reads native scanlines when no conversion is needed.
+///
 /// @sa readScanline() for supported conversions
 void JpegInput::readImage(void* bufferOut, size_t bufferByteCount,
                           uint subimage, uint miplevel,
                           const FormatDescriptor& format)
 {
+    const auto& targetFormat = format.isUnknown() ? spec().format() : format;
+    const size_t outScanlineByteCount
+           = targetFormat.pixelByteCount() * spec().width();
+    if (bufferByteCount < outScanlineByteCount * spec().height())
+        throw buffer_too_small();
+
     pJd->begin_decoding();
     decodingBegun = true;
-    ImageInput::readImage(bufferOut, bufferByteCount,
-                          subimage, miplevel,
-                          format);
+    uint8_t* pDst = static_cast<uint8_t*>(bufferOut);
+    for (uint32_t y = 0; y < spec().height(); y++) {
+        readScanline(pDst, outScanlineByteCount,
+                     y, 0, subimage, miplevel, targetFormat);
+        pDst += outScanlineByteCount;
+    }
 }
 
@@ -300,6 +300,9 @@ PngInput::readHeader()
 ///   R=G=B=GREY. ALPHA goes to A and vice versa. If none in the source,
 ///   1.0 is used.
 ///
+/// 8- and 16-bit files without a transparency key are inflated in their own
+/// color mode and widened to the requested format with row kernels.
+///
 /// If the PNG file has an sBit chunk the normalized results are adjusted
 /// accordingly.
 void
@@ -337,43 +340,91 @@ PngInput::readImage(void* bufferOut, size_t bufferOutByteCount,
                 targetF ? " Float" : "")
               );
 
-    state.info_raw.bitdepth = requestBits;
-    state.info_raw.colortype = [&]{
-        switch (targetFormat.channelCount()) {
-        case 1:
-            return LCT_GREY;
-        case 2:
-            return LCT_GREY_ALPHA;
-        case 3:
-            return LCT_RGB;
-        case 4:
-            return LCT_RGBA;
+    const auto& fileColor = state.info_png.color;
+    const bool fileIsDirect = !fileColor.key_defined
+        && (fileColor.bitdepth == 8 || fileColor.bitdepth == 16)
+        && (fileColor.colortype == LCT_GREY || fileColor.colortype == LCT_GREY_ALPHA
+            || fileColor.colortype == LCT_RGB || fileColor.colortype == LCT_RGBA);
+    imageio::RowConverter converter = nullptr;
+    if (fileIsDirect && (fileColor.bitdepth != requestBits
+                         || spec().format().channelCount() != channelCount)) {
+        converter = imageio::selectUNORMRowConverter(
+                spec().format().channelCount(), fileColor.bitdepth,
+                channelCount, requestBits);
+    }
+
+    if (converter != nullptr) {
+        // Inflate in the file's own color mode, which lodepng does without
+        // its generic per pixel color conversion, then widen with a kernel.
+        lodepng_color_mode_copy(&state.info_raw, &fileColor);
+        const size_t nativeScanlineByteCount = spec().scanlineByteCount();
+        std::vector<uint8_t> nativeImage(nativeScanlineByteCount * height);
+        auto lodepngError = lodepng_finish_decode(nativeImage.data(),
+                                                  nativeImage.size(),
+                                                  width,
+                                                  height,
+                                                  &state,
+                                                  pIdat,
+                                                  idatsize);
+        if (lodepngError)
+            throw std::runtime_error(fmt::format(
+                    "PNG decode error: {}.", lodepng_error_text(lodepngError)));
+
+        const size_t outScanlineByteCount = targetFormat.pixelByteCount() * width;
+        if (bufferOutByteCount < outScanlineByteCount * height)
+            throw buffer_too_small();
+
+        auto* pDst = static_cast<uint8_t*>(bufferOut);
+        imageio::forEachRowBand(height, outScanlineByteCount,
+            [&](uint32_t firstRow, uint32_t endRow) {
+                for (uint32_t y = firstRow; y < endRow; ++y) {
+                    uint8_t* pNative = nativeImage.data() + nativeScanlineByteCount * y;
+                    // LodePNG loads 16 bit channels in big endian order
+                    if (fileColor.bitdepth == 16)
+                        for (size_t i = 0; i < nativeScanlineByteCount; i += 2)
+                            std::swap(pNative[i], pNative[i + 1]);
+                    converter(pDst + outScanlineByteCount * y, pNative, width);
+                }
+            });
+    } else {
+        state.info_raw.bitdepth = requestBits;
+        state.info_raw.colortype = [&]{
+            switch (targetFormat.channelCount()) {
+            case 1:
+                return LCT_GREY;
+            case 2:
+                return LCT_GREY_ALPHA;
+            case 3:
+                return LCT_RGB;
+            case 4:
+                return LCT_RGBA;
+            }
+            throw std::runtime_error(fmt::format(
+                    "PNG decode error: Requested decode into {} channels is not supported.",
+                    targetFormat.channelCount())
+                  );
+        }();
+        auto lodepngError = lodepng_finish_decode(
+                                              (unsigned char*)bufferOut,
+                                              bufferOutByteCount,
+                                              width,
+                                              height,
+                                              &state,
+                                              pIdat,
+                                              idatsize);
+
+        if (lodepngError)
+            throw std::runtime_error(fmt::format(
+                    "PNG decode error: {}.", lodepng_error_text(lodepngError)));
+
+        // TODO: Detect endianness
+        // if constexpr (std::endian::native == std::endian::little)
+        if (requestBits == 16) {
+            // LodePNG loads 16 bit channels in big endian order
+            auto* data = (unsigned char*) bufferOut;
+            for (size_t i = 0; i < bufferOutByteCount; i += 2)
+                std::swap(*(data + i), *(data + i + 1));
         }
-        throw std::runtime_error(fmt::format(
-                "PNG decode error: Requested decode into {} channels is not supported.",
-                targetFormat.channelCount())
-              );
-    }();
-    auto lodepngError = lodepng_finish_decode(
-                                          (unsigned char*)bufferOut,
-                                          bufferOutByteCount,
-                                          width,
-                                          height,
-                                          &state,
-                                          pIdat,
-                                          idatsize);
-
-    if (lodepngError)
-        throw std::runtime_error(fmt::format(
-                "PNG decode error: {}.", lodepng_error_text(lodepngError)));
-
-    // TODO: Detect endianness
-    // if constexpr (std::endian::native == std::endian::little)
-    if (requestBits == 16) {
-        // LodePNG loads 16 bit channels in big endian order
-        auto* data = (unsigned char*) bufferOut;
-        for (size_t i = 0; i < bufferOutByteCount; i += 2)
-            std::swap(*(data + i), *(data + i + 1));
     }
 
     if (state.info_png.sbit_defined) {
@@ -249,6 +249,32 @@ class TgaInput final : public ImageInput {
         uint8_t* out_current_row_ptr = static_cast<uint8_t*>(bufferOut);
         std::vector<uint8_t> tgaScanlineBuffer(tgaFileSpec.scanlineByteCount());
 
+        // Whole row conversions chosen once for the common layouts.
+        const bool sameLayout = tga_channels == dest_channels &&
+                                tga_bytes_per_pixel == dest_bytes_per_pixel;
+        const imageio::RowConverter rowConverter =
+            tga_channels != 0 && tga_bytes_per_pixel % tga_channels == 0 &&
+                    dest_channels != 0 && dest_bytes_per_pixel % dest_channels == 0
+                ? imageio::selectUNORMRowConverter(
+                      tga_channels, tga_bytes_per_pixel / tga_channels * 8, dest_channels,
+                      dest_bytes_per_pixel / dest_channels * 8)
+                : nullptr;
+        if (sameLayout || rowConverter != nullptr) {
+            const size_t out_row_bytes = static_cast<size_t>(tga_width) * dest_bytes_per_pixel;
+            for (uint32_t y = 0; y < tga_height; ++y) {
+                if (sameLayout) {
+                    readNativeScanline(out_current_row_ptr, out_row_bytes, y, 0, subimage,
+                                       miplevel);
+                } else {
+                    readNativeScanline(tgaScanlineBuffer.data(), tgaScanlineBuffer.size(), y, 0,
+                                       subimage, miplevel);
+                    rowConverter(out_current_row_ptr, tgaScanlineBuffer.data(), tga_width);
+                }
+                out_current_row_ptr += out_row_bytes;
+            }
+            return;
+        }
+
         for (uint32_t y = 0; y < tga_height; ++y) {
             if (tgaScanlineBuffer.empty() && tga_width > 0) {
                 throw std::runtime_error(
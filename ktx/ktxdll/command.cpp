@@ -8,6 +8,9 @@
 #include "version.h"
 #include "ktx.h"
 #include "sbufstream.h"
+#include "ktxint.h"
+#include "texture2.h"
+#include <cassert>
 #include <stdio.h>
 #include <filesystem>
 #include <iostream>
@@ -22,6 +25,11 @@
 
 namespace ktx {
 
+CommandStreams& threadCommandStreams() {
+    thread_local CommandStreams streams;
+    return streams;
+}
+
 void Command::parseCommandLine(const std::string& name, const std::string& desc, int argc, char* argv[]) {
     commandName = name;
     commandDescription = desc;
@@ -192,6 +200,16 @@ void OutputStream::writeKTX2(ktxTexture* texture, Reporter& report) {
     // }
 }
 
+void OutputStream::writeKTX2Deflated(ktxTexture2* texture, ktxSupercmpScheme scheme, uint32_t compressionLevel,
+        Reporter& report) {
+    assert(file != stdout);
+    const auto ret = ktxTexture2_WriteDeflatedToStdioStream(texture, file, scheme, compressionLevel);
+    if (KTX_SUCCESS != ret) {
+        std::filesystem::remove(DecodeUTF8Path(filepath).c_str());
+        report.fatal(rc::IO_FAILURE, "Failed to write KTX file \"{}\": KTX error: {}.", filepath, ktxErrorString(ret));
+    }
+}
+
 // -------------------------------------------------------------------------------------------------
 
 } // namespace ktx
@@ -7,8 +7,13 @@
 
 #include "stdafx.h"
 #include <string>
+#include <string_view>
 #include <vector>
+#include <fstream>
 #include <iostream>
+#include <mutex>
+#include <thread>
+#include <utility>
 #include "utility.h"
 
 #include <cxxopts.hpp>
@@ -90,37 +95,117 @@ struct FatalError : public std::exception {
     explicit FatalError(ReturnCode returnCode) : returnCode(returnCode) {}
 };
 
+enum class LogLevel {
+    info,
+    warning,
+    error,
+    fatal,
+};
+
+[[nodiscard]] constexpr inline std::string_view toString(LogLevel value) noexcept {
+    switch (value) {
+    case LogLevel::info: return "info";
+    case LogLevel::warning: return "warning";
+    case LogLevel::error: return "error";
+    case LogLevel::fatal: return "fatal";
+    }
+    return "";
+}
+
+/// Receives the diagnostics of commands as structured records instead of formatted text.
+/// Called from the worker threads of a command as well, but never concurrently for one command.
+class LogSink {
+public:
+    virtual ~LogSink() = default;
+    virtual void log(LogLevel level, const std::string& command, const std::string& message) = 0;
+};
+
+/// Text streams a command invocation prints its results and diagnostics to.
+struct CommandStreams {
+    std::ostream* out = &std::cout;
+    std::ostream* err = &std::cerr;
+    /// If set, diagnostics are passed to it instead of being printed to @c err.
+    LogSink* log = nullptr;
+};
+
+/// Streams of the command invocations started on the calling thread.
+/// std::cout and std::cerr unless overridden with a ScopedCommandStreams.
+[[nodiscard]] CommandStreams& threadCommandStreams();
+
+/// Routes the text output of the command invocations started on the calling thread to
+/// @p streams for the lifetime of the object, so concurrent invocations on different threads
+/// do not share the process wide standard streams.
+class ScopedCommandStreams {
+    CommandStreams previous;
+
+public:
+    explicit ScopedCommandStreams(CommandStreams streams) :
+        previous(std::exchange(threadCommandStreams(), streams)) {}
+    ~ScopedCommandStreams() {
+        threadCommandStreams() = previous;
+    }
+    ScopedCommandStreams(const ScopedCommandStreams&) = delete;
+    ScopedCommandStreams& operator=(const ScopedCommandStreams&) = delete;
+};
+
 struct Reporter {
     std::string commandName;
     std::string commandDescription;
+    /// Captured on construction, so the worker threads of a command report to the streams of the
+    /// thread that started it.
+    CommandStreams streams = threadCommandStreams();
+
+private:
+    std::mutex streamMutex;
+
+public:
+    /// Stream of the regular output of the command.
+    std::ostream& cout() {
+        return *streams.out;
+    }
+
+    /// Stream of the diagnostics of the command.
+    std::ostream& cerr() {
+        return *streams.err;
+    }
+
+    /// Writes @p text to @p os as a single operation, so lines printed by concurrent worker
+    /// threads of the command are not interleaved.
+    void print(std::ostream& os, const std::string& text) {
+        std::lock_guard<std::mutex> lock(streamMutex);
+        os << text;
+        os.flush();
+    }
+
+    /// Reports a diagnostic message to the log sink or prints it to the diagnostics stream.
+    void log(LogLevel level, const std::string& message) {
+        if (streams.log) {
+            std::lock_guard<std::mutex> lock(streamMutex);
+            streams.log->log(level, commandName, message);
+        } else {
+            print(cerr(), fmt::format("{} {}: {}\n", commandName, toString(level), message));
+        }
+    }
 
     template <typename... Args>
     void warning(Args&&... args) {
-        fmt::print(std::cerr, "{} warning: ", commandName);
-        fmt::print(std::cerr, std::forward<Args>(args)...);
-        fmt::print(std::cerr, "\n");
+        log(LogLevel::warning, fmt::format(std::forward<Args>(args)...));
     }
 
     template <typename... Args>
     void error(Args&&... args) {
-        fmt::print(std::cerr, "{} error: ", commandName);
-        fmt::print(std::cerr, std::forward<Args>(args)...);
-        fmt::print(std::cerr, "\n");
+        log(LogLevel::error, fmt::format(std::forward<Args>(args)...));
     }
 
     template <typename... Args>
     void fatal(ReturnCode return_code, Args&&... args) {
-        fmt::print(std::cerr, "{} fatal: ", commandName);
-        fmt::print(std::cerr, std::forward<Args>(args)...);
-        fmt::print(std::cerr, "\n");
+        log(LogLevel::fatal, fmt::format(std::forward<Args>(args)...));
         throw FatalError(return_code);
     }
 
     template <typename... Args>
     void fatal_usage(Args&&... args) {
-        fmt::print(std::cerr, "{} fatal: ", commandName);
-        fmt::print(std::cerr, std::forward<Args>(args)...);
-        fmt::print(std::cerr, " See '{} --help'.\n", commandName);
+        log(LogLevel::fatal, fmt::format("{} See '{} --help'.", fmt::format(std::forward<Args>(args)...), commandName));
         throw FatalError(rc::INVALID_ARGUMENTS);
     }
 };
@@ -177,13 +262,13 @@ struct OptionsGeneric {
         testrun = args["testrun"].as<bool>();
 
         if (args.count("help")) {
-            fmt::print("{}: {}\n", report.commandName, report.commandDescription);
-            fmt::print("{}", opts.help());
+            fmt::print(report.cout(), "{}: {}\n", report.commandName, report.commandDescription);
+            fmt::print(report.cout(), "{}", opts.help());
             throw FatalError(rc::SUCCESS);
         }
 
         if (args.count("version")) {
-            fmt::print("{} version: {}\n", opts.program(), version(testrun));
+            fmt::print(report.cout(), "{} version: {}\n", opts.program(), version(testrun));
             throw FatalError(rc::SUCCESS);
         }
     }
@@ -262,6 +347,77 @@ struct OptionsSingleIn {
     }
 };
 
+/**
+//! [command options_multi_in]
+<dl>
+    <dt>\--input-list &lt;filepath&gt;</dt>
+    <dd>Response file listing additional input files, one path per line. Empty lines are ignored.
+        Specifying more than one input file or an input list processes the files in bulk.</dd>
+    <dt>\--threads &lt;count&gt;</dt>
+    <dd>Number of threads used to process the input files in bulk. By default the number of
+        threads reported by @c thread::hardware_concurrency or 1 if value returned is 0.</dd>
+</dl>
+//! [command options_multi_in]
+*/
+struct OptionsMultiIn {
+    inline static const char* kInputList = "input-list";
+    inline static const char* kThreads = "threads";
+
+    std::vector<std::string> inputFilepaths;
+    bool bulk = false;
+    uint32_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    void init(cxxopts::Options& opts) {
+        opts.add_options()
+                ("stdin", "Use stdin as the input file. (Using a single dash '-' as the input file has the same effect)")
+                ("i,input-file", "The input file(s). Using a single dash '-' as the input file will use stdin.", cxxopts::value<std::vector<std::string>>(), "filepath")
+                (kInputList, "Response file listing additional input files, one path per line.", cxxopts::value<std::string>(), "filepath")
+                (kThreads, "Number of threads used to process the input files in bulk. By default the number of "
+                        "threads reported by thread::hardware_concurrency or 1 if value returned is 0.",
+                        cxxopts::value<uint32_t>(), "<count>");
+        opts.parse_positional("input-file");
+        opts.positional_help("<input-file...>");
+    }
+
+    void process(cxxopts::Options&, cxxopts::ParseResult& args, Reporter& report) {
+        if (!args.unmatched().empty())
+            report.fatal_usage("Too many filenames specified.");
+
+        if (args.count("stdin"))
+            inputFilepaths.emplace_back("-");
+        if (args.count("input-file")) {
+            const auto& argFiles = args["input-file"].as<std::vector<std::string>>();
+            inputFilepaths.insert(inputFilepaths.end(), argFiles.begin(), argFiles.end());
+        }
+
+        if (args.count(kInputList)) {
+            const auto& listFilepath = args[kInputList].as<std::string>();
+            std::ifstream list(listFilepath);
+            if (!list)
+                report.fatal(rc::IO_FAILURE, "Could not open input list \"{}\": {}.", listFilepath, errnoMessage());
+            for (std::string line; std::getline(list, line);) {
+                if (!line.empty() && line.back() == '\r')
+                    line.pop_back();
+                if (!line.empty())
+                    inputFilepaths.emplace_back(std::move(line));
+            }
+        }
+
+        if (inputFilepaths.empty())
+            report.fatal_usage("Missing input file. Either <input-file>, --stdin or --{} must be specified.", kInputList);
+
+        bulk = inputFilepaths.size() > 1 || args.count(kInputList);
+        if (bulk && std::count(inputFilepaths.begin(), inputFilepaths.end(), "-") != 0)
+            report.fatal_usage("'-' or --stdin cannot be used together with multiple input files.");
+
+        if (args[kThreads].count()) {
+            threadCount = args[kThreads].as<uint32_t>();
+            if (threadCount == 0)
+                report.fatal_usage("Invalid --{} argument: \"0\".", kThreads);
+        }
+    }
+};
+
 struct OptionsSingleInSingleOut {
     std::string inputFilepath;
     std::string outputFilepath;
@@ -397,6 +553,9 @@ public:
     }
 
     void writeKTX2(ktxTexture* texture, Reporter& report);
+    /// Deflates @p texture level by level while writing it. Requires a seekable output file.
+    void writeKTX2Deflated(ktxTexture2* texture, ktxSupercmpScheme scheme, uint32_t compressionLevel,
+            Reporter& report);
     void write(const char* data, std::size_t size, Reporter& report);
 };
 
@@ -0,0 +1,771 @@
+// Copyright 2022-2023 The Khronos Group Inc.
+// Copyright 2022-2023 RasterGrid Kft.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "command.h"
+#include "platform_utils.h"
+#include "encode_utils_astc.h"
+#include "encode_utils_basis.h"
+#include "format_descriptor.h"
+#include "formats.h"
+#include "metrics_utils.h"
+#include "sbufstream.h"
+#include "utility.h"
+#include "validate.h"
+#include "ktx.h"
+#include "image.hpp"
+#include "imageio.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <cxxopts.hpp>
+#include <fmt/ostream.h>
+#include <fmt/printf.h>
+
+
+// -------------------------------------------------------------------------------------------------
+
+namespace ktx {
+
+// -------------------------------------------------------------------------------------------------
+
+/** @page ktx_bench ktx bench
+@~English
+
+Measure encoder, supercompression and transcoder throughput and quality.
+
+@section ktx_bench_synopsis SYNOPSIS
+    ktx bench [option...] @e input-file...
+
+@section ktx_bench_description DESCRIPTION
+    @b ktx @b bench encodes each @e input-file with every configuration of the
+    matrix specified by the options below and reports one record per measured
+    operation as CSV or JSON.
+
+    An @e input-file is either an 8-bit PNG, JPEG, TGA or PNM image, which is
+    loaded as R8G8B8A8_SRGB, or a KTX2 file in one of the formats accepted by
+    @ref ktx_encode "ktx encode": R8, R8G8, R8G8B8 or R8G8B8A8 (or their sRGB
+    variants) without supercompression.
+
+    Each record has the following fields:
+    <dl>
+        <dt>input</dt>
+        <dd>The input file.</dd>
+        <dt>operation</dt>
+        <dd>@b load, @b encode, @b deflate or @b transcode.</dd>
+        <dt>codec, settings</dt>
+        <dd>The encoder (astc, etc1s or uastc) and its settings.</dd>
+        <dt>threads</dt>
+        <dd>Encoder thread count. Deflation and transcoding are single threaded.</dd>
+        <dt>zstd, target</dt>
+        <dd>The Zstandard level of @b deflate and the target of @b transcode records.</dd>
+        <dt>seconds, mpix_per_sec</dt>
+        <dd>Fastest time of the operation over the @b \--repeat runs and the
+            corresponding throughput in megapixels of the whole texture
+            (all levels, layers, faces and depth slices) per second.</dd>
+        <dt>bytes, bytes_per_pixel</dt>
+        <dd>Size of the resulting KTX2 file for @b encode and @b deflate records.</dd>
+        <dt>psnr, ssim</dt>
+        <dd>Mean luma PSNR and mean SSIM over the channels of the input of the
+            decoded @b encode result against the input.</dd>
+        <dt>peak_rss_mib</dt>
+        <dd>Peak resident set size of the process after the operation. It never
+            decreases, so compare it between separate runs to attribute it to a
+            single configuration.</dd>
+    </dl>
+
+@section ktx\_bench\_options OPTIONS
+    The following options are available:
+    <dl>
+        <dt>\--astc-block &lt;list&gt;</dt>
+        <dd>Comma separated ASTC block sizes to encode, e.g. 4x4,6x6,8x8.</dd>
+        <dt>\--astc-quality &lt;list&gt;</dt>
+        <dd>Comma separated ASTC quality presets to encode with each block size:
+            fastest | fast | medium | thorough | exhaustive. Default: medium.</dd>
+        <dt>\--etc1s-qlevel &lt;list&gt;</dt>
+        <dd>Comma separated BasisLZ/ETC1S quality levels [1, 255] to encode.</dd>
+        <dt>\--uastc-quality &lt;list&gt;</dt>
+        <dd>Comma separated UASTC quality levels [0, 4] to encode.</dd>
+        <dt>\--uastc-rdo &lt;list&gt;</dt>
+        <dd>Comma separated UASTC RDO settings combined with each UASTC quality
+            level: @b off or an RDO quality scalar (lambda) [0.001, 50.0].
+            Default: off.</dd>
+        <dt>\--zstd &lt;list&gt;</dt>
+        <dd>Comma separated Zstandard levels [1, 22] to deflate the ASTC and
+            UASTC encodings with.</dd>
+        <dt>\--target &lt;list&gt;</dt>
+        <dd>Comma separated transcode targets for the ETC1S and UASTC
+            encodings: etc-rgb | etc-rgba | eac-r11 | eac-rg11 | bc1 | bc3 |
+            bc4 | bc5 | bc7 | astc | rgba8.</dd>
+        <dt>\--threads &lt;list&gt;</dt>
+        <dd>Comma separated encoder thread counts. By default the number of
+            threads reported by @c thread::hardware_concurrency.</dd>
+        <dt>\--repeat &lt;count&gt;</dt>
+        <dd>Number of times each operation is run. The fastest run is reported.
+            Default: 1.</dd>
+        <dt>\--no-quality</dt>
+        <dd>Skip the PSNR and SSIM measurements.</dd>
+        <dt>\--format csv | json | mini-json</dt>
+        <dd>Report format. Default: csv.</dd>
+        <dt>-o, \--output &lt;filepath&gt;</dt>
+        <dd>Write the report to a file instead of the stdout.</dd>
+    </dl>
+    At least one of @b \--astc-block, @b \--etc1s-qlevel and @b \--uastc-quality
+    must be specified.
+    @snippet{doc} ktx/command.h command options_generic
+
+@section ktx_bench_exitstatus EXIT STATUS
+    @snippet{doc} ktx/command.h command exitstatus
+
+@section ktx_bench_history HISTORY
+
+@par Version 4.4
+ - Initial version
+*/
+class CommandBench : public Command {
+    enum class ReportFormat {
+        csv,
+        json,
+        json_mini,
+    };
+
+    struct OptionsBench {
+        inline static const char* kAstcBlock = "astc-block";
+        inline static const char* kAstcQuality = "astc-quality";
+        inline static const char* kEtc1sQLevel = "etc1s-qlevel";
+        inline static const char* kUastcQuality = "uastc-quality";
+        inline static const char* kUastcRdo = "uastc-rdo";
+        inline static const char* kZstd = "zstd";
+        inline static const char* kTarget = "target";
+        inline static const char* kThreads = "threads";
+        inline static const char* kRepeat = "repeat";
+        inline static const char* kNoQuality = "no-quality";
+        inline static const char* kFormat = "format";
+        inline static const char* kOutput = "output";
+
+        std::vector<std::string> inputFilepaths;
+        std::vector<std::pair<std::string, ktx_pack_astc_block_dimension_e>> astcBlocks;
+        std::vector<std::pair<std::string, ktx_pack_astc_quality_levels_e>> astcQualities;
+        std::vector<uint32_t> etc1sQLevels;
+        std::vector<uint32_t> uastcQualities;
+        /// Empty for RDO off
+        std::vector<std::optional<float>> uastcRdos;
+        std::vector<uint32_t> zstdLevels;
+        std::vector<std::pair<std::string, ktx_transcode_fmt_e>> targets;
+        std::vector<uint32_t> threadCounts;
+        uint32_t repeat = 1;
+        bool quality = true;
+        ReportFormat format = ReportFormat::csv;
+        std::string outputFilepath;
+
+        void init(cxxopts::Options& opts);
+        void process(cxxopts::Options& opts, cxxopts::ParseResult& args, Reporter& report);
+    };
+
+    Combine<OptionsBench, OptionsGeneric> options;
+
+    /// One loaded input and the reference its encodings are measured against
+    struct Input {
+        std::string filepath;
+        KTXTexture2 texture{nullptr};
+        uint32_t numChannels = 0;
+        uint64_t pixelCount = 0;
+        MetricsCalculator metrics;
+    };
+
+    /// One record of the report
+    struct Result {
+        std::string input;
+        std::string operation;
+        std::string codec;
+        std::string settings;
+        uint32_t threads = 1;
+        std::optional<uint32_t> zstd;
+        std::string target;
+        double seconds = 0.0;
+        double mpixPerSec = 0.0;
+        std::optional<uint64_t> bytes;
+        std::optional<double> bytesPerPixel;
+        std::optional<float> psnr;
+        std::optional<float> ssim;
+        double peakRssMiB = 0.0;
+    };
+
+    std::vector<Result> results;
+
+public:
+    virtual int main(int argc, char* argv[]) override;
+    virtual void initOptions(cxxopts::Options& opts) override;
+    virtual void processOptions(cxxopts::Options& opts, cxxopts::ParseResult& args) override;
+
+private:
+    void executeBench();
+    [[nodiscard]] Input loadInput(const std::string& filepath);
+    void benchEncoding(Input& input, const std::string& codec, const std::string& settings, uint32_t threads,
+            bool measureFollowUps, const std::function<ktx_error_code_e(KTXTexture2&)>& encode);
+
+    [[nodiscard]] KTXTexture2 copyTexture(KTXTexture2& texture);
+    [[nodiscard]] uint64_t fileSize(KTXTexture2& texture);
+    /// Runs @a operation on a fresh copy of @a source options.repeat times and keeps the last
+    /// result in @a output. Returns the fastest time in seconds.
+    double timeOperation(KTXTexture2& source, KTXTexture2& output,
+            const std::function<ktx_error_code_e(KTXTexture2&)>& operation, const char* name);
+    void addResult(Result&& result, const Input& input);
+
+    void printCSV(std::ostream& os) const;
+    void printJSON(std::ostream& os) const;
+};
+
+// -------------------------------------------------------------------------------------------------
+
+int CommandBench::main(int argc, char* argv[]) {
+    try {
+        parseCommandLine("ktx bench",
+                "Measure encoder, supercompression and transcoder throughput and quality\n"
+                "    of the input-files over a matrix of encoder settings.",
+                argc, argv);
+        executeBench();
+        return +rc::SUCCESS;
+    } catch (const FatalError& error) {
+        return +error.returnCode;
+    } catch (const std::exception& e) {
+        log(LogLevel::fatal, e.what());
+        return +rc::RUNTIME_ERROR;
+    }
+}
+
+void CommandBench::OptionsBench::init(cxxopts::Options& opts) {
+    opts.add_options()
+        ("i,input-file", "The input files. 8-bit PNG, JPEG, TGA or PNM images or uncompressed 8-bit KTX2 files.",
+                cxxopts::value<std::vector<std::string>>(), "filepath")
+        (kAstcBlock, "Comma separated ASTC block sizes, e.g. 4x4,6x6,8x8.",
+                cxxopts::value<std::vector<std::string>>(), "<list>")
+        (kAstcQuality, "Comma separated ASTC quality presets: fastest | fast | medium | thorough | exhaustive."
+                " Default: medium.", cxxopts::value<std::vector<std::string>>(), "<list>")
+        (kEtc1sQLevel, "Comma separated BasisLZ/ETC1S quality levels [1, 255].",
+                cxxopts::value<std::vector<uint32_t>>(), "<list>")
+        (kUastcQuality, "Comma separated UASTC quality levels [0, 4].",
+                cxxopts::value<std::vector<uint32_t>>(), "<list>")
+        (kUastcRdo, "Comma separated UASTC RDO settings: off or an RDO quality scalar [0.001, 50.0]. Default: off.",
+                cxxopts::value<std::vector<std::string>>(), "<list>")
+        (kZstd, "Comma separated Zstandard levels [1, 22] for the ASTC and UASTC encodings.",
+                cxxopts::value<std::vector<uint32_t>>(), "<list>")
+        (kTarget, "Comma separated transcode targets for the ETC1S and UASTC encodings: etc-rgb | etc-rgba |"
+                " eac-r11 | eac-rg11 | bc1 | bc3 | bc4 | bc5 | bc7 | astc | rgba8.",
+                cxxopts::value<std::vector<std::string>>(), "<list>")
+        (kThreads, "Comma separated encoder thread counts. Default: the number of hardware threads.",
+                cxxopts::value<std::vector<uint32_t>>(), "<list>")
+        (kRepeat, "Number of runs of each operation. The fastest is reported. Default: 1.",
+                cxxopts::value<uint32_t>(), "<count>")
+        (kNoQuality, "Skip the PSNR and SSIM measurements.")
+        (kFormat, "Report format: csv | json | mini-json. Default: csv.",
+                cxxopts::value<std::string>()->default_value("csv"), "csv|json|mini-json")
+        ("o,output", "Write the report to a file instead of the stdout.",
+                cxxopts::value<std::string>(), "filepath");
+    opts.parse_positional("input-file");
+    opts.positional_help("<input-file...>");
+}
+
+void CommandBench::OptionsBench::process(cxxopts::Options&, cxxopts::ParseResult& args, Reporter& report) {
+    if (!args.unmatched().empty())
+        report.fatal_usage("Unrecognized arguments.");
+
+    if (args.count("input-file"))
+        inputFilepaths = args["input-file"].as<std::vector<std::string>>();
+    if (inputFilepaths.empty())
+        report.fatal_usage("Missing input file.");
+
+    static const std::unordered_map<std::string, ktx_pack_astc_block_dimension_e> blockMapping{
+        {"4x4", KTX_PACK_ASTC_BLOCK_DIMENSION_4x4},
+        {"5x4", KTX_PACK_ASTC_BLOCK_DIMENSION_5x4},
+        {"5x5", KTX_PACK_ASTC_BLOCK_DIMENSION_5x5},
+        {"6x5", KTX_PACK_ASTC_BLOCK_DIMENSION_6x5},
+        {"6x6", KTX_PACK_ASTC_BLOCK_DIMENSION_6x6},
+        {"8x5", KTX_PACK_ASTC_BLOCK_DIMENSION_8x5},
+        {"8x6", KTX_PACK_ASTC_BLOCK_DIMENSION_8x6},
+        {"8x8", KTX_PACK_ASTC_BLOCK_DIMENSION_8x8},
+        {"10x5", KTX_PACK_ASTC_BLOCK_DIMENSION_10x5},
+        {"10x6", KTX_PACK_ASTC_BLOCK_DIMENSION_10x6},
+        {"10x8", KTX_PACK_ASTC_BLOCK_DIMENSION_10x8},
+        {"10x10", KTX_PACK_ASTC_BLOCK_DIMENSION_10x10},
+        {"12x10", KTX_PACK_ASTC_BLOCK_DIMENSION_12x10},
+        {"12x12", KTX_PACK_ASTC_BLOCK_DIMENSION_12x12},
+    };
+    if (args[kAstcBlock].count()) {
+        for (const auto& value : args[kAstcBlock].as<std::vector<std::string>>()) {
+            const auto block = to_lower_copy(value);
+            const auto it = blockMapping.find(block);
+            if (it == blockMapping.end())
+                report.fatal_usage("Invalid --{} value: \"{}\".", kAstcBlock, value);
+            astcBlocks.emplace_back(block, it->second);
+        }
+    }
+
+    if (args[kAstcQuality].count()) {
+        if (astcBlocks.empty())
+            report.fatal_usage("--{} requires --{}.", kAstcQuality, kAstcBlock);
+        for (const auto& value : args[kAstcQuality].as<std::vector<std::string>>()) {
+            const auto name = to_lower_copy(value);
+            const auto it = std::find_if(std::begin(OptionsEncodeASTC::kAstcQualitySteps),
+                    std::end(OptionsEncodeASTC::kAstcQualitySteps),
+                    [&](const auto& step) { return name == step.first; });
+            if (it == std::end(OptionsEncodeASTC::kAstcQualitySteps))
+                report.fatal_usage("Invalid --{} value: \"{}\".", kAstcQuality, value);
+            astcQualities.emplace_back(it->first, it->second);
+        }
+    } else {
+        astcQualities.emplace_back("medium", KTX_PACK_ASTC_QUALITY_LEVEL_MEDIUM);
+    }
+
+    if (args[kEtc1sQLevel].count()) {
+        etc1sQLevels = args[kEtc1sQLevel].as<std::vector<uint32_t>>();
+        for (const auto level : etc1sQLevels)
+            if (level < 1 || level > 255)
+                report.fatal_usage("Invalid --{} value: \"{}\". The range is [1, 255].", kEtc1sQLevel, level);
+    }
+
+    if (args[kUastcQuality].count()) {
+        uastcQualities = args[kUastcQuality].as<std::vector<uint32_t>>();
+        for (const auto level : uastcQualities)
+            if (level > KTX_PACK_UASTC_MAX_LEVEL)
+                report.fatal_usage("Invalid --{} value: \"{}\". The range is [0, {}].", kUastcQuality, level,
+                        +KTX_PACK_UASTC_MAX_LEVEL);
+    }
+
+    if (args[kUastcRdo].count()) {
+        if (uastcQualities.empty())
+            report.fatal_usage("--{} requires --{}.", kUastcRdo, kUastcQuality);
+        for (const auto& value : args[kUastcRdo].as<std::vector<std::string>>()) {
+            if (to_lower_copy(value) == "off") {
+                uastcRdos.emplace_back(std::nullopt);
+                continue;
+            }
+            float lambda = 0.0f;
+            try {
+                std::size_t end = 0;
+                lambda = std::stof(value, &end);
+                if (end != value.size())
+                    throw std::invalid_argument(value);
+            } catch (const std::exception&) {
+                report.fatal_usage("Invalid --{} value: \"{}\".", kUastcRdo, value);
+            }
+            if (!(lambda >= 0.001f && lambda <= 50.0f))
+                report.fatal_usage("Invalid --{} value: \"{}\". The range is [0.001, 50.0].", kUastcRdo, value);
+            uastcRdos.emplace_back(lambda);
+        }
+    } else {
+        uastcRdos.emplace_back(std::nullopt);
+    }
+
+    if (astcBlocks.empty() && etc1sQLevels.empty() && uastcQualities.empty())
+        report.fatal_usage("At least one of --{}, --{} and --{} must be specified.",
+                kAstcBlock, kEtc1sQLevel, kUastcQuality);
+
+    if (args[kZstd].count()) {
+        zstdLevels = args[kZstd].as<std::vector<uint32_t>>();
+        for (const auto level : zstdLevels)
+            if (level < 1 || level > 22)
+                report.fatal_usage("Invalid --{} value: \"{}\". The range is [1, 22].", kZstd, level);
+    }
+
+    static const std::unordered_map<std::string, ktx_transcode_fmt_e> targetMapping{
+        {"etc-rgb", KTX_TTF_ETC1_RGB},
+        {"etc-rgba", KTX_TTF_ETC2_RGBA},
+        {"eac-r11", KTX_TTF_ETC2_EAC_R11},
+        {"eac-rg11", KTX_TTF_ETC2_EAC_RG11},
+        {"bc1", KTX_TTF_BC1_RGB},
+        {"bc3", KTX_TTF_BC3_RGBA},
+        {"bc4", KTX_TTF_BC4_R},
+        {"bc5", KTX_TTF_BC5_RG},
+        {"bc7", KTX_TTF_BC7_RGBA},
+        {"astc", KTX_TTF_ASTC_4x4_RGBA},
+        {"rgba8", KTX_TTF_RGBA32},
+    };
+    if (args[kTarget].count()) {
+        for (const auto& value : args[kTarget].as<std::vector<std::string>>()) {
+            const auto name = to_lower_copy(value);
+            const auto it = targetMapping.find(name);
+            if (it == targetMapping.end())
+                report.fatal_usage("Invalid --{} value: \"{}\".", kTarget, value);
+            targets.emplace_back(name, it->second);
+        }
+    }
+
+    if (args[kThreads].count()) {
+        threadCounts = args[kThreads].as<std::vector<uint32_t>>();
+        for (const auto count : threadCounts)
+            if (count == 0)
+                report.fatal_usage("Invalid --{} value: \"0\".", kThreads);
+    } else {
+        threadCounts.push_back(std::max(1u, std::thread::hardware_concurrency()));
+    }
+
+    if (args[kRepeat].count()) {
+        repeat = args[kRepeat].as<uint32_t>();
+        if (repeat == 0)
+            report.fatal_usage("Invalid --{} value: \"0\".", kRepeat);
+    }
+
+    quality = !args[kNoQuality].as<bool>();
+
+    const auto formatStr = to_lower_copy(args[kFormat].as<std::string>());
+    if (formatStr == "csv")
+        format = ReportFormat::csv;
+    else if (formatStr == "json")
+        format = ReportFormat::json;
+    else if (formatStr == "mini-json")
+        format = ReportFormat::json_mini;
+    else
+        report.fatal_usage("Unsupported format: \"{}\".", formatStr);
+
+    if (args.count(kOutput))
+        outputFilepath = args[kOutput].as<std::string>();
+}
+
+void CommandBench::initOptions(cxxopts::Options& opts) {
+    options.init(opts);
+}
+
+void CommandBench::processOptions(cxxopts::Options& opts, cxxopts::ParseResult& args) {
+    options.process(opts, args, *this);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+KTXTexture2 CommandBench::copyTexture(KTXTexture2& texture) {
+    KTXTexture2 copy{nullptr};
+    const auto ret = ktxTexture2_CreateCopy(texture, copy.pHandle());
+    if (ret != KTX_SUCCESS)
+        fatal(rc::KTX_FAILURE, "Failed to copy KTX2 texture: {}", ktxErrorString(ret));
+    return copy;
+}
+
+uint64_t CommandBench::fileSize(KTXTexture2& texture) {
+    ktx_uint8_t* data = nullptr;
+    ktx_size_t dataSize = 0;
+    const auto ret = ktxTexture_WriteToMemory(texture, &data, &dataSize);
+    if (ret != KTX_SUCCESS)
+        fatal(rc::KTX_FAILURE, "Failed to serialize KTX2 texture: {}", ktxErrorString(ret));
+    std::free(data);
+    return dataSize;
+}
+
+double CommandBench::timeOperation(KTXTexture2& source, KTXTexture2& output,
+        const std::function<ktx_error_code_e(KTXTexture2&)>& operation, const char* name) {
+    auto best = std::numeric_limits<double>::max();
+    for (uint32_t run = 0; run < options.repeat; ++run) {
+        KTXTexture2 texture = copyTexture(source);
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto ret = operation(texture);
+        const auto end = std::chrono::steady_clock::now();
+        if (ret != KTX_SUCCESS)
+            fatal(rc::KTX_FAILURE, "{} failed. KTX Error: {}", name, ktxErrorString(ret));
+
+        best = std::min(best, std::chrono::duration<double>(end - start).count());
+        std::swap(output, texture);
+    }
+    return best;
+}
+
+void CommandBench::addResult(Result&& result, const Input& input) {
+    result.input = input.filepath;
+    result.mpixPerSec = result.seconds > 0.0 ? double(input.pixelCount) / 1e6 / result.seconds : 0.0;
+    if (result.bytes)
+        result.bytesPerPixel = double(*result.bytes) / double(input.pixelCount);
+    result.peakRssMiB = double(PeakResidentSetSize()) / (1024.0 * 1024.0);
+    results.push_back(std::move(result));
+}
+
+CommandBench::Input CommandBench::loadInput(const std::string& filepath) {
+    Input input;
+    input.filepath = filepath;
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto extension = to_lower_copy(std::filesystem::path(DecodeUTF8Path(filepath)).extension().string());
+    if (extension == ".ktx2") {
+        InputStream inputStream(filepath, *this);
+        validateToolInput(inputStream, fmtInFile(filepath), *this);
+        StreambufStream<std::streambuf*> ktx2Stream{inputStream->rdbuf(), std::ios::in | std::ios::binary};
+        auto ret = ktxTexture2_CreateFromStream(ktx2Stream.stream(), KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT,
+                input.texture.pHandle());
+        if (ret != KTX_SUCCESS)
+            fatal(rc::INVALID_FILE, "Failed to load KTX2 file \"{}\": {}", filepath, ktxErrorString(ret));
+
+        switch (input.texture->vkFormat) {
+        case VK_FORMAT_R8_UNORM: [[fallthrough]];
+        case VK_FORMAT_R8_SRGB: [[fallthrough]];
+        case VK_FORMAT_R8G8_UNORM: [[fallthrough]];
+        case VK_FORMAT_R8G8_SRGB: [[fallthrough]];
+        case VK_FORMAT_R8G8B8_UNORM: [[fallthrough]];
+        case VK_FORMAT_R8G8B8_SRGB: [[fallthrough]];
+        case VK_FORMAT_R8G8B8A8_UNORM: [[fallthrough]];
+        case VK_FORMAT_R8G8B8A8_SRGB:
+            break;
+        default:
+            fatal(rc::INVALID_FILE, "Input file \"{}\" with format {} cannot be encoded. "
+                    "Only R8, R8G8, R8G8B8 and R8G8B8A8 (or their sRGB variants) are supported.",
+                    filepath, toString(VkFormat(input.texture->vkFormat)));
+        }
+        if (input.texture->supercompressionScheme != KTX_SS_NONE)
+            fatal(rc::INVALID_FILE, "Input file \"{}\" must not be supercompressed.", filepath);
+    } else {
+        const auto warningFn = [this](const std::string& w) { this->warning(w); };
+        const auto inputImageFile = ImageInput::open(filepath, nullptr, warningFn);
+        inputImageFile->seekSubimage(0, 0);
+
+        const auto formatType = inputImageFile->formatType();
+        if (formatType == ImageInputFormatType::exr_uint || formatType == ImageInputFormatType::exr_float ||
+                inputImageFile->spec().format().largestChannelBitLength() > 8)
+            fatal(rc::INVALID_FILE, "Input file \"{}\" is not an 8-bit image.", filepath);
+
+        const auto width = inputImageFile->spec().width();
+        const auto height = inputImageFile->spec().height();
+        rgba8image image(width, height);
+        inputImageFile->readImage(static_cast<uint8_t*>(image), image.getByteCount(), 0, 0,
+                createFormatDescriptor(VK_FORMAT_R8G8B8A8_UNORM, *this));
+
+        ktxTextureCreateInfo createInfo;
+        std::memset(&createInfo, 0, sizeof(createInfo));
+        createInfo.vkFormat = VK_FORMAT_R8G8B8A8_SRGB;
+        createInfo.baseWidth = width;
+        createInfo.baseHeight = height;
+        createInfo.baseDepth = 1;
+        createInfo.numDimensions = 2;
+        createInfo.numLevels = 1;
+        createInfo.numLayers = 1;
+        createInfo.numFaces = 1;
+        auto ret = ktxTexture2_Create(&createInfo, KTX_TEXTURE_CREATE_ALLOC_STORAGE, input.texture.pHandle());
+        if (ret != KTX_SUCCESS)
+            fatal(rc::KTX_FAILURE, "Failed to create KTX2 texture: {}", ktxErrorString(ret));
+        ret = ktxTexture_SetImageFromMemory(input.texture, 0, 0, 0,
+                static_cast<const ktx_uint8_t*>(static_cast<uint8_t*>(image)), image.getByteCount());
+        if (ret != KTX_SUCCESS)
+            fatal(rc::KTX_FAILURE, "Failed to set KTX2 image data: {}", ktxErrorString(ret));
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    input.numChannels = ktxTexture2_GetNumComponents(input.texture);
+    for (uint32_t levelIndex = 0; levelIndex < input.texture->numLevels; ++levelIndex)
+        input.pixelCount += uint64_t{std::max(input.texture->baseWidth >> levelIndex, 1u)} *
+                std::max(input.texture->baseHeight >> levelIndex, 1u) *
+                std::max(input.texture->baseDepth >> levelIndex, 1u) *
+                input.texture->numLayers * input.texture->numFaces;
+
+    if (options.quality)
+        input.metrics.saveReference(input.texture);
+
+    Result result;
+    result.operation = "load";
+    result.seconds = std::chrono::duration<double>(end - start).count();
+    addResult(std::move(result), input);
+    return input;
+}
+
+void CommandBench::benchEncoding(Input& input, const std::string& codec, const std::string& settings,
+        uint32_t threads, bool measureFollowUps, const std::function<ktx_error_code_e(KTXTexture2&)>& encode) {
+    KTXTexture2 encoded{nullptr};
+
+    Result result;
+    result.operation = "encode";
+    result.codec = codec;
+    result.settings = settings;
+    result.threads = threads;
+    result.seconds = timeOperation(input.texture, encoded, encode, "Encoding");
+    result.bytes = fileSize(encoded);
+    // No measured images leaves psnr and ssim unset rather than NaN, which is not valid JSON
+    if (options.quality) {
+        const auto qualities = input.metrics.measure(encoded, true, true, *this);
+        double psnrSum = 0.0;
+        double ssimSum = 0.0;
+        for (const auto& quality : qualities) {
+            psnrSum += quality.psnr;
+            for (uint32_t c = 0; c < std::min(input.numChannels, 4u); ++c)
+                ssimSum += quality.ssim[c];
+        }
+        if (!qualities.empty()) {
+            result.psnr = static_cast<float>(psnrSum / double(qualities.size()));
+            result.ssim = static_cast<float>(ssimSum / double(qualities.size() * std::min(input.numChannels, 4u)));
+        }
+    }
+    addResult(std::move(result), input);
+
+    // Deflation and transcoding are single threaded; measure them once per encoder setting
+    if (!measureFollowUps)
+        return;
+
+    if (codec != "etc1s") {
+        for (const auto level : options.zstdLevels) {
+            KTXTexture2 deflated{nullptr};
+            Result deflateResult;
+            deflateResult.operation = "deflate";
+            deflateResult.codec = codec;
+            deflateResult.settings = settings;
+            deflateResult.zstd = level;
+            deflateResult.seconds = timeOperation(encoded, deflated, [&](KTXTexture2& texture) {
+                return ktxTexture2_DeflateZstd(texture, level);
+            }, "Zstd deflation");
+            deflateResult.bytes = fileSize(deflated);
+            addResult(std::move(deflateResult), input);
+        }
+    }
+
+    if (codec != "astc") {
+        for (const auto& [name, target] : options.targets) {
+            KTXTexture2 transcoded{nullptr};
+            Result transcodeResult;
+            transcodeResult.operation = "transcode";
+            transcodeResult.codec = codec;
+            transcodeResult.settings = settings;
+            transcodeResult.target = name;
+            transcodeResult.seconds = timeOperation(encoded, transcoded, [&](KTXTexture2& texture) {
+                return ktxTexture2_TranscodeBasis(texture, target, 0);
+            }, "Transcoding");
+            addResult(std::move(transcodeResult), input);
+        }
+    }
+}
+
+void CommandBench::executeBench() {
+    for (const auto& filepath : options.inputFilepaths) {
+        Input input = loadInput(filepath);
+
+        for (std::size_t t = 0; t < options.threadCounts.size(); ++t) {
+            const auto threads = options.threadCounts[t];
+            const bool measureFollowUps = t == 0;
+
+            for (const auto& [blockName, block] : options.astcBlocks) {
+                for (const auto& [qualityName, qualityLevel] : options.astcQualities) {
+                    benchEncoding(input, "astc", fmt::format("block={} quality={}", blockName, qualityName),
+                            threads, measureFollowUps, [&](KTXTexture2& texture) {
+                        OptionsEncodeASTC params;
+                        params.blockDimension = block;
+                        params.ktxAstcParams::qualityLevel = qualityLevel;
+                        params.threadCount = threads;
+                        return ktxTexture2_CompressAstcEx(texture, &params);
+                    });
+                }
+            }
+
+            for (const auto qLevel : options.etc1sQLevels) {
+                benchEncoding(input, "etc1s", fmt::format("qlevel={}", qLevel),
+                        threads, measureFollowUps, [&](KTXTexture2& texture) {
+                    OptionsEncodeBasis<true> params;
+                    params.uastc = false;
+                    params.ktxBasisParams::qualityLevel = qLevel;
+                    params.threadCount = threads;
+                    return ktxTexture2_CompressBasisEx(texture, &params);
+                });
+            }
+
+            for (const auto uastcQuality : options.uastcQualities) {
+                for (const auto& rdo : options.uastcRdos) {
+                    const auto settings = rdo ?
+                            fmt::format("quality={} rdo={}", uastcQuality, *rdo) :
+                            fmt::format("quality={} rdo=off", uastcQuality);
+                    benchEncoding(input, "uastc", settings, threads, measureFollowUps, [&](KTXTexture2& texture) {
+                        OptionsEncodeBasis<true> params;
+                        params.uastc = true;
+                        params.uastcFlags = (params.uastcFlags & ~KTX_PACK_UASTC_LEVEL_MASK) | uastcQuality;
+                        if (rdo) {
+                            params.uastcRDO = true;
+                            params.ktxBasisParams::uastcRDOQualityScalar = *rdo;
+                        }
+                        params.threadCount = threads;
+                        return ktxTexture2_CompressBasisEx(texture, &params);
+                    });
+                }
+            }
+        }
+    }
+
+    std::ofstream file;
+    if (!options.outputFilepath.empty()) {
+        file.open(DecodeUTF8Path(options.outputFilepath), std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file)
+            fatal(rc::IO_FAILURE, "Could not open output file \"{}\": {}.", options.outputFilepath, errnoMessage());
+    }
+    std::ostream& os = options.outputFilepath.empty() ? cout() : file;
+
+    if (options.format == ReportFormat::csv)
+        printCSV(os);
+    else
+        printJSON(os);
+
+    if (!os)
+        fatal(rc::IO_FAILURE, "Failed to write the report: {}.", errnoMessage());
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void CommandBench::printCSV(std::ostream& os) const {
+    const auto csvString = [](const std::string& value) {
+        std::string result = "\"";
+        for (const auto c : value)
+            result += c == '"' ? std::string("\"\"") : std::string(1, c);
+        return result + "\"";
+    };
+    const auto optionalValue = [](const auto& value) {
+        return value ? fmt::format("{}", *value) : std::string();
+    };
+
+    fmt::print(os, "input,operation,codec,settings,threads,zstd,target,seconds,mpix_per_sec,"
+            "bytes,bytes_per_pixel,psnr,ssim,peak_rss_mib\n");
+    for (const auto& result : results) {
+        fmt::print(os, "{},{},{},{},{},{},{},{:.6f},{:.3f},{},{},{},{},{:.1f}\n",
+                csvString(result.input), result.operation, result.codec, csvString(result.settings),
+                result.threads, optionalValue(result.zstd), result.target, result.seconds, result.mpixPerSec,
+                optionalValue(result.bytes), optionalValue(result.bytesPerPixel),
+                optionalValue(result.psnr), optionalValue(result.ssim), result.peakRssMiB);
+    }
+}
+
+void CommandBench::printJSON(std::ostream& os) const {
+    const bool mini = options.format == ReportFormat::json_mini;
+    const auto space = mini ? "" : " ";
+    const auto nl = mini ? "" : "\n";
+    const auto indent = mini ? "" : "        ";
+    const auto optionalValue = [](const auto& value) {
+        return value ? fmt::format("{}", *value) : std::string("null");
+    };
+
+    fmt::print(os, "{{{}", nl);
+    fmt::print(os, "{}\"results\":{}[{}", mini ? "" : "    ", space, nl);
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const auto& result = results[i];
+        fmt::print(os, "{}{{", mini ? "" : "    ");
+        fmt::print(os, "{}{}\"input\":{}\"{}\",", nl, indent, space, escape_json_copy(result.input));
+        fmt::print(os, "{}{}\"operation\":{}\"{}\",", nl, indent, space, result.operation);
+        fmt::print(os, "{}{}\"codec\":{}\"{}\",", nl, indent, space, result.codec);
+        fmt::print(os, "{}{}\"settings\":{}\"{}\",", nl, indent, space, escape_json_copy(result.settings));
+        fmt::print(os, "{}{}\"threads\":{}{},", nl, indent, space, result.threads);
+        fmt::print(os, "{}{}\"zstd\":{}{},", nl, indent, space, optionalValue(result.zstd));
+        fmt::print(os, "{}{}\"target\":{}\"{}\",", nl, indent, space, result.target);
+        fmt::print(os, "{}{}\"seconds\":{}{:.6f},", nl, indent, space, result.seconds);
+        fmt::print(os, "{}{}\"mpix_per_sec\":{}{:.3f},", nl, indent, space, result.mpixPerSec);
+        fmt::print(os, "{}{}\"bytes\":{}{},", nl, indent, space, optionalValue(result.bytes));
+        fmt::print(os, "{}{}\"bytes_per_pixel\":{}{},", nl, indent, space, optionalValue(result.bytesPerPixel));
+        fmt::print(os, "{}{}\"psnr\":{}{},", nl, indent, space, optionalValue(result.psnr));
+        fmt::print(os, "{}{}\"ssim\":{}{},", nl, indent, space, optionalValue(result.ssim));
+        fmt::print(os, "{}{}\"peak_rss_mib\":{}{:.1f}", nl, indent, space, result.peakRssMiB);
+        fmt::print(os, "{}{}}}{}{}", nl, mini ? "" : "    ", i + 1 < results.size() ? "," : "", nl);
+    }
+    fmt::print(os, "{}]{}", mini ? "" : "    ", nl);
+    fmt::print(os, "}}\n");
+}
+
+} // namespace ktx
+
+KTX_COMMAND_ENTRY_POINT(ktxBench, ktx::CommandBench)
@@ -11,7 +11,11 @@
 #include "format_descriptor.h"
 #include "imagecodec.hpp"
 #include "imagespan.hpp"
+#include "imageio_kernels.h"
+#include "hash_utils.h"
 #include "basis_sgd.h"
+#include <atomic>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -871,6 +875,30 @@ Compare two KTX2 files.
             @b &lt;number&gt; - At most the specified number of differences are output. <br />
             @b none - No per pixel / texel block differences are output. <br />
             The default mode is @b none to limit the verbosity of the output.
+        <dt>\--tolerance &lt;value&gt;[,&lt;value&gt;,&lt;value&gt;,&lt;value&gt;]</dt>
+        <dd>Absolute per channel tolerance used when --content is set to @b image.
+            Texel blocks are decoded to floating point values (normalized formats to
+            [0,1] or [-1,1], UINT and SINT formats to their integer values) and channels
+            are considered matching when their difference is within the tolerance. A single value applies to every channel, otherwise four
+            values are expected in the order the channels appear in the BDFD.
+            Not supported for block compressed formats. By default texel blocks must match
+            exactly.</dd>
+        <dt>\--relative-tolerance &lt;value&gt;[,&lt;value&gt;,&lt;value&gt;,&lt;value&gt;]</dt>
+        <dd>Relative per channel tolerance used when --content is set to @b image. Channels
+            are also considered matching when their difference is within this fraction of
+            the larger magnitude of the two values. Can be combined with --tolerance.</dd>
+        <dt>\--max-diff &lt;number&gt;</dt>
+        <dd>Stop comparing image content once the specified number of texel block differences
+            has been found when --content is set to @b image. The reported differences are
+            the first ones in level, layer, face and texel block order.</dd>
+        <dt>\--threads &lt;count&gt;</dt>
+        <dd>Number of threads used to compare image content when --content is set to
+            @b image. By default the number of threads reported by
+            @c thread::hardware_concurrency or 1 if value returned is 0.</dd>
+        <dt>\--level-hash</dt>
+        <dd>Report the XXH64 hash of the level data of both files for every mip level.
+            The level data is hashed as stored in the file, i.e. after supercompression.
+            Requires --content @b raw.</dd>
         <dt>\--allow-invalid-input</dt>
         <dd>Perform best effort comparison even if any of the input files are invalid.</dd>
         <dt>\--ignore-format-header<dt>
@@ -988,6 +1016,11 @@ class CommandCompare : public Command {
         inline static const char* kIgnoreBDFDBytesPlane = "ignore-bdfd-bytesplane";
         inline static const char* kIgnoreMetadata = "ignore-metadata";
         inline static const char* kIgnoreSGD = "ignore-sgd";
+        inline static const char* kTolerance = "tolerance";
+        inline static const char* kRelativeTolerance = "relative-tolerance";
+        inline static const char* kMaxDiff = "max-diff";
+        inline static const char* kThreads = "threads";
+        inline static const char* kLevelHash = "level-hash";
 
         std::array<std::string, 2> inputFilepaths;
         ContentMode contentMode = ContentMode::raw;
@@ -1001,6 +1034,12 @@ class CommandCompare : public Command {
         bool ignoreAllMetadata = false;
         std::unordered_set<std::string> ignoreMetadataKeys = {};
         IgnoreSGD ignoreSGD = IgnoreSGD::none;
+        bool toleranceCompare = false;
+        std::array<float, 4> tolerance = {};
+        std::array<float, 4> relativeTolerance = {};
+        std::size_t maxDiff = SIZE_MAX;
+        uint32_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+        bool levelHash = false;
 
         void init(cxxopts::Options& opts) {
             opts.add_options()
@@ -1072,7 +1111,22 @@ class CommandCompare : public Command {
                         "  none: Do not ignore the SGD section\n"
                         "Note: --ignore-sgd payload can be used to compare BasisLZ SGD headers without "
                         "expecting an exact match for the individual SGD payload sections.",
-                        cxxopts::value<std::string>()->default_value("none"), "all|unknown|payload|none");
+                        cxxopts::value<std::string>()->default_value("none"), "all|unknown|payload|none")
+                    (kTolerance, "Absolute per channel tolerance of the decoded channel values when --content is set "
+                        "to image, normalized for UNORM/SNORM and raw integer units for UINT/SINT formats. A single "
+                        "value applies to every channel, otherwise four values are expected in BDFD channel order. "
+                        "Not supported for block compressed formats.",
+                        cxxopts::value<std::string>(), "<value>[,<value>,<value>,<value>]")
+                    (kRelativeTolerance, "Relative per channel tolerance of the decoded channel values when --content "
+                        "is set to image, as a fraction of the larger magnitude. Can be combined with --tolerance.",
+                        cxxopts::value<std::string>(), "<value>[,<value>,<value>,<value>]")
+                    (kMaxDiff, "Stop comparing image content after the specified number of texel block differences "
+                        "when --content is set to image.", cxxopts::value<std::string>(), "<number>")
+                    (kThreads, "Number of threads used to compare image content when --content is set to image. "
+                        "By default the number of threads reported by thread::hardware_concurrency or 1 if "
+                        "value returned is 0.", cxxopts::value<uint32_t>(), "<count>")
+                    (kLevelHash, "Report the XXH64 hash of the level data of both files for every mip level. "
+                        "Requires --content raw.");
             opts.parse_positional("input-file1", "input-file2");
             opts.positional_help("<input-file1> <input-file2>");
         }
@@ -1183,6 +1237,58 @@ class CommandCompare : public Command {
                     report.fatal_usage("Invalid --ignore-sgd argument: \"{}\".", ignoreSGDStr);
                 ignoreSGD = it->second;
             }
+
+            const auto parseTolerance = [&](const char* name, std::array<float, 4>& values) {
+                if (contentMode != ContentMode::image)
+                    report.fatal_usage("--{} is specified but --content was not set to \"image\".", name);
+                const auto str = args[name].as<std::string>();
+                std::vector<float> parsed;
+                std::stringstream stream(str);
+                std::string value;
+                while (std::getline(stream, value, ',')) {
+                    std::size_t parsedCharacters = 0;
+                    float number = -1.f;
+                    try {
+                        number = std::stof(value, &parsedCharacters);
+                    } catch (std::exception&) {}
+                    if (parsedCharacters != value.length() || !(number >= 0.f))
+                        report.fatal_usage("Invalid --{} argument: \"{}\".", name, str);
+                    parsed.push_back(number);
+                }
+                if (parsed.size() == 1)
+                    values.fill(parsed[0]);
+                else if (parsed.size() == 4)
+                    std::copy(parsed.begin(), parsed.end(), values.begin());
+                else
+                    report.fatal_usage("Invalid --{} argument: \"{}\". Expected either 1 or 4 values.", name, str);
+                toleranceCompare = true;
+            };
+            if (args[kTolerance].count())
+                parseTolerance(kTolerance, tolerance);
+            if (args[kRelativeTolerance].count())
+                parseTolerance(kRelativeTolerance, relativeTolerance);
+
+            if (args[kMaxDiff].count()) {
+                if (contentMode != ContentMode::image)
+                    report.fatal_usage("--max-diff is specified but --content was not set to \"image\".");
+                const auto maxDiffStr = args[kMaxDiff].as<std::string>();
+                std::size_t parsedCharacters = 0;
+                try {
+                    maxDiff = static_cast<std::size_t>(std::stoull(maxDiffStr, &parsedCharacters));
+                } catch (std::exception&) {}
+                if (parsedCharacters != maxDiffStr.length() || maxDiff == 0)
+                    report.fatal_usage("Invalid --max-diff argument: \"{}\".", maxDiffStr);
+            }
+
+            if (args[kThreads].count()) {
+                threadCount = args[kThreads].as<uint32_t>();
+                if (threadCount == 0)
+                    report.fatal_usage("Invalid --threads argument: \"0\".");
+            }
+
+            levelHash = args[kLevelHash].as<bool>();
+            if (levelHash && contentMode != ContentMode::raw)
+                report.fatal_usage("--{} requires --{} raw.", kLevelHash, kContent);
         }
     };
 
@@ -1192,6 +1298,11 @@ class CommandCompare : public Command {
 
     std::vector<KTX_header2> headers;
 
+    /// Size of the chunks raw level data is streamed and compared in
+    static constexpr std::size_t kRawCompareChunkSize = 4 * 1024 * 1024;
+    /// Per level XXH64 hashes of the level data of the two files, filled by --level-hash
+    std::vector<std::array<std::optional<uint64_t>, 2>> levelHashes;
+
 public:
     virtual int main(int argc, char* argv[]) override;
     virtual void initOptions(cxxopts::Options& opts) override;
@@ -1211,6 +1322,7 @@ private:
     void compareSGD(PrintDiff& diff, InputStreams& streams);
     void compareImages(PrintDiff& diff, InputStreams& streams);
     void compareImagesRaw(PrintDiff& diff, InputStreams& streams);
+    void printLevelHashes(PrintIndent& out);
     void compareImagesPerPixel(PrintDiff& diff, InputStreams& streams);
 
     void read(InputStream& stream, std::size_t offset, void* readDst, std::size_t readSize, std::string_view what) {
@@ -1235,19 +1347,6 @@ private:
         return result;
     }
 
-    typedef bool (*CompareFunc)(ImageSpan::TexelBlockPtr<> texelBlocks[2]);
-
-    static bool compareTexelBlocksPacked(ImageSpan::TexelBlockPtr<> texelBlocks[2]) {
-        // Expect number of packed elements and byte size to match
-        assert(texelBlocks[0].imageCodec().getPackedElementCount() == texelBlocks[1].imageCodec().getPackedElementCount());
-        assert(texelBlocks[0].imageCodec().getPackedElementByteSize() == texelBlocks[1].imageCodec().getPackedElementByteSize());
-        for (uint32_t elementIdx = 0; elementIdx < texelBlocks[0].imageCodec().getPackedElementCount(); ++elementIdx) {
-            if (texelBlocks[0].getPackedElement(elementIdx) != texelBlocks[1].getPackedElement(elementIdx)){
-                return false;
-            }
-        }
-        return true;
-    }
 };
 
 // -------------------------------------------------------------------------------------------------
@@ -1264,7 +1363,7 @@ int CommandCompare::main(int argc, char* argv[]) {
     } catch (const FatalError& error) {
         return +error.returnCode;
     } catch (const std::exception& e) {
-        fmt::print(std::cerr, "{} fatal: {}\n", commandName, e.what());
+        log(LogLevel::fatal, e.what());
         return +rc::RUNTIME_ERROR;
     }
 }
@@ -1303,12 +1402,12 @@ void CommandCompare::executeCompare() {
         for (std::size_t i = 0; i < inputStreams.size(); ++i) {
             if (!validationMessages[i].empty()) {
                 if (std::exchange(hasValidationMessages, true))
-                    fmt::print("\n");
+                    fmt::print(cout(), "\n");
 
-                fmt::print("Validation {} for '{}'\n", validationResults[i] == 0 ? "successful" : "failed",
+                fmt::print(cout(), "Validation {} for '{}'\n", validationResults[i] == 0 ? "successful" : "failed",
                             options.inputFilepaths[i]);
-                fmt::print("\n");
-                fmt::print("{}", validationMessages[i]);
+                fmt::print(cout(), "\n");
+                fmt::print(cout(), "{}", validationMessages[i]);
             }
         }
 
@@ -1323,9 +1422,9 @@ void CommandCompare::executeCompare() {
         }
 
         if (hasValidationMessages)
-            fmt::print("\n");
+            fmt::print(cout(), "\n");
 
-        PrintIndent out{std::cout};
+        PrintIndent out{cout()};
         PrintDiff diff(out, options.format);
         compareHeader(diff, inputStreams);
         compareLevelIndex(diff, inputStreams);
@@ -1333,6 +1432,7 @@ void CommandCompare::executeCompare() {
         compareKVD(diff, inputStreams);
         compareSGD(diff, inputStreams);
         compareImages(diff, inputStreams);
+        printLevelHashes(out);
 
         if (diff.isDifferent())
             throw FatalError(rc::DIFFERENCE_FOUND);
@@ -1348,7 +1448,7 @@ void CommandCompare::executeCompare() {
         const auto space = options.format == OutputFormat::json ? " " : "";
         const auto nl = options.format == OutputFormat::json ? "\n" : "";
 
-        PrintIndent out{std::cout, baseIndent, indentWidth};
+        PrintIndent out{cout(), baseIndent, indentWidth};
         out(0, "{{{}", nl);
         out(1, "\"$schema\":{}\"https://schema.khronos.org/ktx/compare_v0.json\",{}", space, nl);
 
@@ -1384,7 +1484,7 @@ void CommandCompare::executeCompare() {
             bool last = (i == inputStreams.size() - 1);
             if (!validationMessages[i].empty()) {
                 out(2, "[{}", nl);
-                fmt::print("{}", validationMessages[i]);
+                fmt::print(cout(), "{}", validationMessages[i]);
                 out(3, "}}{}", nl);
                 out(2, "]{}{}", last ? "" : ",", nl);
             } else {
@@ -1422,15 +1522,16 @@ void CommandCompare::executeCompare() {
             diff.beginJsonSection("image");
             compareImages(diff, inputStreams);
             diff.endJsonSection();
+            printLevelHashes(out);
 
             if (diff.isDifferent())
                 throw FatalError(rc::DIFFERENCE_FOUND);
         } catch (...) {
             diff.endJsonSection();
-            fmt::print("{}}}{}", nl, nl);
+            fmt::print(cout(), "{}}}{}", nl, nl);
             throw;
         }
-        fmt::print("{}}}{}", nl, nl);
+        fmt::print(cout(), "{}}}{}", nl, nl);
         break;
     }
     }
@@ -2296,6 +2397,13 @@ void CommandCompare::compareImagesRaw(PrintDiff& diff, InputStreams& streams) {
     };
     const uint32_t maxNumLevels = std::max(numLevels[0], numLevels[1]);
 
+    // Level data is compared in chunks so that huge levels do not need to be loaded at once
+    std::unique_ptr<uint8_t[]> chunkBuffers[] = {
+        std::make_unique<uint8_t[]>(kRawCompareChunkSize),
+        std::make_unique<uint8_t[]>(kRawCompareChunkSize)
+    };
+    levelHashes.assign(options.levelHash ? maxNumLevels : 0, {});
+
     for (uint32_t level = 0; level < maxNumLevels; ++level) {
         const auto levelIndexEntryOffset = sizeof(KTX_header2) + level * sizeof(ktxLevelIndexEntry);
         std::optional<ktxLevelIndexEntry> levelIndexEntry[2];
@@ -2316,26 +2424,77 @@ void CommandCompare::compareImagesRaw(PrintDiff& diff, InputStreams& streams) {
         if (!mismatch && levelIndexEntry[0]->byteLength != levelIndexEntry[1]->byteLength)
             mismatch = true;
 
-        if (!mismatch) {
-            // If so far so good then load the level data and compare them
-            std::unique_ptr<uint8_t[]> buffers[] = {
-                std::make_unique<uint8_t[]>(levelIndexEntry[0]->byteLength),
-                std::make_unique<uint8_t[]>(levelIndexEntry[1]->byteLength)
-            };
+        // Stream the level data in fixed size chunks. Without hashing the comparison stops at the
+        // first mismatching chunk, otherwise every present level is read completely once.
+        XXHash64 hashers[2];
+        const std::size_t levelByteLengths[2] = {
+            levelIndexEntry[0].has_value() ? levelIndexEntry[0]->byteLength : 0,
+            levelIndexEntry[1].has_value() ? levelIndexEntry[1]->byteLength : 0
+        };
+        const auto readLength = options.levelHash ?
+                std::max(levelByteLengths[0], levelByteLengths[1]) :
+                (mismatch ? 0 : levelByteLengths[0]);
+
+        for (std::size_t chunkOffset = 0; chunkOffset < readLength; chunkOffset += kRawCompareChunkSize) {
+            std::size_t chunkSizes[2];
+            for (std::size_t i = 0; i < streams.size(); ++i) {
+                chunkSizes[i] = chunkOffset < levelByteLengths[i] ?
+                        std::min(kRawCompareChunkSize, levelByteLengths[i] - chunkOffset) : 0;
+                if (chunkSizes[i] == 0)
+                    continue;
 
-            for (std::size_t i = 0; i < streams.size(); ++i)
-                read(streams[i], levelIndexEntry[i]->byteOffset, buffers[i].get(),
-                    levelIndexEntry[i]->byteLength, fmt::format("level {} data", level));
+                read(streams[i], levelIndexEntry[i]->byteOffset + chunkOffset, chunkBuffers[i].get(),
+                    chunkSizes[i], fmt::format("level {} data", level));
+                if (options.levelHash)
+                    hashers[i].update(chunkBuffers[i].get(), chunkSizes[i]);
+            }
 
-            if (std::memcmp(buffers[0].get(), buffers[1].get(), levelIndexEntry[0]->byteLength) != 0)
+            if (!mismatch && std::memcmp(chunkBuffers[0].get(), chunkBuffers[1].get(), chunkSizes[0]) != 0) {
                 mismatch = true;
+                if (!options.levelHash)
+                    break;
+            }
         }
 
+        if (options.levelHash)
+            for (std::size_t i = 0; i < streams.size(); ++i)
+                if (levelIndexEntry[i].has_value())
+                    levelHashes[level][i] = hashers[i].digest();
+
         if (mismatch)
             diff << DiffMismatch(fmt::format("Mismatch in level {} data", level), fmt::format("m={}", level));
     }
 }
 
+void CommandCompare::printLevelHashes(PrintIndent& out) {
+    if (!options.levelHash || options.contentMode != ContentMode::raw)
+        return;
+
+    const bool text = options.format == OutputFormat::text;
+    const auto formatHash = [&](const std::optional<uint64_t>& hash) {
+        if (!hash.has_value())
+            return std::string(text ? "N/A" : "null");
+        return fmt::format(text ? "{:016x}" : "\"{:016x}\"", *hash);
+    };
+
+    if (text) {
+        fmt::print(cout(), "\nLevel Data Hashes (XXH64)\n\n");
+        for (std::size_t level = 0; level < levelHashes.size(); ++level)
+            out(0, "m={}: {} {}\n", level, formatHash(levelHashes[level][0]), formatHash(levelHashes[level][1]));
+    } else {
+        const auto space = options.format != OutputFormat::json_mini ? " " : "";
+        const auto nl = options.format != OutputFormat::json_mini ? "\n" : "";
+        out(0, ",{}", nl);
+        out(1, "\"levelHash\":{}{{{}", space, nl);
+        for (std::size_t level = 0; level < levelHashes.size(); ++level) {
+            const auto comma = level + 1 < levelHashes.size() ? "," : "";
+            out(2, "\"m={}\":{}[{},{}{}]{}{}", level, space, formatHash(levelHashes[level][0]), space,
+                formatHash(levelHashes[level][1]), comma, nl);
+        }
+        out(1, "}}");
+    }
+}
+
 void CommandCompare::compareImagesPerPixel(PrintDiff& diff, InputStreams& streams) {
     diff.setContext("Image Data\n\n");
 
@@ -2388,16 +2547,42 @@ void CommandCompare::compareImagesPerPixel(PrintDiff& diff, InputStreams& stream
     if (textures[0]->vkFormat != textures[1]->vkFormat)
         fatal(rc::INVALID_ARGUMENTS, "Comparison requires matching texture formats (BasisLZ is treated as R8G8B8A8_UNORM).");
 
-    // Currently, we only support comparing raw packed elements, but this can be extended
-    // in the future with color value comparison (with or without tolerance), for example
-    CompareFunc compareFunc = compareTexelBlocksPacked;
+    if (options.toleranceCompare)
+        for (std::size_t i = 0; i < streams.size(); ++i)
+            if (imageCodecs[i].isBlockCompressed() ||
+                    !(imageCodecs[i].canDecodeFLOAT() || imageCodecs[i].canDecodeUINT() || imageCodecs[i].canDecodeSINT()))
+                fatal(rc::INVALID_ARGUMENTS, "Tolerance based comparison is not supported for the format of file \"{}\".",
+                        streams[i].str());
 
     const uint32_t maxNumLevels = std::max(textures[0]->numLevels, textures[1]->numLevels);
     const uint32_t maxNumFaces = std::max(textures[0]->numFaces, textures[1]->numFaces);
     const uint32_t maxNumLayers = std::max(textures[0]->numLayers, textures[1]->numLayers);
 
-    std::size_t texelBlockDifferences = 0;
+    // Collect the images in report order. Images present in both files are split into bands of
+    // texel block rows, so large images are compared in parallel just like many small ones.
+    struct ImageEntry {
+        uint32_t level;
+        uint32_t layer;
+        uint32_t face;
+        bool missing;
+        glm::uvec4 size;
+        char* data[2];
+        std::optional<std::size_t> fileOffsets[2];
+        std::size_t firstBand;
+        std::size_t endBand;
+    };
+    struct Band {
+        std::size_t image;
+        uint32_t firstRow;
+        uint32_t endRow;
+        bool skipped = false;
+        std::size_t differences = 0;
+        std::vector<std::size_t> mismatchOffsets; // Texel block byte offsets within the image
+    };
+    std::vector<ImageEntry> imageEntries;
+    std::vector<Band> bands;
 
+    const auto texelBlockByteSize = imageCodecs[0].getTexelBlockByteSize();
     for (uint32_t level = 0; level < maxNumLevels; ++level) {
         // Calculate base file offset of level from level data
         const auto levelIndexEntryOffset = sizeof(KTX_header2) + level * sizeof(ktxLevelIndexEntry);
@@ -2420,68 +2605,159 @@ void CommandCompare::compareImagesPerPixel(PrintDiff& diff, InputStreams& stream
             ktxTexture_GetImageSize(textures[1], level) * texelBlockDims.z
         };
 
+        // Rows of texel blocks per band, aiming for bands of kMinParallelBytes. An empty image has
+        // no bands, but clamp still needs an upper bound of at least 1.
+        const std::size_t rowBytes = std::size_t{texelBlockDims.x} * texelBlockByteSize;
+        const uint32_t rowCount = texelBlockDims.y * texelBlockDims.z;
+        const uint32_t rowsPerBand = static_cast<uint32_t>(std::clamp<std::size_t>(
+                imageio::kMinParallelBytes / std::max<std::size_t>(rowBytes, 1), 1, std::max(rowCount, 1u)));
+
         for (uint32_t layer = 0; layer < maxNumLayers; ++layer) {
             for (uint32_t face = 0; face < maxNumFaces; ++face) {
+                ImageEntry entry{level, layer, face, false, glm::uvec4(imageWidth, imageHeight, imageDepth, 1),
+                        {nullptr, nullptr}, {}, bands.size(), bands.size()};
+
                 // Handle when image is missing from one of the files
-                bool missingImage = false;
                 for (std::size_t i = 0; i < streams.size(); ++i)
                     if (level >= textures[i]->numLevels || face >= textures[i]->numFaces || layer >= textures[i]->numLayers)
-                        missingImage = true;
+                        entry.missing = true;
 
-                if (missingImage) {
-                    diff << DiffImage(fmt::format("Mismatch in level {}, layer {}, face {}", level, layer, face),
-                        fmt::format("m={},a={},f={}", level, layer, face), 0, 0, {});
-                    continue;
-                }
+                if (!entry.missing) {
+                    for (std::size_t i = 0; i < streams.size(); ++i) {
+                        // Calculate image file offset
+                        if (levelFileOffsets[i].has_value())
+                            entry.fileOffsets[i] = *levelFileOffsets[i] + (face + layer * textures[i]->numFaces) * imageSizes[i];
 
-                // Calculate image file offset
-                std::optional<std::size_t> imageFileOffsets[2];
-                for (std::size_t i = 0; i < streams.size(); ++i)
-                    if (levelFileOffsets[i].has_value())
-                        imageFileOffsets[i] = *levelFileOffsets[i] + (face + layer * textures[i]->numFaces) * imageSizes[i];
-
-                // Get image data pointers and create image spans from them
-                char* imageDataPtr[2];
-                for (std::size_t i = 0; i < streams.size(); ++i) {
-                    ktx_size_t imageOffset;
-                    ktxTexture_GetImageOffset(textures[i], level, layer, face, &imageOffset);
-                    imageDataPtr[i] = reinterpret_cast<char*>(textures[i]->pData) + imageOffset;
+                        ktx_size_t imageOffset;
+                        ktxTexture_GetImageOffset(textures[i], level, layer, face, &imageOffset);
+                        entry.data[i] = reinterpret_cast<char*>(textures[i]->pData) + imageOffset;
+                    }
+                    for (uint32_t firstRow = 0; firstRow < rowCount; firstRow += rowsPerBand)
+                        bands.push_back(Band{imageEntries.size(), firstRow, std::min(firstRow + rowsPerBand, rowCount), false, 0, {}});
+                    entry.endBand = bands.size();
                 }
+                imageEntries.push_back(entry);
+            }
+        }
+    }
 
-                ImageSpan images[2] = {
-                    ImageSpan(imageWidth, imageHeight, imageDepth, imageDataPtr[0], imageCodecs[0]),
-                    ImageSpan(imageWidth, imageHeight, imageDepth, imageDataPtr[1], imageCodecs[1]),
-                };
+    // Each band records its differences in texel block order, up to --max-diff
+    const std::size_t keepLimit = std::min(options.perPixelOutputLimit, options.maxDiff);
+    const auto compareBand = [&](Band& band) {
+        const auto& entry = imageEntries[band.image];
+        const auto texelBlockDims = imageCodecs[0].pixelToTexelBlockSize(entry.size);
+        const std::size_t rowBytes = std::size_t{texelBlockDims.x} * texelBlockByteSize;
+
+        std::vector<float> decoded[2];
+        std::vector<uint8_t> mismatches(texelBlockDims.x);
+        const auto decodeRow = [&](std::size_t i, const char* row) {
+            decoded[i].resize(std::size_t{texelBlockDims.x} * 4);
+            if (imageCodecs[i].canDecodeFLOAT()) {
+                imageCodecs[i].decodeFLOATRow(row, texelBlockDims.x, decoded[i].data());
+                return;
+            }
+            for (uint32_t x = 0; x < texelBlockDims.x; ++x) {
+                const auto* texelBlock = row + x * texelBlockByteSize;
+                const glm::vec4 value = imageCodecs[i].canDecodeUINT() ?
+                        glm::vec4(imageCodecs[i].decodeUINT(texelBlock)) :
+                        glm::vec4(imageCodecs[i].decodeSINT(texelBlock));
+                std::copy(&value[0], &value[0] + 4, decoded[i].data() + x * 4);
+            }
+        };
 
-                // Loop through texel blocks
-                bool imageMismatch = false;
-                std::vector<std::pair<ImageSpan::TexelBlockPtr<>, ImageSpan::TexelBlockPtr<>>> mismatchingBlocks = {};
-                for (uint32_t blockZ = 0; blockZ < texelBlockDims.z; ++blockZ) {
-                    for (uint32_t blockY = 0; blockY < texelBlockDims.y; ++blockY) {
-                        for (uint32_t blockX = 0; blockX < texelBlockDims.x; ++blockX) {
-                            ImageSpan::TexelBlockPtr<> texelBlocks[2] = {
-                                images[0].at(blockX, blockY, blockZ),
-                                images[1].at(blockX, blockY, blockZ)
-                            };
-                            if (!compareFunc(texelBlocks)) {
-                                imageMismatch = true;
-                                texelBlockDifferences += 1;
-                                if (texelBlockDifferences <= options.perPixelOutputLimit) {
-                                    mismatchingBlocks.push_back(std::make_pair(texelBlocks[0], texelBlocks[1]));
-                                }
-                            }
-                        }
-                    }
-                }
+        for (uint32_t row = band.firstRow; row < band.endRow && band.differences < options.maxDiff; ++row) {
+            const std::size_t rowOffset = row * rowBytes;
+            const char* rows[2] = {entry.data[0] + rowOffset, entry.data[1] + rowOffset};
+            // Identical bytes also match under any tolerance
+            if (std::memcmp(rows[0], rows[1], rowBytes) == 0)
+                continue;
 
-                if (imageMismatch) {
-                    diff << DiffImage(fmt::format("Mismatch in level {} layer {} face {}", level, layer, face),
-                        fmt::format("m={},a={},f={}", level, layer, face), imageFileOffsets[0], imageFileOffsets[1],
-                        mismatchingBlocks);
-                }
+            if (options.toleranceCompare) {
+                decodeRow(0, rows[0]);
+                decodeRow(1, rows[1]);
+                imageio::compareRGBA32F(mismatches.data(), decoded[0].data(), decoded[1].data(), texelBlockDims.x,
+                        options.tolerance.data(), options.relativeTolerance.data());
+            } else {
+                for (uint32_t x = 0; x < texelBlockDims.x; ++x)
+                    mismatches[x] = std::memcmp(rows[0] + x * texelBlockByteSize, rows[1] + x * texelBlockByteSize,
+                            texelBlockByteSize) != 0;
+            }
+
+            for (uint32_t x = 0; x < texelBlockDims.x && band.differences < options.maxDiff; ++x) {
+                if (!mismatches[x])
+                    continue;
+                if (band.mismatchOffsets.size() < keepLimit)
+                    band.mismatchOffsets.push_back(rowOffset + x * texelBlockByteSize);
+                ++band.differences;
             }
         }
+    };
+
+    // Compare the bands in parallel. Once --max-diff differences were found no further bands are
+    // started. A band skipped while an earlier one was still running is compared when reporting,
+    // so the reported differences do not depend on scheduling.
+    std::atomic<std::size_t> foundDifferences{0};
+    parallelFor(bands.size(), options.threadCount, [&](std::size_t bandIndex) {
+        auto& band = bands[bandIndex];
+        if (foundDifferences >= options.maxDiff) {
+            band.skipped = true;
+            return;
+        }
+        compareBand(band);
+        foundDifferences += band.differences;
+    });
+
+    // Report in level, layer, face and texel block order
+    std::size_t texelBlockDifferences = 0;
+    for (const auto& entry : imageEntries) {
+        if (texelBlockDifferences >= options.maxDiff)
+            break;
+
+        if (entry.missing) {
+            diff << DiffImage(fmt::format("Mismatch in level {}, layer {}, face {}", entry.level, entry.layer, entry.face),
+                fmt::format("m={},a={},f={}", entry.level, entry.layer, entry.face), 0, 0, {});
+            continue;
+        }
+
+        ImageSpan images[2] = {
+            ImageSpan(entry.size.x, entry.size.y, entry.size.z, entry.data[0], imageCodecs[0]),
+            ImageSpan(entry.size.x, entry.size.y, entry.size.z, entry.data[1], imageCodecs[1]),
+        };
+
+        bool imageMismatch = false;
+        std::vector<std::pair<ImageSpan::TexelBlockPtr<>, ImageSpan::TexelBlockPtr<>>> mismatchingBlocks = {};
+        for (std::size_t bandIndex = entry.firstBand; bandIndex < entry.endBand; ++bandIndex) {
+            auto& band = bands[bandIndex];
+            if (texelBlockDifferences >= options.maxDiff)
+                break;
+            if (std::exchange(band.skipped, false))
+                compareBand(band);
+            if (band.differences == 0)
+                continue;
+
+            imageMismatch = true;
+            const auto counted = std::min(band.differences, options.maxDiff - texelBlockDifferences);
+            for (std::size_t i = 0; i < band.mismatchOffsets.size() && i < counted; ++i) {
+                if (texelBlockDifferences + i >= options.perPixelOutputLimit)
+                    break;
+                const auto offset = band.mismatchOffsets[i];
+                mismatchingBlocks.emplace_back(
+                        ImageSpan::TexelBlockPtr<>(images[0].data() + offset, images[0]),
+                        ImageSpan::TexelBlockPtr<>(images[1].data() + offset, images[1]));
+            }
+            texelBlockDifferences += counted;
+        }
+
+        if (imageMismatch) {
+            diff << DiffImage(fmt::format("Mismatch in level {} layer {} face {}", entry.level, entry.layer, entry.face),
+                fmt::format("m={},a={},f={}", entry.level, entry.layer, entry.face), entry.fileOffsets[0], entry.fileOffsets[1],
+                mismatchingBlocks);
+        }
     }
+
+    if (texelBlockDifferences >= options.maxDiff)
+        warning("Image content comparison stopped after {} texel block difference(s) as requested by --max-diff.",
+                options.maxDiff);
 }
 
 } // namespace ktx
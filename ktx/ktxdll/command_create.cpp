@@ -11,6 +11,7 @@
 #include "encode_utils_astc.h"
 #include "format_descriptor.h"
 #include "formats.h"
+#include "trace_utils.h"
 #include "utility.h"
 #include <filesystem>
 #include <iostream>
@@ -89,6 +90,7 @@ namespace ktx
         inline static const char *kMipmapFilterScale = "mipmap-filter-scale";
         inline static const char *kMipmapWrap = "mipmap-wrap";
         inline static const char *kScale = "scale";
+        inline static const char *kTrace = "trace";
 
         bool _1d = false;
         bool cubemap = false;
@@ -116,6 +118,7 @@ namespace ktx
         std::optional<std::string> swizzleInput; /// Used to swizzle the input image data
 
         std::optional<float> imageScale;
+        std::optional<std::string> traceFilepath;
 
         std::optional<khr_df_transfer_e> convertTF = {};
         std::optional<khr_df_transfer_e> assignTF = {};
@@ -198,6 +201,11 @@ namespace ktx
                 kSwizzle, "KTX swizzle metadata.", cxxopts::value<std::string>(), "[rgba01]{4}")(
                 kInputSwizzle, "Pre-swizzle input channels.", cxxopts::value<std::string>(),
                 "[rgba01]{4}")(
+                kTrace,
+                "Record the time spent in and the peak memory use after each processing stage,"
+                " including the per level and per thread work of the ASTC encoder, and write it"
+                " to the specified file in the Chrome trace-event JSON format.",
+                cxxopts::value<std::string>(), "<file>")(
                 kAssignTf,
                 "Force the created texture to have the specified transfer function, ignoring"
                 " the transfer function of the input file(s). Possible options match the "
@@ -655,6 +663,9 @@ namespace ktx
                 imageScale = args[kScale].as<float>();
             }
 
+            if (args[kTrace].count())
+                traceFilepath = args[kTrace].as<std::string>();
+
             // List of formats that have supported format conversions
             static const std::unordered_set<VkFormat> convertableFormats{
                 VK_FORMAT_R8_UNORM,
@@ -1123,6 +1134,17 @@ namespace ktx
             <dd>KTX swizzle metadata.</dd>
             <dt>\--input-swizzle [rgba01]{4}</dt>
             <dd>Pre-swizzle input channels.</dd>
+            <dt>\--trace &lt;file&gt;</dt>
+            <dd>Record the duration of each processing stage, i.e. opening and
+                decoding the input images, color conversion, scaling, mipmap
+                generation, format conversion, encoding, metrics calculation,
+                supercompression and writing the output, and write it to
+                @e file in the Chrome trace-event JSON format. View it with
+                chrome://tracing or https://ui.perfetto.dev. ASTC encoding is
+                further split into levels and encoder threads. Each stage is
+                annotated with the peak resident memory of the process at its
+                end. The trace is also written if the command fails. No
+                instrumentation cost is incurred without this option.</dd>
             <dt>\--assign-tf &lt;transfer function&gt;</dt>
             <dd>Force the created texture to have the specified transfer function,
                 ignoring the transfer function of the input file(s). Possible
@@ -1354,6 +1376,7 @@ namespace ktx
      - Reorganize encoding options.
      - Improve explanation of use of @b \--format with @b \--encode.
      - Improve explanation of ASTC encoding.
+     - Add @b \--trace to record the duration of the processing stages.
 
     @section ktx_create_author AUTHOR
         - Mátyás Császár [Vader], RasterGrid www.rastergrid.com
@@ -1374,6 +1397,8 @@ namespace ktx
         uint32_t numFaces = 0;
         uint32_t baseDepth = 0;
 
+        std::unique_ptr<TraceRecorder> trace; // Null unless --trace is specified
+
     public:
         virtual int main(int argc, char *argv[]) override;
         virtual void initOptions(cxxopts::Options &opts) override;
@@ -1381,6 +1406,7 @@ namespace ktx
 
     private:
         void executeCreate();
+        void writeTrace();
         void encodeBasis(KTXTexture2 &texture, OptionsEncodeBasis<false> &opts);
         void encodeASTC(KTXTexture2 &texture, OptionsEncodeASTC &opts);
         void compress(KTXTexture2 &texture, const OptionsDeflate &opts);
@@ -1398,8 +1424,11 @@ namespace ktx
 
         [[nodiscard]] std::string readRawFile(const std::filesystem::path &filepath);
         [[nodiscard]] std::unique_ptr<Image> loadInputImage(ImageInput &inputImageFile);
-        std::vector<uint8_t> convert(const std::unique_ptr<Image> &image, VkFormat format,
-                                     ImageInput &inputFile);
+        void convert(const std::unique_ptr<Image> &image, VkFormat format, ImageInput &inputFile,
+                     uint8_t *dst, size_t dstSize);
+        void convertToTexture(KTXTexture2 &texture, const std::unique_ptr<Image> &image,
+                              ImageInput &inputFile, uint32_t levelIndex, uint32_t layerIndex,
+                              uint32_t faceSlice);
 
         std::unique_ptr<const ColorPrimaries> createColorPrimaries(khr_df_primaries_e primaries) const;
 
@@ -1426,20 +1455,33 @@ namespace ktx
                 "Create, encode and supercompress a KTX2 file from the input images specified as the\n"
                 "    input-file... arguments and save it as the output-file.",
                 argc, argv);
+            if (options.traceFilepath)
+                trace = std::make_unique<TraceRecorder>();
             executeCreate();
+            writeTrace();
             return +rc::SUCCESS;
         }
         catch (const FatalError &error)
         {
+            writeTrace();
             return +error.returnCode;
         }
         catch (const std::exception &e)
         {
-            fmt::print(std::cerr, "{} fatal: {}\n", commandName, e.what());
+            log(LogLevel::fatal, e.what());
+            writeTrace();
             return +rc::RUNTIME_ERROR;
         }
     }
 
+    void CommandCreate::writeTrace()
+    {
+        // Also written after a failure to show the stages that completed up to that point.
+        const auto recorder = std::move(trace);
+        if (recorder && !recorder->write(*options.traceFilepath))
+            warning("Failed to write trace file \"{}\": {}", *options.traceFilepath, errnoMessage());
+    }
+
     void CommandCreate::initOptions(cxxopts::Options &opts) { options.init(opts); }
 
     void CommandCreate::checkNumInputImages()
@@ -1536,6 +1578,12 @@ namespace ktx
             fatal_usage("--compare-ssim can only be used with BasisLZ, UASTC or ASTC encoding.");
         if (options.compare_psnr && !canCompare)
             fatal_usage("--compare-psnr can only be used with BasisLZ, UASTC or ASTC encoding.");
+        if (options.hasQualityTarget() && !canCompare)
+            fatal_usage("--target-psnr and --target-ssim can only be used with BasisLZ, UASTC or ASTC encoding.");
+        if (options.hasQualityTarget())
+            for (const auto *searched : {options.kAstcQuality, options.kUastcQuality, options.kQLevel})
+                if (args[searched].count())
+                    fatal_usage("--{} can't be used together with --target-psnr or --target-ssim.", searched);
 
         if (isFormatAstc(options.vkFormat) && !options.raw)
         {
@@ -1675,6 +1723,7 @@ namespace ktx
 
     std::string CommandCreate::readRawFile(const std::filesystem::path &filepath)
     {
+        TraceScope traceScope{trace.get(), "readRawFile"};
         std::string result;
         InputStream inputStream(filepath.string(), *this);
 
@@ -1757,9 +1806,11 @@ namespace ktx
             assert(ret == KTX_SUCCESS && "Internal error");
             (void)ret;
         } else {
+            TraceScope traceOpen{trace.get(), "ImageInput::open"};
             const auto inputImageFile = ImageInput::open(inputFilepath, nullptr, warningFn);
             inputImageFile->seekSubimage(
                 0, 0);  // Loading multiple subimage from the same input is not supported
+            traceOpen.end();
 
             ImageSpec::Origin usedSourceOrigin;
 
@@ -1950,6 +2001,7 @@ namespace ktx
                             fmtInFile(inputFilepath));
 
                     // Transform transfer function with primary transform
+                    TraceScope traceScope{trace.get(), "transformColorSpace", levelIndex};
                     image->transformColorSpace(*colorSpaceInfo.src.transferFunction,
                                                *colorSpaceInfo.dst.transferFunction,
                                                &primaryTransform);
@@ -1971,6 +2023,7 @@ namespace ktx
                             fmtInFile(inputFilepath));
 
                     // Transform transfer function without primary transform
+                    TraceScope traceScope{trace.get(), "transformColorSpace", levelIndex};
                     image->transformColorSpace(*colorSpaceInfo.src.transferFunction,
                                                *colorSpaceInfo.dst.transferFunction);
                 }
@@ -2044,15 +2097,9 @@ namespace ktx
 
             if (options.swizzleInput) image->swizzle(*options.swizzleInput);
 
-            const auto imageData = convert(image, options.vkFormat, *inputImageFile);
-
-            const auto ret = ktxTexture_SetImageFromMemory(
-                texture, levelIndex, layerIndex,
-                faceIndex + depthSliceIndex,  // Faces and Depths are mutually exclusive, Addition
-                                              // is acceptable
-                imageData.data(), imageData.size());
-            assert(ret == KTX_SUCCESS && "Internal error");
-            (void)ret;
+            convertToTexture(texture, image, *inputImageFile, levelIndex, layerIndex,
+                             faceIndex + depthSliceIndex);  // Faces and Depths are mutually
+                                                            // exclusive, Addition is acceptable
 
             if (options.mipmapGenerate) {
                 uint32_t numMipLevels = options.levels.value_or(maxLevels);
@@ -2079,21 +2126,37 @@ namespace ktx
         // Encode and apply compression
 
         MetricsCalculator metrics;
-        metrics.saveReferenceImages(texture, options, *this);
+        {
+            TraceScope traceScope{trace.get(), "metrics.saveReferenceImages"};
+            metrics.saveReferenceImages(texture, options, *this);
+        }
 
-        if (options.codec != BasisCodec::NONE)
-            encodeBasis(texture, options);
-        if (options.encodeASTC)
-            encodeASTC(texture, options);
+        if (options.hasQualityTarget() && (options.codec != BasisCodec::NONE || options.encodeASTC))
+        {
+            encodeToQualityTarget(
+                texture, options, [&](KTXTexture2 &target) { encodeASTC(target, options); },
+                [&](KTXTexture2 &target) { encodeBasis(target, options); }, *this);
+        }
+        else
+        {
+            if (options.codec != BasisCodec::NONE)
+                encodeBasis(texture, options);
+            if (options.encodeASTC)
+                encodeASTC(texture, options);
+        }
 
-        metrics.decodeAndCalculateMetrics(texture, options, *this);
+        {
+            TraceScope traceScope{trace.get(), "metrics.decodeAndCalculateMetrics"};
+            metrics.decodeAndCalculateMetrics(texture, options, *this);
+        }
 
         compress(texture, options);
 
         // Add KTXwriterScParams metadata if ASTC encoding, BasisU encoding, or other supercompression
         // was used
-        const auto writerScParams = fmt::format("{}{}{}{}", options.astcOptions, options.codecOptions,
-                                                options.commonOptions, options.compressOptions);
+        const auto writerScParams =
+            fmt::format("{}{}{}{}{}", options.astcOptions, options.codecOptions, options.commonOptions,
+                        options.targetOptions, options.compressOptions);
         if (writerScParams.size() > 0)
         {
             // Options always contain a leading space
@@ -2108,6 +2171,7 @@ namespace ktx
         if (outputPath.has_parent_path())
             std::filesystem::create_directories(outputPath.parent_path());
 
+        TraceScope traceScope{trace.get(), "writeKTX2"};
         OutputStream outputFile(options.outputFilepath, *this);
         outputFile.writeKTX2(texture, *this);
     }
@@ -2116,6 +2180,8 @@ namespace ktx
 
     void CommandCreate::encodeBasis(KTXTexture2 &texture, OptionsEncodeBasis<false> &opts)
     {
+        // The Basis encoder processes all levels in one job pool, so it is traced as a whole.
+        TraceScope traceScope{trace.get(), "encodeBasis"};
         auto ret = ktxTexture2_CompressBasisEx(texture, &opts);
         if (ret != KTX_SUCCESS)
             fatal(rc::KTX_FAILURE, "Failed to encode KTX2 file with codec \"{}\". KTX Error: {}",
@@ -2124,6 +2190,8 @@ namespace ktx
 
     void CommandCreate::encodeASTC(KTXTexture2 &texture, OptionsEncodeASTC &opts)
     {
+        TraceScope traceScope{trace.get(), "encodeASTC"};
+        ScopedLibktxTrace libktxTrace{trace.get()};
         const auto ret = ktxTexture2_CompressAstcEx(texture, &opts);
         if (ret != KTX_SUCCESS)
             fatal(rc::KTX_FAILURE, "Failed to encode KTX2 file with codec ASTC. KTX Error: {}",
@@ -2132,6 +2200,7 @@ namespace ktx
 
     void CommandCreate::compress(KTXTexture2 &texture, const OptionsDeflate &opts)
     {
+        TraceScope traceScope{trace.get(), "compress"};
         if (opts.zstd)
         {
             const auto ret = ktxTexture2_DeflateZstd(texture, *opts.zstd);
@@ -2151,6 +2220,7 @@ namespace ktx
 
     std::unique_ptr<Image> CommandCreate::loadInputImage(ImageInput &inputImageFile)
     {
+        TraceScope traceScope{trace.get(), "loadInputImage"};
         std::unique_ptr<Image> image = nullptr;
 
         const auto &inputFormat = inputImageFile.spec().format();
@@ -2210,19 +2280,19 @@ namespace ktx
         return image;
     }
 
-    std::vector<uint8_t> convertUNORMPacked(const std::unique_ptr<Image> &image, uint32_t C0,
-                                            uint32_t C1, uint32_t C2, uint32_t C3,
-                                            std::string_view swizzle = "")
+    void convertUNORMPacked(const std::unique_ptr<Image> &image, uint8_t *dst, size_t dstSize,
+                            uint32_t C0, uint32_t C1, uint32_t C2, uint32_t C3,
+                            std::string_view swizzle = "")
     {
         if (!swizzle.empty())
             image->swizzle(swizzle);
 
-        return image->getUNORMPacked(C0, C1, C2, C3);
+        image->getUNORMPacked(dst, dstSize, C0, C1, C2, C3);
     }
 
     template <typename T>
-    std::vector<uint8_t> convertUNORM(const std::unique_ptr<Image> &image,
-                                      std::string_view swizzle = "")
+    void convertUNORM(const std::unique_ptr<Image> &image, uint8_t *dst, size_t dstSize,
+                      std::string_view swizzle = "")
     {
         using ComponentT = typename T::Color::value_type;
         static constexpr auto componentCount = T::Color::getComponentCount();
@@ -2232,12 +2302,12 @@ namespace ktx
         if (!swizzle.empty())
             image->swizzle(swizzle);
 
-        return image->getUNORM(componentCount, bits);
+        image->getUNORM(dst, dstSize, componentCount, bits);
     }
 
     template <typename T>
-    std::vector<uint8_t> convertUNORMSBits(const std::unique_ptr<Image> &image, uint32_t sBits,
-                                           std::string_view swizzle = "")
+    void convertUNORMSBits(const std::unique_ptr<Image> &image, uint8_t *dst, size_t dstSize,
+                           uint32_t sBits, std::string_view swizzle = "")
     {
         using ComponentT = typename T::Color::value_type;
         static constexpr auto componentCount = T::Color::getComponentCount();
@@ -2247,12 +2317,12 @@ namespace ktx
         if (!swizzle.empty())
             image->swizzle(swizzle);
 
-        return image->getUNORM(componentCount, bits, sBits);
+        image->getUNORM(dst, dstSize, componentCount, bits, sBits);
     }
 
     template <typename T>
-    std::vector<uint8_t> convertSFLOAT(const std::unique_ptr<Image> &image,
-                                       std::string_view swizzle = "")
+    void convertSFLOAT(const std::unique_ptr<Image> &image, uint8_t *dst, size_t dstSize,
+                       std::string_view swizzle = "")
     {
         using ComponentT = typename T::Color::value_type;
         static constexpr auto componentCount = T::Color::getComponentCount();
@@ -2262,22 +2332,22 @@ namespace ktx
         if (!swizzle.empty())
             image->swizzle(swizzle);
 
-        return image->getSFloat(componentCount, bits);
+        image->getSFloat(dst, dstSize, componentCount, bits);
     }
 
-    std::vector<uint8_t> convertB10G11R11(const std::unique_ptr<Image> &image)
+    void convertB10G11R11(const std::unique_ptr<Image> &image, uint8_t *dst, size_t dstSize)
     {
-        return image->getB10G11R11();
+        image->getB10G11R11(dst, dstSize);
     }
 
-    std::vector<uint8_t> convertE5B9G9R9(const std::unique_ptr<Image> &image)
+    void convertE5B9G9R9(const std::unique_ptr<Image> &image, uint8_t *dst, size_t dstSize)
     {
-        return image->getE5B9G9R9();
+        image->getE5B9G9R9(dst, dstSize);
     }
 
     template <typename T>
-    std::vector<uint8_t> convertUINT(const std::unique_ptr<Image> &image,
-                                     std::string_view swizzle = "")
+    void convertUINT(const std::unique_ptr<Image> &image, uint8_t *dst, size_t dstSize,
+                     std::string_view swizzle = "")
     {
         using ComponentT = typename T::Color::value_type;
         static constexpr auto componentCount = T::Color::getComponentCount();
@@ -2287,32 +2357,32 @@ namespace ktx
         if (!swizzle.empty())
             image->swizzle(swizzle);
 
-        return image->getUINT(componentCount, bits);
+        image->getUINT(dst, dstSize, componentCount, bits);
     }
 
-    std::vector<uint8_t> convertUINTPacked(const std::unique_ptr<Image> &image, uint32_t c0 = 0,
-                                           uint32_t c1 = 0, uint32_t c2 = 0, uint32_t c3 = 0,
-                                           std::string_view swizzle = "")
+    void convertUINTPacked(const std::unique_ptr<Image> &image, uint8_t *dst, size_t dstSize,
+                           uint32_t c0 = 0, uint32_t c1 = 0, uint32_t c2 = 0, uint32_t c3 = 0,
+                           std::string_view swizzle = "")
     {
         if (!swizzle.empty())
             image->swizzle(swizzle);
 
-        return image->getUINTPacked(c0, c1, c2, c3);
+        image->getUINTPacked(dst, dstSize, c0, c1, c2, c3);
     }
 
-    std::vector<uint8_t> convertSINTPacked(const std::unique_ptr<Image> &image, uint32_t c0 = 0,
-                                           uint32_t c1 = 0, uint32_t c2 = 0, uint32_t c3 = 0,
-                                           std::string_view swizzle = "")
+    void convertSINTPacked(const std::unique_ptr<Image> &image, uint8_t *dst, size_t dstSize,
+                           uint32_t c0 = 0, uint32_t c1 = 0, uint32_t c2 = 0, uint32_t c3 = 0,
+                           std::string_view swizzle = "")
     {
         if (!swizzle.empty())
             image->swizzle(swizzle);
 
-        return image->getSINTPacked(c0, c1, c2, c3);
+        image->getSINTPacked(dst, dstSize, c0, c1, c2, c3);
     }
 
     template <typename T>
-    std::vector<uint8_t> convertSINT(const std::unique_ptr<Image> &image,
-                                     std::string_view swizzle = "")
+    void convertSINT(const std::unique_ptr<Image> &image, uint8_t *dst, size_t dstSize,
+                     std::string_view swizzle = "")
     {
         using ComponentT = typename T::Color::value_type;
         static constexpr auto componentCount = T::Color::getComponentCount();
@@ -2322,11 +2392,28 @@ namespace ktx
         if (!swizzle.empty())
             image->swizzle(swizzle);
 
-        return image->getSINT(componentCount, bits);
+        image->getSINT(dst, dstSize, componentCount, bits);
     }
 
-    std::vector<uint8_t> CommandCreate::convert(const std::unique_ptr<Image> &image, VkFormat vkFormat,
-                                                ImageInput &inputFile)
+    // Converts straight into the texture's image storage, no intermediate buffer.
+    void CommandCreate::convertToTexture(KTXTexture2 &texture, const std::unique_ptr<Image> &image,
+                                         ImageInput &inputFile, uint32_t levelIndex,
+                                         uint32_t layerIndex, uint32_t faceSlice)
+    {
+        TraceScope traceScope{trace.get(), "convert", levelIndex};
+        ktx_size_t imageOffset = 0;
+        const auto ret = ktxTexture_GetImageOffset(texture, levelIndex, layerIndex, faceSlice,
+                                                   &imageOffset);
+        assert(ret == KTX_SUCCESS && "Internal error");
+        (void)ret;
+
+        const auto imageSize = ktxTexture_GetImageSize(texture, levelIndex);
+        assert(imageOffset + imageSize <= texture->dataSize && "Internal error");
+        convert(image, options.vkFormat, inputFile, texture->pData + imageOffset, imageSize);
+    }
+
+    void CommandCreate::convert(const std::unique_ptr<Image> &image, VkFormat vkFormat,
+                                ImageInput &inputFile, uint8_t *dst, size_t dstSize)
     {
         const uint32_t inputBitDepth =
             std::max(8u, inputFile.spec().format().largestChannelBitLength());
@@ -2441,22 +2528,22 @@ namespace ktx
             [[fallthrough]];
         case VK_FORMAT_R8_SRGB:
             requireUNORM(8);
-            return convertUNORM<r8image>(image);
+            return convertUNORM<r8image>(image, dst, dstSize);
         case VK_FORMAT_R8G8_UNORM:
             [[fallthrough]];
         case VK_FORMAT_R8G8_SRGB:
             requireUNORM(8);
-            return convertUNORM<rg8image>(image);
+            return convertUNORM<rg8image>(image, dst, dstSize);
         case VK_FORMAT_R8G8B8_UNORM:
             [[fallthrough]];
         case VK_FORMAT_R8G8B8_SRGB:
             requireUNORM(8);
-            return convertUNORM<rgb8image>(image);
+            return convertUNORM<rgb8image>(image, dst, dstSize);
         case VK_FORMAT_B8G8R8_UNORM:
             [[fallthrough]];
         case VK_FORMAT_B8G8R8_SRGB:
             requireUNORM(8);
-            return convertUNORM<rgb8image>(image, "bgr1");
+            return convertUNORM<rgb8image>(image, dst, dstSize, "bgr1");
 
             // Verbatim copy with component reordering if needed, extra channels must be dropped.
             //
@@ -2471,12 +2558,12 @@ namespace ktx
             [[fallthrough]];
         case VK_FORMAT_A8B8G8R8_SRGB_PACK32:
             requireUNORM(8);
-            return convertUNORM<rgba8image>(image);
+            return convertUNORM<rgba8image>(image, dst, dstSize);
         case VK_FORMAT_B8G8R8A8_UNORM:
             [[fallthrough]];
         case VK_FORMAT_B8G8R8A8_SRGB:
             requireUNORM(8);
-            return convertUNORM<rgba8image>(image, "bgra");
+            return convertUNORM<rgba8image>(image, dst, dstSize, "bgra");
 
             // Verbatim copy with component reordering if needed, extra channels must be dropped.
 
@@ -2542,93 +2629,93 @@ namespace ktx
             // R8G8B8A8_UNORM followed by the ASTC encoding
             requireUNORM(8);
             assert(false && "Internal error");
-            return {};
+            return;
 
             // Passthrough CLI options to the ASTC encoder.
 
         case VK_FORMAT_R4G4_UNORM_PACK8:
             requireUNORM(8);
-            return convertUNORMPacked(image, 4, 4, 0, 0);
+            return convertUNORMPacked(image, dst, dstSize, 4, 4, 0, 0);
         case VK_FORMAT_R5G6B5_UNORM_PACK16:
             requireUNORM(8);
-            return convertUNORMPacked(image, 5, 6, 5, 0);
+            return convertUNORMPacked(image, dst, dstSize, 5, 6, 5, 0);
         case VK_FORMAT_B5G6R5_UNORM_PACK16:
             requireUNORM(8);
-            return convertUNORMPacked(image, 5, 6, 5, 0, "bgr1");
+            return convertUNORMPacked(image, dst, dstSize, 5, 6, 5, 0, "bgr1");
 
         case VK_FORMAT_R4G4B4A4_UNORM_PACK16:
             requireUNORM(8);
-            return convertUNORMPacked(image, 4, 4, 4, 4);
+            return convertUNORMPacked(image, dst, dstSize, 4, 4, 4, 4);
         case VK_FORMAT_B4G4R4A4_UNORM_PACK16:
             requireUNORM(8);
-            return convertUNORMPacked(image, 4, 4, 4, 4, "bgra");
+            return convertUNORMPacked(image, dst, dstSize, 4, 4, 4, 4, "bgra");
         case VK_FORMAT_R5G5B5A1_UNORM_PACK16:
             requireUNORM(8);
-            return convertUNORMPacked(image, 5, 5, 5, 1);
+            return convertUNORMPacked(image, dst, dstSize, 5, 5, 5, 1);
         case VK_FORMAT_B5G5R5A1_UNORM_PACK16:
             requireUNORM(8);
-            return convertUNORMPacked(image, 5, 5, 5, 1, "bgra");
+            return convertUNORMPacked(image, dst, dstSize, 5, 5, 5, 1, "bgra");
         case VK_FORMAT_A1R5G5B5_UNORM_PACK16:
             requireUNORM(8);
-            return convertUNORMPacked(image, 1, 5, 5, 5, "argb");
+            return convertUNORMPacked(image, dst, dstSize, 1, 5, 5, 5, "argb");
         case VK_FORMAT_A1B5G5R5_UNORM_PACK16_KHR:
             requireUNORM(8);
-            return convertUNORMPacked(image, 1, 5, 5, 5, "abgr");
+            return convertUNORMPacked(image, dst, dstSize, 1, 5, 5, 5, "abgr");
         case VK_FORMAT_A4R4G4B4_UNORM_PACK16:
             requireUNORM(8);
-            return convertUNORMPacked(image, 4, 4, 4, 4, "argb");
+            return convertUNORMPacked(image, dst, dstSize, 4, 4, 4, 4, "argb");
         case VK_FORMAT_A4B4G4R4_UNORM_PACK16:
             requireUNORM(8);
-            return convertUNORMPacked(image, 4, 4, 4, 4, "abgr");
+            return convertUNORMPacked(image, dst, dstSize, 4, 4, 4, 4, "abgr");
 
             // Input values must be rounded to the target precision.
             // When the input file contains an sBIT chunk, its values must be taken into account.
 
         case VK_FORMAT_R10X6_UNORM_PACK16:
             requireUNORM(10);
-            return convertUNORMSBits<r16image>(image, 10);
+            return convertUNORMSBits<r16image>(image, dst, dstSize, 10);
         case VK_FORMAT_R10X6G10X6_UNORM_2PACK16:
             requireUNORM(10);
-            return convertUNORMSBits<rg16image>(image, 10);
+            return convertUNORMSBits<rg16image>(image, dst, dstSize, 10);
         case VK_FORMAT_R10X6G10X6B10X6A10X6_UNORM_4PACK16:
             requireUNORM(10);
-            return convertUNORMSBits<rgba16image>(image, 10);
+            return convertUNORMSBits<rgba16image>(image, dst, dstSize, 10);
 
         case VK_FORMAT_R12X4_UNORM_PACK16:
             requireUNORM(12);
-            return convertUNORMSBits<r16image>(image, 12);
+            return convertUNORMSBits<r16image>(image, dst, dstSize, 12);
         case VK_FORMAT_R12X4G12X4_UNORM_2PACK16:
             requireUNORM(12);
-            return convertUNORMSBits<rg16image>(image, 12);
+            return convertUNORMSBits<rg16image>(image, dst, dstSize, 12);
         case VK_FORMAT_R12X4G12X4B12X4A12X4_UNORM_4PACK16:
             requireUNORM(12);
-            return convertUNORMSBits<rgba16image>(image, 12);
+            return convertUNORMSBits<rgba16image>(image, dst, dstSize, 12);
 
             // Input values must be rounded to the target precision.
             // When the input file contains an sBIT chunk, its values must be taken into account.
 
         case VK_FORMAT_R16_UNORM:
             requireUNORM(16);
-            return convertUNORM<r16image>(image);
+            return convertUNORM<r16image>(image, dst, dstSize);
         case VK_FORMAT_R16G16_UNORM:
             requireUNORM(16);
-            return convertUNORM<rg16image>(image);
+            return convertUNORM<rg16image>(image, dst, dstSize);
         case VK_FORMAT_R16G16B16_UNORM:
             requireUNORM(16);
-            return convertUNORM<rgb16image>(image);
+            return convertUNORM<rgb16image>(image, dst, dstSize);
         case VK_FORMAT_R16G16B16A16_UNORM:
             requireUNORM(16);
-            return convertUNORM<rgba16image>(image);
+            return convertUNORM<rgba16image>(image, dst, dstSize);
 
             // Verbatim copy, extra channels must be dropped.
             // Input PNG file must be 16-bit with sBIT chunk missing or signaling 16 bits.
 
         case VK_FORMAT_A2R10G10B10_UNORM_PACK32:
             requireUNORM(10);
-            return convertUNORMPacked(image, 2, 10, 10, 10, "argb");
+            return convertUNORMPacked(image, dst, dstSize, 2, 10, 10, 10, "argb");
         case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
             requireUNORM(10);
-            return convertUNORMPacked(image, 2, 10, 10, 10, "abgr");
+            return convertUNORMPacked(image, dst, dstSize, 2, 10, 10, 10, "abgr");
 
             // Input values must be rounded to the target precision.
             // When the input file contains an sBIT chunk, its values must be taken into account.
@@ -2656,132 +2743,132 @@ namespace ktx
 
         case VK_FORMAT_R8_UINT:
             requireSFloat(16);
-            return convertUINT<r8image>(image);
+            return convertUINT<r8image>(image, dst, dstSize);
         case VK_FORMAT_R8_SINT:
             requireSFloat(16);
-            return convertSINT<r8image>(image);
+            return convertSINT<r8image>(image, dst, dstSize);
         case VK_FORMAT_R16_UINT:
             requireSFloat(32);
-            return convertUINT<r16image>(image);
+            return convertUINT<r16image>(image, dst, dstSize);
         case VK_FORMAT_R16_SINT:
             requireSFloat(32);
-            return convertSINT<r16image>(image);
+            return convertSINT<r16image>(image, dst, dstSize);
         case VK_FORMAT_R32_UINT:
             requireUINT(32);
-            return convertUINT<r32image>(image);
+            return convertUINT<r32image>(image, dst, dstSize);
         case VK_FORMAT_R8G8_UINT:
             requireSFloat(16);
-            return convertUINT<rg8image>(image);
+            return convertUINT<rg8image>(image, dst, dstSize);
         case VK_FORMAT_R8G8_SINT:
             requireSFloat(16);
-            return convertSINT<rg8image>(image);
+            return convertSINT<rg8image>(image, dst, dstSize);
         case VK_FORMAT_R16G16_UINT:
             requireSFloat(32);
-            return convertUINT<rg16image>(image);
+            return convertUINT<rg16image>(image, dst, dstSize);
         case VK_FORMAT_R16G16_SINT:
             requireSFloat(32);
-            return convertSINT<rg16image>(image);
+            return convertSINT<rg16image>(image, dst, dstSize);
         case VK_FORMAT_R32G32_UINT:
             requireUINT(32);
-            return convertUINT<rg32image>(image);
+            return convertUINT<rg32image>(image, dst, dstSize);
         case VK_FORMAT_R8G8B8_UINT:
             requireSFloat(16);
-            return convertUINT<rgb8image>(image);
+            return convertUINT<rgb8image>(image, dst, dstSize);
         case VK_FORMAT_R8G8B8_SINT:
             requireSFloat(16);
-            return convertSINT<rgb8image>(image);
+            return convertSINT<rgb8image>(image, dst, dstSize);
         case VK_FORMAT_B8G8R8_UINT:
             requireSFloat(16);
-            return convertUINT<rgb8image>(image, "bgr1");
+            return convertUINT<rgb8image>(image, dst, dstSize, "bgr1");
         case VK_FORMAT_B8G8R8_SINT:
             requireSFloat(16);
-            return convertSINT<rgb8image>(image, "bgr1");
+            return convertSINT<rgb8image>(image, dst, dstSize, "bgr1");
         case VK_FORMAT_R16G16B16_UINT:
             requireSFloat(32);
-            return convertUINT<rgb16image>(image);
+            return convertUINT<rgb16image>(image, dst, dstSize);
         case VK_FORMAT_R16G16B16_SINT:
             requireSFloat(32);
-            return convertSINT<rgb16image>(image);
+            return convertSINT<rgb16image>(image, dst, dstSize);
         case VK_FORMAT_R32G32B32_UINT:
             requireUINT(32);
-            return convertUINT<rgb32image>(image);
+            return convertUINT<rgb32image>(image, dst, dstSize);
         case VK_FORMAT_R8G8B8A8_UINT:
             [[fallthrough]];
         case VK_FORMAT_A8B8G8R8_UINT_PACK32:
             requireSFloat(16);
-            return convertUINT<rgba8image>(image);
+            return convertUINT<rgba8image>(image, dst, dstSize);
         case VK_FORMAT_R8G8B8A8_SINT:
             [[fallthrough]];
         case VK_FORMAT_A8B8G8R8_SINT_PACK32:
             requireSFloat(16);
-            return convertSINT<rgba8image>(image);
+            return convertSINT<rgba8image>(image, dst, dstSize);
         case VK_FORMAT_B8G8R8A8_UINT:
             requireSFloat(16);
-            return convertUINT<rgba8image>(image, "bgra");
+            return convertUINT<rgba8image>(image, dst, dstSize, "bgra");
         case VK_FORMAT_B8G8R8A8_SINT:
             requireSFloat(16);
-            return convertSINT<rgba8image>(image, "bgra");
+            return convertSINT<rgba8image>(image, dst, dstSize, "bgra");
         case VK_FORMAT_R16G16B16A16_UINT:
             requireSFloat(32);
-            return convertUINT<rgba16image>(image);
+            return convertUINT<rgba16image>(image, dst, dstSize);
         case VK_FORMAT_R16G16B16A16_SINT:
             requireSFloat(32);
-            return convertSINT<rgba16image>(image);
+            return convertSINT<rgba16image>(image, dst, dstSize);
         case VK_FORMAT_R32G32B32A32_UINT:
             requireUINT(32);
-            return convertUINT<rgba32image>(image);
+            return convertUINT<rgba32image>(image, dst, dstSize);
 
         case VK_FORMAT_A2R10G10B10_UINT_PACK32:
             requireSFloat(16);
-            return convertUINTPacked(image, 2, 10, 10, 10, "argb");
+            return convertUINTPacked(image, dst, dstSize, 2, 10, 10, 10, "argb");
         case VK_FORMAT_A2R10G10B10_SINT_PACK32:
             requireSFloat(16);
-            return convertSINTPacked(image, 2, 10, 10, 10, "argb");
+            return convertSINTPacked(image, dst, dstSize, 2, 10, 10, 10, "argb");
         case VK_FORMAT_A2B10G10R10_UINT_PACK32:
             requireSFloat(16);
-            return convertUINTPacked(image, 2, 10, 10, 10, "abgr");
+            return convertUINTPacked(image, dst, dstSize, 2, 10, 10, 10, "abgr");
         case VK_FORMAT_A2B10G10R10_SINT_PACK32:
             requireSFloat(16);
-            return convertSINTPacked(image, 2, 10, 10, 10, "abgr");
+            return convertSINTPacked(image, dst, dstSize, 2, 10, 10, 10, "abgr");
 
             // The same EXR pixel types as for the decoding must be enforced.
             // Extra channels must be dropped.
 
         case VK_FORMAT_R16_SFLOAT:
             requireSFloat(16);
-            return convertSFLOAT<r16image>(image);
+            return convertSFLOAT<r16image>(image, dst, dstSize);
         case VK_FORMAT_R16G16_SFLOAT:
             requireSFloat(16);
-            return convertSFLOAT<rg16image>(image);
+            return convertSFLOAT<rg16image>(image, dst, dstSize);
         case VK_FORMAT_R16G16B16_SFLOAT:
             requireSFloat(16);
-            return convertSFLOAT<rgb16image>(image);
+            return convertSFLOAT<rgb16image>(image, dst, dstSize);
         case VK_FORMAT_R16G16B16A16_SFLOAT:
             requireSFloat(16);
-            return convertSFLOAT<rgba16image>(image);
+            return convertSFLOAT<rgba16image>(image, dst, dstSize);
 
         case VK_FORMAT_R32_SFLOAT:
             requireSFloat(32);
-            return convertSFLOAT<r32image>(image);
+            return convertSFLOAT<r32image>(image, dst, dstSize);
         case VK_FORMAT_R32G32_SFLOAT:
             requireSFloat(32);
-            return convertSFLOAT<rg32image>(image);
+            return convertSFLOAT<rg32image>(image, dst, dstSize);
         case VK_FORMAT_R32G32B32_SFLOAT:
             requireSFloat(32);
-            return convertSFLOAT<rgb32image>(image);
+            return convertSFLOAT<rgb32image>(image, dst, dstSize);
         case VK_FORMAT_R32G32B32A32_SFLOAT:
             requireSFloat(32);
-            return convertSFLOAT<rgba32image>(image);
+            return convertSFLOAT<rgba32image>(image, dst, dstSize);
 
             // The same EXR pixel types as for the decoding must be enforced.
             // Extra channels must be dropped.
 
         case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
             requireSFloat(16);
-            return convertB10G11R11(image);
+            return convertB10G11R11(image, dst, dstSize);
         case VK_FORMAT_E5B9G9R9_UFLOAT_PACK32:
             requireSFloat(16);
-            return convertE5B9G9R9(image);
+            return convertE5B9G9R9(image, dst, dstSize);
 
             // Input data must be rounded to the target precision.
 
@@ -2805,7 +2892,7 @@ namespace ktx
         case VK_FORMAT_A8_UNORM_KHR:
             // Special case for alpha-only
             requireUNORM(8);
-            return convertUNORM<r8image>(image, "a000");
+            return convertUNORM<r8image>(image, dst, dstSize, "a000");
             break;
 
             // Not supported
@@ -2816,7 +2903,6 @@ namespace ktx
         }
 
         assert(false && "Internal error");
-        return {};
     }
 
     KTXTexture2 CommandCreate::createTexture(const ImageSpec &target)
@@ -2896,6 +2982,7 @@ namespace ktx
     std::unique_ptr<Image> CommandCreate::scaleImage(std::unique_ptr<Image> image, ktx_uint32_t width,
                                                      ktx_uint32_t height)
     {
+        TraceScope traceScope{trace.get(), "scaleImage"};
         try
         {
             image = image->resample(
@@ -2919,11 +3006,13 @@ namespace ktx
             fatal(rc::NOT_SUPPORTED, "Mipmap generation for SINT or UINT format {} is not supported.",
                   toString(static_cast<VkFormat>(texture->vkFormat)));
 
+        TraceScope traceScope{trace.get(), "generateMipLevels"};
         const auto baseWidth = image->getWidth();
         const auto baseHeight = image->getHeight();
 
         for (uint32_t mipLevelIndex = 1; mipLevelIndex < numMipLevels; ++mipLevelIndex)
         {
+            TraceScope traceLevel{trace.get(), "generateMipLevels level", mipLevelIndex};
             const auto mipImageWidth = std::max(1u, baseWidth >> (mipLevelIndex));
             const auto mipImageHeight = std::max(1u, baseHeight >> (mipLevelIndex));
 
@@ -2943,15 +3032,9 @@ namespace ktx
             if (options.normalize)
                 image->normalize();
 
-            const auto imageData = convert(image, options.vkFormat, inputFile);
-
-            const auto ret = ktxTexture_SetImageFromMemory(
-                texture, mipLevelIndex, layerIndex,
-                faceIndex +
-                    depthSliceIndex, // Faces and Depths are mutually exclusive, Addition is acceptable
-                imageData.data(), imageData.size());
-            assert(ret == KTX_SUCCESS && "Internal error");
-            (void)ret;
+            convertToTexture(texture, image, inputFile, mipLevelIndex, layerIndex,
+                             faceIndex + depthSliceIndex); // Faces and Depths are mutually
+                                                           // exclusive, Addition is acceptable
         }
     }
 
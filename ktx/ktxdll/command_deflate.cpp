@@ -47,6 +47,11 @@ Deflate (supercompress) a KTX2 file.
     error is displayed to the stderr and the command exits with the relevant
     non-zero status code.
 
+    When the output is written to a file the levels are read, deflated and
+    written one at a time and the level index is filled in afterwards, so
+    only about a single level is held in memory. When writing to the stdout
+    the whole texture is deflated in memory before being written.
+
     @b ktx @b deflate cannot be applied to KTX files that have been
     supercompressed with BasisLZ.
 
@@ -58,9 +63,19 @@ Deflate (supercompress) a KTX2 file.
         <dd>Silence warning about already supercompressed input fiile.</dd>
         <dt>-e, --warnings-as-errors</dt>
         <dd>Treat warnings as errors.</dd>
+        <dt>--recompress</dt>
+        <dd>Re-deflate an input file that is already supercompressed with
+            Zstd or ZLIB without a warning about the existing
+            supercompression.</dd>
     </dl>
     @snippet{doc} ktx/command.h command options_generic
 
+    Unless the output is written to the stdout the levels are inflated, if
+    needed, and deflated one at a time while writing, without loading the
+    whole texture. When the output file is the input file the result is
+    written to a temporary file next to it that replaces the input once
+    complete.
+
 @section ktx_deflate_exitstatus EXIT STATUS
     @snippet{doc} ktx/command.h command exitstatus
 
@@ -69,6 +84,10 @@ Deflate (supercompress) a KTX2 file.
 @par Version 4.0
  - Initial version
 
+@par Version 4.4
+ - Stream the deflated levels to the output file, also when deflating
+   a file in place, and add --recompress
+
 @section ktx_deflate_author AUTHOR
     - Mark Callow [\@MarkCallow]
 */
@@ -80,8 +99,10 @@ class CommandDeflate : public Command {
     struct Options {
         inline static const char* kQuiet = "quiet";
         inline static const char* kWarningsAsErrors = "warnings-as-errors";
+        inline static const char* kRecompress = "recompress";
         bool quiet = false;
         bool warningsAsErrors = false;
+        bool recompress = false;
         void init(cxxopts::Options& opts);
         void process(cxxopts::Options& opts, cxxopts::ParseResult& args, Reporter& report);
     };
@@ -94,7 +115,8 @@ public:
     virtual void processOptions(cxxopts::Options& opts, cxxopts::ParseResult& args) override;
 
 private:
-    void executeDeflate();
+    void executeDeflateInPlace();
+    void executeDeflate(const std::string& outputFilepath);
 };
 
 // -------------------------------------------------------------------------------------------------
@@ -105,12 +127,18 @@ int CommandDeflate::main(int argc, char* argv[]) {
                 "Deflate (supercompress) the KTX file specified as the input-file\n"
                 "    and save it as the output-file.",
                 argc, argv);
-        executeDeflate();
+        std::error_code ec;
+        if (options.inputFilepath != "-" && options.outputFilepath != "-" &&
+                std::filesystem::equivalent(DecodeUTF8Path(options.inputFilepath),
+                                            DecodeUTF8Path(options.outputFilepath), ec))
+            executeDeflateInPlace();
+        else
+            executeDeflate(options.outputFilepath);
         return +rc::SUCCESS;
     } catch (const FatalError& error) {
         return +error.returnCode;
     } catch (const std::exception& e) {
-        fmt::print(std::cerr, "{} fatal: {}\n", commandName, e.what());
+        log(LogLevel::fatal, e.what());
         return +rc::RUNTIME_ERROR;
     }
 }
@@ -118,7 +146,8 @@ int CommandDeflate::main(int argc, char* argv[]) {
 void CommandDeflate::Options::init(cxxopts::Options& opts) {
     opts.add_options()
         (kQuiet, "Don't print warning when input file is already supercompressed.")
-        (kWarningsAsErrors, "Exit with error when input file is already supercompressed");
+        (kWarningsAsErrors, "Exit with error when input file is already supercompressed")
+        (kRecompress, "Re-deflate input already supercompressed with Zstd or ZLIB without a warning.");
 }
 
 void CommandDeflate::Options::process(cxxopts::Options&,
@@ -126,6 +155,7 @@ void CommandDeflate::Options::process(cxxopts::Options&,
                                              Reporter& report) {
     quiet = args[kQuiet].as<bool>();
     warningsAsErrors = args[kWarningsAsErrors].as<bool>();
+    recompress = args[kRecompress].as<bool>();
     if (quiet && warningsAsErrors) {
         report.fatal_usage("Cannot specify both --{} and --{}.",
                            this->kQuiet, this->kWarningsAsErrors);
@@ -144,21 +174,47 @@ void CommandDeflate::processOptions(cxxopts::Options& opts, cxxopts::ParseResult
     }
 }
 
-void CommandDeflate::executeDeflate() {
+// Opening the output truncates it, so the levels of a file deflated onto
+// itself are streamed to a temporary file in the same directory, which is
+// renamed over the input once the input is closed.
+void CommandDeflate::executeDeflateInPlace() {
+    const auto tempFilepath = options.outputFilepath + ".deflate-tmp";
+    std::error_code ec;
+    try {
+        executeDeflate(tempFilepath);
+    } catch (...) {
+        std::filesystem::remove(DecodeUTF8Path(tempFilepath), ec);
+        throw;
+    }
+
+    std::filesystem::rename(DecodeUTF8Path(tempFilepath), DecodeUTF8Path(options.outputFilepath), ec);
+    if (ec) {
+        std::error_code removeEc;
+        std::filesystem::remove(DecodeUTF8Path(tempFilepath), removeEc);
+        fatal(rc::IO_FAILURE, "Failed to replace \"{}\": {}.", options.outputFilepath, ec.message());
+    }
+}
+
+void CommandDeflate::executeDeflate(const std::string& outputFilepath) {
     InputStream inputStream(options.inputFilepath, *this);
     validateToolInput(inputStream, fmtInFile(options.inputFilepath), *this);
 
+    // The image data is only loaded when deflating in memory. Otherwise the
+    // levels are read from the input stream one at a time while writing.
     KTXTexture2 texture{nullptr};
     StreambufStream<std::streambuf*> ktx2Stream{inputStream->rdbuf(), std::ios::in | std::ios::binary};
-    auto ret = ktxTexture2_CreateFromStream(ktx2Stream.stream(), KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, texture.pHandle());
+    auto ret = ktxTexture2_CreateFromStream(ktx2Stream.stream(), KTX_TEXTURE_CREATE_NO_FLAGS, texture.pHandle());
     if (ret != KTX_SUCCESS)
         fatal(rc::INVALID_FILE, "Failed to create KTX2 texture: {}", ktxErrorString(ret));
 
+    // Streaming needs a seekable output to patch the level index at the end.
+    const bool streamOutput = outputFilepath != "-";
+
     if (texture->supercompressionScheme != KTX_SS_NONE) {
         switch (texture->supercompressionScheme) {
           case KTX_SS_ZLIB:
           case KTX_SS_ZSTD:
-            if (!options.quiet) {
+            if (!options.quiet && !options.recompress) {
                 warning("Modifying existing {} supercompression of {}.",
                         toString(texture->supercompressionScheme),
                         options.inputFilepath);
@@ -171,16 +227,22 @@ void CommandDeflate::executeDeflate() {
         }
     }
 
-    if (options.zstd) {
-        ret = ktxTexture2_DeflateZstd(texture, *options.zstd);
+    if (!streamOutput) {
+        ret = ktxTexture2_LoadImageData(texture, nullptr, 0);
         if (ret != KTX_SUCCESS)
-            fatal(rc::IO_FAILURE, "Zstd deflation failed. KTX Error: {}", ktxErrorString(ret));
-    }
+            fatal(rc::INVALID_FILE, "Failed to load image data: {}", ktxErrorString(ret));
 
-    if (options.zlib) {
-        ret = ktxTexture2_DeflateZLIB(texture, *options.zlib);
-        if (ret != KTX_SUCCESS)
-            fatal(rc::IO_FAILURE, "ZLIB deflation failed. KTX Error: {}", ktxErrorString(ret));
+        if (options.zstd) {
+            ret = ktxTexture2_DeflateZstd(texture, *options.zstd);
+            if (ret != KTX_SUCCESS)
+                fatal(rc::IO_FAILURE, "Zstd deflation failed. KTX Error: {}", ktxErrorString(ret));
+        }
+
+        if (options.zlib) {
+            ret = ktxTexture2_DeflateZLIB(texture, *options.zlib);
+            if (ret != KTX_SUCCESS)
+                fatal(rc::IO_FAILURE, "ZLIB deflation failed. KTX Error: {}", ktxErrorString(ret));
+        }
     }
 
     const auto& findMetadataValue = [&](const char* const key) {
@@ -307,12 +369,19 @@ void CommandDeflate::executeDeflate() {
     updateMetadataValue(KTX_WRITER_SCPARAMS_KEY, writerScParams);
 
     // Save output file
-    const auto outputPath = std::filesystem::path(DecodeUTF8Path(options.outputFilepath));
+    const auto outputPath = std::filesystem::path(DecodeUTF8Path(outputFilepath));
     if (outputPath.has_parent_path())
         std::filesystem::create_directories(outputPath.parent_path());
 
-    OutputStream outputFile(options.outputFilepath, *this);
-    outputFile.writeKTX2(texture, *this);
+    OutputStream outputFile(outputFilepath, *this);
+    if (streamOutput) {
+        if (options.zstd)
+            outputFile.writeKTX2Deflated(texture, KTX_SS_ZSTD, *options.zstd, *this);
+        else
+            outputFile.writeKTX2Deflated(texture, KTX_SS_ZLIB, *options.zlib, *this);
+    } else {
+        outputFile.writeKTX2(texture, *this);
+    }
 }
 
 } // namespace ktx
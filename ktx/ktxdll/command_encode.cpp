@@ -136,7 +136,7 @@ int CommandEncode::main(int argc, char* argv[]) {
     } catch (const FatalError& error) {
         return +error.returnCode;
     } catch (const std::exception& e) {
-        fmt::print(std::cerr, "{} fatal: {}\n", commandName, e.what());
+        log(LogLevel::fatal, e.what());
         return +rc::RUNTIME_ERROR;
     }
 }
@@ -203,6 +203,12 @@ void CommandEncode::processOptions(cxxopts::Options& opts, cxxopts::ParseResult&
         fatal_usage("--compare-ssim can only be used with BasisLZ, UASTC or ASTC encoding.");
     if (options.compare_psnr && !canCompare)
         fatal_usage("--compare-psnr can only be used with BasisLZ, UASTC or ASTC encoding.");
+    if (options.hasQualityTarget() && !canCompare)
+        fatal_usage("--target-psnr and --target-ssim can only be used with BasisLZ, UASTC or ASTC encoding.");
+    if (options.hasQualityTarget())
+        for (const auto* searched : {options.kAstcQuality, options.kUastcQuality, options.kQLevel})
+            if (args[searched].count())
+                fatal_usage("--{} can't be used together with --target-psnr or --target-ssim.", searched);
 
     if (astcCodec)
         options.encodeASTC = true;
@@ -262,16 +268,26 @@ void CommandEncode::executeEncode() {
     MetricsCalculator metrics;
     metrics.saveReferenceImages(texture, options, *this);
 
-    if (options.vkFormat != VK_FORMAT_UNDEFINED) {
+    const auto encodeASTC = [&](KTXTexture2& target) {
+       const auto result = ktxTexture2_CompressAstcEx(target, &options);
+       if (result != KTX_SUCCESS)
+           fatal(rc::IO_FAILURE, "Failed to encode KTX2 file to ASTC. KTX Error: {}", ktxErrorString(result));
+    };
+    const auto encodeBasis = [&](KTXTexture2& target) {
+       const auto result = ktxTexture2_CompressBasisEx(target, &options);
+       if (result != KTX_SUCCESS)
+           fatal(rc::IO_FAILURE, "Failed to encode KTX2 file with codec \"{}\". KTX Error: {}", options.codecName, ktxErrorString(result));
+    };
+
+    if (options.vkFormat != VK_FORMAT_UNDEFINED)
        options.mode = KTX_PACK_ASTC_ENCODER_MODE_LDR; // TODO: Fix me for HDR textures
-       ret = ktxTexture2_CompressAstcEx(texture, &options);
-       if (ret != KTX_SUCCESS)
-           fatal(rc::IO_FAILURE, "Failed to encode KTX2 file to ASTC. KTX Error: {}", ktxErrorString(ret));
-    } else {
-       ret = ktxTexture2_CompressBasisEx(texture, &options);
-       if (ret != KTX_SUCCESS)
-           fatal(rc::IO_FAILURE, "Failed to encode KTX2 file with codec \"{}\". KTX Error: {}", options.codecName, ktxErrorString(ret));
-    }
+
+    if (options.hasQualityTarget())
+       encodeToQualityTarget(texture, options, encodeASTC, encodeBasis, *this);
+    else if (options.vkFormat != VK_FORMAT_UNDEFINED)
+       encodeASTC(texture);
+    else
+       encodeBasis(texture);
 
     metrics.decodeAndCalculateMetrics(texture, options, *this);
 
@@ -288,7 +304,7 @@ void CommandEncode::executeEncode() {
     }
 
     // Add KTXwriterScParams metadata
-    const auto writerScParams = fmt::format("{}{}{}", options.codecOptions, options.commonOptions, options.compressOptions);
+    const auto writerScParams = fmt::format("{}{}{}{}", options.codecOptions, options.commonOptions, options.targetOptions, options.compressOptions);
     ktxHashList_DeleteKVPair(&texture->kvDataHead, KTX_WRITER_SCPARAMS_KEY);
     if (writerScParams.size() > 0) {
         // Options always contain a leading space
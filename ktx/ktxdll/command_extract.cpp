@@ -13,11 +13,16 @@
 #include "transcode_utils.h"
 #include "image.hpp"
 #include "ktx.h"
+#include "ktxint.h"
+#include "texture2.h"
 #include <array>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include <cxxopts.hpp>
 #include <fmt/ostream.h>
@@ -111,6 +116,18 @@ Extract selected images from a KTX2 file.
         <dt>\--raw</dt>
         <dd>Extract the raw image data without any conversion.
         </dd>
+        <dt>\--png-compression store | fast | default | best</dt>
+        <dd>Trade PNG output size for encoding speed. 'store' writes
+            uncompressed deflate blocks and is meant for quick debug dumps,
+            'fast' uses a small LZ77 window without filtering, 'best' uses the
+            largest window and entropy based filtering. Defaults to 'default'.
+        </dd>
+        <dt>\--threads &lt;count&gt;</dt>
+        <dd>Number of threads used to convert and write the images of a
+            multi-output extract. Output file names do not depend on it.
+            By default the number of threads reported by
+            @c thread::hardware_concurrency or 1 if value returned is 0.
+        </dd>
     </dl>
     @snippet{doc} ktx/command.h command options_generic
 
@@ -138,6 +155,15 @@ class CommandExtract : public Command {
         inline static const char* kDepth = "depth";
         inline static const char* kAll = "all";
         inline static const char* kRaw = "raw";
+        inline static const char* kPngCompression = "png-compression";
+        inline static const char* kThreads = "threads";
+
+        enum class PngCompression {
+            store,
+            fast,
+            normal,
+            best,
+        };
 
         std::string outputPath;
         FragmentURI fragmentURI;
@@ -149,6 +175,8 @@ class CommandExtract : public Command {
         bool uriFlagUsed = false;
         bool globalAll = false;
         bool raw = false;
+        PngCompression pngCompression = PngCompression::normal;
+        uint32_t threadCount = std::max(1u, std::thread::hardware_concurrency());
 
         void init(cxxopts::Options& opts);
         void process(cxxopts::Options& opts, cxxopts::ParseResult& args, Reporter& report);
@@ -186,7 +214,7 @@ int CommandExtract::main(int argc, char* argv[]) {
     } catch (const FatalError& error) {
         return +error.returnCode;
     } catch (const std::exception& e) {
-        fmt::print(std::cerr, "{} fatal: {}\n", commandName, e.what());
+        log(LogLevel::fatal, e.what());
         return +rc::RUNTIME_ERROR;
     }
 }
@@ -210,7 +238,13 @@ void CommandExtract::OptionsExtract::init(cxxopts::Options& opts) {
             (kFace, "Face to extract. When 'all' is used every face is exported. Defaults to 0.", cxxopts::value<std::string>(), "[0-5] | all")
             (kDepth, "Depth slice to extract. When 'all' is used every depth is exported. Defaults to 0.", cxxopts::value<std::string>(), "[0-9]+ | all")
             (kAll, "Extract every image slice from the texture.")
-            (kRaw, "Extract the raw image data without any conversion.");
+            (kRaw, "Extract the raw image data without any conversion.")
+            (kPngCompression, "PNG compression effort. 'store' is the fastest and writes uncompressed data,"
+                              " 'best' produces the smallest files. Defaults to 'default'.",
+                              cxxopts::value<std::string>(), "store | fast | default | best")
+            (kThreads, "Number of threads used to convert and write the images of a multi-output extract."
+                       " By default the number of threads reported by thread::hardware_concurrency or 1"
+                       " if value returned is 0.", cxxopts::value<uint32_t>(), "<count>");
 }
 
 void CommandExtract::OptionsExtract::process(cxxopts::Options&, cxxopts::ParseResult& args, Reporter& report) {
@@ -241,6 +275,27 @@ void CommandExtract::OptionsExtract::process(cxxopts::Options&, cxxopts::ParseRe
     raw = args[kRaw].as<bool>();
     globalAll = args[kAll].as<bool>();
 
+    if (args[kPngCompression].count()) {
+        const auto str = to_lower_copy(args[kPngCompression].as<std::string>());
+        if (str == "store")
+            pngCompression = PngCompression::store;
+        else if (str == "fast")
+            pngCompression = PngCompression::fast;
+        else if (str == "default")
+            pngCompression = PngCompression::normal;
+        else if (str == "best")
+            pngCompression = PngCompression::best;
+        else
+            report.fatal_usage("Invalid {} value \"{}\". Possible options are: store | fast | default | best.",
+                    kPngCompression, str);
+    }
+
+    if (args[kThreads].count()) {
+        threadCount = args[kThreads].as<uint32_t>();
+        if (threadCount == 0)
+            report.fatal_usage("Invalid {} value \"0\". At least 1 thread is required.", kThreads);
+    }
+
     if (globalAll) {
         if (level)
             report.fatal_usage("Conflicting options: --level cannot be used with --all.");
@@ -319,13 +374,23 @@ void CommandExtract::processOptions(cxxopts::Options& opts, cxxopts::ParseResult
     }
 }
 
+/// Returns the half open range of indices covering every index selected out of \p count.
+/// An undefined selector selects index 0.
+static std::pair<uint32_t, uint32_t> selectedBounds(const SelectorRange& selector, uint32_t count) {
+    if (selector.is_undefined())
+        return {0, 1};
+    const auto first = std::min(selector.first(), count - 1);
+    const auto end = std::min(selector.last(), count - 1) + 1;
+    return {first, std::max(end, first + 1)};
+}
+
 void CommandExtract::executeExtract() {
     InputStream inputStream(options.inputFilepath, *this);
     validateToolInput(inputStream, fmtInFile(options.inputFilepath), *this);
 
     KTXTexture2 texture{nullptr};
     StreambufStream<std::streambuf*> ktx2Stream{inputStream->rdbuf(), std::ios::in | std::ios::binary};
-    auto ret = ktxTexture2_CreateFromStream(ktx2Stream.stream(), KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, texture.pHandle());
+    auto ret = ktxTexture2_CreateFromStream(ktx2Stream.stream(), KTX_TEXTURE_CREATE_NO_FLAGS, texture.pHandle());
     if (ret != KTX_SUCCESS)
         fatal(rc::INVALID_FILE, "Failed to create KTX2 texture: {}", ktxErrorString(ret));
 
@@ -363,6 +428,35 @@ void CommandExtract::executeExtract() {
             fatal(rc::INVALID_FILE, "Requested depth slice index {} from a non-3D texture.", options.depth);
     }
 
+    // Load only the levels, layers and faces covered by the selectors. The subset texture starts at
+    // the first selected level, layer and face; indices below are offset to keep the output naming.
+    const auto numLevels = texture->numLevels;
+    const auto baseDepth = texture->baseDepth;
+    const bool isArray = texture->isArray;
+    const bool isCubemap = texture->isCubemap;
+    const auto [firstLevel, endLevel] = selectedBounds(options.fragmentURI.mip, texture->numLevels);
+    auto [firstLayer, endLayer] = selectedBounds(options.fragmentURI.stratal, texture->numLayers);
+    // Video frames after the first one can depend on the frames before them, so a video subset
+    // has to start at the first layer. The layers before the selection are loaded and skipped.
+    if (texture->isVideo)
+        firstLayer = 0;
+    auto [firstFace, endFace] = selectedBounds(options.fragmentURI.facial, texture->numFaces);
+    if (endFace - firstFace != 1) {
+        // Only single faces or whole cubemaps form valid textures
+        firstFace = 0;
+        endFace = texture->numFaces;
+    }
+
+    KTXTexture2 subset{nullptr};
+    ret = ktxTexture2_CreateSubset(texture,
+            firstLevel, endLevel - firstLevel,
+            firstLayer, endLayer - firstLayer,
+            firstFace, endFace - firstFace,
+            subset.pHandle());
+    if (ret != KTX_SUCCESS)
+        fatal(rc::INVALID_FILE, "Failed to load the requested images of the KTX2 texture: {}", ktxErrorString(ret));
+    std::swap(texture, subset);
+
     // Transcoding
     if (ktxTexture2_NeedsTranscoding(texture)) {
         texture = transcode(std::move(texture), options, *this);
@@ -375,8 +469,8 @@ void CommandExtract::executeExtract() {
     const auto format = createFormatDescriptor(texture->pDfd);
     const auto blockSizeZ = format.basic.texelBlockDimension2 + 1u;
 
-    const auto lastExportedLevel = options.fragmentURI.mip == all ? texture->numLevels - 1 : options.fragmentURI.mip.last();
-    const auto lastExportedLevelDepthCount = std::max(1u, ceil_div(texture->baseDepth, blockSizeZ) >> lastExportedLevel);
+    const auto lastExportedLevel = options.fragmentURI.mip == all ? numLevels - 1 : options.fragmentURI.mip.last();
+    const auto lastExportedLevelDepthCount = std::max(1u, ceil_div(baseDepth, blockSizeZ) >> lastExportedLevel);
     if (options.depthFlagUsed && options.depth != all && options.depth.last() > lastExportedLevelDepthCount)
         fatal(rc::INVALID_FILE, "Requested depth slice index {} is missing. The input file only has {} depth slice(s) in level {}.",
                 options.depth, lastExportedLevelDepthCount, lastExportedLevel);
@@ -401,51 +495,60 @@ void CommandExtract::executeExtract() {
         fatal(rc::IO_FAILURE, "Failed to create the output directory \"{}\": {}.", e.path1().generic_string(), e.what());
     }
 
-    // Iterate
-    for (uint32_t levelIndex = 0; levelIndex < texture->numLevels; ++levelIndex) {
+    // Collect one job per output file. Names only depend on the selection, so they are the same
+    // regardless of the order in which the jobs run.
+    std::vector<std::function<void()>> jobs;
+    for (uint32_t levelIndex = firstLevel; levelIndex < endLevel; ++levelIndex) {
         if (options.fragmentURI.mip.is_undefined() ?
                 levelIndex != 0 :
                 !options.fragmentURI.mip.contains(levelIndex))
             continue;
 
-        std::size_t imageSize = ktxTexture_GetImageSize(texture, levelIndex);
-        const auto imageWidth = std::max(1u, texture->baseWidth >> levelIndex);
-        const auto imageHeight = std::max(1u, texture->baseHeight >> levelIndex);
-        const auto imageDepth = std::max(1u, texture->baseDepth >> levelIndex);
+        const auto level = levelIndex - firstLevel;
+        std::size_t imageSize = ktxTexture_GetImageSize(texture, level);
+        const auto imageWidth = std::max(1u, texture->baseWidth >> level);
+        const auto imageHeight = std::max(1u, texture->baseHeight >> level);
+        const auto imageDepth = std::max(1u, texture->baseDepth >> level);
 
-        for (uint32_t layerIndex = 0; layerIndex < texture->numLayers; ++layerIndex) {
+        for (uint32_t layerIndex = firstLayer; layerIndex < endLayer; ++layerIndex) {
             if (options.fragmentURI.stratal.is_undefined() ?
                     layerIndex != 0 :
                     !options.fragmentURI.stratal.contains(layerIndex))
                 continue;
 
-            for (uint32_t faceIndex = 0; faceIndex < texture->numFaces; ++faceIndex) {
+            const auto layer = layerIndex - firstLayer;
+            for (uint32_t faceIndex = firstFace; faceIndex < endFace; ++faceIndex) {
                 if (options.fragmentURI.facial.is_undefined() ?
                         faceIndex != 0 :
                         !options.fragmentURI.facial.contains(faceIndex))
                     continue;
 
+                const auto face = faceIndex - firstFace;
+
                 if (imageDepth > 1 && !options.globalAll && !options.depthFlagUsed && options.raw) {
                     // If the texture type is 3D / 3D Array and the "all" or "depth" option is not set,
                     // the whole 3D block of pixel data is selected according to the "level" and "layer"
                     // option. This extraction path requires the "raw" option to be enabled.
 
-                    const auto outputFilepath = !isMultiOutput ? options.outputPath :
+                    auto outputFilepath = !isMultiOutput ? options.outputPath :
                             fmt::format("{}/output{}{}{}.raw",
                             options.outputPath,
-                            texture->numLevels > 1 ? fmt::format("_level{}", levelIndex) : "",
-                            texture->isCubemap ? fmt::format("_face{}", faceIndex) : "",
-                            texture->isArray ? fmt::format("_layer{}", layerIndex) : ""
+                            numLevels > 1 ? fmt::format("_level{}", levelIndex) : "",
+                            isCubemap ? fmt::format("_face{}", faceIndex) : "",
+                            isArray ? fmt::format("_layer{}", layerIndex) : ""
                             // Depth is not part of the name as the whole 3D image is raw exported
                     );
 
-                    OutputStream file(outputFilepath, *this);
-                    for (uint32_t depthIndex = 0; depthIndex < imageDepth; ++depthIndex) {
-                        ktx_size_t imageOffset;
-                        ktxTexture_GetImageOffset(texture, levelIndex, layerIndex, faceIndex + depthIndex, &imageOffset);
-                        const char* imageData = reinterpret_cast<const char*>(texture->pData) + imageOffset;
-                        file.write(imageData, imageSize, *this);
-                    }
+                    jobs.emplace_back([this, &texture, outputFilepath = std::move(outputFilepath),
+                            level, layer, face, imageDepth, imageSize] {
+                        OutputStream file(outputFilepath, *this);
+                        for (uint32_t depthIndex = 0; depthIndex < imageDepth; ++depthIndex) {
+                            ktx_size_t imageOffset;
+                            ktxTexture_GetImageOffset(texture, level, layer, face + depthIndex, &imageOffset);
+                            const char* imageData = reinterpret_cast<const char*>(texture->pData) + imageOffset;
+                            file.write(imageData, imageSize, *this);
+                        }
+                    });
 
                     continue;
                 }
@@ -456,29 +559,37 @@ void CommandExtract::executeExtract() {
                         continue; // Skip
 
                     ktx_size_t imageOffset;
-                    ktxTexture_GetImageOffset(texture, levelIndex, layerIndex, faceIndex + depthIndex, &imageOffset);
-                    char* depthSliceData = reinterpret_cast<char*>(texture->pData) + imageOffset;
+                    ktxTexture_GetImageOffset(texture, level, layer, face + depthIndex, &imageOffset);
+                    const char* depthSliceData = reinterpret_cast<const char*>(texture->pData) + imageOffset;
 
-                    const auto outputFilepath = !isMultiOutput ? options.outputPath :
+                    auto outputFilepath = !isMultiOutput ? options.outputPath :
                             fmt::format("{}/output{}{}{}{}",
                             options.outputPath,
-                            texture->numLevels > 1 ? fmt::format("_level{}", levelIndex) : "",
-                            texture->isCubemap ? fmt::format("_face{}", faceIndex) : "",
-                            texture->isArray ? fmt::format("_layer{}", layerIndex) : "",
-                            texture->baseDepth > 1 ? fmt::format("_depth{}", depthIndex) : ""
+                            numLevels > 1 ? fmt::format("_level{}", levelIndex) : "",
+                            isCubemap ? fmt::format("_face{}", faceIndex) : "",
+                            isArray ? fmt::format("_layer{}", layerIndex) : "",
+                            baseDepth > 1 ? fmt::format("_depth{}", depthIndex) : ""
                     );
 
-                    if (options.raw) {
-                        saveRawFile(outputFilepath, isMultiOutput, depthSliceData, imageSize);
-                    } else {
-                        saveImageFile(outputFilepath, isMultiOutput, depthSliceData, imageSize,
-                                static_cast<VkFormat>(texture->vkFormat), format, imageWidth, imageHeight);
-                    }
+                    jobs.emplace_back([this, &texture, &format, outputFilepath = std::move(outputFilepath),
+                            isMultiOutput, depthSliceData, imageSize, imageWidth, imageHeight] {
+                        if (options.raw) {
+                            saveRawFile(outputFilepath, isMultiOutput, depthSliceData, imageSize);
+                        } else {
+                            saveImageFile(outputFilepath, isMultiOutput, depthSliceData, imageSize,
+                                    static_cast<VkFormat>(texture->vkFormat), format, imageWidth, imageHeight);
+                        }
+                    });
                 }
             }
         }
     }
 
+    // Each job unpacks, encodes and writes its own file, so they can run concurrently
+    parallelFor(jobs.size(), options.threadCount, [&](std::size_t i) {
+        jobs[i]();
+    });
+
     if (ret != KTX_SUCCESS)
         fatal(rc::INVALID_FILE, "Failed to iterate KTX2 texture: {}", ktxErrorString(ret));
 }
@@ -848,6 +959,30 @@ void CommandExtract::savePNG(std::string filepath, bool appendExtension,
         state.info_png.chrm_white_y = (unsigned int)(100000 * primaries.Wy);
     }
 
+    auto& encoder = state.encoder;
+    switch (options.pngCompression) {
+    case OptionsExtract::PngCompression::store:
+        // Uncompressed deflate blocks, no filtering and no color type analysis
+        encoder.zlibsettings.btype = 0;
+        encoder.filter_strategy = LFS_ZERO;
+        encoder.auto_convert = 0;
+        break;
+    case OptionsExtract::PngCompression::fast:
+        encoder.zlibsettings.windowsize = 256;
+        encoder.zlibsettings.nicematch = 32;
+        encoder.zlibsettings.lazymatching = 0;
+        encoder.filter_strategy = LFS_ZERO;
+        encoder.auto_convert = 0;
+        break;
+    case OptionsExtract::PngCompression::normal:
+        break;
+    case OptionsExtract::PngCompression::best:
+        encoder.zlibsettings.windowsize = 32768;
+        encoder.zlibsettings.nicematch = 258;
+        encoder.filter_strategy = LFS_ENTROPY;
+        break;
+    }
+
     std::vector<unsigned char> png;
     auto error = lodepng::encode(png, unpackedImage, width, height, state);
     if (error)
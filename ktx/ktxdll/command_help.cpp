@@ -49,6 +49,7 @@ struct OptionsHelp {
                 "info",
                 "validate",
                 "compare",
+                "bench",
                 "help",
             };
 
@@ -79,6 +80,7 @@ Display help information about the ktx tool.
     @e command specifies which command's man page will be displayed.
     If @e command is s missing the main ktx tool man page will be displayed.
     Possible choices are: <br />
+    -        @ref ktx_bench "bench" <br />
     -        @ref ktx_compare "compare" <br />
     -        @ref ktx_create "create" <br />
     -        @ref ktx_create "deflate" <br />
@@ -129,7 +131,7 @@ int CommandHelp::main(int argc, char* argv[]) {
     } catch (const FatalError& error) {
         return +error.returnCode;
     } catch (const std::exception& e) {
-        fmt::print(std::cerr, "{} fatal: {}\n", commandName, e.what());
+        log(LogLevel::fatal, e.what());
         return +rc::RUNTIME_ERROR;
     }
 }
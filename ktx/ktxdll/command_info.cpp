@@ -7,8 +7,13 @@
 #include "stdafx.h"
 #include "utility.h"
 #include "validate.h"
+#include "platform_utils.h"
+#include "dfdutils/dfd.h"
+#include <atomic>
+#include <chrono>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <utility>
 
@@ -22,13 +27,28 @@
 
 namespace ktx {
 
+/// Routes the text libktx prints on the calling thread to @p os instead of stdout while alive.
+class ScopedLibktxPrint {
+public:
+    explicit ScopedLibktxPrint(std::ostream& os) {
+        dfdSetThreadPrintFunction([](void* userData, const char* text, size_t length) {
+            static_cast<std::ostream*>(userData)->write(text, static_cast<std::streamsize>(length));
+        }, &os);
+    }
+    ~ScopedLibktxPrint() {
+        dfdSetThreadPrintFunction(nullptr, nullptr);
+    }
+    ScopedLibktxPrint(const ScopedLibktxPrint&) = delete;
+    ScopedLibktxPrint& operator=(const ScopedLibktxPrint&) = delete;
+};
+
 /** @page ktx_info ktx info
 @~English
 
-Print information about a KTX2 file.
+Print information about KTX2 files.
 
 @section ktx_info_synopsis SYNOPSIS
-    ktx info [option...] @e input-file
+    ktx info [option...] @e input-file...
 
 @section ktx_info_description DESCRIPTION
     @b ktx @b info prints information about the KTX2 file specified as the @e input-file argument.
@@ -38,6 +58,12 @@ Print information about a KTX2 file.
     If the specified input file is invalid the information is displayed based on best effort and
     may be incomplete.
 
+    When more than one input file or an input list is specified the files are processed in
+    bulk: they are validated concurrently on multiple threads and the information of each file
+    is printed as soon as it is available, so the order may differ from the order of the input
+    files. In JSON formats a JSON-lines report is produced: one minified JSON object per line
+    and file that also contains the "file" path and the "time" spent validating it in seconds.
+
     The JSON output formats conform to the https://schema.khronos.org/ktx/info_v0.json
     schema even if the input file is invalid and certain information cannot be parsed or
     displayed.
@@ -52,6 +78,7 @@ Print information about a KTX2 file.
 @section ktx\_info\_options OPTIONS
     The following options are available:
     @snippet{doc} ktx/command.h command options_format
+    @snippet{doc} ktx/command.h command options_multi_in
     @snippet{doc} ktx/command.h command options_generic
 
 @section ktx_info_exitstatus EXIT STATUS
@@ -67,7 +94,13 @@ Print information about a KTX2 file.
     - Daniel Rákos, RasterGrid www.rastergrid.com
 */
 class CommandInfo : public Command {
-    Combine<OptionsFormat, OptionsSingleIn, OptionsGeneric> options;
+    Combine<OptionsFormat, OptionsMultiIn, OptionsGeneric> options;
+
+    /// Validation result and the formatted validation messages of an input file
+    struct ValidationOutput {
+        int result = 0;
+        std::string messages;
+    };
 
 public:
     virtual int main(int argc, char* argv[]) override;
@@ -76,8 +109,11 @@ public:
 
 private:
     void executeInfo();
-    KTX_error_code printInfoText(std::istream& file);
-    KTX_error_code printInfoJSON(std::istream& file, bool minified);
+    void executeInfoBulk();
+    ValidationOutput validateInput(std::istream& file, const std::string& filepath, bool minified);
+    KTX_error_code printInfoText(std::istream& file, const ValidationOutput& validation);
+    KTX_error_code printInfoJSON(std::istream& file, const ValidationOutput& validation, bool minified,
+            const std::string& extraFields = {});
 };
 
 // -------------------------------------------------------------------------------------------------
@@ -85,7 +121,7 @@ private:
 int CommandInfo::main(int argc, char* argv[]) {
     try {
         parseCommandLine("ktx info",
-                "Prints information about the KTX2 file specified as the input-file argument.\n"
+                "Prints information about the KTX2 files specified as the input-file arguments.\n"
                 "    The command implicitly calls validate and prints any found errors\n"
                 "    and warnings to stdout.",
                 argc, argv);
@@ -94,7 +130,7 @@ int CommandInfo::main(int argc, char* argv[]) {
     } catch (const FatalError& error) {
         return +error.returnCode;
     } catch (const std::exception& e) {
-        fmt::print(std::cerr, "{} fatal: {}\n", commandName, e.what());
+        log(LogLevel::fatal, e.what());
         return +rc::RUNTIME_ERROR;
     }
 }
@@ -108,19 +144,25 @@ void CommandInfo::processOptions(cxxopts::Options& opts, cxxopts::ParseResult& a
 }
 
 void CommandInfo::executeInfo() {
-    InputStream inputStream(options.inputFilepath, *this);
+    if (options.bulk) {
+        executeInfoBulk();
+        return;
+    }
+
+    const auto& inputFilepath = options.inputFilepaths[0];
+    InputStream inputStream(inputFilepath, *this);
 
     KTX_error_code result;
 
     switch (options.format) {
     case OutputFormat::text:
-        result = printInfoText(inputStream);
+        result = printInfoText(inputStream, validateInput(inputStream, inputFilepath, false));
         break;
     case OutputFormat::json:
-        result = printInfoJSON(inputStream, false);
+        result = printInfoJSON(inputStream, validateInput(inputStream, inputFilepath, false), false);
         break;
     case OutputFormat::json_mini:
-        result = printInfoJSON(inputStream, true);
+        result = printInfoJSON(inputStream, validateInput(inputStream, inputFilepath, true), true);
         break;
     default:
         assert(false && "Internal error");
@@ -128,23 +170,105 @@ void CommandInfo::executeInfo() {
     }
 
     if (result != KTX_SUCCESS)
-        fatal(rc::INVALID_FILE, "Failed to process KTX2 file \"{}\": {}", fmtInFile(options.inputFilepath), ktxErrorString(result));
+        fatal(rc::INVALID_FILE, "Failed to process KTX2 file \"{}\": {}", fmtInFile(inputFilepath), ktxErrorString(result));
 }
 
-KTX_error_code CommandInfo::printInfoText(std::istream& file) {
-    std::ostringstream messagesOS;
-    const auto validationResult = validateIOStream(file, fmtInFile(options.inputFilepath), false, false, [&](const ValidationReport& issue) {
-        fmt::print(messagesOS, "{}-{:04}: {}\n", toString(issue.type), issue.id, issue.message);
-        fmt::print(messagesOS, "    {}\n", issue.details);
+void CommandInfo::executeInfoBulk() {
+    const bool text = options.format == OutputFormat::text;
+    std::mutex outputMutex;
+    std::atomic<bool> processingFailed{false};
+    std::atomic<bool> ioFailure{false};
+
+    // Validation runs concurrently, while printing is serialized as the records share the output stream
+    parallelFor(options.inputFilepaths.size(), options.threadCount, [&](std::size_t index) {
+        const auto& filepath = options.inputFilepaths[index];
+        const auto startTime = std::chrono::steady_clock::now();
+
+        std::ifstream file(DecodeUTF8Path(filepath).c_str(), std::ios::binary | std::ios::in);
+        if (!file) {
+            const auto error = fmt::format("Could not open input file \"{}\": {}.", filepath, errnoMessage());
+            ioFailure = true;
+
+            std::lock_guard<std::mutex> lock{outputMutex};
+            if (text)
+                fmt::print(cout(), "File '{}'\n\n{}\n\n", filepath, error);
+            else
+                fmt::print(cout(), "{{\"file\":\"{}\",\"valid\":false,\"messages\":[],\"error\":\"{}\"}}\n",
+                        escape_json_copy(filepath), escape_json_copy(error));
+            cout().flush();
+            return;
+        }
+
+        const auto validation = validateInput(file, filepath, true);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+
+        std::lock_guard<std::mutex> lock{outputMutex};
+        KTX_error_code result;
+        if (text) {
+            fmt::print(cout(), "File '{}'\n\n", filepath);
+            result = printInfoText(file, validation);
+            fmt::print(cout(), "\n");
+        } else {
+            result = printInfoJSON(file, validation, true,
+                    fmt::format("\"file\":\"{}\",\"time\":{:.6f},", escape_json_copy(filepath), elapsed.count()));
+            fmt::print(cout(), "\n");
+        }
+        cout().flush();
+
+        if (result != KTX_SUCCESS) {
+            processingFailed = true;
+            error("Failed to process KTX2 file \"{}\": {}", filepath, ktxErrorString(result));
+        }
     });
 
-    fmt::print("Validation {}\n", validationResult == 0 ? "successful" : "failed");
-    const auto validationMessages = std::move(messagesOS).str();
+    if (ioFailure)
+        throw FatalError(rc::IO_FAILURE);
+    if (processingFailed)
+        throw FatalError(rc::INVALID_FILE);
+}
+
+CommandInfo::ValidationOutput CommandInfo::validateInput(std::istream& file, const std::string& filepath, bool minified) {
+    std::ostringstream messagesOS;
+    ValidationOutput output;
+
+    if (options.format == OutputFormat::text) {
+        output.result = validateIOStream(file, fmtInFile(filepath), false, false, [&](const ValidationReport& issue) {
+            fmt::print(messagesOS, "{}-{:04}: {}\n", toString(issue.type), issue.id, issue.message);
+            fmt::print(messagesOS, "    {}\n", issue.details);
+        });
+    } else {
+        const auto base_indent = minified ? 0 : +0;
+        const auto indent_width = minified ? 0 : 4;
+        const auto space = minified ? "" : " ";
+        const auto nl = minified ? "" : "\n";
+        PrintIndent pi{messagesOS, base_indent, indent_width};
+
+        bool first = true;
+        output.result = validateIOStream(file, fmtInFile(filepath), false, false, [&](const ValidationReport& issue) {
+            if (!std::exchange(first, false)) {
+                pi(2, "}},{}", nl);
+            }
+            pi(2, "{{{}", nl);
+            pi(3, "\"id\":{}{},{}", space, issue.id, nl);
+            pi(3, "\"type\":{}\"{}\",{}", space, toString(issue.type), nl);
+            pi(3, "\"message\":{}\"{}\",{}", space, escape_json_copy(issue.message), nl);
+            pi(3, "\"details\":{}\"{}\"{}", space, escape_json_copy(issue.details), nl);
+        });
+    }
+
+    output.messages = std::move(messagesOS).str();
+    return output;
+}
+
+KTX_error_code CommandInfo::printInfoText(std::istream& file, const ValidationOutput& validation) {
+    const auto validationResult = validation.result;
+    fmt::print(cout(), "Validation {}\n", validationResult == 0 ? "successful" : "failed");
+    const auto& validationMessages = validation.messages;
     if (!validationMessages.empty()) {
-        fmt::print("\n");
-        fmt::print("{}", validationMessages);
+        fmt::print(cout(), "\n");
+        fmt::print(cout(), "{}", validationMessages);
     }
-    fmt::print("\n");
+    fmt::print(cout(), "\n");
 
     file.clear(); // Clear any unexpected EOF from validation
     file.seekg(0);
@@ -152,31 +276,21 @@ KTX_error_code CommandInfo::printInfoText(std::istream& file) {
         return validationResult == 0 ? KTX_FILE_SEEK_ERROR : KTX_SUCCESS;
 
     StreambufStream<std::streambuf*> ktx2Stream{file.rdbuf(), std::ios::in | std::ios::binary};
+    ScopedLibktxPrint libktxPrint{cout()};
     const auto result = ktxPrintKTX2InfoTextForStream(ktx2Stream.stream());
 
     return validationResult == 0 ? result : KTX_SUCCESS;
 }
 
-KTX_error_code CommandInfo::printInfoJSON(std::istream& file, bool minified) {
+KTX_error_code CommandInfo::printInfoJSON(std::istream& file, const ValidationOutput& validation, bool minified,
+        const std::string& extraFields) {
     const auto base_indent = minified ? 0 : +0;
     const auto indent_width = minified ? 0 : 4;
     const auto space = minified ? "" : " ";
     const auto nl = minified ? "" : "\n";
 
-    std::ostringstream messagesOS;
-    PrintIndent pi{messagesOS, base_indent, indent_width};
-
-    bool first = true;
-    const auto validationResult = validateIOStream(file, fmtInFile(options.inputFilepath), false, false, [&](const ValidationReport& issue) {
-        if (!std::exchange(first, false)) {
-            pi(2, "}},{}", nl);
-        }
-        pi(2, "{{{}", nl);
-        pi(3, "\"id\":{}{},{}", space, issue.id, nl);
-        pi(3, "\"type\":{}\"{}\",{}", space, toString(issue.type), nl);
-        pi(3, "\"message\":{}\"{}\",{}", space, escape_json_copy(issue.message), nl);
-        pi(3, "\"details\":{}\"{}\"{}", space, escape_json_copy(issue.details), nl);
-    });
+    const auto validationResult = validation.result;
+    const bool first = validation.messages.empty();
 
     file.clear(); // Clear any unexpected EOF from validation
 
@@ -194,13 +308,15 @@ KTX_error_code CommandInfo::printInfoJSON(std::istream& file, bool minified) {
     }
     const auto ktxWillPrintOutput = fileIdentifierIsCorrect && fileSize >= KTX2_HEADER_SIZE;
 
-    PrintIndent out{std::cout, base_indent, indent_width};
+    PrintIndent out{cout(), base_indent, indent_width};
     out(0, "{{{}", nl);
     out(1, "\"$schema\":{}\"https://schema.khronos.org/ktx/info_v0.json\",{}", space, nl);
+    if (!extraFields.empty())
+        out(1, "{}{}", extraFields, nl);
     out(1, "\"valid\":{}{},{}", space, validationResult == 0, nl);
     if (!first) {
         out(1, "\"messages\":{}[{}", space, nl);
-        fmt::print("{}", std::move(messagesOS).str());
+        fmt::print(cout(), "{}", validation.messages);
         out(2, "}}{}", nl);
         out(1, "]{}{}", ktxWillPrintOutput ? "," : "", nl);
     } else {
@@ -214,6 +330,7 @@ KTX_error_code CommandInfo::printInfoJSON(std::istream& file, bool minified) {
     }
 
     StreambufStream<std::streambuf*> ktx2Stream{file.rdbuf(), std::ios::in | std::ios::binary};
+    ScopedLibktxPrint libktxPrint{cout()};
     const auto result = ktxPrintKTX2InfoJSONForStream(ktx2Stream.stream(), base_indent + 1, indent_width, minified);
     out(0, "}}{}", nl);
 
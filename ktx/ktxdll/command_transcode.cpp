@@ -7,6 +7,8 @@
 #include "deflate_utils.h"
 #include "transcode_utils.h"
 #include "formats.h"
+#include "hash_utils.h"
+#include "output_cache.h"
 #include "sbufstream.h"
 #include "utility.h"
 #include "validate.h"
@@ -16,7 +18,10 @@
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <unordered_map>
+#include <vector>
 
 #include <cxxopts.hpp>
 #include <fmt/ostream.h>
@@ -60,6 +65,17 @@ Transcode a KTX2 file.
             r8 | rg8 | rgb8 | rgba8.
             etc-rgb is ETC1; etc-rgba, eac-r11 and eac-rg11 are ETC2.
         </dd>
+        <dt>\--cache-dir &lt;dir&gt;</dt>
+        <dd>Directory of an on-disk cache of transcoded outputs. The cache is keyed by
+            the contents of the input file, the target and the supercompression options,
+            so repeated transcodes of the same input skip validation, inflation and
+            transcoding and write the cached output directly. The directory can be
+            shared safely by concurrently running processes.
+        </dd>
+        <dt>\--cache-size &lt;MiB&gt;</dt>
+        <dd>Maximum total size of the cache in MiB. The least recently used outputs
+            are evicted once it is exceeded. Default: 1024.
+        </dd>
     </dl>
     @snippet{doc} ktx/deflate_utils.h command options_deflate
     @snippet{doc} ktx/command.h command options_generic
@@ -72,6 +88,9 @@ Transcode a KTX2 file.
 @par Version 4.0
  - Initial version
 
+@par Version 4.4
+ - Add --cache-dir and --cache-size
+
 @section ktx_transcode_author AUTHOR
     - Mátyás Császár [Vader], RasterGrid www.rastergrid.com
     - Daniel Rákos, RasterGrid www.rastergrid.com
@@ -82,6 +101,12 @@ class CommandTranscode : public Command {
     };
 
     struct OptionsTranscode {
+        inline static const char* kCacheDir = "cache-dir";
+        inline static const char* kCacheSize = "cache-size";
+
+        std::string cacheDir;
+        uint64_t cacheSize = 1024;
+
         void init(cxxopts::Options& opts);
         void process(cxxopts::Options& opts, cxxopts::ParseResult& args, Reporter& report);
     };
@@ -95,6 +120,7 @@ public:
 
 private:
     void executeTranscode();
+    [[nodiscard]] uint64_t hashInput(std::istream& stream);
 };
 
 // -------------------------------------------------------------------------------------------------
@@ -110,7 +136,7 @@ int CommandTranscode::main(int argc, char* argv[]) {
     } catch (const FatalError& error) {
         return +error.returnCode;
     } catch (const std::exception& e) {
-        fmt::print(std::cerr, "{} fatal: {}\n", commandName, e.what());
+        log(LogLevel::fatal, e.what());
         return +rc::RUNTIME_ERROR;
     }
 }
@@ -124,10 +150,23 @@ void CommandTranscode::OptionsTranscode::init(cxxopts::Options& opts) {
                    " etc-rgb | etc-rgba | eac-r11 | eac-rg11 | bc1 | bc3 | bc4 | bc5 | bc7 | astc |"
                    " r8 | rg8 | rgb8 | rgba8."
                    "\netc-rgb is ETC1; etc-rgba, eac-r11 and eac-rg11 are ETC2.",
-                   cxxopts::value<std::string>(), "<target>");
+                   cxxopts::value<std::string>(), "<target>")
+        (kCacheDir, "Directory of an on-disk cache of transcoded outputs keyed by the input contents"
+                    " and the output options. Can be shared by concurrent processes.",
+                    cxxopts::value<std::string>(), "<dir>")
+        (kCacheSize, "Maximum total size of the cache in MiB. Least recently used outputs are evicted"
+                     " beyond it. Default: 1024.",
+                     cxxopts::value<uint64_t>(), "<MiB>");
 }
 
-void CommandTranscode::OptionsTranscode::process(cxxopts::Options&, cxxopts::ParseResult&, Reporter&) {
+void CommandTranscode::OptionsTranscode::process(cxxopts::Options&, cxxopts::ParseResult& args, Reporter& report) {
+    if (args[kCacheDir].count())
+        cacheDir = args[kCacheDir].as<std::string>();
+    if (args[kCacheSize].count()) {
+        if (cacheDir.empty())
+            report.fatal_usage("--{} requires --{}.", kCacheSize, kCacheDir);
+        cacheSize = args[kCacheSize].as<uint64_t>();
+    }
 }
 
 void CommandTranscode::initOptions(cxxopts::Options& opts) {
@@ -138,8 +177,53 @@ void CommandTranscode::processOptions(cxxopts::Options& opts, cxxopts::ParseResu
     options.process(opts, args, *this);
 }
 
+uint64_t CommandTranscode::hashInput(std::istream& stream) {
+    if (!stream)
+        fatal(rc::IO_FAILURE, "Could not open input file \"{}\": {}", fmtInFile(options.inputFilepath), errnoMessage());
+
+    XXHash64 hasher;
+    std::vector<char> buffer(1024 * 1024);
+    while (stream) {
+        stream.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        hasher.update(buffer.data(), static_cast<std::size_t>(stream.gcount()));
+    }
+    if (stream.bad())
+        fatal(rc::IO_FAILURE, "Failed to read input file \"{}\": {}", fmtInFile(options.inputFilepath), errnoMessage());
+
+    stream.clear();
+    stream.seekg(0);
+    if (!stream)
+        fatal(rc::IO_FAILURE, "Could not rewind the input file \"{}\": {}", fmtInFile(options.inputFilepath), errnoMessage());
+    return hasher.digest();
+}
+
 void CommandTranscode::executeTranscode() {
     InputStream inputStream(options.inputFilepath, *this);
+
+    const auto outputPath = std::filesystem::path(DecodeUTF8Path(options.outputFilepath));
+    const auto createOutputDirectory = [&] {
+        if (outputPath.has_parent_path())
+            std::filesystem::create_directories(outputPath.parent_path());
+    };
+
+    // The cache key covers everything the output depends on: the input contents, the requested
+    // target, the supercompression options and the tool version written to KTXwriter.
+    std::optional<OutputCache> cache;
+    std::string cacheKey;
+    if (!options.cacheDir.empty()) {
+        cache.emplace(DecodeUTF8Path(options.cacheDir), options.cacheSize * 1024 * 1024);
+        const auto params = fmt::format("transcode|{}|{}|{}", options.transcodeTargetName,
+                options.compressOptions, version(options.testrun));
+        cacheKey = OutputCache::makeKey(hashInput(inputStream), params);
+
+        if (const auto cached = cache->load(cacheKey)) {
+            createOutputDirectory();
+            OutputStream outputFile(options.outputFilepath, *this);
+            outputFile.write(reinterpret_cast<const char*>(cached->data()), cached->size(), *this);
+            return;
+        }
+    }
+
     validateToolInput(inputStream, fmtInFile(options.inputFilepath), *this);
 
     KTXTexture2 texture{nullptr};
@@ -184,12 +268,23 @@ void CommandTranscode::executeTranscode() {
     }
 
     // Save output file
-    const auto outputPath = std::filesystem::path(DecodeUTF8Path(options.outputFilepath));
-    if (outputPath.has_parent_path())
-        std::filesystem::create_directories(outputPath.parent_path());
-
+    createOutputDirectory();
     OutputStream outputFile(options.outputFilepath, *this);
-    outputFile.writeKTX2(texture, *this);
+    if (!cache) {
+        outputFile.writeKTX2(texture, *this);
+        return;
+    }
+
+    ktx_uint8_t* data = nullptr;
+    ktx_size_t dataSize = 0;
+    ret = ktxTexture_WriteToMemory(texture, &data, &dataSize);
+    if (ret != KTX_SUCCESS)
+        fatal(rc::IO_FAILURE, "Failed to write KTX file \"{}\": KTX error: {}.", fmtOutFile(options.outputFilepath), ktxErrorString(ret));
+    std::unique_ptr<ktx_uint8_t, decltype(&std::free)> dataGuard{data, &std::free};
+
+    outputFile.write(reinterpret_cast<const char*>(data), dataSize, *this);
+    if (!cache->store(cacheKey, data, dataSize))
+        warning("Failed to store the output in the cache directory \"{}\".", options.cacheDir);
 }
 
 } // namespace ktx
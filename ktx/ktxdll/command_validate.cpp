@@ -3,9 +3,14 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "command.h"
+#include "platform_utils.h"
 #include "utility.h"
 #include "validate.h"
+#include <atomic>
+#include <chrono>
+#include <fstream>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <utility>
 
@@ -20,16 +25,23 @@ namespace ktx {
 /** @page ktx_validate ktx validate
 @~English
 
-Validate a KTX2 file.
+Validate KTX2 files.
 
 @section ktx_validate_synopsis SYNOPSIS
-    ktx validate [option...] @e input-file
+    ktx validate [option...] @e input-file...
 
 @section ktx_validate_description DESCRIPTION
     @b ktx @b validate validates the Khronos texture format version 2 (KTX2) file specified
     as the @e input-file argument. It prints any found errors and warnings to stdout.
     If the @e input-file is '-' the file will be read from the stdin.
 
+    When more than one input file or an input list is specified the files are validated in
+    bulk, concurrently on multiple threads. Results are reported as soon as a file has been
+    validated, so their order may differ from the order of the input files. In text format
+    the findings of every file with issues are printed, followed by a summary. In JSON
+    formats a JSON-lines report is produced: one minified JSON object per line and file that
+    also contains the "file" path and the "time" spent validating it in seconds.
+
     The validation rules and checks are based on the official specification:
     KTX File Format Specification - https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html
 
@@ -43,11 +55,16 @@ Validate a KTX2 file.
 @section ktx\_validate\_options OPTIONS
     The following options are available:
     @snippet{doc} ktx/command.h command options_format
+    @snippet{doc} ktx/command.h command options_multi_in
     <dl>
         <dt>-g, \--gltf-basisu</dt>
         <dd>Check compatibility with KHR_texture_basisu glTF extension.</dd>
         <dt>-e, \--warnings-as-errors</dt>
         <dd>Treat warnings as errors.</dd>
+        <dt>\--structural</dt>
+        <dd>Only validate the structure of the file: the header, the indices, the DFD, the KVD,
+            the SGD and the paddings between them. The image data is not loaded, deflated or
+            transcoded, so issues only detectable that way are not reported.</dd>
     </dl>
     @snippet{doc} ktx/command.h command options_generic
 
@@ -67,20 +84,24 @@ class CommandValidate : public Command {
     struct OptionsValidate {
         bool warningsAsErrors = false;
         bool GLTFBasisU = false;
+        bool structuralOnly = false;
 
         void init(cxxopts::Options& opts) {
             opts.add_options()
                 ("e,warnings-as-errors", "Treat warnings as errors.")
-                ("g,gltf-basisu", "Check compatibility with KHR_texture_basisu glTF extension.");
+                ("g,gltf-basisu", "Check compatibility with KHR_texture_basisu glTF extension.")
+                ("structural", "Only validate the structure of the file (header, indices, DFD, KVD, SGD "
+                        "and paddings) without loading, deflating or transcoding the image data.");
         }
 
         void process(cxxopts::Options&, cxxopts::ParseResult& args, Reporter&) {
             warningsAsErrors = args["warnings-as-errors"].as<bool>();
             GLTFBasisU = args["gltf-basisu"].as<bool>();
+            structuralOnly = args["structural"].as<bool>();
         }
     };
 
-    Combine<OptionsValidate, OptionsFormat, OptionsSingleIn, OptionsGeneric> options;
+    Combine<OptionsValidate, OptionsFormat, OptionsMultiIn, OptionsGeneric> options;
 
 public:
     virtual int main(int argc, char* argv[]) override;
@@ -89,6 +110,7 @@ public:
 
 private:
     void executeValidate();
+    void executeValidateBulk();
 };
 
 // -------------------------------------------------------------------------------------------------
@@ -96,15 +118,15 @@ private:
 int CommandValidate::main(int argc, char* argv[]) {
     try {
         parseCommandLine("ktx validate",
-                "Validates the Khronos texture format version 2 (KTX2) file specified\n"
-                "    as the input-file argument. It prints any found errors and warnings to stdout.",
+                "Validates the Khronos texture format version 2 (KTX2) files specified\n"
+                "    as the input-file arguments. It prints any found errors and warnings to stdout.",
                 argc, argv);
         executeValidate();
         return +rc::SUCCESS;
     } catch (const FatalError& error) {
         return +error.returnCode;
     } catch (const std::exception& e) {
-        fmt::print(std::cerr, "{} fatal: {}\n", commandName, e.what());
+        log(LogLevel::fatal, e.what());
         return +rc::RUNTIME_ERROR;
     }
 }
@@ -118,26 +140,32 @@ void CommandValidate::processOptions(cxxopts::Options& opts, cxxopts::ParseResul
 }
 
 void CommandValidate::executeValidate() {
-    InputStream inputStream(options.inputFilepath, *this);
+    if (options.bulk) {
+        executeValidateBulk();
+        return;
+    }
+
+    const auto& inputFilepath = options.inputFilepaths[0];
+    InputStream inputStream(inputFilepath, *this);
 
     switch (options.format) {
     case OutputFormat::text: {
         std::ostringstream messagesOS;
         const auto validationResult = validateIOStream(
                 inputStream,
-                fmtInFile(options.inputFilepath),
+                fmtInFile(inputFilepath),
                 options.warningsAsErrors,
                 options.GLTFBasisU,
                 [&](const ValidationReport& issue) {
             fmt::print(messagesOS, "{}-{:04}: {}\n", toString(issue.type), issue.id, issue.message);
             fmt::print(messagesOS, "    {}\n", issue.details);
-        });
+        }, options.structuralOnly);
 
         const auto validationMessages = std::move(messagesOS).str();
         if (!validationMessages.empty()) {
-            fmt::print("Validation {}\n", validationResult == 0 ? "successful" : "failed");
-            fmt::print("\n");
-            fmt::print("{}", validationMessages);
+            fmt::print(cout(), "Validation {}\n", validationResult == 0 ? "successful" : "failed");
+            fmt::print(cout(), "\n");
+            fmt::print(cout(), "{}", validationMessages);
         }
 
         if (validationResult != 0)
@@ -157,7 +185,7 @@ void CommandValidate::executeValidate() {
         bool first = true;
         const auto validationResult = validateIOStream(
                 inputStream,
-                fmtInFile(options.inputFilepath),
+                fmtInFile(inputFilepath),
                 options.warningsAsErrors,
                 options.GLTFBasisU,
                 [&](const ValidationReport& issue) {
@@ -169,15 +197,15 @@ void CommandValidate::executeValidate() {
             pi(3, "\"type\":{}\"{}\",{}", space, toString(issue.type), nl);
             pi(3, "\"message\":{}\"{}\",{}", space, escape_json_copy(issue.message), nl);
             pi(3, "\"details\":{}\"{}\"{}", space, escape_json_copy(issue.details), nl);
-        });
+        }, options.structuralOnly);
 
-        PrintIndent out{std::cout, base_indent, indent_width};
+        PrintIndent out{cout(), base_indent, indent_width};
         out(0, "{{{}", nl);
         out(1, "\"$schema\":{}\"https://schema.khronos.org/ktx/validate_v0.json\",{}", space, nl);
         out(1, "\"valid\":{}{},{}", space, validationResult == 0, nl);
         if (!first) {
             out(1, "\"messages\":{}[{}", space, nl);
-            fmt::print("{}", std::move(messagesOS).str());
+            fmt::print(cout(), "{}", std::move(messagesOS).str());
             out(2, "}}{}", nl);
             out(1, "]{}", nl);
         } else {
@@ -192,6 +220,79 @@ void CommandValidate::executeValidate() {
     }
 }
 
+void CommandValidate::executeValidateBulk() {
+    const bool text = options.format == OutputFormat::text;
+    std::mutex outputMutex;
+    std::atomic<std::size_t> failedCount{0};
+    std::atomic<bool> ioFailure{false};
+
+    // Every file gets its own validation context on the worker that picked it up
+    parallelFor(options.inputFilepaths.size(), options.threadCount, [&](std::size_t index) {
+        const auto& filepath = options.inputFilepaths[index];
+        const auto startTime = std::chrono::steady_clock::now();
+
+        std::ostringstream messagesOS;
+        bool first = true;
+        std::optional<std::string> error;
+        int validationResult = +rc::IO_FAILURE;
+
+        std::ifstream file(DecodeUTF8Path(filepath).c_str(), std::ios::binary | std::ios::in);
+        if (!file) {
+            error = fmt::format("Could not open input file \"{}\": {}.", filepath, errnoMessage());
+        } else {
+            validationResult = validateIOStream(
+                    file,
+                    fmtInFile(filepath),
+                    options.warningsAsErrors,
+                    options.GLTFBasisU,
+                    [&](const ValidationReport& issue) {
+                if (text) {
+                    fmt::print(messagesOS, "{}-{:04}: {}\n", toString(issue.type), issue.id, issue.message);
+                    fmt::print(messagesOS, "    {}\n", issue.details);
+                } else {
+                    fmt::print(messagesOS, "{}{{\"id\":{},\"type\":\"{}\",\"message\":\"{}\",\"details\":\"{}\"}}",
+                            std::exchange(first, false) ? "" : ",", issue.id, toString(issue.type),
+                            escape_json_copy(issue.message), escape_json_copy(issue.details));
+                }
+            }, options.structuralOnly);
+        }
+
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+        if (validationResult != 0)
+            ++failedCount;
+        if (error)
+            ioFailure = true;
+
+        const auto messages = std::move(messagesOS).str();
+        std::string record;
+        if (text) {
+            if (error)
+                record = fmt::format("Validation failed for '{}'\n\n{}\n\n", filepath, *error);
+            else if (!messages.empty())
+                record = fmt::format("Validation {} for '{}'\n\n{}\n", validationResult == 0 ? "successful" : "failed",
+                        filepath, messages);
+        } else {
+            record = fmt::format("{{\"file\":\"{}\",\"valid\":{},\"time\":{:.6f},\"messages\":[{}]{}}}\n",
+                    escape_json_copy(filepath), validationResult == 0, elapsed.count(), messages,
+                    error ? fmt::format(",\"error\":\"{}\"", escape_json_copy(*error)) : "");
+        }
+
+        if (!record.empty()) {
+            std::lock_guard<std::mutex> lock{outputMutex};
+            fmt::print(cout(), "{}", record);
+            cout().flush();
+        }
+    });
+
+    if (text)
+        fmt::print(cout(), "Validated {} file(s), {} failed.\n", options.inputFilepaths.size(), failedCount.load());
+
+    if (ioFailure)
+        throw FatalError(rc::IO_FAILURE);
+    if (failedCount != 0)
+        throw FatalError(rc::INVALID_FILE);
+}
+
 } // namespace ktx
 
 KTX_COMMAND_ENTRY_POINT(ktxValidate, ktx::CommandValidate)
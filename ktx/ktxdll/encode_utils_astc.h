@@ -8,6 +8,7 @@
 #include "utility.h"
 
 #include <thread>
+#include <utility>
 
 // -------------------------------------------------------------------------------------------------
 
@@ -58,6 +59,15 @@ struct OptionsEncodeASTC : public ktxAstcParams {
         kAstcPerceptual
     };
 
+    /// Quality presets searched by --target-psnr and --target-ssim, fastest first
+    inline static const std::pair<const char*, ktx_pack_astc_quality_levels_e> kAstcQualitySteps[] = {
+        {"fastest", KTX_PACK_ASTC_QUALITY_LEVEL_FASTEST},
+        {"fast", KTX_PACK_ASTC_QUALITY_LEVEL_FAST},
+        {"medium", KTX_PACK_ASTC_QUALITY_LEVEL_MEDIUM},
+        {"thorough", KTX_PACK_ASTC_QUALITY_LEVEL_THOROUGH},
+        {"exhaustive", KTX_PACK_ASTC_QUALITY_LEVEL_EXHAUSTIVE}
+    };
+
     std::string astcOptions{};
     bool encodeASTC = false;
     ClampedOption<ktx_uint32_t> qualityLevel{ktxAstcParams::qualityLevel, 0, KTX_PACK_ASTC_QUALITY_LEVEL_MAX};
@@ -180,6 +180,9 @@ struct OptionsEncodeBasis : public ktxBasisParams {
     inline static const char* kUastcRdoF = "uastc-rdo-f";
     inline static const char* kUastcRdoM = "uastc-rdo-m";
 
+    /// BasisLZ quality levels searched by --target-psnr and --target-ssim, lowest first
+    inline static const ktx_uint32_t kQLevelSteps[] = {32, 64, 128, 192, 255};
+
     // The remaining numeric fields are clamped within the Basis library
     ClampedOption<ktx_uint32_t> qualityLevel;
     ClampedOption<ktx_uint32_t> maxEndpoints;
@@ -101,6 +101,14 @@ public:
         return true;
     }
 
+    [[nodiscard]] RangeIndex first() const {
+        RangeIndex first = RangeEnd;
+        for (const auto& range : ranges)
+            if (range.begin != range.end && range.begin < first)
+                first = range.begin;
+        return first;
+    }
+
     [[nodiscard]] RangeIndex last() const {
         RangeIndex last = 0;
         for (const auto& range : ranges)
@@ -0,0 +1,133 @@
+// Copyright 2022-2023 The Khronos Group Inc.
+// Copyright 2022-2023 RasterGrid Kft.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// -------------------------------------------------------------------------------------------------
+
+namespace ktx {
+
+/// Streaming XXH64 content hash (seed 0).
+/// The result matches the reference implementation (e.g. xxhsum -H1), so it can be used to
+/// identify level data across tools without re-reading the files.
+class XXHash64 {
+    static constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+    static constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+    static constexpr uint64_t kPrime3 = 0x165667B19E3779F9ull;
+    static constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ull;
+    static constexpr uint64_t kPrime5 = 0x27D4EB2F165667C5ull;
+
+    uint64_t acc[4];
+    uint8_t buffer[32];
+    std::size_t bufferSize = 0;
+    uint64_t totalSize = 0;
+
+    static uint64_t rotl(uint64_t x, int r) {
+        return (x << r) | (x >> (64 - r));
+    }
+
+    static uint64_t read64(const uint8_t* ptr) {
+        uint64_t value;
+        std::memcpy(&value, ptr, sizeof(value));
+        return value; // Little-endian hosts only, as everywhere else in the tools
+    }
+
+    static uint32_t read32(const uint8_t* ptr) {
+        uint32_t value;
+        std::memcpy(&value, ptr, sizeof(value));
+        return value;
+    }
+
+    static uint64_t round(uint64_t accValue, uint64_t input) {
+        accValue += input * kPrime2;
+        return rotl(accValue, 31) * kPrime1;
+    }
+
+    static uint64_t mergeRound(uint64_t hash, uint64_t accValue) {
+        hash ^= round(0, accValue);
+        return hash * kPrime1 + kPrime4;
+    }
+
+    void consumeStripe(const uint8_t* ptr) {
+        acc[0] = round(acc[0], read64(ptr));
+        acc[1] = round(acc[1], read64(ptr + 8));
+        acc[2] = round(acc[2], read64(ptr + 16));
+        acc[3] = round(acc[3], read64(ptr + 24));
+    }
+
+public:
+    XXHash64() {
+        reset();
+    }
+
+    void reset() {
+        acc[0] = kPrime1 + kPrime2;
+        acc[1] = kPrime2;
+        acc[2] = 0;
+        acc[3] = 0 - kPrime1;
+        bufferSize = 0;
+        totalSize = 0;
+    }
+
+    void update(const void* data, std::size_t size) {
+        auto ptr = static_cast<const uint8_t*>(data);
+        totalSize += size;
+
+        if (bufferSize != 0) {
+            const auto fill = std::min(size, sizeof(buffer) - bufferSize);
+            std::memcpy(buffer + bufferSize, ptr, fill);
+            bufferSize += fill;
+            ptr += fill;
+            size -= fill;
+            if (bufferSize < sizeof(buffer))
+                return;
+            consumeStripe(buffer);
+            bufferSize = 0;
+        }
+
+        for (; size >= sizeof(buffer); ptr += sizeof(buffer), size -= sizeof(buffer))
+            consumeStripe(ptr);
+
+        std::memcpy(buffer, ptr, size);
+        bufferSize = size;
+    }
+
+    uint64_t digest() const {
+        uint64_t hash;
+        if (totalSize >= sizeof(buffer)) {
+            hash = rotl(acc[0], 1) + rotl(acc[1], 7) + rotl(acc[2], 12) + rotl(acc[3], 18);
+            for (const auto accValue : acc)
+                hash = mergeRound(hash, accValue);
+        } else {
+            hash = acc[2] + kPrime5;
+        }
+        hash += totalSize;
+
+        const uint8_t* ptr = buffer;
+        std::size_t size = bufferSize;
+        for (; size >= 8; ptr += 8, size -= 8)
+            hash = rotl(hash ^ round(0, read64(ptr)), 27) * kPrime1 + kPrime4;
+        if (size >= 4) {
+            hash = rotl(hash ^ (uint64_t{read32(ptr)} * kPrime1), 23) * kPrime2 + kPrime3;
+            ptr += 4;
+            size -= 4;
+        }
+        for (; size > 0; ++ptr, --size)
+            hash = rotl(hash ^ (uint64_t{*ptr} * kPrime5), 11) * kPrime1;
+
+        hash ^= hash >> 33;
+        hash *= kPrime2;
+        hash ^= hash >> 29;
+        hash *= kPrime3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+};
+
+} // namespace ktx
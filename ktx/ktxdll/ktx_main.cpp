@@ -4,7 +4,10 @@
 #include "command.h"        // For ktx::Command, ktx::pfnBuiltinCommand, KTX_COMMAND_BUILTIN, rc, etc.
 #include "platform_utils.h" // For the ORIGINAL InitUTF8CLI, version(), CONSOLE_USAGE_WIDTH
 #include "stdafx.h"         // If used
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <unordered_map>
 #include <vector>  // For std::vector
@@ -57,45 +60,45 @@ namespace ktx
         }
         catch (const std::exception &ex)
         {
-            fmt::print(std::cerr, "{}: {}\n", (argc > 0 && argv[0] ? argv[0] : "ktx"), ex.what());
-            printUsage(std::cerr, options);
+            fmt::print(cerr(), "{}: {}\n", (argc > 0 && argv[0] ? argv[0] : "ktx"), ex.what());
+            printUsage(cerr(), options);
             return +rc::INVALID_ARGUMENTS;
         }
         testrun = args["testrun"].as<bool>();
         if (args.count("help"))
         {
-            fmt::print(std::cout,
+            fmt::print(cout(),
                        "{}: Unified CLI frontend for the KTX-Software library with sub-commands for "
                        "specific operations.\n",
                        (argc > 0 && argv[0] ? argv[0] : "ktx"));
-            printUsage(std::cout, options);
+            printUsage(cout(), options);
             return +rc::SUCCESS;
         }
         if (args.count("version"))
         {
-            fmt::print("{} version: {}\n", (argc > 0 && argv[0] ? argv[0] : "ktx"), version(testrun));
+            fmt::print(cout(), "{} version: {}\n", (argc > 0 && argv[0] ? argv[0] : "ktx"), version(testrun));
             return +rc::SUCCESS;
         }
         if (args.unmatched().empty())
         {
             if (argc <= 1)
             { // Only program name
-                fmt::print(std::cerr, "{}: Missing command.\n",
+                fmt::print(cerr(), "{}: Missing command.\n",
                            (argc > 0 && argv[0] ? argv[0] : "ktx"));
             }
             else
             { // Arguments were present but not matched as options or a known command pattern
-                fmt::print(std::cerr, "{}: Unrecognized argument or missing command after: \"{}\"\n",
+                fmt::print(cerr(), "{}: Unrecognized argument or missing command after: \"{}\"\n",
                            (argc > 0 && argv[0] ? argv[0] : "ktx"),
                            (argc > 1 && argv[1] ? argv[1] : ""));
             }
-            printUsage(std::cerr, options);
+            printUsage(cerr(), options);
         }
         else
         {
-            fmt::print(std::cerr, "{}: Unrecognized argument: \"{}\"\n",
+            fmt::print(cerr(), "{}: Unrecognized argument: \"{}\"\n",
                        (argc > 0 && argv[0] ? argv[0] : "ktx"), args.unmatched()[0]);
-            printUsage(std::cerr, options);
+            printUsage(cerr(), options);
         }
         return +rc::INVALID_ARGUMENTS;
     }
@@ -113,6 +116,7 @@ namespace ktx
         fmt::print(os, "  info       Print information about a KTX2 file\n");
         fmt::print(os, "  validate   Validate a KTX2 file\n");
         fmt::print(os, "  compare    Compare two KTX2 files\n");
+        fmt::print(os, "  bench      Measure encoder and transcoder throughput and quality\n");
         fmt::print(os, "  help       Display help information about the ktx tool\n");
 #if KTX_DEVELOPER_FEATURE_PATCH
         fmt::print(os, "  patch      Apply certain patch operations to a KTX2 file.\n");
@@ -138,18 +142,44 @@ KTX_COMMAND_BUILTIN(ktxTranscode)
 KTX_COMMAND_BUILTIN(ktxInfo)
 KTX_COMMAND_BUILTIN(ktxValidate)
 KTX_COMMAND_BUILTIN(ktxCompare)
+KTX_COMMAND_BUILTIN(ktxBench)
 KTX_COMMAND_BUILTIN(ktxHelp)
 #if KTX_DEVELOPER_FEATURE_PATCH
 KTX_COMMAND_BUILTIN(ktxPatch)
 #endif
 
-std::unordered_map<std::string, ktx::pfnBuiltinCommand> builtinCommands = {
-    {"create", ktxCreate}, {"deflate", ktxDeflate}, {"extract", ktxExtract}, {"encode", ktxEncode}, {"transcode", ktxTranscode}, {"info", ktxInfo}, {"validate", ktxValidate}, {"compare", ktxCompare}, {"help", ktxHelp},
+const std::unordered_map<std::string, ktx::pfnBuiltinCommand> builtinCommands = {
+    {"create", ktxCreate}, {"deflate", ktxDeflate}, {"extract", ktxExtract}, {"encode", ktxEncode}, {"transcode", ktxTranscode}, {"info", ktxInfo}, {"validate", ktxValidate}, {"compare", ktxCompare}, {"bench", ktxBench}, {"help", ktxHelp},
 #if KTX_DEVELOPER_FEATURE_PATCH
     {"patch", ktxPatch}
 #endif
 };
 
+namespace
+{
+    /// Forwards the diagnostics of ktx_main_capture to the caller's callback.
+    class CallbackLogSink : public ktx::LogSink
+    {
+        ktx_log_callback callback;
+        void *userData;
+
+    public:
+        CallbackLogSink(ktx_log_callback callback, void *userData) : callback(callback), userData(userData) {}
+
+        virtual void log(ktx::LogLevel level, const std::string &command, const std::string &message) override
+        {
+            if (callback)
+                callback(userData, static_cast<ktx_log_level>(level), command.c_str(), message.c_str());
+        }
+    };
+
+    static_assert(static_cast<int>(ktx::LogLevel::info) == KTX_LOG_INFO &&
+                      static_cast<int>(ktx::LogLevel::warning) == KTX_LOG_WARNING &&
+                      static_cast<int>(ktx::LogLevel::error) == KTX_LOG_ERROR &&
+                      static_cast<int>(ktx::LogLevel::fatal) == KTX_LOG_FATAL,
+                  "ktx_log_level must match ktx::LogLevel");
+} // namespace
+
 // -------------------------------------------------------------------------------------------------
 // Exported ktx_main function
 // -------------------------------------------------------------------------------------------------
@@ -158,18 +188,6 @@ extern "C"
 
     KTX_API int ktx_main(int argc, char *argv[])
     {
-        // print argv for argc
-        // if is debug
-        if (!false)
-        {
-            std::cout << "[KTX DLL Main] argc: " << argc << std::endl;
-            for (int i = 0; i < argc; ++i)
-            {
-                std::cout << "[KTX DLL Main] argv[" << i << "]: " << (argv[i] ? argv[i] : "(null)")
-                          << std::endl;
-            }
-        }
-
         if (argc >= 2)
         {
             std::string command_name = argv[1] ? argv[1] : "";
@@ -184,6 +202,36 @@ extern "C"
         return cmd.main(argc, argv);
     }
 
+    KTX_API int ktx_main_capture(int argc, char *argv[], ktx_log_callback logCallback, void *userData,
+                                 char *outputBuffer, size_t outputBufferSize, size_t *outputSize)
+    {
+        std::ostringstream out;
+        std::ostringstream err;
+        CallbackLogSink sink{logCallback, userData};
+
+        int result;
+        {
+            ktx::ScopedCommandStreams streams({&out, &err, &sink});
+            result = ktx_main(argc, argv);
+        }
+
+        // Usage errors of the top level command are plain text
+        const auto errText = std::move(err).str();
+        if (!errText.empty())
+            sink.log(ktx::LogLevel::error, "ktx", errText);
+
+        const auto outText = std::move(out).str();
+        if (outputSize)
+            *outputSize = outText.size();
+        if (outputBuffer && outputBufferSize > 0)
+        {
+            const auto length = std::min(outText.size(), outputBufferSize - 1);
+            std::memcpy(outputBuffer, outText.data(), length);
+            outputBuffer[length] = '\0';
+        }
+        return result;
+    }
+
 } // extern "C"
 
 // Dummy version function - ensure your build links the actual version.cpp or similar
@@ -7,7 +7,35 @@
     #define KTX_API
 #endif
 
+#include <stddef.h>
+
 extern "C" {
+// Runs one ktx command. Safe to call concurrently from multiple threads: text output and
+// diagnostics go to the streams of the calling thread (see ktx::ScopedCommandStreams in
+// command.h, std::cout and std::cerr by default). Binary output to '-' still uses the process
+// wide stdout.
 KTX_API int ktx_main(int argc, char* argv[]);
+
+// Severity of the messages passed to a ktx_log_callback.
+typedef enum ktx_log_level {
+    KTX_LOG_INFO = 0,
+    KTX_LOG_WARNING = 1,
+    KTX_LOG_ERROR = 2,
+    KTX_LOG_FATAL = 3,
+} ktx_log_level;
+
+// Receives one diagnostic message of a command, e.g. command "ktx encode". Called on the thread of
+// the ktx_main_capture call or on worker threads of the command, but never concurrently for one call.
+typedef void (*ktx_log_callback)(void* userData, ktx_log_level level, const char* command,
+                                 const char* message);
+
+// Runs one ktx command like ktx_main without any console I/O.
+// Diagnostics are passed to logCallback and are discarded if it is NULL. The text output of the
+// command (e.g. the JSON of info, the differences found by compare) is written to outputBuffer as a
+// NUL-terminated string, truncated to outputBufferSize - 1 characters. If outputSize is not NULL it
+// receives the full length of the output, so a larger buffer can be passed if it was truncated.
+// Returns the exit code of the command.
+KTX_API int ktx_main_capture(int argc, char* argv[], ktx_log_callback logCallback, void* userData,
+                             char* outputBuffer, size_t outputBufferSize, size_t* outputSize);
 // No need for ktx_run_command_with_args if we modify InitUTF8CLI behavior conditionally
 }
\ No newline at end of file
@@ -5,6 +5,8 @@
 #pragma once
 
 #include "command.h"
+#include "encode_utils_astc.h"
+#include "encode_utils_basis.h"
 #include "transcode_utils.h"
 #include "utility.h"
 #include "image.hpp"
@@ -13,8 +15,18 @@
 #include "ktxint.h"
 #include "texture2.h"
 
-#include <basisu/encoder/basisu_enc.h>
-#include <basisu/encoder/basisu_ssim.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
 
 // -------------------------------------------------------------------------------------------------
 
@@ -33,39 +45,332 @@ namespace ktx {
       <dt>\--compare-psnr</dt>
       <dd>Calculate encoding peak signal-to-noise ratio (PSNR) and print it to stdout.
           Requires Basis-LZ, UASTC or ASTC encoding.</dd>
+      <dt>\--target-psnr &lt;dB&gt;</dt>
+      <dd>Encode with the fastest encoder settings first and raise the encoder
+          effort only for the mip levels whose PSNR is below the target.
+          ASTC searches the @b \--astc-quality presets, UASTC the
+          @b \--uastc-quality levels per mip level. BasisLZ searches
+          @b \--qlevel for the whole texture. KTXwriterScParams records the
+          chosen setting if all mip levels use the same one, otherwise the
+          target, which repeats the same search when the parameters are
+          replayed. Cannot be combined with the option being searched.
+          Requires Basis-LZ, UASTC or ASTC encoding.</dd>
+      <dt>\--target-ssim &lt;ssim&gt;</dt>
+      <dd>Same as @b \--target-psnr with a minimum SSIM that every channel must
+          reach. Range is (0,1]. Both targets can be combined.
+          Requires Basis-LZ, UASTC or ASTC encoding.</dd>
     </dl>
 </dl>
 //! [command options_metrics]
 */
 struct OptionsMetrics {
+    inline static const char* kTargetPsnr = "target-psnr";
+    inline static const char* kTargetSsim = "target-ssim";
+
     bool compare_ssim;
     bool compare_psnr;
+    std::optional<float> target_psnr;
+    std::optional<float> target_ssim;
+    /// Quality target, or the encoder setting it selected, for KTXwriterScParams
+    std::string targetOptions{};
 
     void init(cxxopts::Options& opts) {
         opts.add_options()
             ("compare-ssim", "Calculate encoding structural similarity index measure (SSIM) and print it to stdout. Requires Basis-LZ, UASTC or ASTC encoding.")
-            ("compare-psnr", "Calculate encoding peak signal-to-noise ratio (PSNR) and print it to stdout. Requires Basis-LZ, UASTC or ASTC encoding.");
+            ("compare-psnr", "Calculate encoding peak signal-to-noise ratio (PSNR) and print it to stdout. Requires Basis-LZ, UASTC or ASTC encoding.")
+            (kTargetPsnr, "Encode with the fastest encoder settings first and raise the encoder effort only for the mip levels "
+                "whose PSNR is below the target. ASTC searches the --astc-quality presets, UASTC the --uastc-quality levels "
+                "per mip level. BasisLZ searches --qlevel for the whole texture. KTXwriterScParams records the chosen "
+                "setting if all mip levels use the same one, otherwise the target. Requires Basis-LZ, UASTC or ASTC encoding.", cxxopts::value<float>(), "<dB>")
+            (kTargetSsim, "Same as --target-psnr with a minimum SSIM that every channel must reach. Range is (0,1]. "
+                "Requires Basis-LZ, UASTC or ASTC encoding.", cxxopts::value<float>(), "<ssim>");
     }
 
-    void process(cxxopts::Options&, cxxopts::ParseResult& args, Reporter&) {
+    void process(cxxopts::Options&, cxxopts::ParseResult& args, Reporter& report) {
         compare_ssim = args["compare-ssim"].as<bool>();
         compare_psnr = args["compare-psnr"].as<bool>();
+
+        if (args[kTargetPsnr].count()) {
+            target_psnr = args[kTargetPsnr].as<float>();
+            if (!(*target_psnr > 0.0f))
+                report.fatal_usage("Invalid --{} value: {}. The target must be positive.", kTargetPsnr, *target_psnr);
+            targetOptions += fmt::format(" --{} {}", kTargetPsnr, *target_psnr);
+        }
+
+        if (args[kTargetSsim].count()) {
+            target_ssim = args[kTargetSsim].as<float>();
+            if (!(*target_ssim > 0.0f && *target_ssim <= 1.0f))
+                report.fatal_usage("Invalid --{} value: {}. The target must be in (0,1].", kTargetSsim, *target_ssim);
+            targetOptions += fmt::format(" --{} {}", kTargetSsim, *target_ssim);
+        }
+    }
+
+    [[nodiscard]] bool hasQualityTarget() const {
+        return target_psnr.has_value() || target_ssim.has_value();
+    }
+};
+
+/// SSIM per channel and PSNR of one image against its reference.
+struct ImageQuality {
+    std::array<float, 4> ssim{1.0f, 1.0f, 1.0f, 1.0f};
+    float psnr = 100.0f;
+};
+
+/// SSIM and PSNR computed directly on 8-bit texture memory.
+///
+/// Follows basisu::compute_ssim (11x11 Gaussian window, sigma 1.5, clamped
+/// borders) and the Rec. 709 luma PSNR of basisu::image_metrics::calc. The
+/// Gaussian window is separable, so it is applied as a horizontal and a
+/// vertical 11 tap pass over a ring of filtered rows instead of a direct 2D
+/// convolution over full size float copies of both images.
+class QualityMetrics {
+public:
+    /// Tightly packed 8-bit image with @a stride interleaved channels per pixel.
+    struct View {
+        const uint8_t* data;
+        uint32_t stride;
+    };
+
+    /// Compare the first @a numChannels channels of @a test against @a reference.
+    /// Remaining channels are identical padding on both sides: their SSIM is 1
+    /// and they read as 0 in the luma used for PSNR. Rows are split across
+    /// threads when @a parallel is set.
+    static ImageQuality compare(View reference, View test, uint32_t width, uint32_t height,
+            uint32_t numChannels, bool ssim, bool psnr, bool parallel) {
+        ImageQuality result;
+        const auto forEachBand = [&](size_t bytesPerRow, auto&& func) {
+            if (parallel)
+                imageio::forEachRowBand(height, bytesPerRow, func);
+            else
+                func(0u, height);
+        };
+
+        if (ssim) {
+            for (uint32_t c = 0; c < std::min(numChannels, 4u); ++c) {
+                std::mutex mutex;
+                double sum = 0.0;
+                // Each pixel touches every filtered moment of every tap; weigh
+                // the work accordingly so small images stay single threaded.
+                forEachBand(size_t{width} * kTaps * kMoments * sizeof(float), [&](uint32_t firstRow, uint32_t endRow) {
+                    const double bandSum = ssimRows(reference, test, width, height, c, firstRow, endRow);
+                    std::lock_guard lock{mutex};
+                    sum += bandSum;
+                });
+                result.ssim[c] = static_cast<float>(sum / (double(width) * height));
+            }
+        }
+
+        if (psnr) {
+            std::mutex mutex;
+            uint64_t sum = 0;
+            uint64_t sum2 = 0;
+            forEachBand(size_t{width} * 8, [&](uint32_t firstRow, uint32_t endRow) {
+                uint64_t bandSum = 0;
+                uint64_t bandSum2 = 0;
+                const auto rowStart = size_t{firstRow} * width;
+                const auto rowEnd = size_t{endRow} * width;
+                for (size_t i = rowStart; i < rowEnd; ++i) {
+                    const auto diff = std::abs(luma709(reference, i, numChannels) - luma709(test, i, numChannels));
+                    bandSum += diff;
+                    bandSum2 += uint64_t(diff) * diff;
+                }
+                std::lock_guard lock{mutex};
+                sum += bandSum;
+                sum2 += bandSum2;
+            });
+
+            // Same rounding steps as basisu::image_metrics::calc
+            const double totalValues = double(width) * double(height);
+            const auto meanSquared = static_cast<float>(std::clamp(double(sum2) / totalValues, 0.0, 255.0 * 255.0));
+            const auto rms = static_cast<float>(std::sqrt(meanSquared));
+            result.psnr = rms != 0.0f ? static_cast<float>(std::clamp(std::log10(255.0 / rms) * 20.0f, 0.0, 100.0)) : 100.0f;
+        }
+
+        return result;
+    }
+
+private:
+    static constexpr int kRadius = 5;
+    static constexpr int kTaps = 2 * kRadius + 1;
+    /// Filtered a, b, a*a, b*b and a*b
+    static constexpr int kMoments = 5;
+    static constexpr float kC1 = 6.50250f;
+    static constexpr float kC2 = 58.52250f;
+
+    /// Normalized 1D taps whose outer product is the normalized 11x11 window
+    static const std::array<float, kTaps>& gaussianTaps() {
+        static const std::array<float, kTaps> taps = [] {
+            std::array<double, kTaps> weights{};
+            double sum = 0.0;
+            for (int i = 0; i < kTaps; ++i) {
+                const double d = i - kRadius;
+                weights[i] = std::exp(-d * d / (2.0 * 1.5 * 1.5));
+                sum += weights[i];
+            }
+            std::array<float, kTaps> result{};
+            for (int i = 0; i < kTaps; ++i)
+                result[i] = static_cast<float>(weights[i] / sum);
+            return result;
+        }();
+        return taps;
+    }
+
+    static int luma709(View view, size_t pixelIndex, uint32_t numChannels) {
+        const uint8_t* pixel = view.data + pixelIndex * view.stride;
+        const uint32_t r = pixel[0];
+        const uint32_t g = numChannels > 1 ? pixel[1] : 0u;
+        const uint32_t b = numChannels > 2 ? pixel[2] : 0u;
+        return static_cast<int>((13938u * r + 46869u * g + 4729u * b + 32768u) >> 16u);
+    }
+
+    /// out[x] = sum(taps[i] * in[x + i]) over a row padded by kRadius on both sides
+    static void convolveRow(const float* in, float* out, uint32_t width, const std::array<float, kTaps>& taps) {
+        uint32_t x = 0;
+#if IMAGEIO_KERNELS_SSE2
+        for (; x + 4 <= width; x += 4) {
+            __m128 acc = _mm_mul_ps(_mm_set1_ps(taps[0]), _mm_loadu_ps(in + x));
+            for (int i = 1; i < kTaps; ++i)
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(taps[i]), _mm_loadu_ps(in + x + i)));
+            _mm_storeu_ps(out + x, acc);
+        }
+#endif
+        for (; x < width; ++x) {
+            float acc = taps[0] * in[x];
+            for (int i = 1; i < kTaps; ++i)
+                acc += taps[i] * in[x + i];
+            out[x] = acc;
+        }
+    }
+
+    /// Sum of the SSIM map of channel @a c over rows [firstRow, endRow).
+    static double ssimRows(View reference, View test, uint32_t width, uint32_t height, uint32_t c,
+            uint32_t firstRow, uint32_t endRow) {
+        const auto& taps = gaussianTaps();
+        const size_t paddedWidth = size_t{width} + 2 * kRadius;
+        const size_t ringRowSize = size_t{width} * kMoments;
+        std::vector<float> scratch(paddedWidth * kMoments + ringRowSize * kTaps);
+        float* padded = scratch.data();
+        float* ring = padded + paddedWidth * kMoments;
+
+        // Horizontally filter the moments of source row y into its ring slot.
+        // The rows of one vertical window are consecutive, so at most kTaps
+        // distinct rows are live and y % kTaps never collides.
+        const auto filterRow = [&](uint32_t y) {
+            const uint8_t* refRow = reference.data + size_t{y} * width * reference.stride + c;
+            const uint8_t* testRow = test.data + size_t{y} * width * test.stride + c;
+            for (size_t j = 0; j < paddedWidth; ++j) {
+                const auto x = static_cast<size_t>(std::clamp<int64_t>(int64_t(j) - kRadius, 0, width - 1));
+                const float a = refRow[x * reference.stride];
+                const float b = testRow[x * test.stride];
+                padded[j] = a;
+                padded[paddedWidth + j] = b;
+                padded[2 * paddedWidth + j] = a * a;
+                padded[3 * paddedWidth + j] = b * b;
+                padded[4 * paddedWidth + j] = a * b;
+            }
+            float* slot = ring + (y % kTaps) * ringRowSize;
+            for (int m = 0; m < kMoments; ++m)
+                convolveRow(padded + m * paddedWidth, slot + m * width, width, taps);
+        };
+
+        const auto ssimValue = [](float mu1, float mu2, float aa, float bb, float ab) {
+            const float mu1mu2 = mu1 * mu2;
+            const float mu1Sq = mu1 * mu1;
+            const float mu2Sq = mu2 * mu2;
+            return ((2.0f * mu1mu2 + kC1) * (2.0f * (ab - mu1mu2) + kC2)) /
+                    ((mu1Sq + mu2Sq + kC1) * ((aa - mu1Sq) + (bb - mu2Sq) + kC2));
+        };
+
+        double sum = 0.0;
+        int64_t nextRow = std::max<int64_t>(0, int64_t(firstRow) - kRadius);
+        for (uint32_t y = firstRow; y < endRow; ++y) {
+            const int64_t lastRow = std::min<int64_t>(int64_t(y) + kRadius, height - 1);
+            for (; nextRow <= lastRow; ++nextRow)
+                filterRow(static_cast<uint32_t>(nextRow));
+
+            std::array<const float*, kTaps> rows;
+            for (int i = 0; i < kTaps; ++i) {
+                const auto source = std::clamp<int64_t>(int64_t(y) + i - kRadius, 0, height - 1);
+                rows[i] = ring + (source % kTaps) * ringRowSize;
+            }
+
+            uint32_t x = 0;
+#if IMAGEIO_KERNELS_SSE2
+            __m128 rowSum = _mm_setzero_ps();
+            for (; x + 4 <= width; x += 4) {
+                __m128 moments[kMoments];
+                for (int m = 0; m < kMoments; ++m) {
+                    __m128 acc = _mm_mul_ps(_mm_set1_ps(taps[0]), _mm_loadu_ps(rows[0] + m * width + x));
+                    for (int i = 1; i < kTaps; ++i)
+                        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(taps[i]), _mm_loadu_ps(rows[i] + m * width + x)));
+                    moments[m] = acc;
+                }
+                const __m128 two = _mm_set1_ps(2.0f);
+                const __m128 mu1mu2 = _mm_mul_ps(moments[0], moments[1]);
+                const __m128 mu1Sq = _mm_mul_ps(moments[0], moments[0]);
+                const __m128 mu2Sq = _mm_mul_ps(moments[1], moments[1]);
+                const __m128 numerator = _mm_mul_ps(
+                        _mm_add_ps(_mm_mul_ps(two, mu1mu2), _mm_set1_ps(kC1)),
+                        _mm_add_ps(_mm_mul_ps(two, _mm_sub_ps(moments[4], mu1mu2)), _mm_set1_ps(kC2)));
+                const __m128 denominator = _mm_mul_ps(
+                        _mm_add_ps(_mm_add_ps(mu1Sq, mu2Sq), _mm_set1_ps(kC1)),
+                        _mm_add_ps(_mm_add_ps(_mm_sub_ps(moments[2], mu1Sq), _mm_sub_ps(moments[3], mu2Sq)), _mm_set1_ps(kC2)));
+                rowSum = _mm_add_ps(rowSum, _mm_div_ps(numerator, denominator));
+            }
+            alignas(16) float lanes[4];
+            _mm_store_ps(lanes, rowSum);
+            sum += double(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+#endif
+            for (; x < width; ++x) {
+                float moments[kMoments];
+                for (int m = 0; m < kMoments; ++m) {
+                    float acc = taps[0] * rows[0][m * width + x];
+                    for (int i = 1; i < kTaps; ++i)
+                        acc += taps[i] * rows[i][m * width + x];
+                    moments[m] = acc;
+                }
+                sum += ssimValue(moments[0], moments[1], moments[2], moments[3], moments[4]);
+            }
+        }
+        return sum;
     }
 };
 
+// -------------------------------------------------------------------------------------------------
+
 class MetricsCalculator {
+    /// One image of the texture, in level, layer, face, depth slice order
+    struct ImageEntry {
+        uint32_t levelIndex;
+        uint32_t layerIndex;
+        uint32_t faceIndex;
+        uint32_t depthSliceIndex;
+        uint32_t width;
+        uint32_t height;
+        size_t referenceOffset;
+    };
+
     uint32_t referenceNumChannels = 0;
-    std::vector<basisu::image> referenceImages;
+    uint32_t referenceNumLevels = 0;
+    /// Raw copy of the R/RG/RGB/RGBA 8bit reference texture data
+    std::vector<uint8_t> referenceData;
+    std::vector<ImageEntry> images;
 
 public:
     void saveReferenceImages(KTXTexture2& texture, const OptionsMetrics& opts, Reporter&) {
         if (!opts.compare_ssim && !opts.compare_psnr)
             return;
 
-        const auto numChannels = ktxTexture2_GetNumComponents(texture);
-        referenceNumChannels = numChannels;
+        saveReference(texture);
+    }
+
+    /// Keep a copy of the uncompressed @a texture to measure encodings of it against.
+    void saveReference(KTXTexture2& texture) {
+        referenceNumChannels = ktxTexture2_GetNumComponents(texture);
+        referenceNumLevels = texture->numLevels;
+        referenceData.assign(texture->pData, texture->pData + texture->dataSize);
+        images.clear();
 
-        // Format is R/RG/RGB/RGBA 8bit UNORM/SRGB
         for (uint32_t levelIndex = 0; levelIndex < texture->numLevels; ++levelIndex) {
             const uint32_t imageWidth = std::max(texture->baseWidth >> levelIndex, 1u);
             const uint32_t imageHeight = std::max(texture->baseHeight >> levelIndex, 1u);
@@ -74,30 +379,19 @@ public:
             for (uint32_t layerIndex = 0; layerIndex < texture->numLayers; ++layerIndex) {
                 for (uint32_t faceIndex = 0; faceIndex < texture->numFaces; ++faceIndex) {
                     for (uint32_t depthSliceIndex = 0; depthSliceIndex < imageDepths; ++depthSliceIndex) {
-
                         ktx_size_t imageOffset;
                         ktxTexture_GetImageOffset(texture, levelIndex, layerIndex, faceIndex + depthSliceIndex, &imageOffset);
-                        const auto* imageData = texture->pData + imageOffset;
-
-                        auto& ref = referenceImages.emplace_back(imageWidth, imageHeight);
-
-                        for (uint32_t y = 0; y < imageHeight; ++y) {
-                            for (uint32_t x = 0; x < imageWidth; ++x) {
-                                ref(x, y) = basisu::color_rgba(0, 0, 0, 255);
-                                for (uint32_t c = 0; c < numChannels; ++c)
-                                    ref(x, y)[c] = *(imageData + y * imageWidth * numChannels + x * numChannels + c);
-                            }
-                        }
+                        images.push_back({levelIndex, layerIndex, faceIndex, depthSliceIndex,
+                                imageWidth, imageHeight, imageOffset});
                     }
                 }
             }
         }
     }
 
-    void decodeAndCalculateMetrics(KTXTexture2& encodedTexture, const OptionsMetrics& opts, Reporter& report) {
-        if (!opts.compare_ssim && !opts.compare_psnr)
-            return;
-
+    /// Decode a copy of @a encodedTexture and measure every image against the reference.
+    std::vector<ImageQuality> measure(KTXTexture2& encodedTexture, bool ssim, bool psnr, Reporter& report) {
+        // Decoding replaces the texture data in place and the encoded texture is still to be written
         KTXTexture2 texture{static_cast<ktxTexture2*>(malloc(sizeof(ktxTexture2)))};
         ktxTexture2_constructCopy(texture, encodedTexture);
 
@@ -120,94 +414,299 @@ public:
         if (ec != KTX_SUCCESS)
             report.fatal(rc::KTX_FAILURE, "Failed to transcode KTX2 texture to calculate error metrics: {}", ktxErrorString(ec));
 
-        float overallSSIM[4] = {};
-        float overallPSNR = 0;
+        // Swizzle the decoded images in place and score them straight from texture memory
+        std::vector<const uint8_t*> decodedImages;
+        decodedImages.reserve(images.size());
+        for (const auto& image : images) {
+            ktx_size_t imageOffset;
+            ktxTexture_GetImageOffset(texture, image.levelIndex, image.layerIndex, image.faceIndex + image.depthSliceIndex, &imageOffset);
+            auto* imageData = texture->pData + imageOffset;
+
+            rgba8image imageView(image.width, image.height, reinterpret_cast<rgba8color*>(imageData));
+            imageView.swizzle(tSwizzleInfo.swizzle);
+            decodedImages.push_back(imageData);
+        }
 
-        auto refIt = referenceImages.begin();
-        for (uint32_t levelIndex = 0; levelIndex < texture->numLevels; ++levelIndex) {
-            const uint32_t imageWidth = std::max(texture->baseWidth >> levelIndex, 1u);
-            const uint32_t imageHeight = std::max(texture->baseHeight >> levelIndex, 1u);
-            const uint32_t imageDepth = std::max(texture->baseDepth >> levelIndex, 1u);
+        // Large images are split into row bands, the small ones are scored concurrently
+        const auto isLarge = [](const ImageEntry& image) {
+            return size_t{image.width} * image.height * 4 >= imageio::kMinParallelBytes;
+        };
+        const auto score = [&](size_t i, bool parallel) {
+            const auto& image = images[i];
+            return QualityMetrics::compare(
+                    {referenceData.data() + image.referenceOffset, referenceNumChannels},
+                    {decodedImages[i], 4u},
+                    image.width, image.height, referenceNumChannels,
+                    ssim, psnr, parallel);
+        };
+
+        std::vector<ImageQuality> qualities(images.size());
+        {
+            std::atomic<size_t> nextImage{0};
+            const auto worker = [&] {
+                for (size_t i; (i = nextImage++) < images.size();)
+                    if (!isLarge(images[i]))
+                        qualities[i] = score(i, false);
+            };
+            const auto threadCount = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), images.size());
+            std::vector<std::thread> workers;
+            for (size_t t = 1; t < threadCount; ++t)
+                workers.emplace_back(worker);
+            worker();
+            for (auto& thread : workers)
+                thread.join();
+        }
+        for (size_t i = 0; i < images.size(); ++i)
+            if (isLarge(images[i]))
+                qualities[i] = score(i, true);
 
-            for (uint32_t layerIndex = 0; layerIndex < texture->numLayers; ++layerIndex) {
-                for (uint32_t faceIndex = 0; faceIndex < texture->numFaces; ++faceIndex) {
-                    for (uint32_t depthSliceIndex = 0; depthSliceIndex < imageDepth; ++depthSliceIndex) {
-                        assert(refIt != referenceImages.end() && "Internal error");
+        return qualities;
+    }
 
-                        ktx_size_t imageOffset;
-                        ktxTexture_GetImageOffset(texture, levelIndex, layerIndex, faceIndex + depthSliceIndex, &imageOffset);
-                        auto* imageData = texture->pData + imageOffset;
-
-                        rgba8image imageView(imageWidth, imageHeight, reinterpret_cast<rgba8color*>(imageData));
-                        imageView.swizzle(tSwizzleInfo.swizzle);
-
-                        auto& ref = *refIt++;
-
-                        basisu::image basisuImage;
-                        basisuImage.resize(imageWidth, imageHeight);
-
-                        for (uint32_t y = 0; y < imageHeight; ++y) {
-                            for (uint32_t x = 0; x < imageWidth; ++x) {
-                                basisuImage(x, y) = basisu::color_rgba(0, 0, 0, 255);
-                                for (uint32_t c = 0; c < referenceNumChannels; ++c)
-                                    basisuImage(x, y)[c] = imageView(x, y)[c];
-                            }
-                        }
-
-                        if (referenceImages.size() != 1)
-                            fmt::print("Level {}{}{}{}:\n",
-                                    levelIndex,
-                                    texture->isArray ? fmt::format(" Layer {}", layerIndex) : "",
-                                    texture->isCubemap ? fmt::format(" Face {}", faceIndex) : "",
-                                    texture->numDimensions == 3 ? fmt::format(" Depth {}", depthSliceIndex) : "");
-
-                        if (opts.compare_ssim) {
-                            const auto ssim = basisu::compute_ssim(ref, basisuImage, false, false);
-                            if (referenceImages.size() != 1) {
-                                if (referenceNumChannels > 3)
-                                    fmt::print("    SSIM R: {:+7.6f}, G: {:+7.6f}, B: {:+7.6f}, A: {:+7.6f}\n", ssim[0], ssim[1], ssim[2], ssim[3]);
-                                else if (referenceNumChannels > 2)
-                                    fmt::print("    SSIM R: {:+7.6f}, G: {:+7.6f}, B: {:+7.6f}\n", ssim[0], ssim[1], ssim[2]);
-                                else if (referenceNumChannels > 1)
-                                    fmt::print("    SSIM R: {:+7.6f}, G: {:+7.6f}\n", ssim[0], ssim[1]);
-                                else if (referenceNumChannels > 0)
-                                    fmt::print("    SSIM R: {:+7.6f}\n", ssim[0]);
-                            }
-                            for (int i = 0; i < 4; ++i)
-                                overallSSIM[i] += ssim[i];
-                        }
-
-                        if (opts.compare_psnr) {
-                            basisu::image_metrics im;
-                            im.calc(ref, basisuImage);
-                            if (referenceImages.size() != 1)
-                                fmt::print("    PSNR: {:9.6f}\n", im.m_psnr);
-                            overallPSNR = std::max(overallPSNR, im.m_psnr);
-                        }
-                    }
+    /// Measure @a encodedTexture and report for each mip level whether all of its images meet the quality target.
+    std::vector<bool> levelsMeetingTarget(KTXTexture2& encodedTexture, const OptionsMetrics& opts, Reporter& report) {
+        const auto qualities = measure(encodedTexture, opts.target_ssim.has_value(), opts.target_psnr.has_value(), report);
+
+        std::vector<bool> passes(referenceNumLevels, true);
+        for (size_t i = 0; i < images.size(); ++i) {
+            const auto& quality = qualities[i];
+            bool pass = !opts.target_psnr || quality.psnr >= *opts.target_psnr;
+            for (uint32_t c = 0; opts.target_ssim && c < std::min(referenceNumChannels, 4u); ++c)
+                pass = pass && quality.ssim[c] >= *opts.target_ssim;
+            if (!pass)
+                passes[images[i].levelIndex] = false;
+        }
+        return passes;
+    }
+
+    void decodeAndCalculateMetrics(KTXTexture2& encodedTexture, const OptionsMetrics& opts, Reporter& report) {
+        if (!opts.compare_ssim && !opts.compare_psnr)
+            return;
+
+        const auto qualities = measure(encodedTexture, opts.compare_ssim, opts.compare_psnr, report);
+
+        float overallSSIM[4] = {};
+        float overallPSNR = 0;
+
+        for (size_t i = 0; i < images.size(); ++i) {
+            const auto& image = images[i];
+            const auto& quality = qualities[i];
+
+            if (images.size() != 1)
+                fmt::print(report.cout(), "Level {}{}{}{}:\n",
+                        image.levelIndex,
+                        encodedTexture->isArray ? fmt::format(" Layer {}", image.layerIndex) : "",
+                        encodedTexture->isCubemap ? fmt::format(" Face {}", image.faceIndex) : "",
+                        encodedTexture->numDimensions == 3 ? fmt::format(" Depth {}", image.depthSliceIndex) : "");
+
+            if (opts.compare_ssim) {
+                const auto& ssim = quality.ssim;
+                if (images.size() != 1) {
+                    if (referenceNumChannels > 3)
+                        fmt::print(report.cout(), "    SSIM R: {:+7.6f}, G: {:+7.6f}, B: {:+7.6f}, A: {:+7.6f}\n", ssim[0], ssim[1], ssim[2], ssim[3]);
+                    else if (referenceNumChannels > 2)
+                        fmt::print(report.cout(), "    SSIM R: {:+7.6f}, G: {:+7.6f}, B: {:+7.6f}\n", ssim[0], ssim[1], ssim[2]);
+                    else if (referenceNumChannels > 1)
+                        fmt::print(report.cout(), "    SSIM R: {:+7.6f}, G: {:+7.6f}\n", ssim[0], ssim[1]);
+                    else if (referenceNumChannels > 0)
+                        fmt::print(report.cout(), "    SSIM R: {:+7.6f}\n", ssim[0]);
                 }
+                for (int c = 0; c < 4; ++c)
+                    overallSSIM[c] += ssim[c];
+            }
+
+            if (opts.compare_psnr) {
+                if (images.size() != 1)
+                    fmt::print(report.cout(), "    PSNR: {:9.6f}\n", quality.psnr);
+                overallPSNR = std::max(overallPSNR, quality.psnr);
             }
         }
-        assert(refIt == referenceImages.end() && "Internal error");
 
-        fmt::print("{}Overall:\n", referenceImages.size() != 1 ? "\n" : "");
+        fmt::print(report.cout(), "{}Overall:\n", images.size() != 1 ? "\n" : "");
 
         if (opts.compare_ssim) {
-            const auto numIf = static_cast<float>(referenceImages.size());
+            const auto numIf = static_cast<float>(images.size());
             if (referenceNumChannels > 3)
-                fmt::print("    SSIM Avg R: {:+7.6f}, G: {:+7.6f}, B: {:+7.6f}, A: {:+7.6f}\n", overallSSIM[0] / numIf, overallSSIM[1] / numIf, overallSSIM[2] / numIf, overallSSIM[3] / numIf);
+                fmt::print(report.cout(), "    SSIM Avg R: {:+7.6f}, G: {:+7.6f}, B: {:+7.6f}, A: {:+7.6f}\n", overallSSIM[0] / numIf, overallSSIM[1] / numIf, overallSSIM[2] / numIf, overallSSIM[3] / numIf);
             else if (referenceNumChannels > 2)
-                fmt::print("    SSIM Avg R: {:+7.6f}, G: {:+7.6f}, B: {:+7.6f}\n", overallSSIM[0] / numIf, overallSSIM[1] / numIf, overallSSIM[2] / numIf);
+                fmt::print(report.cout(), "    SSIM Avg R: {:+7.6f}, G: {:+7.6f}, B: {:+7.6f}\n", overallSSIM[0] / numIf, overallSSIM[1] / numIf, overallSSIM[2] / numIf);
             else if (referenceNumChannels > 1)
-                fmt::print("    SSIM Avg R: {:+7.6f}, G: {:+7.6f}\n", overallSSIM[0] / numIf, overallSSIM[1] / numIf);
+                fmt::print(report.cout(), "    SSIM Avg R: {:+7.6f}, G: {:+7.6f}\n", overallSSIM[0] / numIf, overallSSIM[1] / numIf);
             else
-                fmt::print("    SSIM Avg R: {:+7.6f}\n", overallSSIM[0] / numIf);
+                fmt::print(report.cout(), "    SSIM Avg R: {:+7.6f}\n", overallSSIM[0] / numIf);
         }
 
         if (opts.compare_psnr) {
-            fmt::print("    PSNR Max: {:9.6f}\n", overallPSNR);
+            fmt::print(report.cout(), "    PSNR Max: {:9.6f}\n", overallPSNR);
         }
     }
 };
 
+// -------------------------------------------------------------------------------------------------
+
+/// Adaptive encoding towards the --target-psnr / --target-ssim quality target.
+///
+/// The texture is first encoded with the fastest step of the caller's effort
+/// ladder. Only the mip levels that miss the target are encoded again with the
+/// next step, until they pass or the ladder runs out. With block based codecs
+/// (ASTC, UASTC) each level is independent: a failing level is extracted into
+/// its own texture, encoded and spliced back into the result. BasisLZ shares
+/// its codebooks across the texture, so it is re-encoded whole.
+class QualityTargetEncoder {
+public:
+    /// Encode @a texture in place with the settings of ladder step @a step.
+    using EncodeStep = std::function<void(KTXTexture2& texture, uint32_t step)>;
+
+    /// Returns the ladder step chosen for each mip level.
+    static std::vector<uint32_t> encode(KTXTexture2& texture, const OptionsMetrics& opts,
+            uint32_t stepCount, bool independentLevels, const EncodeStep& encodeStep, Reporter& report) {
+        KTXTexture2 original = copyTexture(texture, report);
+
+        MetricsCalculator metrics;
+        metrics.saveReference(original);
+
+        encodeStep(texture, 0);
+        std::vector<uint32_t> levelSteps(original->numLevels, 0);
+        auto passes = metrics.levelsMeetingTarget(texture, opts, report);
+
+        for (uint32_t step = 1; step < stepCount; ++step) {
+            if (std::all_of(passes.begin(), passes.end(), [](bool pass) { return pass; }))
+                break;
+
+            if (!independentLevels) {
+                KTXTexture2 candidate = copyTexture(original, report);
+                encodeStep(candidate, step);
+                std::swap(texture, candidate);
+                passes = metrics.levelsMeetingTarget(texture, opts, report);
+                std::fill(levelSteps.begin(), levelSteps.end(), step);
+                continue;
+            }
+
+            for (uint32_t levelIndex = 0; levelIndex < original->numLevels; ++levelIndex) {
+                if (passes[levelIndex])
+                    continue;
+
+                KTXTexture2 level = extractLevel(original, levelIndex, report);
+                MetricsCalculator levelMetrics;
+                levelMetrics.saveReference(level);
+                encodeStep(level, step);
+                passes[levelIndex] = levelMetrics.levelsMeetingTarget(level, opts, report)[0];
+                spliceLevel(texture, levelIndex, level, report);
+                levelSteps[levelIndex] = step;
+            }
+        }
+
+        const auto failing = std::count(passes.begin(), passes.end(), false);
+        if (failing != 0)
+            report.warning("Quality target not reached by {} of {} mip level(s) with the highest encoder effort.",
+                    failing, passes.size());
+
+        return levelSteps;
+    }
+
+    /// Format the per level choice of @a name for KTXwriterScParams as one
+    /// valid option set: the chosen value when all levels agree, which
+    /// reproduces the encoding directly, otherwise the quality target in
+    /// @a targetOptions, which repeats the same deterministic search.
+    template <typename StepName>
+    static std::string formatLevelSteps(const char* name, const std::vector<uint32_t>& levelSteps,
+            const std::string& targetOptions, StepName&& stepName) {
+        const bool uniform = std::all_of(levelSteps.begin(), levelSteps.end(),
+                [&](uint32_t step) { return step == levelSteps.front(); });
+        if (!uniform)
+            return targetOptions;
+        return fmt::format(" --{} {}", name, stepName(levelSteps.front()));
+    }
+
+private:
+    static KTXTexture2 copyTexture(KTXTexture2& texture, Reporter& report) {
+        KTXTexture2 copy{static_cast<ktxTexture2*>(malloc(sizeof(ktxTexture2)))};
+        const auto ret = ktxTexture2_constructCopy(copy, texture);
+        if (ret != KTX_SUCCESS)
+            report.fatal(rc::KTX_FAILURE, "Failed to copy KTX2 texture for quality targeted encoding: {}", ktxErrorString(ret));
+        return copy;
+    }
+
+    /// Single level texture holding mip level @a levelIndex of the uncompressed @a texture.
+    static KTXTexture2 extractLevel(KTXTexture2& texture, uint32_t levelIndex, Reporter& report) {
+        ktxTextureCreateInfo createInfo;
+        std::memset(&createInfo, 0, sizeof(createInfo));
+        createInfo.vkFormat = texture->vkFormat;
+        createInfo.baseWidth = std::max(texture->baseWidth >> levelIndex, 1u);
+        createInfo.baseHeight = std::max(texture->baseHeight >> levelIndex, 1u);
+        createInfo.baseDepth = std::max(texture->baseDepth >> levelIndex, 1u);
+        createInfo.numDimensions = texture->numDimensions;
+        createInfo.numLevels = 1;
+        createInfo.numLayers = texture->numLayers;
+        createInfo.numFaces = texture->numFaces;
+        createInfo.isArray = texture->isArray;
+        createInfo.generateMipmaps = false;
+
+        KTXTexture2 level{nullptr};
+        const auto ret = ktxTexture2_Create(&createInfo, KTX_TEXTURE_CREATE_ALLOC_STORAGE, level.pHandle());
+        if (ret != KTX_SUCCESS)
+            report.fatal(rc::KTX_FAILURE, "Failed to create KTX2 texture for quality targeted encoding: {}", ktxErrorString(ret));
+
+        KHR_DFDSETVAL(level->pDfd + 1, PRIMARIES, KHR_DFDVAL(texture->pDfd + 1, PRIMARIES));
+        KHR_DFDSETVAL(level->pDfd + 1, TRANSFER, KHR_DFDVAL(texture->pDfd + 1, TRANSFER));
+
+        // The images of a level are stored contiguously in the same order in both textures
+        ktx_size_t levelOffset;
+        ktxTexture_GetImageOffset(texture, levelIndex, 0, 0, &levelOffset);
+        assert(levelOffset + level->dataSize <= texture->dataSize && "Internal error");
+        std::memcpy(level->pData, texture->pData + levelOffset, level->dataSize);
+        return level;
+    }
+
+    /// Replace mip level @a levelIndex of the encoded @a texture with the encoded single level @a level.
+    static void spliceLevel(KTXTexture2& texture, uint32_t levelIndex, KTXTexture2& level, Reporter& report) {
+        assert(texture->supercompressionScheme == KTX_SS_NONE && level->supercompressionScheme == KTX_SS_NONE);
+
+        const auto levelDepth = std::max(texture->baseDepth >> levelIndex, 1u);
+        const auto levelSize = ktxTexture_GetImageSize(texture, levelIndex) * texture->numLayers * texture->numFaces * levelDepth;
+        ktx_size_t levelOffset;
+        ktxTexture_GetImageOffset(texture, levelIndex, 0, 0, &levelOffset);
+        if (levelSize != level->dataSize || levelOffset + levelSize > texture->dataSize)
+            report.fatal(rc::KTX_FAILURE, "Internal error: re-encoded mip level {} does not match the texture layout.", levelIndex);
+
+        std::memcpy(texture->pData + levelOffset, level->pData, levelSize);
+    }
+};
+
+/// Encode @a texture with the effort ladder of the selected codec until the
+/// quality target of @a options is met and replace @a options.targetOptions
+/// with the KTXwriterScParams that reproduce the result. @a encodeASTC and
+/// @a encodeBasis run a single encode with the current codec options.
+template <typename Options, typename EncodeASTC, typename EncodeBasis>
+void encodeToQualityTarget(KTXTexture2& texture, Options& options,
+        EncodeASTC&& encodeASTC, EncodeBasis&& encodeBasis, Reporter& report) {
+    if (options.encodeASTC) {
+        const auto& steps = OptionsEncodeASTC::kAstcQualitySteps;
+        const auto levelSteps = QualityTargetEncoder::encode(texture, options, std::size(steps), true,
+                [&](KTXTexture2& target, uint32_t step) {
+                    options.ktxAstcParams::qualityLevel = steps[step].second;
+                    encodeASTC(target);
+                }, report);
+        options.targetOptions = QualityTargetEncoder::formatLevelSteps(OptionsEncodeASTC::kAstcQuality, levelSteps,
+                options.targetOptions, [&](uint32_t step) { return steps[step].first; });
+    } else if (options.codec == BasisCodec::UASTC) {
+        const auto levelSteps = QualityTargetEncoder::encode(texture, options, KTX_PACK_UASTC_MAX_LEVEL + 1, true,
+                [&](KTXTexture2& target, uint32_t step) {
+                    options.uastcFlags = (options.uastcFlags & ~KTX_PACK_UASTC_LEVEL_MASK) | step;
+                    encodeBasis(target);
+                }, report);
+        options.targetOptions = QualityTargetEncoder::formatLevelSteps(options.kUastcQuality, levelSteps,
+                options.targetOptions, [](uint32_t step) { return step; });
+    } else {
+        const auto& steps = options.kQLevelSteps;
+        const auto levelSteps = QualityTargetEncoder::encode(texture, options, std::size(steps), false,
+                [&](KTXTexture2& target, uint32_t step) {
+                    options.ktxBasisParams::qualityLevel = steps[step];
+                    encodeBasis(target);
+                }, report);
+        options.targetOptions = QualityTargetEncoder::formatLevelSteps(options.kQLevel, levelSteps,
+                options.targetOptions, [&](uint32_t step) { return steps[step]; });
+    }
+}
+
 } // namespace ktx
@@ -0,0 +1,196 @@
+// Copyright 2022-2023 The Khronos Group Inc.
+// Copyright 2022-2023 RasterGrid Kft.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "hash_utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <fmt/format.h>
+
+// -------------------------------------------------------------------------------------------------
+
+namespace ktx {
+
+/// On-disk, content-addressed cache of command outputs shared between processes.
+///
+/// Entries are keyed by a hash of the input file contents and of every parameter that affects the
+/// output. New entries are written to a uniquely named temporary file and renamed into place, so
+/// concurrent readers only ever observe complete entries. Each entry ends with the XXH64 hash of its
+/// payload which is verified on load; damaged entries are discarded. The modification time of an
+/// entry is refreshed on every hit and the least recently used entries are evicted once the total
+/// size of the cache exceeds its limit. All cache failures are non-fatal: a failed load is a miss
+/// and a failed store leaves the cache unchanged.
+class OutputCache {
+public:
+    inline static const char* kEntryExtension = ".ktxcache";
+    inline static const char* kTempExtension = ".ktxcache-tmp";
+    /// Temporary files older than this are leftovers of crashed processes and are removed on eviction.
+    static constexpr auto kStaleTempAge = std::chrono::hours(1);
+
+private:
+    std::filesystem::path directory;
+    uint64_t maxSize;
+
+public:
+    OutputCache(std::filesystem::path directory, uint64_t maxSize) :
+        directory(std::move(directory)),
+        maxSize(maxSize) {}
+
+    /// Combines the hash of the input contents with the output parameters into an entry key.
+    static std::string makeKey(uint64_t contentHash, const std::string& params) {
+        XXHash64 hasher;
+        hasher.update(params.data(), params.size());
+        return fmt::format("{:016x}{:016x}", contentHash, hasher.digest());
+    }
+
+    /// Returns the payload of the entry or an empty optional on a miss.
+    std::optional<std::vector<uint8_t>> load(const std::string& key) const {
+        const auto path = entryPath(key);
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+            return std::nullopt;
+
+        // tellg reports a failure as -1, which must not become a huge size
+        const auto end = file.tellg();
+        if (end < 0)
+            return std::nullopt;
+        const auto fileSize = static_cast<std::size_t>(end);
+        if (fileSize < sizeof(uint64_t)) {
+            discard(path);
+            return std::nullopt;
+        }
+
+        std::vector<uint8_t> data(fileSize);
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(fileSize));
+        if (!file)
+            return std::nullopt;
+        file.close();
+
+        uint64_t storedHash;
+        const auto payloadSize = fileSize - sizeof(storedHash);
+        std::memcpy(&storedHash, data.data() + payloadSize, sizeof(storedHash));
+        XXHash64 hasher;
+        hasher.update(data.data(), payloadSize);
+        if (hasher.digest() != storedHash) {
+            discard(path);
+            return std::nullopt;
+        }
+        data.resize(payloadSize);
+
+        // Mark the entry as recently used
+        std::error_code ec;
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+        return data;
+    }
+
+    /// Stores the payload under @p key then evicts entries over the size limit.
+    /// Returns false if the entry could not be written.
+    bool store(const std::string& key, const uint8_t* data, std::size_t size) {
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+        if (ec)
+            return false;
+
+        std::random_device rd;
+        const auto tempPath = directory / fmt::format("{}-{:08x}{:08x}{}", key, rd(), rd(), kTempExtension);
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            XXHash64 hasher;
+            hasher.update(data, size);
+            const auto hash = hasher.digest();
+            file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+            file.write(reinterpret_cast<const char*>(&hash), sizeof(hash));
+            file.close();
+            if (!file) {
+                discard(tempPath);
+                return false;
+            }
+        }
+
+        std::filesystem::rename(tempPath, entryPath(key), ec);
+        if (ec) {
+            discard(tempPath);
+            return false;
+        }
+
+        evict();
+        return true;
+    }
+
+    /// Removes the least recently used entries until the total size is within the limit.
+    /// Entries removed concurrently by other processes are simply skipped.
+    void evict() const {
+        struct Entry {
+            std::filesystem::path path;
+            uint64_t size;
+            std::filesystem::file_time_type time;
+        };
+        std::vector<Entry> entries;
+        uint64_t totalSize = 0;
+        const auto now = std::filesystem::file_time_type::clock::now();
+
+        std::error_code ec;
+        for (std::filesystem::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+            std::error_code entryEc;
+            if (!it->is_regular_file(entryEc))
+                continue;
+
+            const auto extension = it->path().extension().string();
+            const auto time = it->last_write_time(entryEc);
+            if (entryEc)
+                continue;
+
+            if (extension == kTempExtension) {
+                if (now - time > kStaleTempAge)
+                    discard(it->path());
+                continue;
+            }
+            if (extension != kEntryExtension)
+                continue;
+
+            const auto size = it->file_size(entryEc);
+            if (entryEc)
+                continue;
+            entries.push_back({it->path(), size, time});
+            totalSize += size;
+        }
+
+        if (totalSize <= maxSize)
+            return;
+
+        std::sort(entries.begin(), entries.end(), [](const Entry& lhs, const Entry& rhs) {
+            return lhs.time < rhs.time;
+        });
+        for (const auto& entry : entries) {
+            if (totalSize <= maxSize)
+                break;
+            discard(entry.path);
+            totalSize -= entry.size;
+        }
+    }
+
+private:
+    std::filesystem::path entryPath(const std::string& key) const {
+        return directory / (key + kEntryExtension);
+    }
+
+    static void discard(const std::filesystem::path& path) {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+};
+
+} // namespace ktx
@@ -0,0 +1,191 @@
+// Copyright 2022-2023 The Khronos Group Inc.
+// Copyright 2022-2023 RasterGrid Kft.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "platform_utils.h"
+#include "utility.h"
+
+#include "ktx.h"
+#include "ktxint.h"
+#include "texture2.h"
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <fmt/format.h>
+
+// -------------------------------------------------------------------------------------------------
+
+namespace ktx {
+
+/// Records the stages of a command as events of the Chrome trace-event format, viewable in
+/// chrome://tracing or Perfetto.
+///
+/// Every span becomes a complete ("X") event on the thread that executed it, annotated with the
+/// peak resident set size of the process at its end. Spans reported by libktx through
+/// ktxSetThreadTraceFunction arrive as begin ("B") and end ("E") events, possibly from the worker
+/// threads of the encoders. Other threads are numbered in order of their first event. All members
+/// are thread-safe.
+class TraceRecorder {
+public:
+    using Clock = std::chrono::steady_clock;
+
+private:
+    struct Event {
+        std::string name;
+        const char* category;
+        char phase;
+        int64_t timestamp; // us
+        int64_t duration;  // us, 'X' events only
+        uint32_t tid;
+        int64_t level;     // -1 if not applicable
+        uint64_t peakRSS;
+    };
+
+    Clock::time_point start = Clock::now();
+    std::mutex mutex;
+    std::vector<Event> events;
+    std::unordered_map<std::thread::id, uint32_t> threadIds;
+
+public:
+    /// The creating thread becomes the thread named "main" in the trace.
+    TraceRecorder() {
+        threadIds.emplace(std::this_thread::get_id(), 0);
+    }
+
+    Clock::time_point now() const {
+        return Clock::now();
+    }
+
+    /// Records a span of a stage of the command executed by the calling thread.
+    void complete(std::string name, Clock::time_point begin, Clock::time_point end, int64_t level = -1) {
+        const auto peakRSS = PeakResidentSetSize();
+        std::lock_guard lock{mutex};
+        events.push_back(Event{std::move(name), "ktx", 'X', micros(begin), micros(end) - micros(begin),
+                threadId(), level, peakRSS});
+    }
+
+    /// Records the begin or end of a span reported by libktx on the calling thread.
+    void mark(const char* name, int64_t level, bool begin) {
+        const auto timestamp = micros(now());
+        const auto peakRSS = begin ? 0 : PeakResidentSetSize();
+        std::lock_guard lock{mutex};
+        events.push_back(Event{name, "libktx", begin ? 'B' : 'E', timestamp, 0, threadId(), level,
+                peakRSS});
+    }
+
+    /// Trace function for ktxSetThreadTraceFunction with the recorder as user data.
+    static void libktxTrace(void* userData, const char* name, ktx_uint32_t level, ktx_bool_t begin) {
+        static_cast<TraceRecorder*>(userData)->mark(name, level, begin);
+    }
+
+    /// Writes the recorded events as a JSON trace file. Returns false if the file cannot be written.
+    bool write(const std::string& filepath) {
+        std::lock_guard lock{mutex};
+        std::ofstream file(filepath, std::ios::binary | std::ios::out);
+        if (!file)
+            return false;
+
+        std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        for (const auto& [id, tid] : threadIds) {
+            (void) id;
+            json += fmt::format(
+                    "{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"{}\"}}}},\n",
+                    tid, tid == 0 ? "main" : fmt::format("worker {}", tid));
+        }
+        for (const auto& event : events) {
+            json += fmt::format("{{\"name\":\"{}\",\"cat\":\"{}\",\"ph\":\"{}\",\"ts\":{},",
+                    escape_json_copy(event.name), event.category, event.phase, event.timestamp);
+            if (event.phase == 'X')
+                json += fmt::format("\"dur\":{},", event.duration);
+            json += fmt::format("\"pid\":1,\"tid\":{},\"args\":{{", event.tid);
+            const char* separator = "";
+            if (event.level >= 0) {
+                json += fmt::format("\"level\":{}", event.level);
+                separator = ",";
+            }
+            if (event.phase != 'B')
+                json += fmt::format("{}\"peak_rss_mib\":{:.2f}", separator, event.peakRSS / (1024.0 * 1024.0));
+            json += "}},\n";
+        }
+        // Counter track of the process high-water mark next to the spans.
+        for (const auto& event : events)
+            if (event.phase != 'B')
+                json += fmt::format("{{\"name\":\"peak RSS\",\"ph\":\"C\",\"ts\":{},\"pid\":1,"
+                        "\"args\":{{\"MiB\":{:.2f}}}}},\n",
+                        event.timestamp + event.duration, event.peakRSS / (1024.0 * 1024.0));
+        json += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"ktx\"}}\n]}\n";
+
+        file.write(json.data(), static_cast<std::streamsize>(json.size()));
+        return static_cast<bool>(file);
+    }
+
+private:
+    int64_t micros(Clock::time_point timePoint) const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(timePoint - start).count();
+    }
+
+    /// Requires the lock to be held.
+    uint32_t threadId() {
+        const auto [it, inserted] = threadIds.emplace(std::this_thread::get_id(),
+                static_cast<uint32_t>(threadIds.size()));
+        (void) inserted;
+        return it->second;
+    }
+};
+
+/// Records the lifetime of the scope as a span of the recorder. Does nothing if the recorder is null,
+/// so instrumented code only pays for a pointer check when tracing is disabled.
+class TraceScope {
+    TraceRecorder* recorder;
+    const char* name;
+    int64_t level;
+    TraceRecorder::Clock::time_point begin;
+
+public:
+    TraceScope(TraceRecorder* recorder, const char* name, int64_t level = -1) :
+        recorder(recorder), name(name), level(level) {
+        if (recorder)
+            begin = recorder->now();
+    }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+    ~TraceScope() {
+        end();
+    }
+
+    /// Ends the span before the end of the scope.
+    void end() {
+        if (recorder)
+            recorder->complete(name, begin, recorder->now(), level);
+        recorder = nullptr;
+    }
+};
+
+/// Routes the trace events of libktx encodes started by the calling thread to the recorder for the
+/// lifetime of the scope. Does nothing if the recorder is null.
+class ScopedLibktxTrace {
+    bool active;
+
+public:
+    explicit ScopedLibktxTrace(TraceRecorder* recorder) : active(recorder != nullptr) {
+        if (active)
+            ktxSetThreadTraceFunction(&TraceRecorder::libktxTrace, recorder);
+    }
+    ScopedLibktxTrace(const ScopedLibktxTrace&) = delete;
+    ScopedLibktxTrace& operator=(const ScopedLibktxTrace&) = delete;
+    ~ScopedLibktxTrace() {
+        if (active)
+            ktxSetThreadTraceFunction(nullptr, nullptr);
+    }
+};
+
+} // namespace ktx
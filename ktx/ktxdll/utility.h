@@ -11,9 +11,15 @@
 #include <fmt/printf.h>
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <exception>
 #include <functional>
+#include <mutex>
 #include <optional>
+#include <system_error>
+#include <thread>
 #include <type_traits>
+#include <vector>
 
 
 // -------------------------------------------------------------------------------------------------
@@ -324,6 +330,49 @@ public:
 
 // -------------------------------------------------------------------------------------------------
 
+/// Calls \p job with every index in [0, count) using up to \p threadCount threads, including the calling one.
+/// Once a job throws no further jobs are started and the first exception is rethrown on the calling thread.
+/// If a thread cannot be created the threads already running and the calling one do the remaining jobs.
+template <typename Job>
+void parallelFor(std::size_t count, uint32_t threadCount, Job&& job) {
+    std::atomic<std::size_t> next{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    const auto worker = [&] {
+        for (std::size_t i; !failed && (i = next++) < count;) {
+            try {
+                job(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock{errorMutex};
+                if (!error)
+                    error = std::current_exception();
+                failed = true;
+            }
+        }
+    };
+
+    const auto workerCount = std::min<std::size_t>(std::max(1u, threadCount), count);
+    std::vector<std::thread> workers;
+    workers.reserve(workerCount > 0 ? workerCount - 1 : 0); // So only the thread creation below can throw
+    for (std::size_t t = 1; t < workerCount; ++t) {
+        try {
+            workers.emplace_back(worker);
+        } catch (const std::system_error&) {
+            break;
+        }
+    }
+    worker();
+    for (auto& thread : workers)
+        thread.join();
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+// -------------------------------------------------------------------------------------------------
+
 /// RAII Handler for ktxTexture
 class KTXTexture2 final {
 private:
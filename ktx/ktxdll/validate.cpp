@@ -68,6 +68,13 @@ private:
 
     std::vector<ktxLevelIndexEntry> levelIndices;
 
+    /// Leading bytes of the file covering the header, the indices, the DFD, the KVD and the SGD
+    /// when they fit into kMaxPrefixSize. Loaded with a single read after the header is parsed.
+    std::vector<uint8_t> prefix;
+    /// Reused buffer for the regions that are not covered by the prefix
+    std::vector<uint8_t> scratch;
+    static constexpr std::size_t kMaxPrefixSize = 256 * 1024;
+
 private:
     /// Expected data members are calculated solely from the VkFormat in the header.
     /// Based on parsing and support any of these member can be empty.
@@ -145,6 +152,8 @@ protected:
 
 private:
     virtual void read(std::size_t offset, void* readDst, std::size_t readSize, std::string_view name) = 0;
+    /// Same as read but reports failures (including EOF) by returning false instead of raising an issue
+    virtual bool tryRead(std::size_t offset, void* readDst, std::size_t readSize) = 0;
     virtual KTX_error_code createKTXTexture(ktxTextureCreateFlags createFlags, ktxTexture2** newTex) = 0;
 
 private:
@@ -163,6 +172,7 @@ public:
 
 private:
     void validateHeader();
+    void loadPrefix();
     void validateIndices();
     void calculateExpectedDFD(VkFormat format);
     void validateLevelIndex();
@@ -185,6 +195,11 @@ private:
     void validateKTXastcDecodeMode(const uint8_t* data, uint32_t size);
     void validateKTXanimData(const uint8_t* data, uint32_t size);
 
+private:
+    /// Returns the content of a file region either from the prefix or read into the scratch buffer.
+    /// The returned pointer is only valid until the next call.
+    const uint8_t* readRegion(std::size_t offset, std::size_t size, std::string_view name);
+
 private:
     size_t calcImageSize(uint32_t level);
     size_t calcLayerSize(uint32_t level);
@@ -233,6 +248,15 @@ private:
         }
     }
 
+    virtual bool tryRead(std::size_t offset, void* readDst, std::size_t readSize) override {
+        stream.seekg(offset);
+        if (stream)
+            stream.read(reinterpret_cast<char*>(readDst), readSize);
+        const bool success = stream && static_cast<std::size_t>(stream.gcount()) == readSize;
+        stream.clear();
+        return success;
+    }
+
     virtual KTX_error_code createKTXTexture(ktxTextureCreateFlags createFlags, ktxTexture2** newTex) override {
         stream.seekg(0);
         if (!stream)
@@ -271,6 +295,13 @@ private:
         }
     }
 
+    virtual bool tryRead(std::size_t offset, void* readDst, std::size_t readSize) override {
+        const bool success = fseek(file, static_cast<long>(offset), SEEK_SET) == 0 &&
+                fread(readDst, 1, readSize, file) == readSize;
+        clearerr(file);
+        return success;
+    }
+
     virtual KTX_error_code createKTXTexture(ktxTextureCreateFlags createFlags, ktxTexture2** newTex) override {
         const auto seekResult = fseek(file, 0, SEEK_SET);
         if (seekResult != 0)
@@ -306,6 +337,14 @@ private:
         std::memcpy(readDst, memoryData + offset, readSize);
     }
 
+    virtual bool tryRead(std::size_t offset, void* readDst, std::size_t readSize) override {
+        if (offset > memorySize || memorySize - offset < readSize)
+            return false;
+
+        std::memcpy(readDst, memoryData + offset, readSize);
+        return true;
+    }
+
     virtual KTX_error_code createKTXTexture(ktxTextureCreateFlags createFlags, ktxTexture2** newTex) override {
         return ktxTexture2_CreateFromMemory(reinterpret_cast<const ktx_uint8_t*>(memoryData), memorySize, createFlags, newTex);
     }
@@ -318,8 +357,12 @@ void validateToolInput(std::istream& stream, const std::string& filepath, Report
         report.fatal(rc::IO_FAILURE, "Could not open input file \"{}\": {}", filepath, errnoMessage());
 
     auto callback = [&](const ValidationReport& issue) {
-        fmt::print(std::cerr, "{}-{:04}: {}\n", toString(issue.type), issue.id, issue.message);
-        fmt::print(std::cerr, "    {}\n", issue.details);
+        const auto message = fmt::format("{}-{:04}: {}\n    {}", toString(issue.type), issue.id, issue.message,
+                issue.details);
+        if (report.streams.log)
+            report.log(issue.type == IssueType::warning ? LogLevel::warning : LogLevel::error, message);
+        else
+            report.print(report.cerr(), message + "\n");
     };
     const auto validationResult = validateIOStream(stream, filepath, false, false, callback);
 
@@ -331,37 +374,37 @@ void validateToolInput(std::istream& stream, const std::string& filepath, Report
         report.fatal(rc::IO_FAILURE, "Could not rewind the input file \"{}\": {}", filepath, errnoMessage());
 }
 
-int validateIOStream(std::istream& stream, const std::string& filepath, bool warningsAsErrors, bool GLTFBasisU, std::function<void(const ValidationReport&)> callback) {
+int validateIOStream(std::istream& stream, const std::string& filepath, bool warningsAsErrors, bool GLTFBasisU, std::function<void(const ValidationReport&)> callback, bool structuralOnly) {
     try {
         ValidationContextIOStream ctx{warningsAsErrors, GLTFBasisU, std::move(callback), stream, filepath};
-        return ctx.validate();
+        return ctx.validate(!structuralOnly);
     } catch (const FatalValidationError&) {
         return +rc::INVALID_FILE;
     }
 }
 
-int validateMemory(const char* data, std::size_t size, bool warningsAsErrors, bool GLTFBasisU, std::function<void(const ValidationReport&)> callback) {
+int validateMemory(const char* data, std::size_t size, bool warningsAsErrors, bool GLTFBasisU, std::function<void(const ValidationReport&)> callback, bool structuralOnly) {
     try {
         ValidationContextMemory ctx{warningsAsErrors, GLTFBasisU, std::move(callback), data, size};
-        return ctx.validate();
+        return ctx.validate(!structuralOnly);
     } catch (const FatalValidationError&) {
         return +rc::INVALID_FILE;
     }
 }
 
-int validateNamedFile(const std::string& filepath, bool warningsAsErrors, bool GLTFBasisU, std::function<void(const ValidationReport&)> callback) {
+int validateNamedFile(const std::string& filepath, bool warningsAsErrors, bool GLTFBasisU, std::function<void(const ValidationReport&)> callback, bool structuralOnly) {
     try {
         ValidationContextIOStream ctx{warningsAsErrors, GLTFBasisU, std::move(callback), filepath};
-        return ctx.validate();
+        return ctx.validate(!structuralOnly);
     } catch (const FatalValidationError&) {
         return +rc::INVALID_FILE;
     }
 }
 
-int validateStdioStream(FILE* file, const std::string& filepath, bool warningsAsErrors, bool GLTFBasisU, std::function<void(const ValidationReport&)> callback) {
+int validateStdioStream(FILE* file, const std::string& filepath, bool warningsAsErrors, bool GLTFBasisU, std::function<void(const ValidationReport&)> callback, bool structuralOnly) {
     try {
         ValidationContextStdioStream ctx{warningsAsErrors, GLTFBasisU, std::move(callback), file, filepath};
-        return ctx.validate();
+        return ctx.validate(!structuralOnly);
     } catch (const FatalValidationError&) {
         return +rc::INVALID_FILE;
     }
@@ -379,6 +422,7 @@ int ValidationContext::validate(bool doCreateAndTranscodeChecks) {
     };
 
     call(&ValidationContext::validateHeader, "Header");
+    call(&ValidationContext::loadPrefix, "Prefix");
     call(&ValidationContext::validateIndices, "Index");
     call(&ValidationContext::calculateExpectedDFD, "Expected DFD", VkFormat(header.vkFormat));
     call(&ValidationContext::validateDFD, "DFD");
@@ -542,6 +586,35 @@ void ValidationContext::validateHeader() {
     }
 }
 
+void ValidationContext::loadPrefix() {
+    // Everything up to the end of the last metadata block is read at once if it is small enough
+    uint64_t prefixEnd = sizeof(KTX_header2) + uint64_t{sizeof(ktxLevelIndexEntry)} * numLevels;
+    const auto extend = [&](uint64_t offset, uint64_t length) {
+        if (offset != 0 && length != 0)
+            prefixEnd = std::max(prefixEnd, offset + length);
+    };
+    extend(header.dataFormatDescriptor.byteOffset, header.dataFormatDescriptor.byteLength);
+    extend(header.keyValueData.byteOffset, header.keyValueData.byteLength);
+    extend(header.supercompressionGlobalData.byteOffset, header.supercompressionGlobalData.byteLength);
+
+    prefix.resize(static_cast<std::size_t>(std::min<uint64_t>(prefixEnd, kMaxPrefixSize)));
+    // On failure (e.g. block offsets past the end of the file) every region is read individually
+    // so the issues are reported against the individual blocks
+    if (!tryRead(0, prefix.data(), prefix.size()))
+        prefix.clear();
+}
+
+const uint8_t* ValidationContext::readRegion(std::size_t offset, std::size_t size, std::string_view name) {
+    // Misaligned regions are copied so that structures can be accessed in place
+    if (offset % 4 == 0 && offset <= prefix.size() && size <= prefix.size() - offset)
+        return prefix.data() + offset;
+
+    if (scratch.size() < size)
+        scratch.resize(size);
+    read(offset, scratch.data(), size, name);
+    return scratch.data();
+}
+
 void ValidationContext::validateIndices() {
     const auto supercompressionScheme = ktxSupercmpScheme(header.supercompressionScheme);
 
@@ -650,7 +723,7 @@ void ValidationContext::validateLevelIndex() {
 
     const auto levelIndexOffset = sizeof(KTX_header2);
     const auto levelIndexSize = sizeof(ktxLevelIndexEntry) * numLevels;
-    read(levelIndexOffset, levelIndices.data(), levelIndexSize, "the level index");
+    std::memcpy(levelIndices.data(), readRegion(levelIndexOffset, levelIndexSize, "the level index"), levelIndexSize);
 
     const auto blockByteLength = (expectedBytePlanes ? expectedBytePlanes->at(0) : (parsedBlockByteLength == 0 ? uint8_t(1) : parsedBlockByteLength.value_or(0)));
     std::size_t requiredLevelAlignment = calcLevelAlignment(ktxSupercmpScheme(header.supercompressionScheme), blockByteLength);
@@ -777,9 +850,8 @@ void ValidationContext::validateDFD() {
     if (dfdByteOffset == 0 || dfdByteLength == 0)
         return; // There is no DFD block
 
-    const auto buffer = std::make_unique<uint8_t[]>(dfdByteLength);
-    read(dfdByteOffset, buffer.get(), dfdByteLength, "the DFD");
-    const auto* ptrDFD = buffer.get();
+    const auto* buffer = readRegion(dfdByteOffset, dfdByteLength, "the DFD");
+    const auto* ptrDFD = buffer;
     const auto* ptrDFDEnd = ptrDFD + dfdByteLength;
     const auto* ptrDFDIt = ptrDFD;
 
@@ -846,7 +918,7 @@ void ValidationContext::validateDFD() {
                     std::vector<SampleType> samples(numSamplesValidating);
                     std::memcpy(samples.data(), ptrDFDIt + sizeof(BDFD), numSamplesValidating * sizeof(SampleType));
 
-                    validateDFDBasic(numBlocks, reinterpret_cast<uint32_t*>(buffer.get()), block, samples);
+                    validateDFDBasic(numBlocks, reinterpret_cast<const uint32_t*>(buffer), block, samples);
                 }
 
             } else if (blockHeader.vendorId == KHR_DF_VENDORID_KHRONOS && blockHeader.descriptorType == KHR_DF_KHR_DESCRIPTORTYPE_ADDITIONAL_DIMENSIONS) {
@@ -1278,9 +1350,7 @@ void ValidationContext::validateKVD() {
     if (kvdByteOffset == 0 || kvdByteLength == 0)
         return; // There is no KVD block
 
-    const auto buffer = std::make_unique<uint8_t[]>(kvdByteLength);
-    read(kvdByteOffset, buffer.get(), kvdByteLength, "the Key/Value Data");
-    const auto* ptrKVD = buffer.get();
+    const auto* ptrKVD = readRegion(kvdByteOffset, kvdByteLength, "the Key/Value Data");
     const auto* ptrKVDEnd = ptrKVD + kvdByteLength;
 
     struct KeyValueEntry {
@@ -1615,8 +1685,7 @@ void ValidationContext::validateSGD() {
     if (sgdByteOffset == 0 || sgdByteLength == 0)
         return; // There is no SGD block
 
-    const auto buffer = std::make_unique<uint8_t[]>(sgdByteLength);
-    read(sgdByteOffset, buffer.get(), sgdByteLength, "the SGD");
+    const auto* buffer = readRegion(sgdByteOffset, sgdByteLength, "the SGD");
 
     if (header.supercompressionScheme != KTX_SS_BASIS_LZ)
         return;
@@ -1635,7 +1704,7 @@ void ValidationContext::validateSGD() {
         return;
     }
 
-    const ktxBasisLzGlobalHeader& bgh = *reinterpret_cast<const ktxBasisLzGlobalHeader*>(buffer.get());
+    const ktxBasisLzGlobalHeader& bgh = *reinterpret_cast<const ktxBasisLzGlobalHeader*>(buffer);
 
     const uint64_t expectedBgdByteLength =
             sizeof(ktxBasisLzGlobalHeader) +
@@ -1654,7 +1723,7 @@ void ValidationContext::validateSGD() {
     if (sgdByteLength < sizeof(ktxBasisLzGlobalHeader) + sizeof(ktxBasisLzEtc1sImageDesc) * imageCount)
         return;
 
-    const ktxBasisLzEtc1sImageDesc* imageDescs = BGD_ETC1S_IMAGE_DESCS(buffer.get());
+    const auto* imageDescs = reinterpret_cast<const ktxBasisLzEtc1sImageDesc*>(buffer + sizeof(ktxBasisLzGlobalHeader));
 
     bool foundPFrame = false;
     uint32_t i = 0;
@@ -1715,8 +1784,7 @@ void ValidationContext::validatePaddings() {
         }
 
         const auto paddingSize = offset - position;
-        const auto buffer = std::make_unique<uint8_t[]>(paddingSize);
-        read(position, buffer.get(), paddingSize, "the padding before " + name);
+        const auto* buffer = readRegion(position, paddingSize, "the padding before " + name);
 
         for (size_t i = 0; i < paddingSize; ++i)
             if (buffer[i] != 0) {
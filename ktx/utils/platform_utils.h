@@ -5,6 +5,7 @@
 #pragma once
 
 #include "stdafx.h"
+#include <cstdint>
 #include <string>
 #include <iostream>
 #include <memory>
@@ -19,6 +20,9 @@
 #endif
 #include <windows.h>
 #include <shellapi.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
 #endif
 
 #if defined(_WIN32) && !defined(_UNICODE)
@@ -79,3 +83,23 @@ inline int unlinkUTF8(const std::string& path) {
     return unlink(path.c_str());
 #endif
 }
+
+/// Returns the peak resident set size (peak working set on Windows) of the process in bytes
+/// or 0 if it is not available.
+inline uint64_t PeakResidentSetSize() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+    return counters.PeakWorkingSetSize;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#if defined(__APPLE__)
+    return static_cast<uint64_t>(usage.ru_maxrss); // Bytes on macOS
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024; // Kilobytes elsewhere
+#endif
+#endif
+}
@@ -496,6 +496,29 @@ astcQuality(ktx_uint32_t quality_level) {
     return ASTCENC_PRE_MEDIUM;
 }
 
+/**
+ * @internal
+ * @brief Trace function of the calling thread, see ktxSetThreadTraceFunction.
+ */
+struct TraceTarget {
+    ktxTraceFunction func = nullptr;
+    void* userData = nullptr;
+
+    void operator()(const char* name, ktx_uint32_t level, bool begin) const {
+        if (func)
+            func(userData, name, level, begin ? KTX_TRUE : KTX_FALSE);
+    }
+};
+
+static thread_local TraceTarget threadTraceTarget;
+
+/* Public function, see texture2.h for documentation */
+extern "C" void
+ktxSetThreadTraceFunction(ktxTraceFunction traceFunction, void* userData) {
+    threadTraceTarget.func = traceFunction;
+    threadTraceTarget.userData = userData;
+}
+
 struct CompressionWorkload {
     astcenc_context* context;
     astcenc_image* image;
@@ -503,6 +526,9 @@ struct CompressionWorkload {
     uint8_t* data_out;
     size_t data_len;
     astcenc_error error;
+    /** Trace function of the thread that started the compression. */
+    TraceTarget trace;
+    ktx_uint32_t level;
 };
 
 static void
@@ -510,9 +536,11 @@ compressionWorkloadRunner(int threadCount, int threadId, void* payload) {
     (void)threadCount;
 
     CompressionWorkload* work = static_cast<CompressionWorkload*>(payload);
+    work->trace("astcenc_compress_image", work->level, true);
     astcenc_error error = astcenc_compress_image(
                            work->context, work->image, &work->swizzle,
                            work->data_out, work->data_len, threadId);
+    work->trace("astcenc_compress_image", work->level, false);
 
     // This is a racy update, so which error gets returned is a random, but it
     // will reliably report an error if an error occurs
@@ -812,6 +840,7 @@ ktxTexture2_CompressAstcEx(ktxTexture2* This, ktxAstcParams* params) {
                                                      KTX_FORMAT_VERSION_TWO);
         ktx_size_t offset = ktxTexture2_levelDataOffset(This, level);
 
+        threadTraceTarget("encodeASTC level", level, true);
         for (uint32_t image = 0; image < levelImages; image++) {
             astcenc_image *input_image = nullptr;
             if (num_components == 1)
@@ -836,6 +865,8 @@ ktxTexture2_CompressAstcEx(ktxTexture2* This, ktxAstcParams* params) {
             work.data_out = buffer_out;
             work.data_len = levelImageSizeOut;
             work.error = ASTCENC_SUCCESS;
+            work.trace = threadTraceTarget;
+            work.level = level;
 
             launchThreads(threadCount, compressionWorkloadRunner, &work);
 
@@ -851,10 +882,12 @@ ktxTexture2_CompressAstcEx(ktxTexture2* This, ktxAstcParams* params) {
                 //std::cout << "ASTC compressor failed\n" <<
                 //             astcenc_get_error_string(work.error) << std::endl;
 
+                threadTraceTarget("encodeASTC level", level, false);
                 astcenc_context_free(astc_context);
                 return mapAstcError(work.error);
             }
         }
+        threadTraceTarget("encodeASTC level", level, false);
     }
 
     // We are done with astcencoder
@@ -20,6 +20,8 @@
 
 #include <inttypes.h>
 #include <stdlib.h>
+#include <mutex>
+#include <shared_mutex>
 #include <zstd.h>
 #include <KHR/khr_df.h>
 
@@ -365,7 +367,65 @@ ktxTexture2_rewriteDfd4Uastc(ktxTexture2* This,
     return KTX_SUCCESS;
 }
 
-static bool basisuEncoderInitialized = false;
+/*
+ * basisu_encoder_init serializes itself but the transcoder initialization it
+ * includes does not, so initialize the transcoder through the same one-time
+ * guard as the transcoding functions first.
+ */
+static void
+initEncoder()
+{
+    static std::once_flag encoderInitialized;
+    std::call_once(encoderInitialized, [] {
+        ktxInitBasisuTranscoder();
+        // force_serialization uses a mutex to serialize when multiple command
+        // queues per thread are used. We shouldn't need to worry about this.
+        // How to decide whether to use OpenCL?
+        basisu_encoder_init((BASISU_SUPPORT_OPENCL ? true : false)/*use_opencl*/
+                            /*opencl_force_serialization = false*/);
+        //atexit(basisu_encoder_deinit);
+    });
+}
+
+#if BASISU_SUPPORT_SSE
+/*
+ * basisu selects its SSE 4.1 kernels through the process wide
+ * g_cpu_supports_sse41, which is also read by the job pool threads of an
+ * encoding, so params->noSSE cannot be applied per thread. Encodings that
+ * disable SSE clear the flag while holding sseSupportMutex exclusively; all
+ * other encodings hold it shared and so always see the detected value.
+ */
+static std::shared_mutex sseSupportMutex;
+
+class ScopedSSESupport {
+  public:
+    explicit ScopedSSESupport(bool disable) : disabled(disable) {
+        if (disabled) {
+            exclusiveLock = std::unique_lock<std::shared_mutex>(sseSupportMutex);
+            prevSSESupport = g_cpu_supports_sse41;
+            g_cpu_supports_sse41 = false;
+        } else {
+            sharedLock = std::shared_lock<std::shared_mutex>(sseSupportMutex);
+        }
+    }
+    ~ScopedSSESupport() { release(); }
+
+    void release() {
+        if (exclusiveLock.owns_lock()) {
+            g_cpu_supports_sse41 = prevSSESupport;
+            exclusiveLock.unlock();
+        }
+        if (sharedLock.owns_lock())
+            sharedLock.unlock();
+    }
+
+  private:
+    bool disabled;
+    bool prevSSESupport = false;
+    std::unique_lock<std::shared_mutex> exclusiveLock;
+    std::shared_lock<std::shared_mutex> sharedLock;
+};
+#endif
 
 /**
  * @memberof ktxTexture2
@@ -452,15 +512,7 @@ ktxTexture2_CompressBasisEx(ktxTexture2* This, ktxBasisParams* params)
             return result;
     }
 
-    if (!basisuEncoderInitialized) {
-        // force_serialization uses a mutex to serialize when multiple command
-        // queues per thread are used. We shouldn't need to worry about this.
-        // How to decide whether to use OpenCL?
-        basisu_encoder_init((BASISU_SUPPORT_OPENCL ? true : false)/*use_opencl*/
-                            /*opencl_force_serialization = false*/);
-        //atexit(basisu_encoder_deinit);
-        basisuEncoderInitialized = true;
-    }
+    initEncoder();
 
     basis_compressor_params cparams;
     cparams.m_read_source_images = false; // Don't read from source files.
@@ -628,9 +680,7 @@ ktxTexture2_CompressBasisEx(ktxTexture2* This, ktxBasisParams* params)
     cparams.m_pJob_pool = &jpool;
 
 #if BASISU_SUPPORT_SSE
-    bool prevSSESupport = g_cpu_supports_sse41;
-    if (params->noSSE)
-        g_cpu_supports_sse41 = false;
+    ScopedSSESupport sseSupport(params->noSSE);
 #endif
 
     ktx_uint32_t transfer = KHR_DFDVAL(BDB, TRANSFER);
@@ -828,7 +878,7 @@ ktxTexture2_CompressBasisEx(ktxTexture2* This, ktxBasisParams* params)
     //
 
 #if BASISU_SUPPORT_SSE
-    g_cpu_supports_sse41 = prevSSESupport;
+    sseSupport.release();
 #endif
 
     const uint8_vec& bf = c.get_output_basis_file();
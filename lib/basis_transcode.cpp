@@ -20,6 +20,7 @@
 
 #include <inttypes.h>
 #include <stdio.h>
+#include <mutex>
 #include <KHR/khr_df.h>
 
 #include "dfdutils/dfd.h"
@@ -59,82 +60,37 @@ ktxTexture2_transcodeUastc(ktxTexture2* This,
                            ktx_transcode_flags transcodeFlags);
 
 /**
- * @memberof ktxTexture2
- * @ingroup reader
+ * @internal
  * @~English
- * @brief Transcode a KTX2 texture with BasisLZ/ETC1S or UASTC images.
- *
- * If the texture contains BasisLZ supercompressed images, Inflates them from
- * back to ETC1S then transcodes them to the specified block-compressed
- * format. If the texture contains UASTC images, inflates them, if they have been
- * supercompressed with zstd, then transcodes then to the specified format, The
- * transcoded images replace the original images and the texture's fields including
- * the DFD are modified to reflect the new format.
- *
- * These types of textures must be transcoded to a desired target
- * block-compressed format before they can be uploaded to a GPU via a
- * graphics API.
- *
- * The following block compressed transcode targets are available: @c KTX_TTF_ETC1_RGB,
- * @c KTX_TTF_ETC2_RGBA, @c KTX_TTF_BC1_RGB, @c KTX_TTF_BC3_RGBA,
- * @c KTX_TTF_BC4_R, @c KTX_TTF_BC5_RG, @c KTX_TTF_BC7_RGBA,
- * @c @c KTX_TTF_PVRTC1_4_RGB, @c KTX_TTF_PVRTC1_4_RGBA,
- * @c KTX_TTF_PVRTC2_4_RGB, @c KTX_TTF_PVRTC2_4_RGBA, @c KTX_TTF_ASTC_4x4_RGBA,
- * @c KTX_TTF_ETC2_EAC_R11, @c KTX_TTF_ETC2_EAC_RG11, @c KTX_TTF_ETC and
- * @c KTX_TTF_BC1_OR_3.
+ * @brief Check a texture can be transcoded to @p outputFormat and resolve
+ *        the actual target.
  *
- * @c KTX_TTF_ETC automatically selects between @c KTX_TTF_ETC1_RGB and
- * @c KTX_TTF_ETC2_RGBA according to whether an alpha channel is available. @c KTX_TTF_BC1_OR_3
- * does likewise between @c KTX_TTF_BC1_RGB and @c KTX_TTF_BC3_RGBA. Note that if
- * @c KTX_TTF_PVRTC1_4_RGBA or @c KTX_TTF_PVRTC2_4_RGBA is specified and there is no alpha
- * channel @c KTX_TTF_PVRTC1_4_RGB or @c KTX_TTF_PVRTC2_4_RGB respectively will be selected.
- *
- * Transcoding to ATC & FXT1 formats is not supported by libktx as there
- * are no equivalent Vulkan formats.
+ * Performs the checks and format mapping common to ktxTexture2_TranscodeBasis
+ * and ktxTexture2_TranscodeImageToBuffer.
  *
- * The following uncompressed transcode targets are also available: @c KTX_TTF_RGBA32,
- * @c KTX_TTF_RGB565, KTX_TTF_BGR565 and KTX_TTF_RGBA4444.
+ * @param[in]     This           pointer to the ktxTexture2 object of interest.
+ * @param[in,out] pOutputFormat  requested target format. On return, the
+ *                               format that will actually be transcoded to,
+ *                               e.g. @c KTX_TTF_ETC resolved to
+ *                               @c KTX_TTF_ETC1_RGB or @c KTX_TTF_ETC2_RGBA.
+ * @param[in]     transcodeFlags bitfield of flags modifying the transcode
+ *                               operation.
+ * @param[out]    pAlphaContent  the alpha content of the source images.
+ * @param[out]    pVkFormat      VkFormat corresponding to the target format.
+ * @param[out]    pTextureFormat Basis Universal format of the source images.
  *
- * The following @p transcodeFlags are available.
- *
- * @sa ktxtexture2_CompressBasis().
- *
- * @param[in]   This         pointer to the ktxTexture2 object of interest.
- * @param[in]   outputFormat a value from the ktx_texture_transcode_fmt_e enum
- *                                             specifying the target format.
- * @param[in]   transcodeFlags  bitfield of flags modifying the transcode
- *                                                operation. @sa ktx_texture_decode_flags_e.
- *
- * @return      KTX_SUCCESS on success, other KTX_* enum values on error.
- *
- * @exception KTX_FILE_DATA_ERROR
- *                              Supercompression global data is corrupted.
- * @exception KTX_INVALID_OPERATION
- *                              The texture's format is not transcodable (not
- *                              ETC1S/BasisLZ or UASTC).
- * @exception KTX_INVALID_OPERATION
- *                              Supercompression global data is missing, i.e.,
- *                              the texture object is invalid.
- * @exception KTX_INVALID_OPERATION
- *                              Image data is missing, i.e., the texture object
- *                              is invalid.
- * @exception KTX_INVALID_OPERATION
- *                              @p outputFormat is PVRTC1 but the texture does
- *                              does not have power-of-two dimensions.
- * @exception KTX_INVALID_VALUE @p outputFormat is invalid.
- * @exception KTX_TRANSCODE_FAILED
- *                              Something went wrong during transcoding.
- * @exception KTX_UNSUPPORTED_FEATURE
- *                              KTX_TF_PVRTC_DECODE_TO_NEXT_POW2 was requested
- *                              or the specified transcode target has not been
- *                              included in the library being used.
- * @exception KTX_OUT_OF_MEMORY Not enough memory to carry out transcoding.
+ * @return      KTX_SUCCESS on success, other KTX_* enum values on error. See
+ *              ktxTexture2_TranscodeBasis.
  */
- KTX_error_code
- ktxTexture2_TranscodeBasis(ktxTexture2* This,
-                            ktx_transcode_fmt_e outputFormat,
-                            ktx_transcode_flags transcodeFlags)
+static KTX_error_code
+ktxTexture2_resolveTranscodeTarget(ktxTexture2* This,
+                                   ktx_transcode_fmt_e* pOutputFormat,
+                                   ktx_transcode_flags transcodeFlags,
+                                   alpha_content_e* pAlphaContent,
+                                   VkFormat* pVkFormat,
+                                   basis_tex_format* pTextureFormat)
 {
+    ktx_transcode_fmt_e outputFormat = *pOutputFormat;
     uint32_t* BDB = This->pDfd + 1;
     khr_df_model_e colorModel = (khr_df_model_e)KHR_DFDVAL(BDB, MODEL);
     if (colorModel != KHR_DF_MODEL_UASTC
@@ -286,6 +242,120 @@ ktxTexture2_transcodeUastc(ktxTexture2* This,
         return KTX_UNSUPPORTED_FEATURE;
     }
 
+    *pOutputFormat = outputFormat;
+    *pAlphaContent = alphaContent;
+    *pVkFormat = vkFormat;
+    *pTextureFormat = textureFormat;
+    return KTX_SUCCESS;
+}
+
+/**
+ * @internal
+ * @~English
+ * @brief Perform the transcoder's one-time global initialization.
+ *
+ * Safe to call concurrently; only the first call initializes.
+ *
+ * Requires ~9 milliseconds when compiled and executed natively on a Core i7
+ * 2.2 GHz. If this is too slow, the tables it computes can easily be moved to
+ * be compiled in.
+ */
+extern "C" void
+ktxInitBasisuTranscoder()
+{
+    static std::once_flag transcoderInitialized;
+    std::call_once(transcoderInitialized, basisu_transcoder_init);
+}
+
+/**
+ * @memberof ktxTexture2
+ * @ingroup reader
+ * @~English
+ * @brief Transcode a KTX2 texture with BasisLZ/ETC1S or UASTC images.
+ *
+ * If the texture contains BasisLZ supercompressed images, Inflates them from
+ * back to ETC1S then transcodes them to the specified block-compressed
+ * format. If the texture contains UASTC images, inflates them, if they have been
+ * supercompressed with zstd, then transcodes then to the specified format, The
+ * transcoded images replace the original images and the texture's fields including
+ * the DFD are modified to reflect the new format.
+ *
+ * These types of textures must be transcoded to a desired target
+ * block-compressed format before they can be uploaded to a GPU via a
+ * graphics API.
+ *
+ * The following block compressed transcode targets are available: @c KTX_TTF_ETC1_RGB,
+ * @c KTX_TTF_ETC2_RGBA, @c KTX_TTF_BC1_RGB, @c KTX_TTF_BC3_RGBA,
+ * @c KTX_TTF_BC4_R, @c KTX_TTF_BC5_RG, @c KTX_TTF_BC7_RGBA,
+ * @c @c KTX_TTF_PVRTC1_4_RGB, @c KTX_TTF_PVRTC1_4_RGBA,
+ * @c KTX_TTF_PVRTC2_4_RGB, @c KTX_TTF_PVRTC2_4_RGBA, @c KTX_TTF_ASTC_4x4_RGBA,
+ * @c KTX_TTF_ETC2_EAC_R11, @c KTX_TTF_ETC2_EAC_RG11, @c KTX_TTF_ETC and
+ * @c KTX_TTF_BC1_OR_3.
+ *
+ * @c KTX_TTF_ETC automatically selects between @c KTX_TTF_ETC1_RGB and
+ * @c KTX_TTF_ETC2_RGBA according to whether an alpha channel is available. @c KTX_TTF_BC1_OR_3
+ * does likewise between @c KTX_TTF_BC1_RGB and @c KTX_TTF_BC3_RGBA. Note that if
+ * @c KTX_TTF_PVRTC1_4_RGBA or @c KTX_TTF_PVRTC2_4_RGBA is specified and there is no alpha
+ * channel @c KTX_TTF_PVRTC1_4_RGB or @c KTX_TTF_PVRTC2_4_RGB respectively will be selected.
+ *
+ * Transcoding to ATC & FXT1 formats is not supported by libktx as there
+ * are no equivalent Vulkan formats.
+ *
+ * The following uncompressed transcode targets are also available: @c KTX_TTF_RGBA32,
+ * @c KTX_TTF_RGB565, KTX_TTF_BGR565 and KTX_TTF_RGBA4444.
+ *
+ * The following @p transcodeFlags are available.
+ *
+ * @sa ktxtexture2_CompressBasis().
+ *
+ * @param[in]   This         pointer to the ktxTexture2 object of interest.
+ * @param[in]   outputFormat a value from the ktx_texture_transcode_fmt_e enum
+ *                                             specifying the target format.
+ * @param[in]   transcodeFlags  bitfield of flags modifying the transcode
+ *                                                operation. @sa ktx_texture_decode_flags_e.
+ *
+ * @return      KTX_SUCCESS on success, other KTX_* enum values on error.
+ *
+ * @exception KTX_FILE_DATA_ERROR
+ *                              Supercompression global data is corrupted.
+ * @exception KTX_INVALID_OPERATION
+ *                              The texture's format is not transcodable (not
+ *                              ETC1S/BasisLZ or UASTC).
+ * @exception KTX_INVALID_OPERATION
+ *                              Supercompression global data is missing, i.e.,
+ *                              the texture object is invalid.
+ * @exception KTX_INVALID_OPERATION
+ *                              Image data is missing, i.e., the texture object
+ *                              is invalid.
+ * @exception KTX_INVALID_OPERATION
+ *                              @p outputFormat is PVRTC1 but the texture does
+ *                              does not have power-of-two dimensions.
+ * @exception KTX_INVALID_VALUE @p outputFormat is invalid.
+ * @exception KTX_TRANSCODE_FAILED
+ *                              Something went wrong during transcoding.
+ * @exception KTX_UNSUPPORTED_FEATURE
+ *                              KTX_TF_PVRTC_DECODE_TO_NEXT_POW2 was requested
+ *                              or the specified transcode target has not been
+ *                              included in the library being used.
+ * @exception KTX_OUT_OF_MEMORY Not enough memory to carry out transcoding.
+ */
+ KTX_error_code
+ ktxTexture2_TranscodeBasis(ktxTexture2* This,
+                            ktx_transcode_fmt_e outputFormat,
+                            ktx_transcode_flags transcodeFlags)
+{
+    alpha_content_e alphaContent;
+    VkFormat vkFormat;
+    basis_tex_format textureFormat;
+    KTX_error_code result;
+
+    result = ktxTexture2_resolveTranscodeTarget(This, &outputFormat,
+                                                transcodeFlags, &alphaContent,
+                                                &vkFormat, &textureFormat);
+    if (result != KTX_SUCCESS)
+        return result;
+
+    DECLARE_PRIVATE(priv, This);
 
     // Create a prototype texture to use for calculating sizes in the target
     // format and, as useful side effects, provide us with a properly sized
@@ -304,7 +374,6 @@ ktxTexture2_transcodeUastc(ktxTexture2* This,
     createInfo.numLevels = This->numLevels;
     createInfo.pDfd = nullptr;
 
-    KTX_error_code result;
     ktxTexture2* prototype;
     result = ktxTexture2_Create(&createInfo, KTX_TEXTURE_CREATE_ALLOC_STORAGE,
                                 &prototype);
@@ -330,14 +399,7 @@ ktxTexture2_transcodeUastc(ktxTexture2* This,
         }
     }
 
-    // Transcoder global initialization. Requires ~9 milliseconds when compiled
-    // and executed natively on a Core i7 2.2 GHz. If this is too slow, the
-    // tables it computes can easily be moved to be compiled in.
-    static bool transcoderInitialized;
-    if (!transcoderInitialized) {
-        basisu_transcoder_init();
-        transcoderInitialized = true;
-    }
+    ktxInitBasisuTranscoder();
 
     if (textureFormat == basis_tex_format::cETC1S) {
         result = ktxTexture2_transcodeLzEtc1s(This, alphaContent,
@@ -383,6 +445,262 @@ ktxTexture2_transcodeUastc(ktxTexture2* This,
     return result;
  }
 
+/**
+ * @memberof ktxTexture2
+ * @ingroup reader
+ * @~English
+ * @brief Transcode a single image of a KTX2 texture with BasisLZ/ETC1S or
+ *        UASTC images into a caller-supplied buffer.
+ *
+ * Unlike ktxTexture2_TranscodeBasis the texture object is not modified and
+ * no memory is allocated for the output, so images can be transcoded
+ * directly into, e.g., mapped GPU staging memory. Rows of the output are
+ * written @p rowPitch bytes apart. To place the image at a particular slice
+ * offset within a larger buffer, offset @p pDst accordingly.
+ *
+ * The texture's image data is loaded, and inflated if supercompressed with
+ * Zstandard, if that has not already been done. For BasisLZ/ETC1S textures
+ * the codebooks are decoded on each call, so when transcoding all images of a
+ * texture ktxTexture2_TranscodeBasis is more efficient. Video textures are
+ * not supported because P-frames depend on previously decoded frames.
+ *
+ * See ktxTexture2_TranscodeBasis for the available target formats and
+ * @p transcodeFlags.
+ *
+ * @param[in]   This         pointer to the ktxTexture2 object of interest.
+ * @param[in]   level        mip level of the image to transcode.
+ * @param[in]   layer        array layer of the image to transcode.
+ * @param[in]   faceSlice    cube map face or depth slice of the image to
+ *                           transcode.
+ * @param[in]   outputFormat a value from the ktx_texture_transcode_fmt_e enum
+ *                           specifying the target format.
+ * @param[in]   transcodeFlags  bitfield of flags modifying the transcode
+ *                           operation. @sa ktx_texture_decode_flags_e.
+ * @param[out]  pDst         pointer to the destination of the image.
+ * @param[in]   dstSize      size in bytes of the memory at @p pDst.
+ * @param[in]   rowPitch     distance in bytes between the starts of
+ *                           consecutive rows of blocks, or of pixels for
+ *                           uncompressed targets. Must be a multiple of the
+ *                           block or pixel size. Pass 0 for tightly packed
+ *                           rows. PVRTC1 targets must be tightly packed.
+ * @param[in]   rowCount     number of rows of pixels in the destination for
+ *                           uncompressed targets. Pass 0 to use the height
+ *                           of the level. Ignored for block-compressed
+ *                           targets.
+ * @param[out]  pWritten     if not NULL, receives the number of bytes from
+ *                           @p pDst spanned by the transcoded image.
+ *
+ * @return      KTX_SUCCESS on success, other KTX_* enum values on error.
+ *
+ * @exception KTX_INVALID_VALUE @p This or @p pDst is NULL, @p level,
+ *                              @p layer or @p faceSlice is out of range,
+ *                              @p rowPitch or @p rowCount is too small or
+ *                              not a multiple of the block size or
+ *                              @p dstSize is too small.
+ * @exception KTX_INVALID_OPERATION
+ *                              The texture is a video or see
+ *                              ktxTexture2_TranscodeBasis.
+ * @exception KTX_FILE_DATA_ERROR
+ *                              Supercompression global data is corrupted.
+ * @exception KTX_TRANSCODE_FAILED
+ *                              Something went wrong during transcoding.
+ * @exception KTX_UNSUPPORTED_FEATURE
+ *                              See ktxTexture2_TranscodeBasis.
+ */
+KTX_error_code
+ktxTexture2_TranscodeImageToBuffer(ktxTexture2* This,
+                                   ktx_uint32_t level, ktx_uint32_t layer,
+                                   ktx_uint32_t faceSlice,
+                                   ktx_transcode_fmt_e outputFormat,
+                                   ktx_transcode_flags transcodeFlags,
+                                   ktx_uint8_t* pDst, ktx_size_t dstSize,
+                                   ktx_uint32_t rowPitch,
+                                   ktx_uint32_t rowCount,
+                                   ktx_size_t* pWritten)
+{
+    alpha_content_e alphaContent;
+    VkFormat vkFormat;
+    basis_tex_format textureFormat;
+    KTX_error_code result;
+
+    if (!This || !pDst)
+        return KTX_INVALID_VALUE;
+
+    if (This->isVideo)
+        return KTX_INVALID_OPERATION;
+
+    // Check level before shifting by it, numLevels is at most 32.
+    if (level >= This->numLevels || layer >= This->numLayers)
+        return KTX_INVALID_VALUE;
+    uint32_t levelDepth = MAX(1, This->baseDepth >> level);
+    uint32_t faceSlices = This->numFaces * levelDepth;
+    if (faceSlice >= faceSlices)
+        return KTX_INVALID_VALUE;
+
+    result = ktxTexture2_resolveTranscodeTarget(This, &outputFormat,
+                                                transcodeFlags, &alphaContent,
+                                                &vkFormat, &textureFormat);
+    if (result != KTX_SUCCESS)
+        return result;
+
+    // Destination layout. The transcoder's pitch, row count and buffer size
+    // parameters are in blocks for compressed targets and in pixels for
+    // uncompressed targets.
+    transcoder_texture_format targetFormat
+                      = (transcoder_texture_format)outputFormat;
+    const bool uncompressed
+                      = basis_transcoder_format_is_uncompressed(targetFormat);
+    const uint32_t unitByteLength
+                      = basis_get_bytes_per_block_or_pixel(targetFormat);
+    uint32_t levelWidth = MAX(1, This->baseWidth >> level);
+    uint32_t levelHeight = MAX(1, This->baseHeight >> level);
+    // ETC1S and UASTC texel block dimensions
+    const uint32_t bw = 4, bh = 4;
+    uint32_t levelBlocksX = (levelWidth + (bw - 1)) / bw;
+    uint32_t levelBlocksY = (levelHeight + (bh - 1)) / bh;
+    uint32_t packedPitch = uncompressed ? levelWidth : levelBlocksX;
+    uint32_t pitch = packedPitch;
+    uint32_t rows = uncompressed ? levelHeight : levelBlocksY;
+
+    if (rowPitch != 0) {
+        if (rowPitch % unitByteLength != 0)
+            return KTX_INVALID_VALUE;
+        pitch = rowPitch / unitByteLength;
+        if (pitch < packedPitch)
+            return KTX_INVALID_VALUE;
+        if (pitch != packedPitch
+            && (outputFormat == KTX_TTF_PVRTC1_4_RGB
+                || outputFormat == KTX_TTF_PVRTC1_4_RGBA))
+            return KTX_INVALID_VALUE;
+    }
+    if (uncompressed && rowCount != 0) {
+        if (rowCount < levelHeight)
+            return KTX_INVALID_VALUE;
+        rows = rowCount;
+    }
+    ktx_size_t requiredSize = (ktx_size_t)pitch * rows * unitByteLength;
+    if (dstSize < requiredSize)
+        return KTX_INVALID_VALUE;
+
+    if (!This->pData) {
+        if (ktxTexture_isActiveStream((ktxTexture*)This)) {
+             // Load pending. Complete it.
+            result = ktxTexture2_LoadImageData(This, NULL, 0);
+            if (result != KTX_SUCCESS)
+                return result;
+        } else {
+            // No data to transcode.
+            return KTX_INVALID_OPERATION;
+        }
+    }
+
+    ktxInitBasisuTranscoder();
+
+    uint64_t levelOffset = ktxTexture2_levelDataOffset(This, level);
+    uint32_t imageInLevel = layer * faceSlices + faceSlice;
+    basisu_transcoder_state xcoderState;
+    bool status;
+
+    if (textureFormat == basis_tex_format::cETC1S) {
+        DECLARE_PRIVATE(priv, This);
+        uint8_t* bgd = priv._supercompressionGlobalData;
+        ktxBasisLzGlobalHeader& bgdh
+                      = *reinterpret_cast<ktxBasisLzGlobalHeader*>(bgd);
+        if (!(bgdh.endpointsByteLength && bgdh.selectorsByteLength
+              && bgdh.tablesByteLength)) {
+            debug_printf("ktxTexture2_TranscodeImageToBuffer: missing endpoints, selectors or tables");
+            return KTX_FILE_DATA_ERROR;
+        }
+
+        // Index of the image's description and total number of images. See
+        // the firstImages comment in ktxTexture2_transcodeLzEtc1s.
+        uint32_t layersFaces = This->numLayers * This->numFaces;
+        uint32_t image = 0, imageCount = 0;
+        for (uint32_t l = 0; l < This->numLevels; l++) {
+            if (l == level)
+                image = imageCount + imageInLevel;
+            imageCount += layersFaces * MAX(This->baseDepth >> l, 1);
+        }
+        if (BGD_TABLES_ADDR(0, bgdh, imageCount) + bgdh.tablesByteLength
+            > priv._sgdByteLength)
+            return KTX_FILE_DATA_ERROR;
+
+        const ktxBasisLzEtc1sImageDesc& imageDesc
+                                        = BGD_ETC1S_IMAGE_DESCS(bgd)[image];
+        if (alphaContent != eNone
+            && (imageDesc.alphaSliceByteOffset == 0
+                || imageDesc.alphaSliceByteLength == 0))
+            return KTX_FILE_DATA_ERROR;
+
+        basist::basisu_lowlevel_etc1s_transcoder bit;
+        bit.decode_palettes(bgdh.endpointCount,
+                            BGD_ENDPOINTS_ADDR(bgd, imageCount),
+                            bgdh.endpointsByteLength,
+                            bgdh.selectorCount,
+                            BGD_SELECTORS_ADDR(bgd, bgdh, imageCount),
+                            bgdh.selectorsByteLength);
+        bit.decode_tables(BGD_TABLES_ADDR(bgd, bgdh, imageCount),
+                          bgdh.tablesByteLength);
+
+        status = bit.transcode_image(
+                      targetFormat,
+                      pDst,
+                      (uint32_t)(dstSize / unitByteLength),
+                      This->pData,
+                      (uint32_t)This->dataSize,
+                      levelBlocksX,
+                      levelBlocksY,
+                      levelWidth,
+                      levelHeight,
+                      level,
+                      (uint32_t)(levelOffset + imageDesc.rgbSliceByteOffset),
+                      imageDesc.rgbSliceByteLength,
+                      (uint32_t)(levelOffset + imageDesc.alphaSliceByteOffset),
+                      imageDesc.alphaSliceByteLength,
+                      transcodeFlags,
+                      alphaContent != eNone,
+                      false, // is_video
+                      pitch, // output_row_pitch_in_blocks_or_pixels
+                      &xcoderState,
+                      uncompressed ? rows : 0 // output_rows_in_pixels
+                      );
+    } else {
+        basisu_lowlevel_uastc_transcoder uit;
+        ktx_size_t imageSizeIn = ktxTexture_calcImageSize(ktxTexture(This),
+                                                          level,
+                                                          KTX_FORMAT_VERSION_TWO);
+
+        status = uit.transcode_image(
+                      targetFormat,
+                      pDst,
+                      (uint32_t)(dstSize / unitByteLength),
+                      This->pData,
+                      (uint32_t)This->dataSize,
+                      levelBlocksX,
+                      levelBlocksY,
+                      levelWidth,
+                      levelHeight,
+                      level,
+                      (uint32_t)(levelOffset + imageInLevel * imageSizeIn),
+                      (uint32_t)imageSizeIn,
+                      transcodeFlags,
+                      alphaContent != eNone,
+                      false, // is_video
+                      pitch, // output_row_pitch_in_blocks_or_pixels
+                      &xcoderState,
+                      uncompressed ? rows : 0, // output_rows_in_pixels
+                      -1, // channel0
+                      -1  // channel1
+                      );
+    }
+    if (!status)
+        return KTX_TRANSCODE_FAILED;
+
+    if (pWritten)
+        *pWritten = requiredSize;
+    return KTX_SUCCESS;
+}
+
 /**
  * @memberof ktxTexture2 @private
  * @ingroup reader
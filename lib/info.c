@@ -52,13 +52,13 @@ enum {
 #define LENGTH_OF_INDENT(INDENT) ((base_indent + INDENT) * indent_width)
 
 /** @internal */
-#define PRINT_INDENT(INDENT, FMT, ...) {                              \
-        printf("%*s" FMT, LENGTH_OF_INDENT(INDENT), "", __VA_ARGS__); \
+#define PRINT_INDENT(INDENT, FMT, ...) {                                 \
+        dfdPrintf("%*s" FMT, LENGTH_OF_INDENT(INDENT), "", __VA_ARGS__); \
     }
 
 /** @internal */
-#define PRINT_INDENT_NOARG(INDENT, FMT) {                \
-        printf("%*s" FMT, LENGTH_OF_INDENT(INDENT), ""); \
+#define PRINT_INDENT_NOARG(INDENT, FMT) {                   \
+        dfdPrintf("%*s" FMT, LENGTH_OF_INDENT(INDENT), ""); \
     }
 
 /** @internal */
@@ -70,15 +70,15 @@ static void printFlagBitsJSON(uint32_t indent, const char* nl, uint32_t flags, c
 
         const char* str = toStringFn(bit_index, bit_value);
         if (str) {
-            printf("%s%s%*s\"%s\"", first ? "" : ",", first ? "" : nl, indent, "", str);
+            dfdPrintf("%s%s%*s\"%s\"", first ? "" : ",", first ? "" : nl, indent, "", str);
             first = false;
         } else if (bit_value) {
-            printf("%s%s%*s%u", first ? "" : ",", first ? "" : nl, indent, "", bit_mask);
+            dfdPrintf("%s%s%*s%u", first ? "" : ",", first ? "" : nl, indent, "", bit_mask);
             first = false;
         }
     }
     if (!first)
-        printf("%s", nl);
+        dfdPrintf("%s", nl);
 }
 
 /** @internal */
@@ -140,7 +140,7 @@ printKVData(ktx_uint8_t* pKvd, ktx_uint32_t kvdLen)
 
     result = ktxHashList_Deserialize(&kvDataHead, kvdLen, pKvd);
     if (result != KTX_SUCCESS) {
-        fprintf(stdout, "Failed to parse or not enough memory to build list of key/value pairs.\n");
+        dfdPrintf("Failed to parse or not enough memory to build list of key/value pairs.\n");
         return;
     }
 
@@ -157,9 +157,9 @@ printKVData(ktx_uint8_t* pKvd, ktx_uint32_t kvdLen)
         ktxHashListEntry_GetKey(entry, &keyLen, &key);
         ktxHashListEntry_GetValue(entry, &valueLen, (void**)&value);
         // Keys must be NUL terminated.
-        fprintf(stdout, "%s:", key);
+        dfdPrintf("%s:", key);
         if (!value) {
-            fprintf(stdout, " null\n");
+            dfdPrintf(" null\n");
 
         } else {
             if (strcmp(key, "KTXglFormat") == 0) {
@@ -167,10 +167,10 @@ printKVData(ktx_uint8_t* pKvd, ktx_uint32_t kvdLen)
                     ktx_uint32_t glInternalformat = *(const ktx_uint32_t*) (value + 0);
                     ktx_uint32_t glFormat = *(const ktx_uint32_t*) (value + 4);
                     ktx_uint32_t glType = *(const ktx_uint32_t*) (value + 8);
-                    fprintf(stdout, "\n");
-                    fprintf(stdout, "    glInternalformat: 0x%08X\n", glInternalformat);
-                    fprintf(stdout, "    glFormat: 0x%08X\n", glFormat);
-                    fprintf(stdout, "    glType: 0x%08X\n", glType);
+                    dfdPrintf("\n");
+                    dfdPrintf("    glInternalformat: 0x%08X\n", glInternalformat);
+                    dfdPrintf("    glFormat: 0x%08X\n", glFormat);
+                    dfdPrintf("    glType: 0x%08X\n", glType);
                 }
 
             } else if (strcmp(key, "KTXanimData") == 0) {
@@ -178,40 +178,40 @@ printKVData(ktx_uint8_t* pKvd, ktx_uint32_t kvdLen)
                     ktx_uint32_t duration = *(const ktx_uint32_t*) (value + 0);
                     ktx_uint32_t timescale = *(const ktx_uint32_t*) (value + 4);
                     ktx_uint32_t loopCount = *(const ktx_uint32_t*) (value + 8);
-                    fprintf(stdout, "\n");
-                    fprintf(stdout, "    duration: %u\n", duration);
-                    fprintf(stdout, "    timescale: %u\n", timescale);
-                    fprintf(stdout, "    loopCount: %u%s\n", loopCount, loopCount == 0 ? " (infinite)" : "");
+                    dfdPrintf("\n");
+                    dfdPrintf("    duration: %u\n", duration);
+                    dfdPrintf("    timescale: %u\n", timescale);
+                    dfdPrintf("    loopCount: %u%s\n", loopCount, loopCount == 0 ? " (infinite)" : "");
                 }
 
             } else if (strcmp(key, "KTXcubemapIncomplete") == 0) {
                 if (valueLen == sizeof(ktx_uint8_t)) {
                     ktx_uint8_t faces = *value;
-                    fprintf(stdout, "\n");
-                    fprintf(stdout, "    positiveX: %s\n", faces & 1u << 0u ? "true" : "false");
-                    fprintf(stdout, "    negativeX: %s\n", faces & 1u << 1u ? "true" : "false");
-                    fprintf(stdout, "    positiveY: %s\n", faces & 1u << 2u ? "true" : "false");
-                    fprintf(stdout, "    negativeY: %s\n", faces & 1u << 3u ? "true" : "false");
-                    fprintf(stdout, "    positiveZ: %s\n", faces & 1u << 4u ? "true" : "false");
-                    fprintf(stdout, "    negativeZ: %s\n", faces & 1u << 5u ? "true" : "false");
+                    dfdPrintf("\n");
+                    dfdPrintf("    positiveX: %s\n", faces & 1u << 0u ? "true" : "false");
+                    dfdPrintf("    negativeX: %s\n", faces & 1u << 1u ? "true" : "false");
+                    dfdPrintf("    positiveY: %s\n", faces & 1u << 2u ? "true" : "false");
+                    dfdPrintf("    negativeY: %s\n", faces & 1u << 3u ? "true" : "false");
+                    dfdPrintf("    positiveZ: %s\n", faces & 1u << 4u ? "true" : "false");
+                    dfdPrintf("    negativeZ: %s\n", faces & 1u << 5u ? "true" : "false");
                 }
 
             } else if (isKnownKeyValueUINT32(key)) {
                 if (valueLen == sizeof(ktx_uint32_t)) {
                     ktx_uint32_t number = *(const ktx_uint32_t*) value;
-                    fprintf(stdout, " %u\n", number);
+                    dfdPrintf(" %u\n", number);
                 }
 
             } else if (isKnownKeyValueString(key)) {
                 if (value[valueLen-1] == '\0') {
-                    fprintf(stdout, " %s\n", value);
+                    dfdPrintf(" %s\n", value);
                 }
 
             } else {
-                fprintf(stdout, " [");
+                dfdPrintf(" [");
                 for (ktx_uint32_t i = 0; i < valueLen; i++)
-                    fprintf(stdout, "%d%s", (int) value[i], i + 1 == valueLen ? "" : ", ");
-                fprintf(stdout, "]\n");
+                    dfdPrintf("%d%s", (int) value[i], i + 1 == valueLen ? "" : ", ");
+                dfdPrintf("]\n");
             }
         }
     }
@@ -244,7 +244,7 @@ printKVDataJSON(ktx_uint8_t* pKvd, ktx_uint32_t kvdLen, ktx_uint32_t base_indent
     result = ktxHashList_Deserialize(&kvDataHead, kvdLen, pKvd);
     if (result != KTX_SUCCESS) {
         // Logging while printing JSON is not possible, we rely on the validation step to provide meaningful errors
-        // fprintf(stdout, "Failed to parse or not enough memory to build list of key/value pairs.\n");
+        // dfdPrintf("Failed to parse or not enough memory to build list of key/value pairs.\n");
         return;
     }
 
@@ -266,7 +266,7 @@ printKVDataJSON(ktx_uint8_t* pKvd, ktx_uint32_t kvdLen, ktx_uint32_t base_indent
             if (!isKnownKeyValue(key)) {
                 // Known keys are not be printed with null
                 if (!firstPrint)
-                    fprintf(stdout, ",%s", nl);
+                    dfdPrintf(",%s", nl);
                 firstPrint = false;
                 PRINT_INDENT(0, "\"%s\":%snull", key, space)
             }
@@ -274,7 +274,7 @@ printKVDataJSON(ktx_uint8_t* pKvd, ktx_uint32_t kvdLen, ktx_uint32_t base_indent
             if (strcmp(key, "KTXglFormat") == 0) {
                 if (valueLen == 3 * sizeof(ktx_uint32_t)) {
                     if (!firstPrint)
-                        fprintf(stdout, ",%s", nl);
+                        dfdPrintf(",%s", nl);
                     firstPrint = false;
                     ktx_uint32_t glInternalformat = *(const ktx_uint32_t*) (value + 0);
                     ktx_uint32_t glFormat = *(const ktx_uint32_t*) (value + 4);
@@ -288,7 +288,7 @@ printKVDataJSON(ktx_uint8_t* pKvd, ktx_uint32_t kvdLen, ktx_uint32_t base_indent
             } else if (strcmp(key, "KTXanimData") == 0) {
                 if (valueLen == 3 * sizeof(ktx_uint32_t)) {
                     if (!firstPrint)
-                        fprintf(stdout, ",%s", nl);
+                        dfdPrintf(",%s", nl);
                     firstPrint = false;
                     ktx_uint32_t duration = *(const ktx_uint32_t*) (value + 0);
                     ktx_uint32_t timescale = *(const ktx_uint32_t*) (value + 4);
@@ -302,7 +302,7 @@ printKVDataJSON(ktx_uint8_t* pKvd, ktx_uint32_t kvdLen, ktx_uint32_t base_indent
             } else if (strcmp(key, "KTXcubemapIncomplete") == 0) {
                 if (valueLen == sizeof(ktx_uint8_t)) {
                     if (!firstPrint)
-                        fprintf(stdout, ",%s", nl);
+                        dfdPrintf(",%s", nl);
                     firstPrint = false;
                     ktx_uint8_t faces = *value;
                     PRINT_INDENT(0, "\"%s\":%s{%s", key, space, nl)
@@ -317,7 +317,7 @@ printKVDataJSON(ktx_uint8_t* pKvd, ktx_uint32_t kvdLen, ktx_uint32_t base_indent
             } else if (isKnownKeyValueUINT32(key)) {
                 if (valueLen == sizeof(ktx_uint32_t)) {
                     if (!firstPrint)
-                        fprintf(stdout, ",%s", nl);
+                        dfdPrintf(",%s", nl);
                     firstPrint = false;
                     ktx_uint32_t number = *(const ktx_uint32_t*) value;
                     PRINT_INDENT(0, "\"%s\":%s%u", key, space, number)
@@ -325,22 +325,22 @@ printKVDataJSON(ktx_uint8_t* pKvd, ktx_uint32_t kvdLen, ktx_uint32_t base_indent
             } else if (isKnownKeyValueString(key)) {
                 if (value[valueLen-1] == '\0') {
                     if (!firstPrint)
-                        fprintf(stdout, ",%s", nl);
+                        dfdPrintf(",%s", nl);
                     firstPrint = false;
                     PRINT_INDENT(0, "\"%s\":%s\"%s\"", key, space, value)
                 }
             } else {
                 if (!firstPrint)
-                    fprintf(stdout, ",%s", nl);
+                    dfdPrintf(",%s", nl);
                 firstPrint = false;
                 PRINT_INDENT(0, "\"%s\":%s[", key, space)
                 for (ktx_uint32_t i = 0; i < valueLen; i++)
-                    fprintf(stdout, "%d%s", (int) value[i], i + 1 == valueLen ? "" : ", ");
-                fprintf(stdout, "]");
+                    dfdPrintf("%d%s", (int) value[i], i + 1 == valueLen ? "" : ", ");
+                dfdPrintf("]");
             }
         }
     }
-    fprintf(stdout, "%s", nl);
+    dfdPrintf("%s", nl);
 
     ktxHashList_Destruct(&kvDataHead);
 }
@@ -394,7 +394,7 @@ printIdentifier(const ktx_uint8_t identifier[12], bool json)
     if (_isatty(_fileno(stdout)))
         SetConsoleOutputCP(CP_UTF8);
 #endif
-    fprintf(stdout, "%.*s", idlen, u8identifier);
+    dfdPrintf("%.*s", idlen, u8identifier);
 }
 
 /*===========================================================*
@@ -411,24 +411,24 @@ printIdentifier(const ktx_uint8_t identifier[12], bool json)
 void
 printKTXHeader(KTX_header* pHeader)
 {
-    fprintf(stdout, "identifier: ");
+    dfdPrintf("identifier: ");
     printIdentifier(pHeader->identifier, false);
-    fprintf(stdout, "\n");
-    fprintf(stdout, "endianness: %#x\n", pHeader->endianness);
-    fprintf(stdout, "glType: %#x\n", pHeader->glType);
-    fprintf(stdout, "glTypeSize: %u\n", pHeader->glTypeSize);
-    fprintf(stdout, "glFormat: %#x\n", pHeader->glFormat);
-    fprintf(stdout, "glInternalformat: %#x\n", pHeader->glInternalformat);
-    fprintf(stdout, "glBaseInternalformat: %#x\n",
+    dfdPrintf("\n");
+    dfdPrintf("endianness: %#x\n", pHeader->endianness);
+    dfdPrintf("glType: %#x\n", pHeader->glType);
+    dfdPrintf("glTypeSize: %u\n", pHeader->glTypeSize);
+    dfdPrintf("glFormat: %#x\n", pHeader->glFormat);
+    dfdPrintf("glInternalformat: %#x\n", pHeader->glInternalformat);
+    dfdPrintf("glBaseInternalformat: %#x\n",
             pHeader->glBaseInternalformat);
-    fprintf(stdout, "pixelWidth: %u\n", pHeader->pixelWidth);
-    fprintf(stdout, "pixelHeight: %u\n", pHeader->pixelHeight);
-    fprintf(stdout, "pixelDepth: %u\n", pHeader->pixelDepth);
-    fprintf(stdout, "numberOfArrayElements: %u\n",
+    dfdPrintf("pixelWidth: %u\n", pHeader->pixelWidth);
+    dfdPrintf("pixelHeight: %u\n", pHeader->pixelHeight);
+    dfdPrintf("pixelDepth: %u\n", pHeader->pixelDepth);
+    dfdPrintf("numberOfArrayElements: %u\n",
             pHeader->numberOfArrayElements);
-    fprintf(stdout, "numberOfFaces: %u\n", pHeader->numberOfFaces);
-    fprintf(stdout, "numberOfMipLevels: %u\n", pHeader->numberOfMipLevels);
-    fprintf(stdout, "bytesOfKeyValueData: %u\n", pHeader->bytesOfKeyValueData);
+    dfdPrintf("numberOfFaces: %u\n", pHeader->numberOfFaces);
+    dfdPrintf("numberOfMipLevels: %u\n", pHeader->numberOfMipLevels);
+    dfdPrintf("bytesOfKeyValueData: %u\n", pHeader->bytesOfKeyValueData);
 }
 
 /**
@@ -449,24 +449,24 @@ printKTXInfo2(ktxStream* stream, KTX_header* pHeader)
     KTX_error_code result;
 
     if (pHeader->endianness == KTX_ENDIAN_REF_REV) {
-        fprintf(stdout, "This file has opposite endianness to this machine. Following\n"
+        dfdPrintf("This file has opposite endianness to this machine. Following\n"
                         "are the converted pHeader values\n\n");
     } else {
-        fprintf(stdout, "Header\n\n");
+        dfdPrintf("Header\n\n");
     }
     // Print first as ktxCheckHeader1_ modifies the header.
     printKTXHeader(pHeader);
 
     result = ktxCheckHeader1_(pHeader, &suppInfo);
     if (result != KTX_SUCCESS) {
-        fprintf(stdout, "The KTX 1 file pHeader is invalid:\n");
+        dfdPrintf("The KTX 1 file pHeader is invalid:\n");
         switch (result) {
           case KTX_FILE_DATA_ERROR:
-            fprintf(stdout, "  it has invalid data such as bad glTypeSize, improper dimensions,\n"
+            dfdPrintf("  it has invalid data such as bad glTypeSize, improper dimensions,\n"
                             "improper number of faces or too many levels.\n");
             break;
           case KTX_UNSUPPORTED_FEATURE:
-            fprintf(stdout, "  it describes an unsupported feature or format\n");
+            dfdPrintf("  it describes an unsupported feature or format\n");
             break;
           default:
               ; // _ktxCheckHeader returns only the above 2 errors.
@@ -475,13 +475,13 @@ printKTXInfo2(ktxStream* stream, KTX_header* pHeader)
     }
 
     if (pHeader->bytesOfKeyValueData) {
-        fprintf(stdout, "\nKey/Value Data\n\n");
+        dfdPrintf("\nKey/Value Data\n\n");
         metadata = malloc(pHeader->bytesOfKeyValueData);
         stream->read(stream, metadata, pHeader->bytesOfKeyValueData);
         printKVData(metadata, pHeader->bytesOfKeyValueData);
         free(metadata);
     } else {
-        fprintf(stdout, "\nNo Key/Value data.\n");
+        dfdPrintf("\nNo Key/Value data.\n");
     }
 
     uint32_t levelCount = MAX(1, pHeader->numberOfMipLevels);
@@ -496,7 +496,7 @@ printKTXInfo2(ktxStream* stream, KTX_header* pHeader)
     // are a multiple of 4, all levels and faces will also be a multiple
     // of 4 so mipPadding and facePadding will always be 0. So they are
     // ignored here.
-    fprintf(stdout, "\nData Sizes (bytes)\n------------------\n");
+    dfdPrintf("\nData Sizes (bytes)\n------------------\n");
     for (uint32_t level = 0; level < levelCount; level++) {
         ktx_uint32_t faceLodSize;
         ktx_uint32_t lodSize;
@@ -510,9 +510,9 @@ printKTXInfo2(ktxStream* stream, KTX_header* pHeader)
         }
         result = stream->skip(stream, lodSize);
         dataSize += lodSize;
-        fprintf(stdout, "Level %u: %u\n", level, lodSize);
+        dfdPrintf("Level %u: %u\n", level, lodSize);
     }
-    fprintf(stdout, "\nTotal: %" PRId64 "\n", dataSize);
+    dfdPrintf("\nTotal: %" PRId64 "\n", dataSize);
 }
 
 /**
@@ -554,38 +554,38 @@ const char* ktxBUImageFlagsBitString(ktx_uint32_t bit_index, bool bit_value);
 void
 printKTX2Header(KTX_header2* pHeader)
 {
-    fprintf(stdout, "identifier: ");
+    dfdPrintf("identifier: ");
     printIdentifier(pHeader->identifier, false);
-    fprintf(stdout, "\n");
+    dfdPrintf("\n");
     const char* vkFormatStr = vkFormatString(pHeader->vkFormat);
     if (strcmp(vkFormatStr, "VK_UNKNOWN_FORMAT") == 0)
-        fprintf(stdout, "vkFormat: 0x%08X\n", (uint32_t) pHeader->vkFormat);
+        dfdPrintf("vkFormat: 0x%08X\n", (uint32_t) pHeader->vkFormat);
     else
-        fprintf(stdout, "vkFormat: %s\n", vkFormatStr);
-    fprintf(stdout, "typeSize: %u\n", pHeader->typeSize);
-    fprintf(stdout, "pixelWidth: %u\n", pHeader->pixelWidth);
-    fprintf(stdout, "pixelHeight: %u\n", pHeader->pixelHeight);
-    fprintf(stdout, "pixelDepth: %u\n", pHeader->pixelDepth);
-    fprintf(stdout, "layerCount: %u\n",
+        dfdPrintf("vkFormat: %s\n", vkFormatStr);
+    dfdPrintf("typeSize: %u\n", pHeader->typeSize);
+    dfdPrintf("pixelWidth: %u\n", pHeader->pixelWidth);
+    dfdPrintf("pixelHeight: %u\n", pHeader->pixelHeight);
+    dfdPrintf("pixelDepth: %u\n", pHeader->pixelDepth);
+    dfdPrintf("layerCount: %u\n",
             pHeader->layerCount);
-    fprintf(stdout, "faceCount: %u\n", pHeader->faceCount);
-    fprintf(stdout, "levelCount: %u\n", pHeader->levelCount);
+    dfdPrintf("faceCount: %u\n", pHeader->faceCount);
+    dfdPrintf("levelCount: %u\n", pHeader->levelCount);
     const char* scSchemeStr = ktxSupercompressionSchemeString(pHeader->supercompressionScheme);
     if (strcmp(scSchemeStr, "Invalid scheme value") == 0)
-        fprintf(stdout, "supercompressionScheme: Invalid scheme (0x%X)\n", (uint32_t) pHeader->supercompressionScheme);
+        dfdPrintf("supercompressionScheme: Invalid scheme (0x%X)\n", (uint32_t) pHeader->supercompressionScheme);
     else if (strcmp(scSchemeStr, "Vendor or reserved scheme") == 0)
-        fprintf(stdout, "supercompressionScheme: Vendor or reserved scheme (0x%X)\n", (uint32_t) pHeader->supercompressionScheme);
+        dfdPrintf("supercompressionScheme: Vendor or reserved scheme (0x%X)\n", (uint32_t) pHeader->supercompressionScheme);
     else
-        fprintf(stdout, "supercompressionScheme: %s\n", scSchemeStr);
-    fprintf(stdout, "dataFormatDescriptor.byteOffset: %#x\n",
+        dfdPrintf("supercompressionScheme: %s\n", scSchemeStr);
+    dfdPrintf("dataFormatDescriptor.byteOffset: %#x\n",
             pHeader->dataFormatDescriptor.byteOffset);
-    fprintf(stdout, "dataFormatDescriptor.byteLength: %u\n",
+    dfdPrintf("dataFormatDescriptor.byteLength: %u\n",
             pHeader->dataFormatDescriptor.byteLength);
-    fprintf(stdout, "keyValueData.byteOffset: %#x\n", pHeader->keyValueData.byteOffset);
-    fprintf(stdout, "keyValueData.byteLength: %u\n", pHeader->keyValueData.byteLength);
-    fprintf(stdout, "supercompressionGlobalData.byteOffset: %#" PRIx64 "\n",
+    dfdPrintf("keyValueData.byteOffset: %#x\n", pHeader->keyValueData.byteOffset);
+    dfdPrintf("keyValueData.byteLength: %u\n", pHeader->keyValueData.byteLength);
+    dfdPrintf("supercompressionGlobalData.byteOffset: %#" PRIx64 "\n",
             pHeader->supercompressionGlobalData.byteOffset);
-    fprintf(stdout, "supercompressionGlobalData.byteLength: %" PRId64 "\n",
+    dfdPrintf("supercompressionGlobalData.byteLength: %" PRId64 "\n",
             pHeader->supercompressionGlobalData.byteLength);
 }
 
@@ -602,11 +602,11 @@ printLevelIndex(ktxLevelIndexEntry levelIndex[], ktx_uint32_t numLevels)
 {
     numLevels = MIN(MAX_NUM_LEVELS, numLevels); // Print at most 64 levels to stop parsing garbage
     for (ktx_uint32_t level = 0; level < numLevels; level++) {
-    fprintf(stdout, "Level%u.byteOffset: %#" PRIx64 "\n", level,
+    dfdPrintf("Level%u.byteOffset: %#" PRIx64 "\n", level,
             levelIndex[level].byteOffset);
-    fprintf(stdout, "Level%u.byteLength: %" PRId64 "\n", level,
+    dfdPrintf("Level%u.byteLength: %" PRId64 "\n", level,
             levelIndex[level].byteLength);
-    fprintf(stdout, "Level%u.uncompressedByteLength: %" PRId64 "\n", level,
+    dfdPrintf("Level%u.uncompressedByteLength: %" PRId64 "\n", level,
             levelIndex[level].uncompressedByteLength);
     }
 }
@@ -627,23 +627,23 @@ printBasisSGDInfo(ktx_uint8_t* bgd, ktx_uint64_t byteLength,
     if (byteLength < sizeof(ktxBasisLzGlobalHeader))
         return;
 
-    fprintf(stdout, "endpointCount: %u\n", bgdh->endpointCount);
-    fprintf(stdout, "selectorCount: %u\n", bgdh->selectorCount);
-    fprintf(stdout, "endpointsByteLength: %u\n", bgdh->endpointsByteLength);
-    fprintf(stdout, "selectorsByteLength: %u\n", bgdh->selectorsByteLength);
-    fprintf(stdout, "tablesByteLength: %u\n", bgdh->tablesByteLength);
-    fprintf(stdout, "extendedByteLength: %u\n", bgdh->extendedByteLength);
+    dfdPrintf("endpointCount: %u\n", bgdh->endpointCount);
+    dfdPrintf("selectorCount: %u\n", bgdh->selectorCount);
+    dfdPrintf("endpointsByteLength: %u\n", bgdh->endpointsByteLength);
+    dfdPrintf("selectorsByteLength: %u\n", bgdh->selectorsByteLength);
+    dfdPrintf("tablesByteLength: %u\n", bgdh->tablesByteLength);
+    dfdPrintf("extendedByteLength: %u\n", bgdh->extendedByteLength);
 
     ktxBasisLzEtc1sImageDesc* slices = (ktxBasisLzEtc1sImageDesc*)(bgd + sizeof(ktxBasisLzGlobalHeader));
     for (ktx_uint32_t i = 0; i < numImages; i++) {
         if (byteLength < (i + 1) * sizeof(ktxBasisLzEtc1sImageDesc) + sizeof(ktxBasisLzGlobalHeader))
             break;
 
-        fprintf(stdout, "\nimageFlags: %#x\n", slices[i].imageFlags);
-        fprintf(stdout, "rgbSliceByteLength: %u\n", slices[i].rgbSliceByteLength);
-        fprintf(stdout, "rgbSliceByteOffset: %#x\n", slices[i].rgbSliceByteOffset);
-        fprintf(stdout, "alphaSliceByteLength: %u\n", slices[i].alphaSliceByteLength);
-        fprintf(stdout, "alphaSliceByteOffset: %#x\n", slices[i].alphaSliceByteOffset);
+        dfdPrintf("\nimageFlags: %#x\n", slices[i].imageFlags);
+        dfdPrintf("rgbSliceByteLength: %u\n", slices[i].rgbSliceByteLength);
+        dfdPrintf("rgbSliceByteOffset: %#x\n", slices[i].rgbSliceByteOffset);
+        dfdPrintf("alphaSliceByteLength: %u\n", slices[i].alphaSliceByteLength);
+        dfdPrintf("alphaSliceByteOffset: %#x\n", slices[i].alphaSliceByteOffset);
     }
 }
 
@@ -675,10 +675,10 @@ printKTX2Info2(ktxStream* stream, KTX_header2* pHeader)
     ktx_uint32_t levelIndexSize;
     KTX_error_code ec = KTX_SUCCESS;
 
-    fprintf(stdout, "Header\n\n");
+    dfdPrintf("Header\n\n");
     printKTX2Header(pHeader);
 
-    fprintf(stdout, "\nLevel Index\n\n");
+    dfdPrintf("\nLevel Index\n\n");
     numLevels = MAX(1, pHeader->levelCount);
     levelIndexSize = sizeof(ktxLevelIndexEntry) * numLevels;
     levelIndex = (ktxLevelIndexEntry*)malloc(levelIndexSize);
@@ -693,7 +693,7 @@ printKTX2Info2(ktxStream* stream, KTX_header2* pHeader)
     free(levelIndex);
 
     if (hasDFD) {
-        fprintf(stdout, "\nData Format Descriptor\n\n");
+        dfdPrintf("\nData Format Descriptor\n\n");
         ktx_uint32_t* dfd = (ktx_uint32_t*)malloc(pHeader->dataFormatDescriptor.byteLength);
         if (dfd == NULL)
             return KTX_OUT_OF_MEMORY;
@@ -711,7 +711,7 @@ printKTX2Info2(ktxStream* stream, KTX_header2* pHeader)
     }
 
     if (hasKVD) {
-        fprintf(stdout, "\nKey/Value Data\n\n");
+        dfdPrintf("\nKey/Value Data\n\n");
         ktx_uint8_t* kvd = malloc(pHeader->keyValueData.byteLength);
         if (kvd == NULL)
             return KTX_OUT_OF_MEMORY;
@@ -723,7 +723,7 @@ printKTX2Info2(ktxStream* stream, KTX_header2* pHeader)
         printKVData(kvd, pHeader->keyValueData.byteLength);
         free(kvd);
     } else {
-        fprintf(stdout, "\nNo Key/Value data.\n");
+        dfdPrintf("\nNo Key/Value data.\n");
     }
 
     if (hasSGD) {
@@ -751,11 +751,11 @@ printKTX2Info2(ktxStream* stream, KTX_header2* pHeader)
             // NOTA BENE: faceCount * layerPixelDepth is only reasonable because
             // faceCount and depth can't both be > 1. I.e there are no 3d cubemaps.
             uint32_t numImages = layersFaces * layerPixelDepth;
-            fprintf(stdout, "\nBasis Supercompression Global Data\n\n");
+            dfdPrintf("\nBasis Supercompression Global Data\n\n");
             printBasisSGDInfo(sgd, pHeader->supercompressionGlobalData.byteLength, numImages);
             free(sgd);
         } else {
-            fprintf(stdout, "\nUnrecognized supercompressionScheme.\n");
+            dfdPrintf("\nUnrecognized supercompressionScheme.\n");
         }
     }
 
@@ -804,7 +804,7 @@ printKTX2Info2JSON(ktxStream* stream, KTX_header2* pHeader, ktx_uint32_t base_in
     PRINT_INDENT(0, "\"header\":%s{%s", space, nl)
     PRINT_INDENT(1, "\"identifier\":%s\"", space)
     printIdentifier(pHeader->identifier, true);
-    printf("\",%s", nl);
+    dfdPrintf("\",%s", nl);
     const char* vkFormatStr = vkFormatString(pHeader->vkFormat);
     if (strcmp(vkFormatStr, "VK_UNKNOWN_FORMAT") == 0)
         PRINT_INDENT(1, "\"vkFormat\":%s%u,%s", space, (uint32_t) pHeader->vkFormat, nl)
@@ -831,12 +831,12 @@ printKTX2Info2JSON(ktxStream* stream, KTX_header2* pHeader, ktx_uint32_t base_in
         return KTX_OUT_OF_MEMORY;
     ec = stream->read(stream, levelIndex, levelIndexSize);
     if (ec != KTX_SUCCESS) {
-        printf("%s", nl);
+        dfdPrintf("%s", nl);
         free(levelIndex);
         return ec;
     }
 
-    printf(",%s", nl);
+    dfdPrintf(",%s", nl);
     PRINT_INDENT(0, "\"index\":%s{%s", space, nl)
 
     PRINT_INDENT(1, "\"dataFormatDescriptor\":%s{%s", space, nl)
@@ -872,11 +872,11 @@ printKTX2Info2JSON(ktxStream* stream, KTX_header2* pHeader, ktx_uint32_t base_in
             return KTX_OUT_OF_MEMORY;
         ec = stream->read(stream, dfd, pHeader->dataFormatDescriptor.byteLength);
         if (ec != KTX_SUCCESS) {
-            printf("%s", nl);
+            dfdPrintf("%s", nl);
             free(dfd);
             return ec;
         }
-        printf(",%s", nl);
+        dfdPrintf(",%s", nl);
         PRINT_INDENT(0, "\"dataFormatDescriptor\":%s{%s", space, nl)
         printDFDJSON(dfd, pHeader->dataFormatDescriptor.byteLength, base_indent + 1, indent_width, minified);
         free(dfd);
@@ -889,11 +889,11 @@ printKTX2Info2JSON(ktxStream* stream, KTX_header2* pHeader, ktx_uint32_t base_in
             return KTX_OUT_OF_MEMORY;
         ec = stream->read(stream, kvd, pHeader->keyValueData.byteLength);
         if (ec != KTX_SUCCESS) {
-            printf("%s", nl);
+            dfdPrintf("%s", nl);
             free(kvd);
             return ec;
         }
-        printf(",%s", nl);
+        dfdPrintf(",%s", nl);
         PRINT_INDENT(0, "\"keyValueData\":%s{%s", space, nl)
         printKVDataJSON(kvd, pHeader->keyValueData.byteLength, base_indent + 1, indent_width, minified);
         free(kvd);
@@ -901,7 +901,7 @@ printKTX2Info2JSON(ktxStream* stream, KTX_header2* pHeader, ktx_uint32_t base_in
     }
 
     if (hasSGD) {
-        printf(",%s", nl);
+        dfdPrintf(",%s", nl);
         PRINT_INDENT(0, "\"supercompressionGlobalData\":%s{%s", space, nl)
 
         switch (pHeader->supercompressionScheme) {
@@ -917,14 +917,14 @@ printKTX2Info2JSON(ktxStream* stream, KTX_header2* pHeader, ktx_uint32_t base_in
                 return KTX_OUT_OF_MEMORY;
             ec = stream->setpos(stream, pHeader->supercompressionGlobalData.byteOffset);
             if (ec != KTX_SUCCESS) {
-                printf("%s", nl);
+                dfdPrintf("%s", nl);
                 PRINT_INDENT(0, "}%s", nl)
                 free(sgd);
                 return ec;
             }
             ec = stream->read(stream, sgd, sgdByteLength);
             if (ec != KTX_SUCCESS) {
-                printf("%s", nl);
+                dfdPrintf("%s", nl);
                 PRINT_INDENT(0, "}%s", nl)
                 free(sgd);
                 return ec;
@@ -941,12 +941,12 @@ printKTX2Info2JSON(ktxStream* stream, KTX_header2* pHeader, ktx_uint32_t base_in
             ktxBasisLzGlobalHeader* bgdh = (ktxBasisLzGlobalHeader*)(sgd);
 
             if (sgdByteLength < sizeof(ktxBasisLzGlobalHeader)) {
-                printf("%s", nl);
+                dfdPrintf("%s", nl);
                 PRINT_INDENT(0, "}%s", nl)
                 free(sgd);
                 return ec;
             }
-            printf(",%s", nl);
+            dfdPrintf(",%s", nl);
             PRINT_INDENT(1, "\"endpointCount\":%s%u,%s", space, bgdh->endpointCount, nl)
             PRINT_INDENT(1, "\"selectorCount\":%s%u,%s", space, bgdh->selectorCount, nl)
             PRINT_INDENT(1, "\"endpointsByteLength\":%s%u,%s", space, bgdh->endpointsByteLength, nl)
@@ -961,9 +961,9 @@ printKTX2Info2JSON(ktxStream* stream, KTX_header2* pHeader, ktx_uint32_t base_in
                     break;
 
                 if (i == 0)
-                    printf("%s", nl);
+                    dfdPrintf("%s", nl);
                 else
-                    printf(",%s", nl);
+                    dfdPrintf(",%s", nl);
 
                 PRINT_INDENT(2, "{%s", nl)
 
@@ -982,7 +982,7 @@ printKTX2Info2JSON(ktxStream* stream, KTX_header2* pHeader, ktx_uint32_t base_in
                 PRINT_INDENT(3, "\"alphaSliceByteOffset\":%s%u%s", space, slices[i].alphaSliceByteOffset, nl)
                 PRINT_INDENT_NOARG(2, "}")
             }
-            printf("%s", nl);
+            dfdPrintf("%s", nl);
             PRINT_INDENT(1, "]%s", nl)
 
             free(sgd);
@@ -1002,7 +1002,7 @@ printKTX2Info2JSON(ktxStream* stream, KTX_header2* pHeader, ktx_uint32_t base_in
         }
         PRINT_INDENT_NOARG(0, "}")
     }
-    printf("%s", nl);
+    dfdPrintf("%s", nl);
 
     return ec;
 }
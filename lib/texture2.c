@@ -31,6 +31,7 @@
 #include "dfdutils/dfd.h"
 #include "ktx.h"
 #include "ktxint.h"
+#include "basis_sgd.h"
 #include "filestream.h"
 #include "memstream.h"
 #include "texture2.h"
@@ -607,6 +608,418 @@ cleanup:
     return result;
 }
 
+/**
+ * @memberof ktxTexture2 @private
+ * @~English
+ * @brief Read part of the stored data of one level of a ktxTexture2.
+ *
+ * The bytes are read from the texture's image data, if it is loaded, or
+ * from its source stream. The stream position is left undefined.
+ *
+ * @param[in] This    pointer to the ktxTexture2 object of interest.
+ * @param[in] level   index of the level to read.
+ * @param[in] offset  offset of the first byte to read, relative to the
+ *                    start of the level's stored, possibly supercompressed,
+ *                    data.
+ * @param[in] count   number of bytes to read.
+ * @param[in,out] pDest pointer to a buffer of at least @p count bytes.
+ *
+ * @return      KTX_SUCCESS on success, other KTX_* enum values on error.
+ */
+KTX_error_code
+ktxTexture2_readLevelDataInt(ktxTexture2* This, ktx_uint32_t level,
+                             ktx_size_t offset, ktx_size_t count,
+                             ktx_uint8_t* pDest)
+{
+    ktxStream* stream;
+    KTX_error_code result;
+
+    if (This->pData) {
+        memcpy(pDest,
+               This->pData + ktxTexture2_levelDataOffset(This, level) + offset,
+               count);
+        return KTX_SUCCESS;
+    }
+
+    stream = ktxTexture2_getStream(This);
+    result = stream->setpos(stream,
+                            ktxTexture2_levelFileOffset(This, level) + offset);
+    if (result != KTX_SUCCESS)
+        return result;
+    return stream->read(stream, pDest, count);
+}
+
+/**
+ * @memberof ktxTexture2 @private
+ * @~English
+ * @brief Inflate the data of a single level deflated with Zstandard or ZLIB.
+ *
+ * @param[in] This          pointer to the ktxTexture2 object of interest.
+ * @param[in] dctx          Zstandard decompression context. Only used when
+ *                          the supercompressionScheme is @c KTX_SS_ZSTD.
+ * @param[in] level         index of the level being inflated.
+ * @param[in] pDeflatedData pointer to the deflated data of the level.
+ * @param[in,out] pInflatedData pointer to a buffer of at least the level's
+ *                          uncompressedByteLength bytes.
+ *
+ * @return      KTX_SUCCESS on success, other KTX_* enum values on error.
+ */
+KTX_error_code
+ktxTexture2_inflateLevelInt(ktxTexture2* This, ZSTD_DCtx* dctx,
+                            ktx_uint32_t level, ktx_uint8_t* pDeflatedData,
+                            ktx_uint8_t* pInflatedData)
+{
+    ktxLevelIndexEntry* cindex = &This->_private->_levelIndex[level];
+    size_t levelByteLength = cindex->uncompressedByteLength;
+
+    if (This->supercompressionScheme == KTX_SS_ZSTD) {
+        levelByteLength = ZSTD_decompressDCtx(dctx, pInflatedData,
+                                              levelByteLength,
+                                              pDeflatedData,
+                                              cindex->byteLength);
+        if (ZSTD_isError(levelByteLength)) {
+            switch (ZSTD_getErrorCode(levelByteLength)) {
+              case ZSTD_error_dstSize_tooSmall:
+                return KTX_DECOMPRESS_LENGTH_ERROR;
+              case ZSTD_error_checksum_wrong:
+                return KTX_DECOMPRESS_CHECKSUM_ERROR;
+              case ZSTD_error_memory_allocation:
+                return KTX_OUT_OF_MEMORY;
+              default:
+                return KTX_FILE_DATA_ERROR;
+            }
+        }
+    } else {
+        KTX_error_code result = ktxUncompressZLIBInt(pInflatedData,
+                                                     &levelByteLength,
+                                                     pDeflatedData,
+                                                     cindex->byteLength);
+        if (result != KTX_SUCCESS)
+            return result;
+    }
+
+    if (cindex->uncompressedByteLength != levelByteLength)
+        return KTX_DECOMPRESS_LENGTH_ERROR;
+    return KTX_SUCCESS;
+}
+
+/**
+ * @memberof ktxTexture2 @private
+ * @~English
+ * @brief Construct a ktxTexture2 holding a subset of the images of a
+ *        source ktxTexture2.
+ *
+ * Only the stored data of the selected levels is read from the source. Zstd
+ * and ZLIB supercompressed levels are inflated, so the constructed texture
+ * has supercompressionScheme @c KTX_SS_NONE, and only the selected layers
+ * and faces are kept. BasisLZ levels are kept whole, as their images share
+ * a single buffer of slices, but the image descriptions in the
+ * supercompression global data are reduced to the selected images so
+ * transcoding only processes those.
+ *
+ * Arguments must have been validated by the caller.
+ *
+ * @param[in] This pointer to a ktxTexture2-sized block of memory to
+ *                 initialize.
+ * @param[in] orig pointer to the source texture.
+ * @param[in] firstLevel index of the first level to keep.
+ * @param[in] numLevels  number of levels to keep.
+ * @param[in] firstLayer index of the first layer to keep.
+ * @param[in] numLayers  number of layers to keep.
+ * @param[in] firstFace  index of the first face to keep.
+ * @param[in] numFaces   number of faces to keep.
+ *
+ * @return      KTX_SUCCESS on success, other KTX_* enum values on error.
+ *
+ * @exception KTX_OUT_OF_MEMORY Not enough memory for the texture data.
+ * @exception KTX_FILE_DATA_ERROR
+ *                              The source's supercompression global data is
+ *                              too short for its images.
+ */
+static KTX_error_code
+ktxTexture2_constructSubset(ktxTexture2* This, ktxTexture2* orig,
+                            ktx_uint32_t firstLevel, ktx_uint32_t numLevels,
+                            ktx_uint32_t firstLayer, ktx_uint32_t numLayers,
+                            ktx_uint32_t firstFace, ktx_uint32_t numFaces)
+{
+    ktxLevelIndexEntry* oindex = orig->_private->_levelIndex;
+    ktxLevelIndexEntry* nindex;
+    ktx_uint8_t* pDeflatedData = NULL;
+    ktx_uint8_t* pInflatedData = NULL;
+    ZSTD_DCtx* dctx = NULL;
+    ktx_bool_t fromStream = orig->pData == NULL;
+    ktx_bool_t doInflate = orig->supercompressionScheme == KTX_SS_ZSTD
+                           || orig->supercompressionScheme == KTX_SS_ZLIB;
+    ktx_bool_t allImages = numLayers == orig->numLayers
+                           && numFaces == orig->numFaces;
+    ktx_uint32_t alignment;
+    ktx_uint64_t levelOffset = 0;
+    KTX_error_code result = KTX_SUCCESS;
+
+    memcpy(This, orig, sizeof(ktxTexture2));
+    // Zero all the pointers to make error handling easier
+    This->_protected = NULL;
+    This->_private = NULL;
+    This->pDfd = NULL;
+    This->kvData = NULL;
+    This->kvDataHead = NULL;
+    This->pData = NULL;
+
+    This->_protected =
+                    (ktxTexture_protected*)malloc(sizeof(ktxTexture_protected));
+    if (!This->_protected)
+        return KTX_OUT_OF_MEMORY;
+    memcpy(This->_protected, orig->_protected, sizeof(ktxTexture_protected));
+    // The subset is always fully loaded. The source keeps its stream.
+    memset(ktxTexture2_getStream(This), 0, sizeof(ktxStream));
+
+    This->baseWidth = MAX(1, orig->baseWidth >> firstLevel);
+    This->baseHeight = MAX(1, orig->baseHeight >> firstLevel);
+    This->baseDepth = MAX(1, orig->baseDepth >> firstLevel);
+    This->numLevels = numLevels;
+    This->numLayers = numLayers;
+    This->numFaces = numFaces;
+    This->isCubemap = numFaces == 6;
+
+    ktx_size_t privateSize = sizeof(ktxTexture2_private)
+                           + sizeof(ktxLevelIndexEntry) * (numLevels - 1);
+    This->_private = (ktxTexture2_private*)malloc(privateSize);
+    if (This->_private == NULL) {
+        result = KTX_OUT_OF_MEMORY;
+        goto cleanup;
+    }
+    memcpy(This->_private, orig->_private, sizeof(ktxTexture2_private));
+    This->_private->_supercompressionGlobalData = NULL;
+    This->_private->_sgdByteLength = 0;
+    This->_private->_firstLevelFileOffset = 0;
+    nindex = This->_private->_levelIndex;
+
+    This->pDfd = (ktx_uint32_t*)malloc(*orig->pDfd);
+    if (!This->pDfd) {
+        result = KTX_OUT_OF_MEMORY;
+        goto cleanup;
+    }
+    memcpy(This->pDfd, orig->pDfd, *orig->pDfd);
+
+    if (orig->kvDataHead) {
+        ktxHashList_ConstructCopy(&This->kvDataHead, orig->kvDataHead);
+    } else if (orig->kvData) {
+        This->kvData = (ktx_uint8_t*)malloc(orig->kvDataLen);
+        if (!This->kvData) {
+            result = KTX_OUT_OF_MEMORY;
+            goto cleanup;
+        }
+        memcpy(This->kvData, orig->kvData, orig->kvDataLen);
+    }
+
+    if (doInflate)
+        alignment = ktxTexture2_calcPostInflationLevelAlignment(orig);
+    else
+        alignment = orig->_private->_requiredLevelAlignment;
+
+    // Lay the levels out smallest first, as they are in a KTX2 file.
+    This->dataSize = 0;
+    for (int32_t level = numLevels - 1; level >= 0; level--) {
+        ktxLevelIndexEntry* src = &oindex[firstLevel + level];
+        if (orig->supercompressionScheme == KTX_SS_BASIS_LZ) {
+            nindex[level] = *src;
+        } else {
+            ktx_size_t imagesByteLength = src->uncompressedByteLength
+                                    / (orig->numLayers * orig->numFaces);
+            nindex[level].uncompressedByteLength = nindex[level].byteLength
+                                    = imagesByteLength * numLayers * numFaces;
+        }
+        nindex[level].byteOffset = levelOffset;
+        ktx_size_t paddedLevelByteLength
+              = _KTX_PADN(alignment, nindex[level].byteLength);
+        levelOffset += paddedLevelByteLength;
+        This->dataSize += paddedLevelByteLength;
+    }
+
+    This->pData = malloc(This->dataSize);
+    if (This->pData == NULL) {
+        result = KTX_OUT_OF_MEMORY;
+        goto cleanup;
+    }
+
+    if (orig->supercompressionScheme == KTX_SS_ZSTD) {
+        dctx = ZSTD_createDCtx();
+        if (dctx == NULL) {
+            result = KTX_OUT_OF_MEMORY;
+            goto cleanup;
+        }
+    }
+
+    for (ktx_uint32_t level = 0; level < numLevels; level++) {
+        ktx_uint32_t srcLevel = firstLevel + level;
+        ktx_uint8_t* pDest = This->pData + nindex[level].byteOffset;
+        ktx_uint8_t* pImages = NULL;
+        ktx_size_t faceByteLength = oindex[srcLevel].uncompressedByteLength
+                                / (orig->numLayers * orig->numFaces);
+
+        if (orig->supercompressionScheme == KTX_SS_BASIS_LZ) {
+            result = ktxTexture2_readLevelDataInt(orig, srcLevel, 0,
+                                                  oindex[srcLevel].byteLength,
+                                                  pDest);
+            if (result != KTX_SUCCESS)
+                goto cleanup;
+            continue;
+        }
+
+        if (doInflate) {
+            free(pDeflatedData);
+            pDeflatedData = malloc(oindex[srcLevel].byteLength);
+            if (pDeflatedData == NULL) {
+                result = KTX_OUT_OF_MEMORY;
+                goto cleanup;
+            }
+            result = ktxTexture2_readLevelDataInt(orig, srcLevel, 0,
+                                                  oindex[srcLevel].byteLength,
+                                                  pDeflatedData);
+            if (result != KTX_SUCCESS)
+                goto cleanup;
+            if (allImages) {
+                // Inflate straight into the destination.
+                result = ktxTexture2_inflateLevelInt(orig, dctx, srcLevel,
+                                                     pDeflatedData, pDest);
+                if (result != KTX_SUCCESS)
+                    goto cleanup;
+                continue;
+            }
+            free(pInflatedData);
+            pInflatedData = malloc(oindex[srcLevel].uncompressedByteLength);
+            if (pInflatedData == NULL) {
+                result = KTX_OUT_OF_MEMORY;
+                goto cleanup;
+            }
+            result = ktxTexture2_inflateLevelInt(orig, dctx, srcLevel,
+                                                 pDeflatedData, pInflatedData);
+            if (result != KTX_SUCCESS)
+                goto cleanup;
+            pImages = pInflatedData;
+        }
+
+        // Each layer holds numFaces * depth images, each of the same size.
+        for (ktx_uint32_t layer = 0; layer < numLayers; layer++) {
+            ktx_size_t srcOffset = ((firstLayer + layer) * orig->numFaces
+                                    + firstFace) * faceByteLength;
+            ktx_size_t count = numFaces * faceByteLength;
+            if (pImages) {
+                memcpy(pDest, pImages + srcOffset, count);
+            } else {
+                result = ktxTexture2_readLevelDataInt(orig, srcLevel,
+                                                      srcOffset, count, pDest);
+                if (result != KTX_SUCCESS)
+                    goto cleanup;
+            }
+            pDest += count;
+        }
+    }
+
+    if (IS_BIG_ENDIAN && fromStream
+        && orig->supercompressionScheme == KTX_SS_NONE) {
+        // Perform endianness conversion on texture data.
+        for (ktx_uint32_t level = 0; level < numLevels; ++level) {
+            ktx_uint8_t* pDest = This->pData + nindex[level].byteOffset;
+            ktx_size_t levelByteLength = nindex[level].byteLength;
+            switch (This->_protected->_typeSize) {
+              case 2:
+                _ktxSwapEndian16((ktx_uint16_t*)pDest, levelByteLength / 2);
+                break;
+              case 4:
+                _ktxSwapEndian32((ktx_uint32_t*)pDest, levelByteLength / 4);
+                break;
+              case 8:
+                _ktxSwapEndian64((ktx_uint64_t*)pDest, levelByteLength / 8);
+                break;
+            }
+        }
+    }
+
+    if (doInflate) {
+        This->supercompressionScheme = KTX_SS_NONE;
+        This->_private->_requiredLevelAlignment = alignment;
+    }
+
+    if (orig->supercompressionScheme == KTX_SS_BASIS_LZ) {
+        // Keep only the descriptions of the selected images, in the same
+        // level, layer, face, slice order. The endpoints, selectors, tables
+        // and extended data that follow them are copied unchanged.
+        ktx_uint8_t* osgd = orig->_private->_supercompressionGlobalData;
+        ktx_uint32_t origImageCount = 0;
+        ktx_uint32_t imageCount = 0;
+        ktx_uint32_t firstImage = 0;
+        ktx_size_t descSize = sizeof(ktxBasisLzEtc1sImageDesc);
+        ktx_size_t headerSize = sizeof(ktxBasisLzGlobalHeader);
+
+        for (ktx_uint32_t level = 0; level < orig->numLevels; level++) {
+            // NOTA BENE: numFaces * depth is only reasonable because they
+            // can't both be > 1. I.e there are no 3d cubemaps.
+            ktx_uint32_t depth = MAX(orig->baseDepth >> level, 1);
+            if (level < firstLevel)
+                firstImage += orig->numLayers * orig->numFaces * depth;
+            else if (level < firstLevel + numLevels)
+                imageCount += numLayers * numFaces * depth;
+            origImageCount += orig->numLayers * orig->numFaces * depth;
+        }
+        if (osgd == NULL || orig->_private->_sgdByteLength
+                            < headerSize + descSize * origImageCount) {
+            result = KTX_FILE_DATA_ERROR;
+            goto cleanup;
+        }
+
+        ktx_size_t tailSize = orig->_private->_sgdByteLength - headerSize
+                              - descSize * origImageCount;
+        ktx_size_t sgdByteLength = headerSize + descSize * imageCount
+                                   + tailSize;
+        ktx_uint8_t* sgd = (ktx_uint8_t*)malloc(sgdByteLength);
+        if (!sgd) {
+            result = KTX_OUT_OF_MEMORY;
+            goto cleanup;
+        }
+        This->_private->_supercompressionGlobalData = sgd;
+        This->_private->_sgdByteLength = sgdByteLength;
+
+        memcpy(sgd, osgd, headerSize);
+        ktx_uint8_t* pDesc = sgd + headerSize;
+        for (ktx_uint32_t level = 0; level < numLevels; level++) {
+            ktx_uint32_t depth = MAX(orig->baseDepth >> (firstLevel + level), 1);
+            for (ktx_uint32_t layer = 0; layer < numLayers; layer++) {
+                ktx_uint32_t srcImage = firstImage
+                    + ((firstLayer + layer) * orig->numFaces + firstFace) * depth;
+                memcpy(pDesc, osgd + headerSize + descSize * srcImage,
+                       descSize * numFaces * depth);
+                pDesc += descSize * numFaces * depth;
+            }
+            firstImage += orig->numLayers * orig->numFaces * depth;
+        }
+        memcpy(pDesc, osgd + headerSize + descSize * origImageCount, tailSize);
+    } else if (orig->_private->_sgdByteLength > 0) {
+        This->_private->_supercompressionGlobalData
+                        = (ktx_uint8_t*)malloc(orig->_private->_sgdByteLength);
+        if (!This->_private->_supercompressionGlobalData) {
+            result = KTX_OUT_OF_MEMORY;
+            goto cleanup;
+        }
+        memcpy(This->_private->_supercompressionGlobalData,
+               orig->_private->_supercompressionGlobalData,
+               orig->_private->_sgdByteLength);
+        This->_private->_sgdByteLength = orig->_private->_sgdByteLength;
+    }
+
+    free(pDeflatedData);
+    free(pInflatedData);
+    ZSTD_freeDCtx(dctx);
+    return KTX_SUCCESS;
+
+cleanup:
+    free(pDeflatedData);
+    free(pInflatedData);
+    ZSTD_freeDCtx(dctx);
+    ktxTexture2_destruct(This);
+    return result;
+}
+
 bool isSrgbFormat(VkFormat format);
 bool isNotSrgbFormatButHasSrgbVariant(VkFormat format);
 
@@ -1343,6 +1756,103 @@ ktxTexture2_Create(const ktxTextureCreateInfo* const createInfo,
 
  }
 
+/**
+ * @memberof ktxTexture2
+ * @~English
+ * @brief Create a ktxTexture2 holding a range of levels, layers and faces
+ *        of a ktxTexture2.
+ *
+ * The address of the newly created ktxTexture2 is written to the location
+ * pointed at by @p newTex. Level @p firstLevel of @p orig becomes level 0
+ * of the new texture and its base dimensions are set accordingly.
+ *
+ * If the image data of @p orig has not been loaded, only the data of the
+ * selected levels is read from its source. @p orig keeps its source so
+ * further subsets can be created from it. Data supercompressed with
+ * Zstd or ZLIB is inflated, so the new texture is not supercompressed.
+ * BasisLZ data stays supercompressed but the new texture only describes
+ * the selected images, so ktxTexture2\_TranscodeBasis() only transcodes
+ * those.
+ *
+ * @param[in]     orig       pointer to the source texture.
+ * @param[in]     firstLevel index of the first level to keep.
+ * @param[in]     numLevels  number of levels to keep.
+ * @param[in]     firstLayer index of the first layer to keep.
+ * @param[in]     numLayers  number of layers to keep.
+ * @param[in]     firstFace  index of the first face to keep.
+ * @param[in]     numFaces   number of faces to keep. Must be 1 or the number
+ *                           of faces of @p orig.
+ * @param[in,out] newTex     pointer to a location in which store the address
+ *                           of the newly created texture.
+ *
+ * @return      KTX_SUCCESS on success, other KTX_* enum values on error.
+ *
+ * @exception KTX_INVALID_VALUE @p orig or @p newTex is NULL, a count is 0,
+ *                              a range extends beyond the source or
+ *                              @p numFaces is invalid.
+ * @exception KTX_INVALID_OPERATION
+ *                              @p orig has neither image data nor an active
+ *                              source, or it is a video and @p firstLayer
+ *                              is not 0. Video P-frames depend on the
+ *                              preceding frames.
+ * @exception KTX_UNSUPPORTED_FEATURE
+ *                              @p orig uses an unknown supercompression
+ *                              scheme.
+ * @exception KTX_OUT_OF_MEMORY Not enough memory for the texture data.
+ */
+KTX_error_code
+ktxTexture2_CreateSubset(ktxTexture2* orig,
+                         ktx_uint32_t firstLevel, ktx_uint32_t numLevels,
+                         ktx_uint32_t firstLayer, ktx_uint32_t numLayers,
+                         ktx_uint32_t firstFace, ktx_uint32_t numFaces,
+                         ktxTexture2** newTex)
+{
+    KTX_error_code result;
+
+    if (orig == NULL || newTex == NULL)
+        return KTX_INVALID_VALUE;
+
+    if (numLevels == 0 || firstLevel >= orig->numLevels
+        || numLevels > orig->numLevels - firstLevel)
+        return KTX_INVALID_VALUE;
+    if (numLayers == 0 || firstLayer >= orig->numLayers
+        || numLayers > orig->numLayers - firstLayer)
+        return KTX_INVALID_VALUE;
+    if ((numFaces != 1 && numFaces != orig->numFaces)
+        || firstFace >= orig->numFaces
+        || numFaces > orig->numFaces - firstFace)
+        return KTX_INVALID_VALUE;
+
+    if (!orig->pData && !ktxTexture_isActiveStream((ktxTexture*)orig))
+        return KTX_INVALID_OPERATION;
+    if (orig->isVideo && firstLayer != 0)
+        return KTX_INVALID_OPERATION;
+
+    switch (orig->supercompressionScheme) {
+      case KTX_SS_NONE:
+      case KTX_SS_BASIS_LZ:
+      case KTX_SS_ZSTD:
+      case KTX_SS_ZLIB:
+        break;
+      default:
+        return KTX_UNSUPPORTED_FEATURE;
+    }
+
+    ktxTexture2* tex = (ktxTexture2*)malloc(sizeof(ktxTexture2));
+    if (tex == NULL)
+        return KTX_OUT_OF_MEMORY;
+
+    result = ktxTexture2_constructSubset(tex, orig, firstLevel, numLevels,
+                                         firstLayer, numLayers,
+                                         firstFace, numFaces);
+    if (result != KTX_SUCCESS) {
+        free(tex);
+    } else {
+        *newTex = tex;
+    }
+    return result;
+}
+
 /**
  * @defgroup reader Reader
  * @brief Read KTX-formatted data.
@@ -57,8 +57,58 @@ ktxTexture2_constructFromStreamAndHeader(ktxTexture2* This, ktxStream* pStream,
 ktx_uint64_t ktxTexture2_calcDataSizeTexture(ktxTexture2* This);
 ktx_size_t ktxTexture2_calcLevelOffset(ktxTexture2* This, ktx_uint32_t level);
 ktx_uint32_t ktxTexture2_calcRequiredLevelAlignment(ktxTexture2* This);
+ktx_uint32_t ktxTexture2_calcPostInflationLevelAlignment(ktxTexture2* This);
 ktx_uint64_t ktxTexture2_levelFileOffset(ktxTexture2* This, ktx_uint32_t level);
 ktx_uint64_t ktxTexture2_levelDataOffset(ktxTexture2* This, ktx_uint32_t level);
+KTX_error_code
+ktxTexture2_readLevelDataInt(ktxTexture2* This, ktx_uint32_t level,
+                             ktx_size_t offset, ktx_size_t count,
+                             ktx_uint8_t* pDest);
+/* Declared at file scope so the prototype names the same type as zstd.h. */
+struct ZSTD_DCtx_s;
+KTX_error_code
+ktxTexture2_inflateLevelInt(ktxTexture2* This, struct ZSTD_DCtx_s* dctx,
+                            ktx_uint32_t level, ktx_uint8_t* pDeflatedData,
+                            ktx_uint8_t* pInflatedData);
+/* Thread-safe, runs basisu_transcoder_init exactly once per process. */
+void ktxInitBasisuTranscoder(void);
+
+/* Not yet part of ktx.h. Declared here for the tools, which link libktx
+   statically. */
+KTX_error_code
+ktxTexture2_CreateSubset(ktxTexture2* orig,
+                         ktx_uint32_t firstLevel, ktx_uint32_t numLevels,
+                         ktx_uint32_t firstLayer, ktx_uint32_t numLayers,
+                         ktx_uint32_t firstFace, ktx_uint32_t numFaces,
+                         ktxTexture2** newTex);
+KTX_error_code
+ktxTexture2_WriteDeflatedToStream(ktxTexture2* This, ktxStream* dststr,
+                                  ktxSupercmpScheme scheme,
+                                  ktx_uint32_t compressionLevel);
+KTX_error_code
+ktxTexture2_WriteDeflatedToStdioStream(ktxTexture2* This, FILE* dstsstr,
+                                       ktxSupercmpScheme scheme,
+                                       ktx_uint32_t compressionLevel);
+KTX_error_code
+ktxTexture2_TranscodeImageToBuffer(ktxTexture2* This,
+                                   ktx_uint32_t level, ktx_uint32_t layer,
+                                   ktx_uint32_t faceSlice,
+                                   ktx_transcode_fmt_e outputFormat,
+                                   ktx_transcode_flags transcodeFlags,
+                                   ktx_uint8_t* pDst, ktx_size_t dstSize,
+                                   ktx_uint32_t rowPitch,
+                                   ktx_uint32_t rowCount,
+                                   ktx_size_t* pWritten);
+
+/* Receives the begin (begin != 0) and end of the encoding stages of libktx,
+   e.g. the per level and per worker thread spans of the ASTC encoder. May be
+   called concurrently from the worker threads of the encoder. */
+typedef void (*ktxTraceFunction)(void* userData, const char* name,
+                                 ktx_uint32_t level, ktx_bool_t begin);
+/* Sets the trace function for the encodes started by the calling thread.
+   Pass NULL to disable tracing, which is the default. */
+void
+ktxSetThreadTraceFunction(ktxTraceFunction traceFunction, void* userData);
 
 #ifdef __cplusplus
 }
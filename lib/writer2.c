@@ -99,6 +99,56 @@ strnstr(const char *haystack, const char *needle, size_t len)
 }
 #endif
 
+/** @internal
+ * @~English
+ * @brief Check that a hash list only contains keys allowed in a KTX2 file.
+ *
+ * @param[in] head  the head of the hash list.
+ *
+ * @return    KTX_SUCCESS on success, other KTX_* enum values on error.
+ *
+ * @exception KTX_INVALID_OPERATION
+ *                  a key uses the reserved "ktx" prefix or is an
+ *                  unrecognized key with the "KTX" prefix.
+ */
+static KTX_error_code
+checkMetadataKeys(ktxHashList head)
+{
+    ktxHashListEntry* pEntry;
+
+    for (pEntry = head; pEntry != NULL; pEntry = ktxHashList_Next(pEntry)) {
+        unsigned int keyLen;
+        char* key;
+
+        ktxHashListEntry_GetKey(pEntry, &keyLen, &key);
+        if (strncasecmp(key, "KTX", 3) == 0) {
+            ktx_uint32_t i;
+            const char* knownKeys[] = {
+              "KTXcubemapIncomplete",
+              "KTXorientation",
+              "KTXglFormat",
+              "KTXdxgiFormat__",
+              "KTXmetalPixelFormat",
+              "KTXswizzle",
+              "KTXwriter",
+              "KTXwriterScParams",
+              "KTXastcDecodeMode",
+              "KTXanimData"
+            };
+            if (strncmp(key, "ktx", 3) == 0)
+                return KTX_INVALID_OPERATION;
+            // Check for unrecognized KTX keys.
+            for (i = 0; i < sizeof(knownKeys)/sizeof(char*); i++) {
+                if (strcmp(key, knownKeys[i]) == 0)
+                    break;
+            }
+            if (i == sizeof(knownKeys)/sizeof(char*))
+                return KTX_INVALID_OPERATION;
+        }
+    }
+    return KTX_SUCCESS;
+}
+
 /** @internal
  * @~English
  * @brief Append the library's id to the KTXwriter value.
@@ -423,36 +473,9 @@ ktxTexture2_WriteToStream(ktxTexture2* This, ktxStream* dststr)
 
     ktxHashListEntry* pEntry;
     // Check for invalid metadata.
-    for (pEntry = This->kvDataHead; pEntry != NULL; pEntry = ktxHashList_Next(pEntry)) {
-        unsigned int keyLen;
-        char* key;
-
-        ktxHashListEntry_GetKey(pEntry, &keyLen, &key);
-        if (strncasecmp(key, "KTX", 3) == 0) {
-            ktx_uint32_t i;
-            const char* knownKeys[] = {
-              "KTXcubemapIncomplete",
-              "KTXorientation",
-              "KTXglFormat",
-              "KTXdxgiFormat__",
-              "KTXmetalPixelFormat",
-              "KTXswizzle",
-              "KTXwriter",
-              "KTXwriterScParams",
-              "KTXastcDecodeMode",
-              "KTXanimData"
-            };
-            if (strncmp(key, "ktx", 3) == 0)
-                return KTX_INVALID_OPERATION;
-            // Check for unrecognized KTX keys.
-            for (i = 0; i < sizeof(knownKeys)/sizeof(char*); i++) {
-                if (strcmp(key, knownKeys[i]) == 0)
-                    break;
-            }
-            if (i == sizeof(knownKeys)/sizeof(char*))
-                return KTX_INVALID_OPERATION;
-        }
-    }
+    result = checkMetadataKeys(This->kvDataHead);
+    if (result != KTX_SUCCESS)
+        return result;
 
 #if defined(TestNoMetadata)
     if (!__disableWriterMetadata__) {
@@ -987,4 +1010,292 @@ ktxTexture2_DeflateZLIB(ktxTexture2* This, ktx_uint32_t compressionLevel)
     return KTX_SUCCESS;
 }
 
+/**
+ * @memberof ktxTexture2
+ * @~English
+ * @brief Deflate a ktxTexture2 level by level while writing it to a ktxStream.
+ *
+ * The image data does not need to be loaded. Each level is read from the
+ * texture's loaded data or, if it was created without loading the image
+ * data, from its source stream. Levels already supercompressed with
+ * Zstandard or ZLIB are inflated first, so this can also be used to
+ * recompress a texture. Every level is then deflated and appended to
+ * @p dststr, so at most the data of a single level is held in memory at a
+ * time, unlike when calling ktxTexture2_DeflateZstd or
+ * ktxTexture2_DeflateZLIB followed by ktxTexture2_WriteToStream.
+ *
+ * The level index is written once all levels have been deflated by seeking
+ * back in @p dststr, which therefore must not be a pipe.
+ *
+ * The texture object itself is not modified other than the library id being
+ * added to its KTXwriter metadata, as in ktxTexture2_WriteToStream.
+ *
+ * @param[in] This      pointer to the ktxTexture2 object of interest.
+ * @param[in] dststr    destination stream.
+ * @param[in] scheme    @c KTX_SS_ZSTD or @c KTX_SS_ZLIB.
+ * @param[in] compressionLevel set speed vs compression ratio trade-off.
+ *            See ktxTexture2_DeflateZstd and ktxTexture2_DeflateZLIB for the
+ *            accepted values.
+ *
+ * @return      KTX_SUCCESS on success, other KTX_* enum values on error.
+ *
+ * @exception KTX_INVALID_VALUE @p This or @p dststr is NULL, @p scheme is not
+ *                              Zstandard or ZLIB or @p compressionLevel is
+ *                              out of range.
+ * @exception KTX_INVALID_OPERATION
+ *                              The texture is supercompressed with a scheme
+ *                              other than Zstandard or ZLIB or its metadata
+ *                              is invalid.
+ * @exception KTX_FILE_ISPIPE   @p dststr does not support seeking.
+ * @exception KTX_OUT_OF_MEMORY Not enough memory for a level.
+ * @exception KTX_FILE_WRITE_ERROR
+ *                              An error occurred while writing the file.
+ */
+KTX_error_code
+ktxTexture2_WriteDeflatedToStream(ktxTexture2* This, ktxStream* dststr,
+                                  ktxSupercmpScheme scheme,
+                                  ktx_uint32_t compressionLevel)
+{
+    KTX_header2 header = { .identifier = KTX2_IDENTIFIER_REF };
+    ktxLevelIndexEntry* srcIndex;
+    ktxLevelIndexEntry* levelIndex = NULL;
+    ktx_uint8_t* pStored = NULL;
+    ktx_uint8_t* pInflated = NULL;
+    ktx_uint8_t* pDeflated = NULL;
+    ktx_uint8_t* pKvd = NULL;
+    ktx_uint32_t kvdLen = 0;
+    ktx_uint32_t levelIndexSize;
+    ktx_uint64_t dataOffset;
+    ktx_off_t startPos, endPos;
+    ZSTD_CCtx* cctx = NULL;
+    ZSTD_DCtx* dctx = NULL;
+    ktxHashListEntry* pEntry = NULL;
+    KTX_error_code result;
+
+    if (!This || !dststr)
+        return KTX_INVALID_VALUE;
+
+    if (scheme != KTX_SS_ZSTD && scheme != KTX_SS_ZLIB)
+        return KTX_INVALID_VALUE;
+
+    if (This->supercompressionScheme != KTX_SS_NONE
+        && This->supercompressionScheme != KTX_SS_ZSTD
+        && This->supercompressionScheme != KTX_SS_ZLIB)
+        return KTX_INVALID_OPERATION;
+
+    result = checkMetadataKeys(This->kvDataHead);
+    if (result != KTX_SUCCESS)
+        return result;
+
+    result = dststr->getpos(dststr, &startPos);
+    if (result != KTX_SUCCESS)
+        return result;
+
+    result = ktxHashList_FindEntry(&This->kvDataHead, KTX_WRITER_KEY, &pEntry);
+    result = appendLibId(&This->kvDataHead, pEntry);
+    if (result != KTX_SUCCESS)
+        return result;
+
+    ktxHashList_Sort(&This->kvDataHead); // KTX2 requires sorted metadata.
+    ktxHashList_Serialize(&This->kvDataHead, &kvdLen, &pKvd);
+
+    header.vkFormat = This->vkFormat;
+    header.typeSize = This->_protected->_typeSize;
+    header.pixelWidth = This->baseWidth;
+    header.pixelHeight = This->numDimensions > 1 ? This->baseHeight : 0;
+    header.pixelDepth = This->numDimensions > 2 ? This->baseDepth : 0;
+    header.layerCount = This->isArray ? This->numLayers : 0;
+    header.faceCount = This->numFaces;
+    header.levelCount = This->generateMipmaps ? 0 : This->numLevels;
+    header.supercompressionScheme = scheme;
+
+    levelIndexSize = sizeof(ktxLevelIndexEntry) * This->numLevels;
+    header.dataFormatDescriptor.byteOffset = sizeof(header) + levelIndexSize;
+    header.dataFormatDescriptor.byteLength = *This->pDfd;
+    header.keyValueData.byteOffset = kvdLen != 0
+        ? header.dataFormatDescriptor.byteOffset
+          + header.dataFormatDescriptor.byteLength
+        : 0;
+    header.keyValueData.byteLength = kvdLen;
+    // Supercompressed levels only require 1 byte alignment, so the level
+    // data directly follows the metadata.
+    dataOffset = (ktx_uint64_t)header.dataFormatDescriptor.byteOffset
+                 + header.dataFormatDescriptor.byteLength + kvdLen;
+
+    // The level index is rewritten with the final values at the end.
+    levelIndex = calloc(This->numLevels, sizeof(ktxLevelIndexEntry));
+    if (!levelIndex) {
+        result = KTX_OUT_OF_MEMORY;
+        goto cleanup;
+    }
+
+    result = dststr->write(dststr, &header, sizeof(header), 1);
+    if (result == KTX_SUCCESS)
+        result = dststr->write(dststr, levelIndex, levelIndexSize, 1);
+    if (result == KTX_SUCCESS)
+        result = dststr->write(dststr, This->pDfd, 1, *This->pDfd);
+    if (result == KTX_SUCCESS && kvdLen != 0)
+        result = dststr->write(dststr, pKvd, 1, kvdLen);
+    if (result != KTX_SUCCESS)
+        goto cleanup;
+
+    if (scheme == KTX_SS_ZSTD) {
+        cctx = ZSTD_createCCtx();
+        if (cctx == NULL) {
+            result = KTX_OUT_OF_MEMORY;
+            goto cleanup;
+        }
+    }
+    if (This->supercompressionScheme == KTX_SS_ZSTD) {
+        dctx = ZSTD_createDCtx();
+        if (dctx == NULL) {
+            result = KTX_OUT_OF_MEMORY;
+            goto cleanup;
+        }
+    }
+
+    srcIndex = This->_private->_levelIndex;
+    for (ktx_int32_t level = This->numLevels - 1; level >= 0; level--) {
+        ktx_size_t storedLength = srcIndex[level].byteLength;
+        ktx_size_t levelLength = This->supercompressionScheme == KTX_SS_NONE
+                                 ? storedLength
+                                 : srcIndex[level].uncompressedByteLength;
+        ktx_uint8_t* pLevel;
+        ktx_size_t deflatedLength;
+
+        pStored = malloc(storedLength);
+        if (pStored == NULL) {
+            result = KTX_OUT_OF_MEMORY;
+            goto cleanup;
+        }
+        result = ktxTexture2_readLevelDataInt(This, level, 0, storedLength,
+                                              pStored);
+        if (result != KTX_SUCCESS)
+            goto cleanup;
+
+        if (This->supercompressionScheme != KTX_SS_NONE) {
+            pInflated = malloc(levelLength);
+            if (pInflated == NULL) {
+                result = KTX_OUT_OF_MEMORY;
+                goto cleanup;
+            }
+            result = ktxTexture2_inflateLevelInt(This, dctx, level, pStored,
+                                                 pInflated);
+            if (result != KTX_SUCCESS)
+                goto cleanup;
+            free(pStored);
+            pStored = NULL;
+            pLevel = pInflated;
+        } else {
+            pLevel = pStored;
+        }
+
+        if (scheme == KTX_SS_ZSTD) {
+            ktx_size_t bound = ZSTD_compressBound(levelLength);
+            pDeflated = malloc(bound);
+            if (pDeflated == NULL) {
+                result = KTX_OUT_OF_MEMORY;
+                goto cleanup;
+            }
+            deflatedLength = ZSTD_compressCCtx(cctx, pDeflated, bound,
+                                               pLevel, levelLength,
+                                               compressionLevel);
+            if (ZSTD_isError(deflatedLength)) {
+                switch (ZSTD_getErrorCode(deflatedLength)) {
+                  case ZSTD_error_parameter_outOfBound:
+                    result = KTX_INVALID_VALUE;
+                    break;
+                  case ZSTD_error_memory_allocation:
+                    result = KTX_OUT_OF_MEMORY;
+                    break;
+                  default:
+                    result = KTX_INVALID_OPERATION;
+                    break;
+                }
+                goto cleanup;
+            }
+        } else {
+            deflatedLength = ktxCompressZLIBBounds(levelLength);
+            pDeflated = malloc(deflatedLength);
+            if (pDeflated == NULL) {
+                result = KTX_OUT_OF_MEMORY;
+                goto cleanup;
+            }
+            result = ktxCompressZLIBInt(pDeflated, &deflatedLength,
+                                        pLevel, levelLength,
+                                        compressionLevel);
+            if (result != KTX_SUCCESS)
+                goto cleanup;
+        }
+
+        result = dststr->write(dststr, pDeflated, 1, deflatedLength);
+        if (result != KTX_SUCCESS)
+            goto cleanup;
+
+        levelIndex[level].byteOffset = dataOffset;
+        levelIndex[level].byteLength = deflatedLength;
+        levelIndex[level].uncompressedByteLength = levelLength;
+        dataOffset += deflatedLength;
+
+        free(pStored);
+        free(pInflated);
+        free(pDeflated);
+        pStored = pInflated = pDeflated = NULL;
+    }
+
+    // Back-patch the level index.
+    result = dststr->getpos(dststr, &endPos);
+    if (result == KTX_SUCCESS)
+        result = dststr->setpos(dststr, startPos + sizeof(header));
+    if (result == KTX_SUCCESS)
+        result = dststr->write(dststr, levelIndex, levelIndexSize, 1);
+    if (result == KTX_SUCCESS)
+        result = dststr->setpos(dststr, endPos);
+
+cleanup:
+    ZSTD_freeCCtx(cctx);
+    ZSTD_freeDCtx(dctx);
+    free(pStored);
+    free(pInflated);
+    free(pDeflated);
+    free(levelIndex);
+    free(pKvd);
+    return result;
+}
+
+/**
+ * @memberof ktxTexture2
+ * @~English
+ * @brief Deflate a ktxTexture2 level by level while writing it to a stdio
+ *        stream.
+ *
+ * See ktxTexture2_WriteDeflatedToStream for details. @p dstsstr must be
+ * seekable.
+ *
+ * @param[in] This      pointer to the ktxTexture2 object of interest.
+ * @param[in] dstsstr   destination stdio stream.
+ * @param[in] scheme    @c KTX_SS_ZSTD or @c KTX_SS_ZLIB.
+ * @param[in] compressionLevel set speed vs compression ratio trade-off.
+ *
+ * @return      KTX_SUCCESS on success, other KTX_* enum values on error.
+ */
+KTX_error_code
+ktxTexture2_WriteDeflatedToStdioStream(ktxTexture2* This, FILE* dstsstr,
+                                       ktxSupercmpScheme scheme,
+                                       ktx_uint32_t compressionLevel)
+{
+    ktxStream stream;
+    KTX_error_code result;
+
+    if (!This)
+        return KTX_INVALID_VALUE;
+
+    result = ktxFileStream_construct(&stream, dstsstr, KTX_FALSE);
+    if (result != KTX_SUCCESS)
+        return result;
+
+    return ktxTexture2_WriteDeflatedToStream(This, &stream, scheme,
+                                             compressionLevel);
+}
+
 /** @} */
@@ -0,0 +1,751 @@
+// vcpp-bench: repeatable microbenchmarks of the imageio and libktx hot paths.
+//
+// All inputs are synthetic images generated in-process with a fixed seed, so no assets are needed.
+// Every benchmark runs one untimed warm-up iteration followed by --repeat timed iterations; the
+// median is the reported time. Results are written as JSON. With --baseline the results are compared
+// against a previously stored JSON report and every benchmark whose median got slower by more than
+// --threshold is flagged as a regression, which also sets the exit code to 2.
+//
+// Usage: vcpp-bench [--size <w>x<h>] [--repeat <n>] [--threads <n>] [--filter <substring>] [--long]
+//                   [--output <file.json>] [--baseline <file.json>] [--threshold <fraction>]
+//                   [--compare <file.json>] [--list]
+
+#include "image.hpp"
+#include "imagecodec.hpp"
+#include "imageio.h"
+#include "utility.h"
+#include "ktx.h"
+#include "vkformat_enum.h"
+#include "dfdutils/dfd.h"
+#include "ktxint.h"
+#include "texture2.h" // ktxTexture2_TranscodeImageToBuffer, not yet in ktx.h
+
+#include <OpenImageIO/imageio.h>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using ktx::KTXTexture2;
+
+namespace
+{
+    struct Options
+    {
+        uint32_t width = 512;
+        uint32_t height = 512;
+        uint32_t repeat = 5;
+        uint32_t threads = 1; // A single encoder thread keeps the timings comparable between machines
+        std::string filter;
+        bool longRunning = false; // Include ASTC exhaustive and UASTC level 4
+        bool list = false;
+        std::string output;
+        std::string baseline;
+        std::string compare;
+        double threshold = 0.10;
+    };
+
+    struct Result
+    {
+        std::string name;
+        uint64_t bytes = 0; // Bytes of input processed by one iteration
+        uint32_t iterations = 0;
+        double minMs = 0.0;
+        double medianMs = 0.0;
+        double meanMs = 0.0;
+    };
+
+    // Consumes a value so the optimizer cannot drop the work producing it.
+    volatile uint64_t g_sink = 0;
+
+    template <typename T>
+    void keep(const T &value)
+    {
+        uint64_t bits = 0;
+        std::memcpy(&bits, &value, std::min(sizeof(bits), sizeof(value)));
+        g_sink = g_sink + bits;
+    }
+
+    void check(ktx_error_code_e ret, const char *what)
+    {
+        if (ret != KTX_SUCCESS)
+            throw std::runtime_error(std::string(what) + " failed: " + ktxErrorString(ret));
+    }
+
+    class Bench
+    {
+    public:
+        explicit Bench(const Options &options) : options(options) {}
+
+        bool selected(const std::string &name) const
+        {
+            return options.filter.empty() || name.find(options.filter) != std::string::npos;
+        }
+
+        // Runs body once to warm up and then options.repeat times. prepare runs untimed before
+        // each iteration to restore the state body consumes, e.g. a fresh copy of a texture.
+        void run(const std::string &name, uint64_t bytes, const std::function<void()> &prepare,
+                 const std::function<void()> &body)
+        {
+            if (!selected(name))
+                return;
+            if (options.list)
+            {
+                std::cout << name << "\n";
+                return;
+            }
+
+            std::vector<double> times;
+            for (uint32_t i = 0; i <= options.repeat; ++i)
+            {
+                prepare();
+                const auto start = std::chrono::steady_clock::now();
+                body();
+                const auto end = std::chrono::steady_clock::now();
+                if (i > 0)
+                    times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+            }
+
+            std::sort(times.begin(), times.end());
+            Result result;
+            result.name = name;
+            result.bytes = bytes;
+            result.iterations = static_cast<uint32_t>(times.size());
+            result.minMs = times.front();
+            result.medianMs = times.size() % 2 ? times[times.size() / 2]
+                                               : (times[times.size() / 2 - 1] + times[times.size() / 2]) / 2.0;
+            result.meanMs = std::accumulate(times.begin(), times.end(), 0.0) / times.size();
+            std::cerr << name << ": " << result.medianMs << " ms\n";
+            results.push_back(std::move(result));
+        }
+
+        void run(const std::string &name, uint64_t bytes, const std::function<void()> &body)
+        {
+            run(name, bytes, [] {}, body);
+        }
+
+        const std::vector<Result> &getResults() const { return results; }
+
+    private:
+        const Options &options;
+        std::vector<Result> results;
+    };
+
+    // -------------------------------------------------------------------------------------------------
+
+    // Smooth gradients with a band of noise and hard edges, so resamplers, encoders and deflate all
+    // see a mix of easy and hard content.
+    std::unique_ptr<rgba8image> makeImage(uint32_t width, uint32_t height)
+    {
+        auto image = std::make_unique<rgba8image>(width, height);
+        std::mt19937 rng(0x5eed);
+        std::uniform_int_distribution<int> noise(0, 255);
+        for (uint32_t y = 0; y < height; ++y)
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                auto &pixel = (*image)(x, y);
+                const bool edge = ((x / 32) + (y / 32)) % 2 == 0;
+                const bool noisy = y > height / 2 && y < height * 3 / 4;
+                pixel.comps[0] = static_cast<uint8_t>(x * 255 / std::max(width - 1, 1u));
+                pixel.comps[1] = static_cast<uint8_t>(y * 255 / std::max(height - 1, 1u));
+                pixel.comps[2] = noisy ? static_cast<uint8_t>(noise(rng)) : static_cast<uint8_t>(edge ? 224 : 32);
+                pixel.comps[3] = static_cast<uint8_t>(edge ? 255 : 128);
+            }
+        return image;
+    }
+
+    std::unique_ptr<rgba32fimage> toFloat(rgba8image &image)
+    {
+        auto result = std::make_unique<rgba32fimage>(image.getWidth(), image.getHeight());
+        for (uint32_t y = 0; y < image.getHeight(); ++y)
+            for (uint32_t x = 0; x < image.getWidth(); ++x)
+                for (uint32_t c = 0; c < 4; ++c)
+                    (*result)(x, y).comps[c] = image(x, y).comps[c] / 255.0f * (c < 3 ? 4.0f : 1.0f); // Some HDR range
+        return result;
+    }
+
+    KTXTexture2 createTexture(rgba8image &image, VkFormat vkFormat)
+    {
+        ktxTextureCreateInfo createInfo;
+        std::memset(&createInfo, 0, sizeof(createInfo));
+        createInfo.vkFormat = vkFormat;
+        createInfo.baseWidth = image.getWidth();
+        createInfo.baseHeight = image.getHeight();
+        createInfo.baseDepth = 1;
+        createInfo.numDimensions = 2;
+        createInfo.numLevels = 1;
+        createInfo.numLayers = 1;
+        createInfo.numFaces = 1;
+        KTXTexture2 texture{nullptr};
+        check(ktxTexture2_Create(&createInfo, KTX_TEXTURE_CREATE_ALLOC_STORAGE, texture.pHandle()), "ktxTexture2_Create");
+        check(ktxTexture_SetImageFromMemory(texture, 0, 0, 0, static_cast<uint8_t *>(image), image.getByteCount()),
+              "ktxTexture_SetImageFromMemory");
+        return texture;
+    }
+
+    KTXTexture2 copyTexture(KTXTexture2 &texture)
+    {
+        KTXTexture2 copy{nullptr};
+        check(ktxTexture2_CreateCopy(texture, copy.pHandle()), "ktxTexture2_CreateCopy");
+        return copy;
+    }
+
+    // Writes an image file with OpenImageIO, which unlike imageio can write every format under test.
+    void writeFixture(const std::filesystem::path &path, const void *pixels, OIIO::TypeDesc pixelType,
+                      uint32_t width, uint32_t height, int channels, OIIO::TypeDesc fileType)
+    {
+        auto output = OIIO::ImageOutput::create(path.string());
+        if (!output)
+            throw std::runtime_error("No OpenImageIO writer for " + path.string());
+        const OIIO::ImageSpec spec(static_cast<int>(width), static_cast<int>(height), channels, fileType);
+        // Source pixels are always RGBA, fewer channels skip the trailing ones.
+        const auto pixelStride = static_cast<OIIO::stride_t>(4 * pixelType.size());
+        if (!output->open(path.string(), spec) || !output->write_image(pixelType, pixels, pixelStride) ||
+            !output->close())
+            throw std::runtime_error("Failed to write " + path.string() + ": " + output->geterror());
+    }
+
+    // -------------------------------------------------------------------------------------------------
+
+    void benchImage(Bench &bench, rgba8image &image8, rgba32fimage &image32f)
+    {
+        static const char *filters[] = {"box", "tent", "bell", "b-spline", "mitchell", "blackman",
+                                        "lanczos3", "lanczos4", "lanczos6", "lanczos12", "kaiser", "gaussian",
+                                        "catmullrom", "quadratic_interp", "quadratic_approx", "quadratic_mix"};
+        const auto width = image8.getWidth();
+        const auto height = image8.getHeight();
+        const auto wrap = basisu::Resampler::Boundary_Op::BOUNDARY_WRAP;
+
+        for (const auto filter : filters)
+            bench.run(std::string("resample/rgba8/") + filter, image8.getByteCount(), [&]
+                      { keep(image8.resample(width / 2, height / 2, filter, 1.0f, wrap)->getByteCount()); });
+        bench.run("resample/rgba32f/lanczos4", image32f.getByteCount(), [&]
+                  { keep(image32f.resample(width / 2, height / 2, "lanczos4", 1.0f, wrap)->getByteCount()); });
+
+        const TransferFunctionSRGB srgb;
+        const TransferFunctionLinear linear;
+        const ColorPrimariesBT709 bt709;
+        const ColorPrimariesDisplayP3 displayP3;
+        const auto primaryTransform = bt709.transformTo(displayP3);
+
+        rgba8image work8(width, height);
+        const auto restore8 = [&]
+        { std::memcpy(static_cast<uint8_t *>(work8), static_cast<uint8_t *>(image8), image8.getByteCount()); };
+        bench.run("transformColorSpace/rgba8/srgb-linear", image8.getByteCount(), restore8, [&]
+                  { work8.transformColorSpace(srgb, linear, nullptr); });
+        bench.run("transformColorSpace/rgba8/linear-srgb", image8.getByteCount(), restore8, [&]
+                  { work8.transformColorSpace(linear, srgb, nullptr); });
+        bench.run("transformColorSpace/rgba8/srgb-bt709-displayp3", image8.getByteCount(), restore8, [&]
+                  { work8.transformColorSpace(srgb, srgb, &primaryTransform); });
+        rgba32fimage work32f(width, height);
+        bench.run("transformColorSpace/rgba32f/srgb-linear", image32f.getByteCount(), [&]
+                  { std::memcpy(static_cast<uint8_t *>(work32f), static_cast<uint8_t *>(image32f), image32f.getByteCount()); },
+                  [&]
+                  { work32f.transformColorSpace(srgb, linear, nullptr); });
+
+        bench.run("getUNORM/rgba8-to-8", image8.getByteCount(), [&]
+                  { keep(image8.getUNORM(4, 8).size()); });
+        bench.run("getUNORM/rgba32f-to-16", image32f.getByteCount(), [&]
+                  { keep(image32f.getUNORM(4, 16).size()); });
+        bench.run("getSFloat/rgba32f-to-16", image32f.getByteCount(), [&]
+                  { keep(image32f.getSFloat(4, 16).size()); });
+        bench.run("getSFloat/rgba32f-to-32", image32f.getByteCount(), [&]
+                  { keep(image32f.getSFloat(4, 32).size()); });
+        bench.run("getE5B9G9R9/rgba32f", image32f.getByteCount(), [&]
+                  { keep(image32f.getE5B9G9R9().size()); });
+    }
+
+    void benchDecode(Bench &bench, const Options &options, rgba8image &image8, rgba32fimage &image32f)
+    {
+        const auto width = image8.getWidth();
+        const auto height = image8.getHeight();
+        const auto directory = std::filesystem::temp_directory_path() / "vcpp-bench";
+        if (!options.list)
+            std::filesystem::create_directories(directory);
+
+        struct Fixture
+        {
+            const char *name;
+            const void *pixels;
+            OIIO::TypeDesc pixelType;
+            int channels;
+            OIIO::TypeDesc fileType;
+        };
+        const Fixture fixtures[] = {
+            {"png", static_cast<uint8_t *>(image8), OIIO::TypeDesc::UINT8, 4, OIIO::TypeDesc::UINT8},
+            {"jpg", static_cast<uint8_t *>(image8), OIIO::TypeDesc::UINT8, 3, OIIO::TypeDesc::UINT8},
+            {"exr", static_cast<uint8_t *>(image32f), OIIO::TypeDesc::FLOAT, 4, OIIO::TypeDesc::HALF},
+            {"tga", static_cast<uint8_t *>(image8), OIIO::TypeDesc::UINT8, 4, OIIO::TypeDesc::UINT8},
+        };
+
+        for (const auto &fixture : fixtures)
+        {
+            const auto name = std::string("decode/") + fixture.name;
+            if (!bench.selected(name))
+                continue;
+
+            const auto path = directory / (std::string("synthetic.") + fixture.name);
+            std::uintmax_t fileSize = 0;
+            if (!options.list)
+            {
+                writeFixture(path, fixture.pixels, fixture.pixelType, width, height, fixture.channels, fixture.fileType);
+                fileSize = std::filesystem::file_size(path);
+            }
+
+            std::vector<uint8_t> pixels;
+            bench.run(name, fileSize, [&]
+                      {
+                const auto input = ImageInput::open(path.string());
+                if (!input)
+                    throw std::runtime_error("imageio cannot open " + path.string());
+                input->seekSubimage(0, 0);
+                pixels.resize(input->spec().imageByteCount());
+                input->readImage(pixels.data(), pixels.size());
+                keep(pixels.back()); });
+        }
+    }
+
+    void benchImageCodec(Bench &bench, rgba8image &image8, rgba32fimage &image32f)
+    {
+        struct Format
+        {
+            const char *name;
+            VkFormat vkFormat;
+            uint32_t typeSize;
+            std::vector<uint8_t> data;
+        };
+        Format formats[] = {
+            {"R8G8B8A8_UNORM", VK_FORMAT_R8G8B8A8_UNORM, 1, image8.getUNORM(4, 8)},
+            {"R16G16B16A16_SFLOAT", VK_FORMAT_R16G16B16A16_SFLOAT, 2, image32f.getSFloat(4, 16)},
+            {"R32G32B32A32_SFLOAT", VK_FORMAT_R32G32B32A32_SFLOAT, 4, image32f.getSFloat(4, 32)},
+            {"E5B9G9R9_UFLOAT_PACK32", VK_FORMAT_E5B9G9R9_UFLOAT_PACK32, 4, image32f.getE5B9G9R9()},
+            {"B10G11R11_UFLOAT_PACK32", VK_FORMAT_B10G11R11_UFLOAT_PACK32, 4, image32f.getB10G11R11()},
+        };
+
+        for (auto &format : formats)
+        {
+            std::unique_ptr<uint32_t, decltype(&std::free)> dfd(vk2dfd(format.vkFormat), &std::free);
+            if (!dfd)
+                throw std::runtime_error(std::string("No DFD for ") + format.name);
+            const ImageCodec codec(format.vkFormat, format.typeSize, dfd.get());
+            const auto blockSize = codec.getTexelBlockByteSize();
+
+            bench.run(std::string("ImageCodec/decodeFLOAT/") + format.name, format.data.size(), [&]
+                      {
+                glm::vec4 sum{0.0f};
+                for (size_t offset = 0; offset + blockSize <= format.data.size(); offset += blockSize)
+                    sum += codec.decodeFLOAT(format.data.data() + offset);
+                keep(sum.x + sum.y + sum.z + sum.w); });
+        }
+    }
+
+    void benchDeflate(Bench &bench, const Options &options, rgba8image &image8)
+    {
+        // --list only prints the names, so skip creating the source texture.
+        const uint64_t bytes = image8.getByteCount();
+        KTXTexture2 source{nullptr};
+        if (!options.list)
+        {
+            KTXTexture2 created = createTexture(image8, VK_FORMAT_R8G8B8A8_UNORM);
+            std::swap(source, created);
+        }
+        KTXTexture2 work{nullptr};
+        const auto fresh = [&]
+        {
+            KTXTexture2 copy = copyTexture(source);
+            std::swap(work, copy);
+        };
+
+        struct Scheme
+        {
+            const char *name;
+            ktx_error_code_e (*deflate)(ktxTexture2 *, ktx_uint32_t);
+            std::vector<ktx_uint32_t> levels;
+        };
+        const Scheme schemes[] = {
+            {"zstd", ktxTexture2_DeflateZstd, {1, 10, 18}},
+            {"zlib", ktxTexture2_DeflateZLIB, {1, 6, 9}},
+        };
+
+        for (const auto &scheme : schemes)
+            for (const auto level : scheme.levels)
+            {
+                const auto suffix = std::string(scheme.name) + "-" + std::to_string(level);
+                bench.run("deflate/" + suffix, bytes, fresh, [&]
+                          { check(scheme.deflate(work, level), "Deflate"); });
+
+                // Creating the texture from memory with its image data inflates it.
+                std::unique_ptr<ktx_uint8_t, decltype(&std::free)> file(nullptr, &std::free);
+                ktx_size_t size = 0;
+                if (!options.list && bench.selected("inflate/" + suffix))
+                {
+                    fresh();
+                    check(scheme.deflate(work, level), "Deflate");
+                    ktx_uint8_t *written = nullptr;
+                    check(ktxTexture2_WriteToMemory(work, &written, &size), "ktxTexture2_WriteToMemory");
+                    file.reset(written);
+                }
+                bench.run("inflate/" + suffix, bytes, [&]
+                          {
+                    KTXTexture2 loaded{nullptr};
+                    check(ktxTexture2_CreateFromMemory(file.get(), size, KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT,
+                                                       loaded.pHandle()), "ktxTexture2_CreateFromMemory");
+                    keep(loaded->dataSize); });
+            }
+    }
+
+    ktxBasisParams basisParams(const Options &options, bool uastc)
+    {
+        ktxBasisParams params{};
+        params.structSize = sizeof(params);
+        params.uastc = uastc ? KTX_TRUE : KTX_FALSE;
+        params.threadCount = options.threads;
+        return params;
+    }
+
+    void benchEncode(Bench &bench, const Options &options, rgba8image &image8)
+    {
+        const uint64_t bytes = image8.getByteCount();
+        KTXTexture2 source{nullptr};
+        if (!options.list)
+        {
+            KTXTexture2 created = createTexture(image8, VK_FORMAT_R8G8B8A8_SRGB);
+            std::swap(source, created);
+        }
+        KTXTexture2 work{nullptr};
+        const auto fresh = [&]
+        {
+            KTXTexture2 copy = copyTexture(source);
+            std::swap(work, copy);
+        };
+
+        struct Block
+        {
+            const char *name;
+            ktx_uint32_t dimension;
+        };
+        const Block blocks[] = {
+            {"4x4", KTX_PACK_ASTC_BLOCK_DIMENSION_4x4},
+            {"6x6", KTX_PACK_ASTC_BLOCK_DIMENSION_6x6},
+            {"8x8", KTX_PACK_ASTC_BLOCK_DIMENSION_8x8},
+            {"12x12", KTX_PACK_ASTC_BLOCK_DIMENSION_12x12},
+        };
+        struct Preset
+        {
+            const char *name;
+            ktx_uint32_t quality;
+        };
+        std::vector<Preset> presets = {
+            {"fastest", KTX_PACK_ASTC_QUALITY_LEVEL_FASTEST},
+            {"fast", KTX_PACK_ASTC_QUALITY_LEVEL_FAST},
+            {"medium", KTX_PACK_ASTC_QUALITY_LEVEL_MEDIUM},
+            {"thorough", KTX_PACK_ASTC_QUALITY_LEVEL_THOROUGH},
+        };
+        if (options.longRunning)
+            presets.push_back({"exhaustive", KTX_PACK_ASTC_QUALITY_LEVEL_EXHAUSTIVE});
+
+        for (const auto &block : blocks)
+            for (const auto &preset : presets)
+            {
+                ktxAstcParams params{};
+                params.structSize = sizeof(params);
+                params.threadCount = options.threads;
+                params.blockDimension = block.dimension;
+                params.mode = KTX_PACK_ASTC_ENCODER_MODE_LDR;
+                params.qualityLevel = preset.quality;
+                bench.run(std::string("encode/astc/") + block.name + "/" + preset.name, bytes, fresh, [&]
+                          { check(ktxTexture2_CompressAstcEx(work, &params), "ktxTexture2_CompressAstcEx"); });
+            }
+
+        for (const ktx_uint32_t qualityLevel : {64u, 128u, 255u})
+        {
+            auto params = basisParams(options, false);
+            params.compressionLevel = KTX_ETC1S_DEFAULT_COMPRESSION_LEVEL_;
+            params.qualityLevel = qualityLevel;
+            bench.run("encode/etc1s/q" + std::to_string(qualityLevel), bytes, fresh, [&]
+                      { check(ktxTexture2_CompressBasisEx(work, &params), "ktxTexture2_CompressBasisEx"); });
+        }
+
+        const ktx_uint32_t maxUastcLevel = options.longRunning ? KTX_PACK_UASTC_LEVEL_VERYSLOW : KTX_PACK_UASTC_LEVEL_SLOWER;
+        for (ktx_uint32_t level = KTX_PACK_UASTC_LEVEL_FASTEST; level <= maxUastcLevel; ++level)
+        {
+            auto params = basisParams(options, true);
+            params.uastcFlags = level;
+            bench.run("encode/uastc/level" + std::to_string(level), bytes, fresh, [&]
+                      { check(ktxTexture2_CompressBasisEx(work, &params), "ktxTexture2_CompressBasisEx"); });
+        }
+    }
+
+    void benchTranscode(Bench &bench, const Options &options, rgba8image &image8)
+    {
+        struct Target
+        {
+            const char *name;
+            ktx_transcode_fmt_e format;
+            uint32_t unitBytes; // Bytes per 4x4 block, or per pixel if uncompressed
+            bool uncompressed;
+        };
+        const Target targets[] = {
+            {"etc1-rgb", KTX_TTF_ETC1_RGB, 8, false},
+            {"etc2-rgba", KTX_TTF_ETC2_RGBA, 16, false},
+            {"eac-r11", KTX_TTF_ETC2_EAC_R11, 8, false},
+            {"eac-rg11", KTX_TTF_ETC2_EAC_RG11, 16, false},
+            {"bc1", KTX_TTF_BC1_RGB, 8, false},
+            {"bc3", KTX_TTF_BC3_RGBA, 16, false},
+            {"bc4", KTX_TTF_BC4_R, 8, false},
+            {"bc5", KTX_TTF_BC5_RG, 16, false},
+            {"bc7", KTX_TTF_BC7_RGBA, 16, false},
+            {"pvrtc1-4-rgba", KTX_TTF_PVRTC1_4_RGBA, 8, false},
+            {"pvrtc2-4-rgba", KTX_TTF_PVRTC2_4_RGBA, 8, false},
+            {"astc-4x4", KTX_TTF_ASTC_4x4_RGBA, 16, false},
+            {"rgba32", KTX_TTF_RGBA32, 4, true},
+            {"rgb565", KTX_TTF_RGB565, 2, true},
+            {"rgba4444", KTX_TTF_RGBA4444, 2, true},
+        };
+
+        struct Source
+        {
+            const char *name;
+            bool uastc;
+            KTXTexture2 texture{nullptr};
+        };
+        Source sources[] = {{"etc1s", false}, {"uastc", true}};
+
+        // Reference encoding, only made if one of its transcodes is selected.
+        const auto encode = [&](Source &source, const std::string &name)
+        {
+            if (options.list || !bench.selected(name) || source.texture.handle())
+                return;
+            auto params = basisParams(options, source.uastc);
+            params.compressionLevel = KTX_ETC1S_DEFAULT_COMPRESSION_LEVEL_;
+            params.qualityLevel = 128;
+            params.uastcFlags = KTX_PACK_UASTC_LEVEL_DEFAULT;
+            KTXTexture2 encoded = createTexture(image8, VK_FORMAT_R8G8B8A8_SRGB);
+            check(ktxTexture2_CompressBasisEx(encoded, &params), "ktxTexture2_CompressBasisEx");
+            std::swap(source.texture, encoded);
+        };
+
+        KTXTexture2 work{nullptr};
+        for (auto &source : sources)
+            for (const auto &target : targets)
+            {
+                const auto name = std::string("transcode/") + source.name + "/" + target.name;
+                encode(source, name);
+                bench.run(name, image8.getByteCount(), [&]
+                          {
+                    KTXTexture2 copy = copyTexture(source.texture);
+                    std::swap(work, copy); },
+                          [&]
+                          { check(ktxTexture2_TranscodeBasis(work, target.format, 0), "ktxTexture2_TranscodeBasis"); });
+            }
+
+        // Single images transcoded straight into caller memory with rows 256 byte aligned, as in a
+        // GPU staging buffer. The texture is not modified, so no copy is needed per iteration.
+        std::vector<uint8_t> buffer;
+        for (auto &source : sources)
+            for (const auto &target : targets)
+            {
+                const auto name = std::string("transcodeImage/") + source.name + "/" + target.name;
+                encode(source, name);
+                const auto columns = target.uncompressed ? image8.getWidth() : (image8.getWidth() + 3) / 4;
+                const auto rows = target.uncompressed ? image8.getHeight() : (image8.getHeight() + 3) / 4;
+                // PVRTC1 blocks depend on their neighbours and must be tightly packed
+                const bool packed = target.format == KTX_TTF_PVRTC1_4_RGBA;
+                const auto rowPitch = packed ? 0u : (columns * target.unitBytes + 255u) / 256u * 256u;
+                buffer.resize(static_cast<size_t>(packed ? columns * target.unitBytes : rowPitch) * rows);
+                bench.run(name, image8.getByteCount(), [&]
+                          { check(ktxTexture2_TranscodeImageToBuffer(source.texture, 0, 0, 0, target.format, 0,
+                                                                     buffer.data(), buffer.size(), rowPitch, 0,
+                                                                     nullptr),
+                                  "ktxTexture2_TranscodeImageToBuffer"); });
+            }
+    }
+
+    // -------------------------------------------------------------------------------------------------
+
+    nlohmann::json toJson(const Options &options, const std::vector<Result> &results)
+    {
+        nlohmann::json report;
+        report["version"] = 1;
+        report["config"] = {{"width", options.width},
+                            {"height", options.height},
+                            {"repeat", options.repeat},
+                            {"threads", options.threads}};
+        report["results"] = nlohmann::json::array();
+        for (const auto &result : results)
+        {
+            const auto seconds = result.medianMs / 1000.0;
+            report["results"].push_back({{"name", result.name},
+                                         {"bytes", result.bytes},
+                                         {"iterations", result.iterations},
+                                         {"min_ms", result.minMs},
+                                         {"median_ms", result.medianMs},
+                                         {"mean_ms", result.meanMs},
+                                         {"mb_per_s", seconds > 0.0 ? result.bytes / 1e6 / seconds : 0.0}});
+        }
+        return report;
+    }
+
+    nlohmann::json loadJson(const std::string &path)
+    {
+        std::ifstream file(path);
+        if (!file)
+            throw std::runtime_error("Cannot open " + path);
+        auto json = nlohmann::json::parse(file, nullptr, false);
+        if (json.is_discarded() || !json.contains("results"))
+            throw std::runtime_error(path + " is not a vcpp-bench report");
+        return json;
+    }
+
+    // Annotates the results in report with the change against baseline. Returns the number of
+    // regressions, i.e. the benchmarks whose median got slower by more than threshold.
+    int compareToBaseline(nlohmann::json &report, const nlohmann::json &baseline, double threshold)
+    {
+        std::map<std::string, double> baselineMedians;
+        for (const auto &result : baseline["results"])
+            baselineMedians[result.at("name").get<std::string>()] = result.at("median_ms").get<double>();
+
+        if (baseline.contains("config") && report.contains("config") && baseline["config"] != report["config"])
+            std::cerr << "warning: the baseline was recorded with a different configuration: "
+                      << baseline["config"].dump() << "\n";
+
+        int regressions = 0;
+        for (auto &result : report["results"])
+        {
+            const auto it = baselineMedians.find(result.at("name").get<std::string>());
+            if (it == baselineMedians.end() || it->second <= 0.0)
+                continue;
+            const auto change = result.at("median_ms").get<double>() / it->second - 1.0;
+            const bool regression = change > threshold;
+            result["baseline_median_ms"] = it->second;
+            result["change"] = change;
+            result["regression"] = regression;
+            if (regression)
+            {
+                ++regressions;
+                std::cerr << "REGRESSION " << result.at("name").get<std::string>() << ": "
+                          << it->second << " ms -> " << result.at("median_ms").get<double>() << " ms (+"
+                          << change * 100.0 << "%)\n";
+            }
+        }
+        report["regressions"] = regressions;
+        return regressions;
+    }
+
+    Options parseOptions(int argc, char *argv[])
+    {
+        Options options;
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            const auto value = [&]() -> std::string
+            {
+                if (i + 1 >= argc)
+                    throw std::runtime_error("Missing value for " + arg);
+                return argv[++i];
+            };
+
+            if (arg == "--size")
+            {
+                const auto size = value();
+                const auto x = size.find('x');
+                if (x == std::string::npos)
+                    throw std::runtime_error("--size must be <width>x<height>");
+                options.width = static_cast<uint32_t>(std::stoul(size.substr(0, x)));
+                options.height = static_cast<uint32_t>(std::stoul(size.substr(x + 1)));
+            }
+            else if (arg == "--repeat")
+                options.repeat = std::max(1u, static_cast<uint32_t>(std::stoul(value())));
+            else if (arg == "--threads")
+                options.threads = std::max(1u, static_cast<uint32_t>(std::stoul(value())));
+            else if (arg == "--filter")
+                options.filter = value();
+            else if (arg == "--long")
+                options.longRunning = true;
+            else if (arg == "--list")
+                options.list = true;
+            else if (arg == "--output")
+                options.output = value();
+            else if (arg == "--baseline")
+                options.baseline = value();
+            else if (arg == "--compare")
+                options.compare = value();
+            else if (arg == "--threshold")
+                options.threshold = std::stod(value());
+            else
+                throw std::runtime_error("Unknown argument " + arg);
+        }
+        if (options.width < 16 || options.height < 16)
+            throw std::runtime_error("--size must be at least 16x16");
+        return options;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        const auto options = parseOptions(argc, argv);
+
+        nlohmann::json report;
+        if (!options.compare.empty())
+        {
+            // Compare two stored reports without running anything.
+            report = loadJson(options.compare);
+        }
+        else
+        {
+            Bench bench(options);
+            const auto image8 = makeImage(options.width, options.height);
+            const auto image32f = toFloat(*image8);
+
+            benchImage(bench, *image8, *image32f);
+            benchDecode(bench, options, *image8, *image32f);
+            benchImageCodec(bench, *image8, *image32f);
+            benchDeflate(bench, options, *image8);
+            benchEncode(bench, options, *image8);
+            benchTranscode(bench, options, *image8);
+
+            if (options.list)
+                return 0;
+            report = toJson(options, bench.getResults());
+        }
+
+        int regressions = 0;
+        if (!options.baseline.empty())
+            regressions = compareToBaseline(report, loadJson(options.baseline), options.threshold);
+
+        if (options.output.empty())
+        {
+            std::cout << report.dump(2) << std::endl;
+        }
+        else
+        {
+            std::ofstream file(options.output);
+            file << report.dump(2) << std::endl;
+            if (!file)
+                throw std::runtime_error("Failed to write " + options.output);
+        }
+
+        return regressions > 0 ? 2 : 0;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "[error] " << e.what() << "\n";
+        return 1;
+    }
+}